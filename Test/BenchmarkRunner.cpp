@@ -0,0 +1,815 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "BenchmarkRunner.h"
+#include "Lv2Host.h"
+#include "HostedLv2Plugin.h"
+#include "TtlPluginInfo.h"
+#include "RtSafetyMonitor.h"
+#include "lv2/atom/forge.h"
+#include "lv2/patch/patch.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <random>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace toob;
+
+JSON_MAP_BEGIN(BenchmarkChainEntry)
+JSON_MAP_REFERENCE(BenchmarkChainEntry, uri)
+JSON_MAP_REFERENCE(BenchmarkChainEntry, name)
+JSON_MAP_REFERENCE(BenchmarkChainEntry, library)
+JSON_MAP_REFERENCE(BenchmarkChainEntry, controls)
+JSON_MAP_REFERENCE(BenchmarkChainEntry, files)
+JSON_MAP_END()
+
+JSON_MAP_BEGIN(BenchmarkPluginResult)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, name)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, uri)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, nsPerFrame)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, medianNsPerFrame)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, meanBlockUs)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, p99BlockUs)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, maxBlockUs)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, dspLoadPercent)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, heapBytes)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, rtAllocations)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, rtFrees)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, rtMutexLocks)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, tailNsPerFrame)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, tailSlowdown)
+JSON_MAP_REFERENCE(BenchmarkPluginResult, tailSubnormals)
+JSON_MAP_END()
+
+JSON_MAP_BEGIN(BenchmarkReport)
+JSON_MAP_REFERENCE(BenchmarkReport, sampleRate)
+JSON_MAP_REFERENCE(BenchmarkReport, blockSize)
+JSON_MAP_REFERENCE(BenchmarkReport, seconds)
+JSON_MAP_REFERENCE(BenchmarkReport, blocks)
+JSON_MAP_REFERENCE(BenchmarkReport, plugins)
+JSON_MAP_REFERENCE(BenchmarkReport, total)
+JSON_MAP_REFERENCE(BenchmarkReport, peakRssBytes)
+JSON_MAP_REFERENCE(BenchmarkReport, rtSafetyChecked)
+JSON_MAP_REFERENCE(BenchmarkReport, denormalChecked)
+JSON_MAP_REFERENCE(BenchmarkReport, tailSeconds)
+JSON_MAP_END()
+
+namespace {
+	using clock_t_ = std::chrono::steady_clock;
+
+	// Bytes currently allocated from the heap (0 where the C library can't tell us).
+	int64_t HeapBytes()
+	{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+		struct mallinfo2 info = mallinfo2();
+		return (int64_t)(info.uordblks + info.hblkhd);
+#else
+		return 0;
+#endif
+	}
+
+	// Process high-water resident set size.
+	int64_t PeakRssBytes()
+	{
+		std::ifstream f("/proc/self/status");
+		std::string line;
+		while (std::getline(f, line))
+		{
+			if (line.rfind("VmHWM:", 0) == 0)
+			{
+				std::istringstream s(line.substr(6));
+				int64_t kb = 0;
+				s >> kb;
+				return kb * 1024;
+			}
+		}
+		return 0;
+	}
+
+	BenchmarkPluginResult MakeResult(std::vector<double>& blockTimesNs, uint32_t blockSize, double sampleRate)
+	{
+		BenchmarkPluginResult result;
+		if (blockTimesNs.empty())
+		{
+			return result;
+		}
+		double total = 0;
+		for (double t : blockTimesNs)
+		{
+			total += t;
+		}
+		std::sort(blockTimesNs.begin(), blockTimesNs.end());
+		size_t n = blockTimesNs.size();
+		size_t p99Index = (size_t)std::ceil(n * 0.99) - 1;
+
+		double mean = total / n;
+		result.nsPerFrame_ = mean / blockSize;
+		result.medianNsPerFrame_ = blockTimesNs[n / 2] / blockSize;
+		result.meanBlockUs_ = mean * 1E-3;
+		result.p99BlockUs_ = blockTimesNs[std::min(p99Index, n - 1)] * 1E-3;
+		result.maxBlockUs_ = blockTimesNs[n - 1] * 1E-3;
+		double blockPeriodNs = blockSize * 1E9 / sampleRate;
+		result.dspLoadPercent_ = mean * 100 / blockPeriodNs;
+		return result;
+	}
+
+	// The largest median block time over windows of windowBlocks consecutive blocks, with windows
+	// starting every quarter window.
+	double WorstWindowMedianNs(const std::vector<double>& blockTimesNs, size_t windowBlocks)
+	{
+		if (blockTimesNs.empty())
+		{
+			return 0;
+		}
+		windowBlocks = std::clamp(windowBlocks, (size_t)1, blockTimesNs.size());
+		size_t step = std::max(windowBlocks / 4, (size_t)1);
+		std::vector<double> window(windowBlocks);
+		double worst = 0;
+		for (size_t start = 0; start + windowBlocks <= blockTimesNs.size(); start += step)
+		{
+			std::copy(blockTimesNs.begin() + start, blockTimesNs.begin() + start + windowBlocks, window.begin());
+			std::nth_element(window.begin(), window.begin() + windowBlocks / 2, window.end());
+			worst = std::max(worst, window[windowBlocks / 2]);
+		}
+		return worst;
+	}
+}
+
+struct BenchmarkRunner::ChainPlugin {
+	ChainPlugin(const BenchmarkChainEntry& entry, const std::filesystem::path& bundlePath)
+		: entry(entry), info(bundlePath, entry.uri_)
+	{
+	}
+	BenchmarkChainEntry entry;
+	TtlPluginInfo info;
+	HostedLv2Plugin* plugin = nullptr;
+	std::vector<int> audioInputs;
+	std::vector<int> audioOutputs;
+	std::vector<double> blockTimesNs;
+	std::vector<double> tailTimesNs;
+	uint64_t tailSubnormals = 0;
+	int64_t heapBytes = 0;
+	size_t rtScopeId = 0;
+};
+
+BenchmarkRunner::BenchmarkRunner(const Options& options)
+	: options(options)
+{
+	if (options.blockSize == 0)
+	{
+		throw std::runtime_error("Block size must be greater than zero.");
+	}
+	if (options.sampleRate <= 0)
+	{
+		throw std::runtime_error("Sample rate must be greater than zero.");
+	}
+	host = std::make_unique<Lv2Host>((float)options.sampleRate, (int)options.blockSize);
+	if (options.denormalCheck && options.tailSeconds <= 0)
+	{
+		throw std::runtime_error("Tail length must be greater than zero.");
+	}
+	silence.resize(options.blockSize);
+
+	RtSafetyMonitor::Enable(options.rtSafetyCheck);
+	RtSafetyMonitor::SetTrap(options.rtSafetyTrap);
+	RtSafetyMonitor::ResetViolationCounts();
+}
+
+BenchmarkRunner::~BenchmarkRunner()
+{
+	if (host)
+	{
+		for (auto& plugin : plugins)
+		{
+			plugin->plugin->Deactivate();
+		}
+	}
+	plugins.clear();
+	host = nullptr;
+	RtSafetyMonitor::Enable(false);
+}
+
+std::vector<BenchmarkChainEntry> BenchmarkRunner::ReadChain(const std::filesystem::path& chainFile)
+{
+	std::ifstream f(chainFile);
+	if (!f.is_open())
+	{
+		throw std::runtime_error("Can't open " + chainFile.string());
+	}
+	std::vector<BenchmarkChainEntry> chain;
+	try {
+		pipedal::json_reader reader(f);
+		reader.read(&chain);
+	}
+	catch (const std::exception& e)
+	{
+		throw std::runtime_error(chainFile.string() + ": " + e.what());
+	}
+	return chain;
+}
+
+void BenchmarkRunner::LoadChain(const std::filesystem::path& chainFile)
+{
+	LoadChain(ReadChain(chainFile));
+}
+
+void BenchmarkRunner::LoadChain(const std::vector<BenchmarkChainEntry>& chain)
+{
+	if (chain.empty())
+	{
+		throw std::runtime_error("The chain contains no plugins.");
+	}
+	for (const auto& entry : chain)
+	{
+		AddPlugin(entry);
+	}
+}
+
+std::string BenchmarkRunner::UnsupportedFeature(const TtlPluginInfo& info) const
+{
+	for (const auto& feature : info.RequiredFeatures())
+	{
+		if (!host->SupportsFeature(feature))
+		{
+			return feature;
+		}
+	}
+	return "";
+}
+
+void BenchmarkRunner::AddPlugin(const BenchmarkChainEntry& entry)
+{
+	std::filesystem::path library = entry.library_.empty() ? options.library : std::filesystem::path(entry.library_);
+	std::filesystem::path bundle = entry.library_.empty() && !options.bundle.empty() ? options.bundle : library.parent_path();
+
+	int64_t heapBefore = HeapBytes();
+
+	if (plugins.size() >= RtSafetyMonitor::MAX_SCOPE_ID)
+	{
+		throw std::runtime_error("Too many plugins in the chain.");
+	}
+	auto chainPlugin = std::make_unique<ChainPlugin>(entry, bundle);
+	chainPlugin->rtScopeId = plugins.size();
+	std::string missingFeature = UnsupportedFeature(chainPlugin->info);
+	if (!missingFeature.empty())
+	{
+		throw std::runtime_error("Plugin " + entry.uri_ + " requires " + missingFeature + ", which hostTest doesn't provide.");
+	}
+	if (chainPlugin->entry.name_.empty())
+	{
+		std::string uri = entry.uri_;
+		size_t pos = uri.find_last_of("#/");
+		chainPlugin->entry.name_ = pos == std::string::npos ? uri : uri.substr(pos + 1);
+	}
+	for (const auto& control : entry.controls_)
+	{
+		const auto* port = chainPlugin->info.FindPort(control.first);
+		if (port == nullptr || port->kind != TtlPluginInfo::PortKind::Control || !port->isInput)
+		{
+			throw std::runtime_error("Plugin " + entry.uri_ + " has no control input named '" + control.first + "'.");
+		}
+	}
+
+	HostedLv2Plugin* plugin = host->CreatePlugin(library.string().c_str(), entry.uri_.c_str());
+	if (plugin == nullptr)
+	{
+		throw std::runtime_error("Can't load " + library.string());
+	}
+	chainPlugin->plugin = plugin;
+
+	for (const auto& port : chainPlugin->info.Ports())
+	{
+		switch (port.kind)
+		{
+		case TtlPluginInfo::PortKind::Control:
+			if (port.isInput)
+			{
+				float value = port.defaultValue;
+				auto f = entry.controls_.find(port.symbol);
+				if (f != entry.controls_.end())
+				{
+					value = f->second;
+				}
+				if (port.hasRange)
+				{
+					plugin->SetPortType(port.index, PortType::InputControl, port.defaultValue, port.minValue, port.maxValue);
+				}
+				else
+				{
+					plugin->SetPortType(port.index, PortType::InputControl);
+				}
+				plugin->SetControl(port.index, value);
+			}
+			else
+			{
+				plugin->SetPortType(port.index, PortType::OutputControl);
+			}
+			break;
+		case TtlPluginInfo::PortKind::Audio:
+		case TtlPluginInfo::PortKind::CV:
+			// CV ports get a (silent) audio buffer, but don't take part in routing.
+			if (port.isInput)
+			{
+				plugin->SetPortType(port.index, PortType::InputAudio);
+				std::fill_n(plugin->GetInputAudio(port.index), options.blockSize, 0.0f);
+				if (port.kind == TtlPluginInfo::PortKind::Audio)
+				{
+					chainPlugin->audioInputs.push_back(port.index);
+				}
+			}
+			else
+			{
+				plugin->SetPortType(port.index, PortType::OutputAudio);
+				if (port.kind == TtlPluginInfo::PortKind::Audio)
+				{
+					chainPlugin->audioOutputs.push_back(port.index);
+				}
+			}
+			break;
+		case TtlPluginInfo::PortKind::Atom:
+			if (port.isInput)
+			{
+				plugin->SetPortType(port.index, PortType::InputAtomStream, 8192);
+			}
+			else
+			{
+				plugin->SetPortType(port.index, PortType::OutputAtomStream, 65536);
+			}
+			break;
+		default:
+			throw std::runtime_error("Plugin " + entry.uri_ + ": port '" + port.symbol + "' has an unsupported port type.");
+		}
+	}
+	plugin->Activate();
+
+	if (!entry.files_.empty())
+	{
+		LV2_URID_Map* map = host->GetMap();
+		LV2_URID patch_Set = map->map(map->handle, LV2_PATCH__Set);
+		LV2_URID patch_property = map->map(map->handle, LV2_PATCH__property);
+		LV2_URID patch_value = map->map(map->handle, LV2_PATCH__value);
+
+		LV2_Atom_Forge forge;
+		lv2_atom_forge_init(&forge, map);
+		std::vector<uint8_t> buffer(4096);
+
+		for (const auto& file : entry.files_)
+		{
+			std::string property = chainPlugin->info.ResolveWritableProperty(file.first);
+			std::filesystem::path path = std::filesystem::absolute(file.second);
+			if (!std::filesystem::exists(path))
+			{
+				throw std::runtime_error("File not found: " + path.string());
+			}
+			std::string pathString = path.string();
+
+			lv2_atom_forge_set_buffer(&forge, buffer.data(), buffer.size());
+			LV2_Atom_Forge_Frame frame;
+			lv2_atom_forge_object(&forge, &frame, 0, patch_Set);
+			lv2_atom_forge_key(&forge, patch_property);
+			lv2_atom_forge_urid(&forge, map->map(map->handle, property.c_str()));
+			lv2_atom_forge_key(&forge, patch_value);
+			lv2_atom_forge_path(&forge, pathString.c_str(), (uint32_t)pathString.length());
+			lv2_atom_forge_pop(&forge, &frame);
+
+			plugin->WriteInputAtom((const LV2_Atom*)buffer.data());
+		}
+	}
+
+	// Run on silence, in real time, so that files get loaded, and background threads get to finish.
+	uint64_t loadFrames = (uint64_t)(options.loadSeconds * options.sampleRate);
+	paceStart = clock_t_::now();
+	for (uint64_t frame = 0; frame < loadFrames; frame += options.blockSize)
+	{
+		for (int port : chainPlugin->audioInputs)
+		{
+			std::copy(silence.begin(), silence.end(), plugin->GetInputAudio(port));
+		}
+		plugin->PrepareAtomPorts();
+		{
+			RtSafetyMonitor::Scope rtScope(chainPlugin->rtScopeId);
+			plugin->RunInstance(options.blockSize);
+		}
+		plugin->RunWork();
+		PaceTo(frame + options.blockSize);
+	}
+	chainPlugin->heapBytes = HeapBytes() - heapBefore;
+
+	plugins.push_back(std::move(chainPlugin));
+}
+
+void BenchmarkRunner::PaceTo(uint64_t frames)
+{
+	auto target = paceStart + std::chrono::nanoseconds((int64_t)(frames * 1E9 / options.sampleRate));
+	std::this_thread::sleep_until(target);
+}
+
+void BenchmarkRunner::RunBlock(const float* input, uint32_t frames, Phase phase)
+{
+	const float* channels[2] = { input, input };
+	size_t nChannels = 1;
+
+	for (auto& chainPlugin : plugins)
+	{
+		HostedLv2Plugin* plugin = chainPlugin->plugin;
+		for (size_t j = 0; j < chainPlugin->audioInputs.size(); ++j)
+		{
+			const float* source = channels[std::min(j, nChannels - 1)];
+			std::copy(source, source + frames, plugin->GetInputAudio(chainPlugin->audioInputs[j]));
+		}
+		plugin->PrepareAtomPorts();
+
+		clock_t_::time_point t0, t1;
+		{
+			RtSafetyMonitor::Scope rtScope(chainPlugin->rtScopeId);
+			t0 = clock_t_::now();
+			plugin->RunInstance(frames);
+			t1 = clock_t_::now();
+		}
+
+		plugin->RunWork();
+		double timeNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+		if (phase == Phase::Measure)
+		{
+			chainPlugin->blockTimesNs.push_back(timeNs);
+		}
+		else if (phase == Phase::Tail)
+		{
+			chainPlugin->tailTimesNs.push_back(timeNs);
+			for (int port : chainPlugin->audioOutputs)
+			{
+				const float* output = plugin->GetOutputAudio(port);
+				for (uint32_t i = 0; i < frames; ++i)
+				{
+					if (std::fpclassify(output[i]) == FP_SUBNORMAL)
+					{
+						++chainPlugin->tailSubnormals;
+					}
+				}
+			}
+		}
+
+		// A plugin without audio outputs (e.g. a tuner) passes its input through.
+		if (!chainPlugin->audioOutputs.empty())
+		{
+			nChannels = std::min(chainPlugin->audioOutputs.size(), (size_t)2);
+			for (size_t j = 0; j < nChannels; ++j)
+			{
+				channels[j] = plugin->GetOutputAudio(chainPlugin->audioOutputs[j]);
+			}
+		}
+	}
+}
+
+BenchmarkReport BenchmarkRunner::Run()
+{
+	if (plugins.empty())
+	{
+		throw std::runtime_error("No plugins loaded.");
+	}
+	std::vector<float> signal = GenerateTestSignal(options.sampleRate);
+	std::vector<float> block(options.blockSize);
+	size_t signalPosition = 0;
+	auto nextBlock = [&]() {
+		for (size_t i = 0; i < block.size(); ++i)
+		{
+			block[i] = signal[signalPosition++];
+			if (signalPosition == signal.size())
+			{
+				signalPosition = 0;
+			}
+		}
+		return block.data();
+	};
+
+	uint64_t warmupBlocks = (uint64_t)(options.warmupSeconds * options.sampleRate / options.blockSize);
+	uint64_t measuredBlocks = (uint64_t)std::ceil(options.seconds * options.sampleRate / options.blockSize);
+
+	for (auto& plugin : plugins)
+	{
+		plugin->blockTimesNs.clear();
+		plugin->blockTimesNs.reserve(measuredBlocks);
+	}
+
+	// Warm-up is always paced in real time, so that caches, branch predictors and
+	// any lazily-initialized background processing reach a steady state.
+	paceStart = clock_t_::now();
+	for (uint64_t i = 0; i < warmupBlocks; ++i)
+	{
+		RunBlock(nextBlock(), options.blockSize, Phase::Warmup);
+		PaceTo((i + 1) * options.blockSize);
+	}
+
+	paceStart = clock_t_::now();
+	for (uint64_t i = 0; i < measuredBlocks; ++i)
+	{
+		RunBlock(nextBlock(), options.blockSize, Phase::Measure);
+		if (options.realtime)
+		{
+			PaceTo((i + 1) * options.blockSize);
+		}
+	}
+	if (options.denormalCheck)
+	{
+		RunTail();
+	}
+
+	BenchmarkReport report;
+	report.sampleRate_ = options.sampleRate;
+	report.blockSize_ = options.blockSize;
+	report.blocks_ = measuredBlocks;
+	report.seconds_ = measuredBlocks * options.blockSize / options.sampleRate;
+
+	std::vector<double> chainTimesNs(measuredBlocks, 0.0);
+	for (auto& plugin : plugins)
+	{
+		for (size_t i = 0; i < measuredBlocks; ++i)
+		{
+			chainTimesNs[i] += plugin->blockTimesNs[i];
+		}
+		BenchmarkPluginResult result = MakeResult(plugin->blockTimesNs, options.blockSize, options.sampleRate);
+		result.name_ = plugin->entry.name_;
+		result.uri_ = plugin->entry.uri_;
+		result.heapBytes_ = plugin->heapBytes;
+		result.rtAllocations_ = RtSafetyMonitor::GetViolationCount(plugin->rtScopeId, RtSafetyMonitor::Violation::Allocate);
+		result.rtFrees_ = RtSafetyMonitor::GetViolationCount(plugin->rtScopeId, RtSafetyMonitor::Violation::Free);
+		result.rtMutexLocks_ = RtSafetyMonitor::GetViolationCount(plugin->rtScopeId, RtSafetyMonitor::Violation::MutexLock);
+		report.plugins_.push_back(std::move(result));
+	}
+	report.total_ = MakeResult(chainTimesNs, options.blockSize, options.sampleRate);
+	report.total_.name_ = "Total";
+	for (const auto& result : report.plugins_)
+	{
+		report.total_.heapBytes_ += result.heapBytes_;
+		report.total_.rtAllocations_ += result.rtAllocations_;
+		report.total_.rtFrees_ += result.rtFrees_;
+		report.total_.rtMutexLocks_ += result.rtMutexLocks_;
+	}
+	if (options.denormalCheck)
+	{
+		report.denormalChecked_ = true;
+		report.tailSeconds_ = options.tailSeconds;
+
+		size_t windowBlocks = (size_t)std::ceil(options.sampleRate / options.blockSize);
+		size_t tailBlocks = plugins[0]->tailTimesNs.size();
+		std::vector<double> chainTailTimesNs(tailBlocks, 0.0);
+		for (size_t p = 0; p < plugins.size(); ++p)
+		{
+			const ChainPlugin& plugin = *plugins[p];
+			BenchmarkPluginResult& result = report.plugins_[p];
+			for (size_t i = 0; i < tailBlocks; ++i)
+			{
+				chainTailTimesNs[i] += plugin.tailTimesNs[i];
+			}
+			result.tailNsPerFrame_ = WorstWindowMedianNs(plugin.tailTimesNs, windowBlocks) / options.blockSize;
+			result.tailSlowdown_ = result.medianNsPerFrame_ == 0 ? 0 : result.tailNsPerFrame_ / result.medianNsPerFrame_;
+			result.tailSubnormals_ = plugin.tailSubnormals;
+			report.total_.tailSubnormals_ += result.tailSubnormals_;
+		}
+		report.total_.tailNsPerFrame_ = WorstWindowMedianNs(chainTailTimesNs, windowBlocks) / options.blockSize;
+		report.total_.tailSlowdown_ = report.total_.medianNsPerFrame_ == 0 ? 0 : report.total_.tailNsPerFrame_ / report.total_.medianNsPerFrame_;
+	}
+	report.peakRssBytes_ = PeakRssBytes();
+	report.rtSafetyChecked_ = RtSafetyMonitor::IsEnabled();
+	return report;
+}
+
+void BenchmarkRunner::RunTail()
+{
+	// Plugins are expected to set FTZ/DAZ themselves (see LsNumerics::AutoDenorm); the host thread
+	// deliberately leaves the FPU in its default IEEE mode, so that a plugin that doesn't shows up here.
+	std::vector<float> tail = GenerateDecayingTail(options.sampleRate, options.tailSeconds);
+	for (float value : tail)
+	{
+		if (std::fpclassify(value) == FP_SUBNORMAL)
+		{
+			throw std::logic_error("Denormal check input contains subnormal samples.");
+		}
+	}
+	uint64_t tailBlocks = tail.size() / options.blockSize;
+
+	for (auto& plugin : plugins)
+	{
+		plugin->tailTimesNs.clear();
+		plugin->tailTimesNs.reserve(tailBlocks);
+		plugin->tailSubnormals = 0;
+	}
+	paceStart = clock_t_::now();
+	for (uint64_t i = 0; i < tailBlocks; ++i)
+	{
+		RunBlock(tail.data() + i * options.blockSize, options.blockSize, Phase::Tail);
+		if (options.realtime)
+		{
+			PaceTo((i + 1) * options.blockSize);
+		}
+	}
+}
+
+std::vector<float> BenchmarkRunner::GenerateTestSignal(double sampleRate)
+{
+	// Plucked notes on each open guitar string, 0.5s each.
+	static constexpr double noteFrequencies[] = { 82.41, 110.0, 146.83, 196.0, 246.94, 329.63 };
+	constexpr size_t HARMONICS = 12;
+	const size_t noteLength = (size_t)(sampleRate * 0.5);
+
+	std::vector<float> result(noteLength * std::size(noteFrequencies));
+
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+	const float noiseLevel = 0.0005f; // -66dB.
+
+	size_t position = 0;
+	for (double f : noteFrequencies)
+	{
+		for (size_t i = 0; i < noteLength; ++i)
+		{
+			double t = i / sampleRate;
+			double value = 0;
+			for (size_t h = 1; h <= HARMONICS; ++h)
+			{
+				double fh = f * h;
+				if (fh >= sampleRate * 0.45)
+				{
+					break;
+				}
+				// higher harmonics are quieter, and decay faster.
+				value += std::sin(2 * std::numbers::pi * fh * t) * std::exp(-t * (3.0 + h)) / h;
+			}
+			result[position++] = (float)(value * 0.2) + noise(rng) * noiseLevel;
+		}
+	}
+	return result;
+}
+
+std::vector<float> BenchmarkRunner::GenerateDecayingTail(double sampleRate, double seconds)
+{
+	// Decays at a constant rate from -14dB to just above the smallest normal float (~ -758dB), so that
+	// filter and delay state in the plugins decays into the subnormal range. Samples near the zero
+	// crossings that would round to subnormals are flushed to zero, so that the input itself has no
+	// subnormals, and a plugin that passes its input straight through isn't blamed for subnormal output.
+	constexpr double frequency = 110.0;
+	constexpr double startDb = -14;
+	constexpr double endDb = -740;
+
+	std::vector<float> result((size_t)(sampleRate * seconds));
+	size_t decayLength = result.size() / 2;
+	for (size_t i = 0; i < decayLength; ++i)
+	{
+		double db = startDb + (endDb - startDb) * i / decayLength;
+		double value = std::sin(2 * std::numbers::pi * frequency * i / sampleRate) * std::pow(10.0, db / 20);
+		result[i] = std::abs(value) < std::numeric_limits<float>::min() ? 0.0f : (float)value;
+	}
+	return result;
+}
+
+void BenchmarkRunner::PrintReport(std::ostream& s, const BenchmarkReport& report)
+{
+	std::ios_base::fmtflags flags = s.flags();
+	std::streamsize precision = s.precision();
+
+	s << "Sample rate: " << report.sampleRate_ << "  Block size: " << report.blockSize_
+	  << "  Measured: " << std::fixed << std::setprecision(1) << report.seconds_ << "s (" << report.blocks_ << " blocks)" << std::endl;
+	s << std::endl;
+
+	size_t nameWidth = 8;
+	for (const auto& result : report.plugins_)
+	{
+		nameWidth = std::max(nameWidth, result.name_.length() + 2);
+	}
+
+	s << std::left << std::setw((int)nameWidth) << "Plugin" << std::right
+	  << std::setw(10) << "ns/frame"
+	  << std::setw(12) << "mean us"
+	  << std::setw(12) << "p99 us"
+	  << std::setw(12) << "max us"
+	  << std::setw(9) << "%DSP"
+	  << std::setw(12) << "heap MiB"
+	  << std::endl;
+
+	auto printLine = [&](const BenchmarkPluginResult& result) {
+		s << std::left << std::setw((int)nameWidth) << result.name_ << std::right << std::fixed
+		  << std::setw(10) << std::setprecision(1) << result.nsPerFrame_
+		  << std::setw(12) << std::setprecision(2) << result.meanBlockUs_
+		  << std::setw(12) << std::setprecision(2) << result.p99BlockUs_
+		  << std::setw(12) << std::setprecision(2) << result.maxBlockUs_
+		  << std::setw(9) << std::setprecision(2) << result.dspLoadPercent_
+		  << std::setw(12) << std::setprecision(2) << result.heapBytes_ / (1024.0 * 1024.0)
+		  << std::endl;
+	};
+	for (const auto& result : report.plugins_)
+	{
+		printLine(result);
+	}
+	s << std::endl;
+	printLine(report.total_);
+	s << std::endl;
+	s << "Peak RSS: " << std::setprecision(1) << report.peakRssBytes_ / (1024.0 * 1024.0) << " MiB" << std::endl;
+
+	s << std::endl;
+	if (!report.rtSafetyChecked_)
+	{
+		s << "Real-time safety: not checked." << std::endl;
+	}
+	else if (report.total_.RtViolations() == 0)
+	{
+		s << "Real-time safety: no allocations or mutex locks in run()." << std::endl;
+	}
+	else
+	{
+		s << "Real-time safety violations in run():" << std::endl;
+		for (const auto& result : report.plugins_)
+		{
+			if (result.RtViolations() != 0)
+			{
+				s << "    " << std::left << std::setw((int)nameWidth) << result.name_ << std::right
+				  << "allocations: " << result.rtAllocations_
+				  << "  frees: " << result.rtFrees_
+				  << "  mutex locks: " << result.rtMutexLocks_
+				  << std::endl;
+			}
+		}
+	}
+
+	if (report.denormalChecked_)
+	{
+		s << std::endl;
+		s << "Denormal check (" << std::setprecision(1) << report.tailSeconds_ << "s decaying tail, median block times, slowest 1s window):" << std::endl;
+		s << "    " << std::left << std::setw((int)nameWidth) << "Plugin" << std::right
+		  << std::setw(10) << "med ns/f"
+		  << std::setw(12) << "tail ns/f"
+		  << std::setw(10) << "ratio"
+		  << std::setw(13) << "subnormals"
+		  << std::endl;
+		auto printTailLine = [&](const BenchmarkPluginResult& result) {
+			s << "    " << std::left << std::setw((int)nameWidth) << result.name_ << std::right << std::fixed
+			  << std::setw(10) << std::setprecision(1) << result.medianNsPerFrame_
+			  << std::setw(12) << std::setprecision(1) << result.tailNsPerFrame_
+			  << std::setw(10) << std::setprecision(2) << result.tailSlowdown_
+			  << std::setw(13) << result.tailSubnormals_
+			  << (result.DenormalFailure() ? "  <--" : "")
+			  << std::endl;
+		};
+		for (const auto& result : report.plugins_)
+		{
+			printTailLine(result);
+		}
+		printTailLine(report.total_);
+
+		if (report.DenormalFailure())
+		{
+			s << "Denormals: subnormal output, or tail more than "
+			  << std::setprecision(1) << BenchmarkPluginResult::DENORMAL_SLOWDOWN_LIMIT << "x slower than signal (marked <--)." << std::endl;
+		}
+		else
+		{
+			s << "Denormals: no slowdowns or subnormal output in decaying tails." << std::endl;
+		}
+	}
+	s.flags(flags);
+	s.precision(precision);
+}
+
+void BenchmarkRunner::WriteReport(std::ostream& s, const BenchmarkReport& report)
+{
+	pipedal::json_writer writer(s, false);
+	writer.write(report);
+	s << std::endl;
+}
+
+void BenchmarkRunner::WriteReports(std::ostream& s, const std::vector<BenchmarkReport>& reports)
+{
+	pipedal::json_writer writer(s, false);
+	writer.write(reports);
+	s << std::endl;
+}
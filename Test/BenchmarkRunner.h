@@ -0,0 +1,181 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "json.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <filesystem>
+#include <iostream>
+#include <chrono>
+
+namespace toob {
+
+	class Lv2Host;
+	class HostedLv2Plugin;
+	class TtlPluginInfo;
+
+	/// One plugin in a benchmark chain description.
+	///
+	/// A chain description is a JSON array of these:
+	///
+	///     [
+	///         { "uri": "http://two-play.com/plugins/toob-input_stage", "controls": { "trim": 6 } },
+	///         { "uri": "http://two-play.com/plugins/toob-nam", "files": { "modelFile": "/path/to/model.nam" } },
+	///         { "uri": "http://two-play.com/plugins/toob-convolution-reverb", "files": { "impulseFile": "/path/to/ir.wav" } }
+	///     ]
+	///
+	/// Controls are port symbols; unspecified controls take their default values. Files are
+	/// patch:writable properties (full URI, or the name after the URI's '#'), sent as patch:Set messages.
+	class BenchmarkChainEntry {
+	public:
+		std::string uri_;
+		std::string name_;     // optional display name.
+		std::string library_;  // optional plugin library; defaults to the runner's library.
+		std::map<std::string, float> controls_;
+		std::map<std::string, std::string> files_;
+
+		DECLARE_JSON_MAP(BenchmarkChainEntry);
+	};
+
+	class BenchmarkPluginResult {
+	public:
+		std::string name_;
+		std::string uri_;
+		double nsPerFrame_ = 0;
+		double medianNsPerFrame_ = 0;
+		double meanBlockUs_ = 0;
+		double p99BlockUs_ = 0;
+		double maxBlockUs_ = 0;
+		double dspLoadPercent_ = 0;
+		int64_t heapBytes_ = 0; // heap growth from instantiation through file loading.
+		// Real-time safety violations: calls made from inside run().
+		uint64_t rtAllocations_ = 0;
+		uint64_t rtFrees_ = 0;
+		uint64_t rtMutexLocks_ = 0;
+
+		// Denormal check: the median block time of the slowest one-second window of a decaying tail,
+		// relative to medianNsPerFrame_. Medians, so that a few pre-empted blocks don't count as a slowdown.
+		double tailNsPerFrame_ = 0;
+		double tailSlowdown_ = 0;
+		uint64_t tailSubnormals_ = 0; // subnormal samples in the plugin's audio output during the tail.
+
+		uint64_t RtViolations() const { return rtAllocations_ + rtFrees_ + rtMutexLocks_; }
+
+		static constexpr double DENORMAL_SLOWDOWN_LIMIT = 2.0;
+		bool DenormalFailure() const { return tailSubnormals_ != 0 || tailSlowdown_ > DENORMAL_SLOWDOWN_LIMIT; }
+
+		DECLARE_JSON_MAP(BenchmarkPluginResult);
+	};
+
+	class BenchmarkReport {
+	public:
+		double sampleRate_ = 0;
+		uint32_t blockSize_ = 0;
+		double seconds_ = 0;
+		uint64_t blocks_ = 0;
+		std::vector<BenchmarkPluginResult> plugins_;
+		BenchmarkPluginResult total_;
+		int64_t peakRssBytes_ = 0;
+		bool rtSafetyChecked_ = false;
+		bool denormalChecked_ = false;
+		double tailSeconds_ = 0;
+
+		bool DenormalFailure() const
+		{
+			for (const auto& plugin : plugins_)
+			{
+				if (plugin.DenormalFailure())
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		DECLARE_JSON_MAP(BenchmarkReport);
+	};
+
+	/// Renders a fixed test signal through a chain of hosted plugins, and times each plugin's run() calls.
+	class BenchmarkRunner {
+	public:
+		struct Options {
+			double sampleRate = 48000;
+			uint32_t blockSize = 64;
+			double seconds = 10;         // measured audio.
+			double warmupSeconds = 3;    // unmeasured audio, before measurement starts.
+			double loadSeconds = 1;      // per-plugin time allowed for files to load.
+			bool realtime = true;        // pace blocks in real time (background threads see realistic scheduling).
+			bool rtSafetyCheck = true;   // count allocations, frees and mutex locks made inside run(). See RtSafetyMonitor.
+			bool rtSafetyTrap = false;   // raise SIGTRAP at each real-time safety violation.
+			bool denormalCheck = false;  // after measuring, time a decaying tail, and check for denormal slowdowns.
+			double tailSeconds = 10;     // length of the decaying tail.
+			std::filesystem::path library;
+			std::filesystem::path bundle; // directory containing the plugins' .ttl files; defaults to the library's directory.
+		};
+
+		BenchmarkRunner(const Options& options);
+		~BenchmarkRunner();
+
+		static std::vector<BenchmarkChainEntry> ReadChain(const std::filesystem::path& chainFile);
+
+		void LoadChain(const std::filesystem::path& chainFile);
+		void LoadChain(const std::vector<BenchmarkChainEntry>& chain);
+
+		/// The first of the plugin's required features that the host doesn't provide, or an empty string.
+		std::string UnsupportedFeature(const TtlPluginInfo& info) const;
+
+		BenchmarkReport Run();
+
+		static void PrintReport(std::ostream& s, const BenchmarkReport& report);
+		static void WriteReport(std::ostream& s, const BenchmarkReport& report);
+		static void WriteReports(std::ostream& s, const std::vector<BenchmarkReport>& reports);
+
+		/// The test signal: plucked-string notes across the guitar range, with a low noise floor.
+		static std::vector<float> GenerateTestSignal(double sampleRate);
+
+		/// A note that decays to the bottom of the normal float range over the first half of the tail, followed by silence.
+		static std::vector<float> GenerateDecayingTail(double sampleRate, double seconds);
+
+	private:
+		struct ChainPlugin;
+
+		void AddPlugin(const BenchmarkChainEntry& entry);
+		enum class Phase { Warmup, Measure, Tail };
+
+		void RunBlock(const float* input, uint32_t frames, Phase phase);
+		void RunTail();
+		void PaceTo(uint64_t frames);
+
+		Options options;
+		std::unique_ptr<Lv2Host> host;
+		std::vector<std::unique_ptr<ChainPlugin>> plugins;
+		std::vector<float> silence;
+
+		std::chrono::steady_clock::time_point paceStart;
+	};
+}
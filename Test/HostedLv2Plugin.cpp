@@ -23,6 +23,8 @@
 
 #include "HostedLv2Plugin.h"
 #include "Lv2Exception.h"
+#include "lv2/atom/util.h"
+#include <cstring>
 
 
 using namespace toob;
@@ -70,10 +72,80 @@ HostedLv2Plugin::~HostedLv2Plugin()
 
 void HostedLv2Plugin::Instantiate(const LV2_Descriptor* descriptor, const char* resourcePath) noexcept(false)
 {
-	this->instance = descriptor->instantiate(descriptor, host->GetSampleRate(), resourcePath, host->GetFeatures());
+	// host features, plus a worker schedule for this instance.
+	for (const LV2_Feature* const* pFeature = host->GetFeatures(); *pFeature != nullptr; ++pFeature)
+	{
+		features.push_back(*pFeature);
+	}
+	features.push_back(scheduleFeature.GetFeature());
+	features.push_back(nullptr);
+
+	this->instance = descriptor->instantiate(descriptor, host->GetSampleRate(), resourcePath, features.data());
 	this->descriptor = descriptor;
+	if (this->instance == nullptr)
+	{
+		throw Lv2Exception("Failed to instantiate plugin.");
+	}
+	if (descriptor->extension_data)
+	{
+		workerInterface = (const LV2_Worker_Interface*)descriptor->extension_data(LV2_WORKER__interface);
+	}
+}
 
-	
+void HostedLv2Plugin::ScheduleWork(uint32_t size, const void* data)
+{
+	const uint8_t* p = (const uint8_t*)data;
+	workRequests.push_back(std::vector<uint8_t>(p, p + size));
+}
+
+LV2_Worker_Status HostedLv2Plugin::WorkerRespond(LV2_Worker_Respond_Handle handle, uint32_t size, const void* data)
+{
+	HostedLv2Plugin* this_ = (HostedLv2Plugin*)handle;
+	const uint8_t* p = (const uint8_t*)data;
+	this_->workResponses.push_back(std::vector<uint8_t>(p, p + size));
+	return LV2_WORKER_SUCCESS;
+}
+
+void HostedLv2Plugin::RunWork()
+{
+	if (!workerInterface)
+	{
+		workRequests.clear();
+		return;
+	}
+	while (!workRequests.empty())
+	{
+		std::vector<std::vector<uint8_t>> requests;
+		std::swap(requests, workRequests);
+		for (const auto& request : requests)
+		{
+			workerInterface->work(instance, WorkerRespond, (LV2_Worker_Respond_Handle)this, (uint32_t)request.size(), request.data());
+		}
+	}
+	while (!workResponses.empty())
+	{
+		std::vector<std::vector<uint8_t>> responses;
+		std::swap(responses, workResponses);
+		for (const auto& response : responses)
+		{
+			workerInterface->work_response(instance, (uint32_t)response.size(), response.data());
+		}
+	}
+	if (workerInterface->end_run)
+	{
+		workerInterface->end_run(instance);
+	}
+}
+
+void HostedLv2Plugin::WriteInputAtom(const LV2_Atom* atom)
+{
+	size_t eventSize = sizeof(LV2_Atom_Event) + atom->size;
+	size_t offset = pendingInputEvents.size();
+	pendingInputEvents.resize(offset + lv2_atom_pad_size((uint32_t)eventSize));
+
+	LV2_Atom_Event* event = (LV2_Atom_Event*)(pendingInputEvents.data() + offset);
+	event->time.frames = 0;
+	memcpy(&event->body, atom, sizeof(LV2_Atom) + atom->size);
 }
 
 
@@ -158,7 +230,7 @@ void HostedLv2Plugin::SetPortType(int port, PortType portType, uint32_t bufferSi
 		LV2_Atom* pAtom = (LV2_Atom*)(void*)buffer;
 		pAtom->size = bufferSize - 8;
 		pAtom->type = uris.ridAtomSequence;
-		inputAtomStreams.push_back(AtomStreamEntry(port, pAtom, bufferSize));
+		outputAtomStreams.push_back(AtomStreamEntry(port, pAtom, bufferSize));
 		ConnectPort(port, buffer);
 	}
 	break;
@@ -211,9 +283,27 @@ void HostedLv2Plugin::PrepareAtomPorts()
 {
 	for (auto i = inputAtomStreams.begin(); i != inputAtomStreams.end(); ++i)
 	{
-		(*i).buffer->type = uris.ridAtomSequence;
-		(*i).buffer->size = 0;
-
+		LV2_Atom_Sequence* sequence = (LV2_Atom_Sequence*)(*i).buffer;
+		sequence->atom.type = uris.ridAtomSequence;
+		sequence->atom.size = sizeof(LV2_Atom_Sequence_Body);
+		sequence->body.unit = 0;
+		sequence->body.pad = 0;
+	}
+	if (!inputAtomStreams.empty() && !pendingInputEvents.empty())
+	{
+		LV2_Atom_Sequence* sequence = (LV2_Atom_Sequence*)inputAtomStreams[0].buffer;
+		uint32_t capacity = inputAtomStreams[0].size - sizeof(LV2_Atom);
+		size_t offset = 0;
+		while (offset < pendingInputEvents.size())
+		{
+			const LV2_Atom_Event* event = (const LV2_Atom_Event*)(pendingInputEvents.data() + offset);
+			if (lv2_atom_sequence_append_event(sequence, capacity, event) == nullptr)
+			{
+				throw Lv2Exception("Input atom buffer overflow.");
+			}
+			offset += lv2_atom_pad_size(sizeof(LV2_Atom_Event) + event->body.size);
+		}
+		pendingInputEvents.clear();
 	}
 	for (auto i = outputAtomStreams.begin(); i != outputAtomStreams.end(); ++i)
 	{
@@ -223,9 +313,13 @@ void HostedLv2Plugin::PrepareAtomPorts()
 	}
 }
 void HostedLv2Plugin::Run(uint32_t samples)
+{
+	RunInstance(samples);
+	RunWork();
+}
+void HostedLv2Plugin::RunInstance(uint32_t samples)
 {
 	this->descriptor->run(this->instance,samples);
-
 }
 void HostedLv2Plugin::Deactivate()
 {
@@ -25,9 +25,12 @@
 
 #include "Lv2Host.h"
 #include <vector>
+#include <cstdint>
 #include "InputControl.h"
 #include "OutputControl.h"
+#include "ScheduleFeature.h"
 #include "lv2/core/lv2.h"
+#include "lv2/worker/worker.h"
 #include "Lv2Exception.h"
 
 
@@ -97,13 +100,28 @@ namespace toob {
 		std::vector<PortType> portTypes;
 		Lv2Host* host;
 
+		// Work is queued during run(), and executed synchronously afterwards, as an offline host is allowed to do.
+		ScheduleFeature scheduleFeature;
+		std::vector<const LV2_Feature*> features;
+		const LV2_Worker_Interface* workerInterface = nullptr;
+		std::vector<std::vector<uint8_t>> workRequests;
+		std::vector<std::vector<uint8_t>> workResponses;
 
+		// LV2_Atom_Events waiting to be delivered to the first input atom port.
+		std::vector<uint8_t> pendingInputEvents;
+
+		void ScheduleWork(uint32_t size, const void* data);
+		static LV2_Worker_Status WorkerRespond(LV2_Worker_Respond_Handle handle, uint32_t size, const void* data);
 
 
 	private:
 		friend class Lv2Host;
 
 		HostedLv2Plugin(Lv2Host* host)
+			: scheduleFeature(
+				[this](uint32_t size, const void* data) {
+					ScheduleWork(size, data);
+				})
 		{
 			this->host = host;
 			uris.Map(host);
@@ -117,6 +135,11 @@ namespace toob {
 
 		void PrepareAtomPorts();
 		void Run(uint32_t samples);
+
+		/// Run the plugin's run() method only. Scheduled work is deferred until RunWork().
+		void RunInstance(uint32_t samples);
+		/// Perform scheduled work, and deliver work responses to the plugin.
+		void RunWork();
 		void Deactivate();
 
 	public:
@@ -144,5 +167,9 @@ namespace toob {
 		{
 			inputControls[control]->SetValue(value);
 		}
+
+		/// Queue an atom (e.g. a patch:Set message) for delivery to the plugin's first
+		/// input atom port, at frame 0 of the next Run().
+		void WriteInputAtom(const LV2_Atom* atom);
 	};
 };
\ No newline at end of file
@@ -34,17 +34,11 @@ using namespace toob;
 
 void LoadTest::Execute()
 {
-	LinkTest();
 	ExecuteInputStage();
 
 
 } 
 
-void LoadTest::LinkTest()
-{
-	const LV2_Descriptor* pDescriptor = lv2_descriptor(0);
-}
-
 void LoadTest::ExecuteInputStage()
 {
 
@@ -28,8 +28,6 @@ class LoadTest {
 public:
 	void Execute();
 private:
-	void LinkTest();
-
 	void ExecuteInputStage();
 
 };
\ No newline at end of file
@@ -22,6 +22,7 @@
  */
 
 #include "LogFeature.h"
+#include "RtSafetyMonitor.h"
 #include <mutex>
 #include <cstdio>
 
@@ -36,6 +37,7 @@ int LogFeature::printfFn(LV2_Log_Handle handle, LV2_URID type, const char* fmt,
 	va_list va;
 	va_start(va, fmt);
 
+	RtSafetyMonitor::Suspend rtSuspend;
 	LogFeature* logFeature = (LogFeature*)handle;
 	return logFeature->vprintf(type, fmt, va);
 }
@@ -45,6 +47,7 @@ int LogFeature::vprintfFn(LV2_Log_Handle handle,
 	const char* fmt,
 	va_list        ap)
 {
+	RtSafetyMonitor::Suspend rtSuspend;
 	LogFeature* logFeature = (LogFeature*)handle;
 	return logFeature->vprintf(type, fmt, ap);
 }
@@ -53,6 +53,23 @@ void Lv2Host::DeletePlugin(HostedLv2Plugin* plugin)
 	delete plugin;
 }
 
+bool Lv2Host::SupportsFeature(const std::string& uri)
+{
+	// HostedLv2Plugin adds a worker schedule to the host's features.
+	if (uri == LV2_WORKER__schedule)
+	{
+		return true;
+	}
+	for (const LV2_Feature* const* pFeature = GetFeatures(); *pFeature != nullptr; ++pFeature)
+	{
+		if (uri == (*pFeature)->URI)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 void Lv2Host::Activate()
 {
 	for (auto plugin : activePlugins)
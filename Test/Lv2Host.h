@@ -26,6 +26,7 @@
 #include "MapFeature.h"
 #include "LogFeature.h"
 #include <vector>
+#include <string>
 #include "Lv2Exception.h"
 #include "lv2/urid/urid.h"
 
@@ -62,6 +63,10 @@ namespace toob {
 		{
 			return mapFeature.GetUrid(uri);
 		}
+		LV2_URID_Map* GetMap()
+		{
+			return mapFeature.GetMap();
+		}
 	protected:
 		void AddFeature(const LV2_Feature* feature)
 		{
@@ -84,6 +89,8 @@ namespace toob {
 			return pFeatures;
 		}
 	public:
+		/// True if plugins created by this host are given the feature.
+		bool SupportsFeature(const std::string& uri);
 
 		void Activate();
 		void Run(int samples);
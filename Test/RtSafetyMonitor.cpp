@@ -0,0 +1,232 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include "RtSafetyMonitor.h"
+#include <atomic>
+#include <csignal>
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define TOOB_RT_SAFETY_INTERPOSE 1
+#include <dlfcn.h>
+#include <pthread.h>
+#include <cerrno>
+#else
+#define TOOB_RT_SAFETY_INTERPOSE 0
+#endif
+
+using namespace toob;
+
+namespace {
+	std::atomic<bool> enabled { false };
+	std::atomic<bool> trap { false };
+	std::atomic<uint64_t> violationCounts[RtSafetyMonitor::MAX_SCOPE_ID][RtSafetyMonitor::VIOLATION_TYPES];
+
+	// Plain thread-locals with no constructors, so that they can be safely touched from inside malloc.
+	thread_local int tScopeId __attribute__((tls_model("initial-exec"))) = -1;
+	thread_local int tSuspendCount __attribute__((tls_model("initial-exec"))) = 0;
+
+	inline void CheckRealtime(RtSafetyMonitor::Violation violation)
+	{
+		if (__builtin_expect(tScopeId >= 0 && tSuspendCount == 0, 0))
+		{
+			violationCounts[tScopeId][(size_t)violation].fetch_add(1, std::memory_order_relaxed);
+			if (trap.load(std::memory_order_relaxed))
+			{
+				// Stop in the debugger without allocating or re-entering the monitor.
+				++tSuspendCount;
+				raise(SIGTRAP);
+				--tSuspendCount;
+			}
+		}
+	}
+}
+
+#if TOOB_RT_SAFETY_INTERPOSE
+
+extern "C" {
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* ptr, size_t size);
+	void* __libc_memalign(size_t alignment, size_t size);
+	void __libc_free(void* ptr);
+
+	// These definitions take precedence over glibc's for the executable, and for plugin libraries loaded
+	// with dlopen. operator new/delete in libstdc++ call through to them.
+
+	void* malloc(size_t size)
+	{
+		CheckRealtime(RtSafetyMonitor::Violation::Allocate);
+		return __libc_malloc(size);
+	}
+	void* calloc(size_t count, size_t size)
+	{
+		CheckRealtime(RtSafetyMonitor::Violation::Allocate);
+		return __libc_calloc(count, size);
+	}
+	void* realloc(void* ptr, size_t size)
+	{
+		CheckRealtime(RtSafetyMonitor::Violation::Allocate);
+		return __libc_realloc(ptr, size);
+	}
+	void* memalign(size_t alignment, size_t size)
+	{
+		CheckRealtime(RtSafetyMonitor::Violation::Allocate);
+		return __libc_memalign(alignment, size);
+	}
+	void* aligned_alloc(size_t alignment, size_t size)
+	{
+		CheckRealtime(RtSafetyMonitor::Violation::Allocate);
+		return __libc_memalign(alignment, size);
+	}
+	int posix_memalign(void** result, size_t alignment, size_t size)
+	{
+		CheckRealtime(RtSafetyMonitor::Violation::Allocate);
+		if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0 || alignment == 0)
+		{
+			return EINVAL;
+		}
+		void* p = __libc_memalign(alignment, size);
+		if (!p)
+		{
+			return ENOMEM;
+		}
+		*result = p;
+		return 0;
+	}
+	void free(void* ptr)
+	{
+		if (ptr)
+		{
+			CheckRealtime(RtSafetyMonitor::Violation::Free);
+		}
+		__libc_free(ptr);
+	}
+
+	int pthread_mutex_lock(pthread_mutex_t* mutex)
+	{
+		using lock_fn = int (*)(pthread_mutex_t*);
+		static std::atomic<lock_fn> realLock { nullptr };
+
+		lock_fn fn = realLock.load(std::memory_order_acquire);
+		if (!fn)
+		{
+			++tSuspendCount;
+			fn = (lock_fn)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+			--tSuspendCount;
+			realLock.store(fn, std::memory_order_release);
+		}
+		CheckRealtime(RtSafetyMonitor::Violation::MutexLock);
+		return fn(mutex);
+	}
+}
+
+#endif
+
+bool RtSafetyMonitor::IsAvailable()
+{
+	return TOOB_RT_SAFETY_INTERPOSE != 0;
+}
+
+void RtSafetyMonitor::Enable(bool enable)
+{
+	enabled = enable && IsAvailable();
+}
+
+bool RtSafetyMonitor::IsEnabled()
+{
+	return enabled;
+}
+
+void RtSafetyMonitor::SetTrap(bool trap_)
+{
+	trap = trap_;
+}
+
+uint64_t RtSafetyMonitor::GetViolationCount(size_t scopeId, Violation violation)
+{
+	if (scopeId >= MAX_SCOPE_ID)
+	{
+		return 0;
+	}
+	return violationCounts[scopeId][(size_t)violation].load(std::memory_order_relaxed);
+}
+
+uint64_t RtSafetyMonitor::GetViolationCount(size_t scopeId)
+{
+	uint64_t result = 0;
+	for (size_t i = 0; i < VIOLATION_TYPES; ++i)
+	{
+		result += GetViolationCount(scopeId, (Violation)i);
+	}
+	return result;
+}
+
+void RtSafetyMonitor::ResetViolationCounts()
+{
+	for (auto& scopeCounts : violationCounts)
+	{
+		for (auto& count : scopeCounts)
+		{
+			count = 0;
+		}
+	}
+}
+
+const char* RtSafetyMonitor::GetViolationName(Violation violation)
+{
+	switch (violation)
+	{
+	case Violation::Allocate:
+		return "allocate";
+	case Violation::Free:
+		return "free";
+	case Violation::MutexLock:
+		return "mutex lock";
+	default:
+		return "unknown";
+	}
+}
+
+RtSafetyMonitor::Scope::Scope(size_t scopeId)
+	: previousScopeId(tScopeId)
+{
+	if (enabled.load(std::memory_order_relaxed) && scopeId < MAX_SCOPE_ID)
+	{
+		tScopeId = (int)scopeId;
+	}
+}
+
+RtSafetyMonitor::Scope::~Scope()
+{
+	tScopeId = previousScopeId;
+}
+
+RtSafetyMonitor::Suspend::Suspend()
+{
+	++tSuspendCount;
+}
+
+RtSafetyMonitor::Suspend::~Suspend()
+{
+	--tSuspendCount;
+}
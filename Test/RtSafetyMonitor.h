@@ -0,0 +1,83 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace toob {
+
+	/// Real-time safety tripwire for hosted plugins.
+	///
+	/// On glibc builds, hostTest replaces malloc/free (and friends) and pthread_mutex_lock with versions that
+	/// check whether the calling thread is inside a plugin's run() method. Calls made inside a Scope are counted
+	/// as violations against that scope's id. Host callbacks that a plugin may legitimately call from run()
+	/// (worker scheduling, logging) use a Suspend to exclude the host's own allocations.
+	class RtSafetyMonitor {
+	public:
+		enum class Violation {
+			Allocate,
+			Free,
+			MutexLock
+		};
+		static constexpr size_t VIOLATION_TYPES = 3;
+		static constexpr size_t MAX_SCOPE_ID = 64;
+
+		/// True if allocation and locking calls can be monitored in this build.
+		static bool IsAvailable();
+
+		/// Enable or disable checking. Disabled by default.
+		static void Enable(bool enable);
+		static bool IsEnabled();
+
+		/// Raise SIGTRAP on each violation, so that a debugger stops at the offending call.
+		static void SetTrap(bool trap);
+
+		static uint64_t GetViolationCount(size_t scopeId, Violation violation);
+		static uint64_t GetViolationCount(size_t scopeId);
+		static void ResetViolationCounts();
+
+		static const char* GetViolationName(Violation violation);
+
+		/// Marks the current thread as executing realtime code on behalf of scopeId.
+		class Scope {
+		public:
+			Scope(size_t scopeId);
+			~Scope();
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+		private:
+			int previousScopeId;
+		};
+
+		/// Temporarily suspends checking on the current thread (e.g. in host callbacks).
+		class Suspend {
+		public:
+			Suspend();
+			~Suspend();
+			Suspend(const Suspend&) = delete;
+			Suspend& operator=(const Suspend&) = delete;
+		};
+	};
+}
@@ -22,6 +22,7 @@
  */
 
 #include "ScheduleFeature.h"
+#include "RtSafetyMonitor.h"
 #include <mutex>
 
 
@@ -32,6 +33,8 @@ static LV2_Worker_Status scheduleWorkFn(
 	uint32_t                   size,
 	const void* data)
 {
+	// Host-side allocations here aren't the plugin's fault.
+	RtSafetyMonitor::Suspend rtSuspend;
 	ScheduleFeature* feature = (ScheduleFeature*)(void*)handle;
 	feature->ScheduleWork(size, data);
 
@@ -49,13 +52,22 @@ ScheduleFeature::ScheduleFeature()
 
 }
 
+ScheduleFeature::ScheduleFeature(WorkHandler&& workHandler)
+	: ScheduleFeature()
+{
+	this->workHandler = std::move(workHandler);
+}
+
 
 void ScheduleFeature::ScheduleWork(
 	uint32_t     size,
 	const void* data
 )
 {
-
+	if (workHandler)
+	{
+		workHandler(size, data);
+	}
 }
 
 
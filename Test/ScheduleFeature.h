@@ -38,17 +38,22 @@
 #include <map>
 #include <string>
 #include <mutex>
+#include <functional>
 
 namespace toob {
 	class ScheduleFeature {
 
+	public:
+		using WorkHandler = std::function<void(uint32_t size, const void* data)>;
 	private:
 		LV2_Feature feature;
 		LV2_Worker_Schedule schedule;
 		std::mutex mapMutex;
+		WorkHandler workHandler;
 
 	public:
 		ScheduleFeature();
+		ScheduleFeature(WorkHandler&& workHandler);
 
 		const LV2_Feature* GetFeature()
 		{
@@ -23,12 +23,230 @@
 
 #include "Test.h"
 #include "LoadTest.h"
+#include "BenchmarkRunner.h"
+#include "TtlPluginInfo.h"
+#include "CommandLineParser.hpp"
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <map>
 
-int main(void)
+using namespace toob;
+using namespace std;
+
+static void PrintHelp()
+{
+	cout << "hostTest - LV2 host test and plugin benchmark" << endl;
+	cout << endl;
+	cout << "Syntax: hostTest [--chain <chain.json>] [options...]" << endl;
+	cout << "        hostTest --all-plugins [--chain <chain.json>] [options...]" << endl;
+	cout << endl;
+	cout << "   Without --chain or --all-plugins, runs the host load test." << endl;
+	cout << endl;
+	cout << "   --chain <file>: a JSON array of plugins to benchmark, in signal-chain order." << endl;
+	cout << "        e.g. [ { \"uri\": \"http://two-play.com/plugins/toob-nam\"," << endl;
+	cout << "                 \"controls\": { \"inputGain\": 3 }," << endl;
+	cout << "                 \"files\": { \"modelFile\": \"/path/to/model.nam\" } } ]" << endl;
+	cout << "        Memory allocations and mutex locks made inside a plugin's run() are reported as" << endl;
+	cout << "        real-time safety violations, and cause hostTest to fail." << endl;
+	cout << "   --all-plugins: benchmark each plugin in the bundle's manifest.ttl on its own. Entries in" << endl;
+	cout << "        the --chain file supply controls and files for the plugins they name. Plugins that" << endl;
+	cout << "        require host features that hostTest doesn't provide are skipped." << endl;
+	cout << endl;
+	cout << "Options:" << endl;
+	cout << "   -b, --block-size <frames>   (default 64)" << endl;
+	cout << "   -r, --sample-rate <hz>      (default 48000)" << endl;
+	cout << "   -s, --seconds <seconds>     Measured audio duration (default 10)." << endl;
+	cout << "   -w, --warmup <seconds>      Unmeasured audio before measuring (default 3)." << endl;
+	cout << "   -l, --library <path>        Plugin library (default /usr/lib/lv2/ToobAmp.lv2/ToobAmp.so)." << endl;
+	cout << "   --bundle <directory>        Directory containing the plugins' .ttl files (default: the library's directory)." << endl;
+	cout << "   --offline                   Measure as fast as possible instead of in real time." << endl;
+	cout << "   --no-rt-check               Don't check for allocations and mutex locks in run()." << endl;
+	cout << "   --rt-trap                   Raise SIGTRAP on each allocation or mutex lock in run() (for use in a debugger)." << endl;
+	cout << "   --denormal-check            After measuring, feed a tail that decays to the bottom of the float range, and fail" << endl;
+	cout << "                               if a plugin outputs subnormals, or slows down by more than 2x." << endl;
+	cout << "   --tail-seconds <seconds>    Length of the --denormal-check tail (default 10)." << endl;
+	cout << "   --json <file>               Also write the results as JSON." << endl;
+	cout << "   -h, --help                  Display this message." << endl;
+}
+
+static bool Failed(const BenchmarkReport& report)
+{
+	if (report.total_.RtViolations() != 0)
+	{
+		cerr << "Error: Real-time safety violations detected." << endl;
+		return true;
+	}
+	if (report.DenormalFailure())
+	{
+		cerr << "Error: Denormal slowdowns or subnormal output detected." << endl;
+		return true;
+	}
+	return false;
+}
+
+static int RunAllPlugins(const BenchmarkRunner::Options& options, const std::string& chainFile, const std::string& jsonFile)
 {
+	std::filesystem::path bundle = options.bundle.empty() ? options.library.parent_path() : options.bundle;
+
+	std::map<std::string, BenchmarkChainEntry> settings;
+	if (!chainFile.empty())
+	{
+		for (const auto& entry : BenchmarkRunner::ReadChain(chainFile))
+		{
+			settings[entry.uri_] = entry;
+		}
+	}
+
+	std::vector<BenchmarkReport> reports;
+	std::vector<std::string> skipped;
+	std::vector<std::string> failed;
+	for (const auto& uri : TtlPluginInfo::BundlePlugins(bundle))
+	{
+		BenchmarkChainEntry entry;
+		entry.uri_ = uri;
+		auto f = settings.find(uri);
+		if (f != settings.end())
+		{
+			entry = f->second;
+		}
+		cout << "---- " << uri << endl;
+		try
+		{
+			BenchmarkRunner runner(options);
+			std::string missingFeature = runner.UnsupportedFeature(TtlPluginInfo(bundle, uri));
+			if (!missingFeature.empty())
+			{
+				cout << "Skipped: requires " << missingFeature << "." << endl << endl;
+				skipped.push_back(uri);
+				continue;
+			}
+			runner.LoadChain(std::vector<BenchmarkChainEntry>{ entry });
+			BenchmarkReport report = runner.Run();
+			BenchmarkRunner::PrintReport(cout, report);
+			if (Failed(report))
+			{
+				failed.push_back(uri);
+			}
+			reports.push_back(std::move(report));
+		}
+		catch (const std::exception& e)
+		{
+			cerr << "Error: " << e.what() << endl;
+			failed.push_back(uri);
+		}
+		cout << endl;
+	}
+
+	if (!jsonFile.empty())
+	{
+		std::ofstream f(jsonFile);
+		if (!f.is_open())
+		{
+			throw std::runtime_error("Can't write to " + jsonFile);
+		}
+		BenchmarkRunner::WriteReports(f, reports);
+	}
+
+	cout << reports.size() << " plugins checked, " << skipped.size() << " skipped." << endl;
+	for (const auto& uri : skipped)
+	{
+		cout << "    Skipped: " << uri << endl;
+	}
+	if (!failed.empty())
+	{
+		for (const auto& uri : failed)
+		{
+			cerr << "    Failed: " << uri << endl;
+		}
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+	try {
+		std::string chainFile;
+		std::string jsonFile;
+		bool offline = false;
+		bool noRtCheck = false;
+		bool rtTrap = false;
+		bool denormalCheck = false;
+		bool allPlugins = false;
+		bool help = false;
+		BenchmarkRunner::Options options;
+		std::string library = "/usr/lib/lv2/ToobAmp.lv2/ToobAmp.so";
+		std::string bundle;
+
+		CommandLineParser commandLineParser;
+		commandLineParser.AddOption("", "chain", &chainFile);
+		commandLineParser.AddOption("", "all-plugins", &allPlugins);
+		commandLineParser.AddOption("b", "block-size", &options.blockSize);
+		commandLineParser.AddOption("r", "sample-rate", &options.sampleRate);
+		commandLineParser.AddOption("s", "seconds", &options.seconds);
+		commandLineParser.AddOption("w", "warmup", &options.warmupSeconds);
+		commandLineParser.AddOption("l", "library", &library);
+		commandLineParser.AddOption("", "bundle", &bundle);
+		commandLineParser.AddOption("", "offline", &offline);
+		commandLineParser.AddOption("", "no-rt-check", &noRtCheck);
+		commandLineParser.AddOption("", "rt-trap", &rtTrap);
+		commandLineParser.AddOption("", "denormal-check", &denormalCheck);
+		commandLineParser.AddOption("", "tail-seconds", &options.tailSeconds);
+		commandLineParser.AddOption("", "json", &jsonFile);
+		commandLineParser.AddOption("h", "help", &help);
+
+		commandLineParser.Parse(argc, argv);
+
+		if (help || commandLineParser.Arguments().size() != 0)
+		{
+			PrintHelp();
+			return help ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		if (chainFile.empty() && !allPlugins)
+		{
+			LoadTest* loadTest = new LoadTest();
+			loadTest->Execute();
+			delete loadTest;
+			return EXIT_SUCCESS;
+		}
+
+		options.library = library;
+		options.bundle = bundle;
+		options.realtime = !offline;
+		options.rtSafetyCheck = !noRtCheck;
+		options.rtSafetyTrap = rtTrap;
+		options.denormalCheck = denormalCheck;
+
+		if (allPlugins)
+		{
+			return RunAllPlugins(options, chainFile, jsonFile);
+		}
 
-	LoadTest* loadTest = new LoadTest();
-	loadTest->Execute();
-	delete loadTest;
+		BenchmarkRunner runner(options);
+		runner.LoadChain(chainFile);
+		BenchmarkReport report = runner.Run();
 
+		BenchmarkRunner::PrintReport(cout, report);
+		if (!jsonFile.empty())
+		{
+			std::ofstream f(jsonFile);
+			if (!f.is_open())
+			{
+				throw std::runtime_error("Can't write to " + jsonFile);
+			}
+			BenchmarkRunner::WriteReport(f, report);
+		}
+		if (Failed(report))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		cerr << "Error: " << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,584 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "TtlPluginInfo.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cctype>
+#include <cstring>
+
+using namespace toob;
+
+static const std::string RDF_TYPE = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+static const std::string LV2_PREFIX = "http://lv2plug.in/ns/lv2core#";
+static const std::string LV2_PORT = LV2_PREFIX + "port";
+static const std::string LV2_INDEX = LV2_PREFIX + "index";
+static const std::string LV2_SYMBOL = LV2_PREFIX + "symbol";
+static const std::string LV2_DEFAULT = LV2_PREFIX + "default";
+static const std::string LV2_MINIMUM = LV2_PREFIX + "minimum";
+static const std::string LV2_MAXIMUM = LV2_PREFIX + "maximum";
+static const std::string LV2_REQUIRED_FEATURE = LV2_PREFIX + "requiredFeature";
+static const std::string LV2_PLUGIN = LV2_PREFIX + "Plugin";
+static const std::string LV2_INPUT_PORT = LV2_PREFIX + "InputPort";
+static const std::string LV2_OUTPUT_PORT = LV2_PREFIX + "OutputPort";
+static const std::string LV2_AUDIO_PORT = LV2_PREFIX + "AudioPort";
+static const std::string LV2_CONTROL_PORT = LV2_PREFIX + "ControlPort";
+static const std::string LV2_CV_PORT = LV2_PREFIX + "CVPort";
+static const std::string ATOM_ATOM_PORT = "http://lv2plug.in/ns/ext/atom#AtomPort";
+static const std::string PATCH_WRITABLE = "http://lv2plug.in/ns/ext/patch#writable";
+
+namespace {
+	// Splits Turtle source into tokens: IRIs ("<...>"), string literals (returned as '"' + content),
+	// punctuation, and bare words (prefixed names, numbers, keywords).
+	class TtlTokenizer {
+	public:
+		TtlTokenizer(const std::string& text)
+			: text(text)
+		{
+		}
+
+		std::vector<std::string> Tokenize()
+		{
+			std::vector<std::string> result;
+			while (true)
+			{
+				SkipWhitespaceAndComments();
+				if (pos >= text.size())
+				{
+					break;
+				}
+				char c = text[pos];
+				switch (c)
+				{
+				case '[':
+				case ']':
+				case '(':
+				case ')':
+				case ',':
+				case ';':
+					result.push_back(std::string(1, c));
+					++pos;
+					break;
+				case '<':
+				{
+					size_t end = text.find('>', pos);
+					if (end == std::string::npos)
+					{
+						throw std::runtime_error("Unterminated IRI.");
+					}
+					result.push_back(text.substr(pos, end + 1 - pos));
+					pos = end + 1;
+					break;
+				}
+				case '"':
+				case '\'':
+					result.push_back(ReadString(c));
+					break;
+				default:
+					result.push_back(ReadWord());
+					break;
+				}
+			}
+			return result;
+		}
+
+	private:
+		void SkipWhitespaceAndComments()
+		{
+			while (pos < text.size())
+			{
+				char c = text[pos];
+				if (c == '#')
+				{
+					while (pos < text.size() && text[pos] != '\n')
+					{
+						++pos;
+					}
+				}
+				else if (std::isspace((unsigned char)c))
+				{
+					++pos;
+				}
+				else
+				{
+					break;
+				}
+			}
+		}
+		std::string ReadString(char quote)
+		{
+			std::string result = "\"";
+			bool longString = text.compare(pos, 3, std::string(3, quote)) == 0;
+			pos += longString ? 3 : 1;
+			while (true)
+			{
+				if (pos >= text.size())
+				{
+					throw std::runtime_error("Unterminated string.");
+				}
+				char c = text[pos];
+				if (c == '\\' && pos + 1 < text.size())
+				{
+					result += text[pos + 1];
+					pos += 2;
+					continue;
+				}
+				if (c == quote)
+				{
+					if (!longString)
+					{
+						++pos;
+						return result;
+					}
+					if (text.compare(pos, 3, std::string(3, quote)) == 0)
+					{
+						pos += 3;
+						return result;
+					}
+				}
+				result += c;
+				++pos;
+			}
+		}
+		std::string ReadWord()
+		{
+			size_t start = pos;
+			while (pos < text.size())
+			{
+				char c = text[pos];
+				if (std::isspace((unsigned char)c) || strchr("[](),;<\"'", c) != nullptr)
+				{
+					break;
+				}
+				if (c == '.')
+				{
+					// a '.' terminates a statement unless it's inside a number or name.
+					if (pos + 1 >= text.size() || std::isspace((unsigned char)text[pos + 1]) || text[pos + 1] == '#')
+					{
+						if (pos == start)
+						{
+							++pos;
+						}
+						break;
+					}
+				}
+				++pos;
+			}
+			return text.substr(start, pos - start);
+		}
+
+		const std::string& text;
+		size_t pos = 0;
+	};
+
+	class TtlParser {
+	public:
+		TtlParser(std::vector<std::string>&& tokens)
+			: tokens(std::move(tokens))
+		{
+		}
+
+		bool AtEnd() const { return i >= tokens.size(); }
+		const std::string& Peek() const
+		{
+			static const std::string empty;
+			return i < tokens.size() ? tokens[i] : empty;
+		}
+		const std::string& Get()
+		{
+			if (i >= tokens.size())
+			{
+				throw std::runtime_error("Unexpected end of file.");
+			}
+			return tokens[i++];
+		}
+		bool Accept(const char* token)
+		{
+			if (Peek() == token)
+			{
+				++i;
+				return true;
+			}
+			return false;
+		}
+
+		// Read a "@prefix name: <iri> ." directive, if there is one.
+		bool AcceptPrefix()
+		{
+			if (!Accept("@prefix"))
+			{
+				return false;
+			}
+			std::string name = Get();
+			if (!name.empty() && name.back() == ':')
+			{
+				name.pop_back();
+			}
+			prefixes[name] = Expand(Get());
+			Accept(".");
+			return true;
+		}
+
+		std::string Expand(const std::string& token) const
+		{
+			if (token == "a")
+			{
+				return RDF_TYPE;
+			}
+			if (token.size() >= 2 && token[0] == '<')
+			{
+				return token.substr(1, token.size() - 2);
+			}
+			size_t colon = token.find(':');
+			if (colon != std::string::npos && token[0] != '"')
+			{
+				auto f = prefixes.find(token.substr(0, colon));
+				if (f != prefixes.end())
+				{
+					return f->second + token.substr(colon + 1);
+				}
+			}
+			return token;
+		}
+
+		static std::string LiteralValue(const std::string& token)
+		{
+			if (!token.empty() && token[0] == '"')
+			{
+				return token.substr(1);
+			}
+			return token;
+		}
+
+		// Skip a single object (a blank node, a collection, or a term with its language tag/datatype).
+		void SkipObject()
+		{
+			const std::string& token = Get();
+			if (token == "[" || token == "(")
+			{
+				int depth = 1;
+				while (depth != 0)
+				{
+					const std::string& t = Get();
+					if (t == "[" || t == "(")
+					{
+						++depth;
+					}
+					else if (t == "]" || t == ")")
+					{
+						--depth;
+					}
+				}
+			}
+			SkipAnnotation();
+		}
+		void SkipAnnotation()
+		{
+			const std::string& next = Peek();
+			if (!next.empty() && (next[0] == '@' || next.compare(0, 2, "^^") == 0))
+			{
+				++i;
+			}
+		}
+		void SkipStatement()
+		{
+			while (!AtEnd() && Peek() != ".")
+			{
+				SkipObject();
+			}
+			Accept(".");
+		}
+
+	private:
+		std::vector<std::string> tokens;
+		size_t i = 0;
+		std::map<std::string, std::string> prefixes;
+	};
+
+	float ToFloat(const std::string& value)
+	{
+		try
+		{
+			return std::stof(value);
+		}
+		catch (const std::exception&)
+		{
+			throw std::runtime_error("Invalid number: " + value);
+		}
+	}
+
+	TtlPluginInfo::PortInfo ParsePort(TtlParser& parser)
+	{
+		TtlPluginInfo::PortInfo port;
+		bool hasMin = false, hasMax = false;
+
+		while (!parser.Accept("]"))
+		{
+			std::string predicate = parser.Expand(parser.Get());
+			do
+			{
+				if (predicate == RDF_TYPE)
+				{
+					std::string type = parser.Expand(parser.Get());
+					if (type == LV2_INPUT_PORT)
+						port.isInput = true;
+					else if (type == LV2_OUTPUT_PORT)
+						port.isInput = false;
+					else if (type == LV2_AUDIO_PORT)
+						port.kind = TtlPluginInfo::PortKind::Audio;
+					else if (type == LV2_CONTROL_PORT)
+						port.kind = TtlPluginInfo::PortKind::Control;
+					else if (type == LV2_CV_PORT)
+						port.kind = TtlPluginInfo::PortKind::CV;
+					else if (type == ATOM_ATOM_PORT)
+						port.kind = TtlPluginInfo::PortKind::Atom;
+				}
+				else if (predicate == LV2_INDEX)
+				{
+					port.index = (int)ToFloat(TtlParser::LiteralValue(parser.Get()));
+					parser.SkipAnnotation();
+				}
+				else if (predicate == LV2_SYMBOL)
+				{
+					port.symbol = TtlParser::LiteralValue(parser.Get());
+					parser.SkipAnnotation();
+				}
+				else if (predicate == LV2_DEFAULT)
+				{
+					port.defaultValue = ToFloat(TtlParser::LiteralValue(parser.Get()));
+					parser.SkipAnnotation();
+				}
+				else if (predicate == LV2_MINIMUM)
+				{
+					port.minValue = ToFloat(TtlParser::LiteralValue(parser.Get()));
+					parser.SkipAnnotation();
+					hasMin = true;
+				}
+				else if (predicate == LV2_MAXIMUM)
+				{
+					port.maxValue = ToFloat(TtlParser::LiteralValue(parser.Get()));
+					parser.SkipAnnotation();
+					hasMax = true;
+				}
+				else
+				{
+					parser.SkipObject();
+				}
+			} while (parser.Accept(","));
+			parser.Accept(";");
+		}
+		port.hasRange = hasMin && hasMax;
+		if (port.index < 0)
+		{
+			throw std::runtime_error("Port has no lv2:index: " + port.symbol);
+		}
+		return port;
+	}
+}
+
+TtlPluginInfo::TtlPluginInfo(const std::filesystem::path& bundlePath, const std::string& pluginUri)
+	: uri(pluginUri)
+{
+	std::vector<std::filesystem::path> ttlFiles;
+	for (const auto& entry : std::filesystem::directory_iterator(bundlePath))
+	{
+		if (entry.path().extension() == ".ttl" && entry.path().filename() != "manifest.ttl")
+		{
+			ttlFiles.push_back(entry.path());
+		}
+	}
+	std::sort(ttlFiles.begin(), ttlFiles.end());
+
+	for (const auto& ttlFile : ttlFiles)
+	{
+		if (Scan(ttlFile))
+		{
+			std::sort(ports.begin(), ports.end(), [](const PortInfo& left, const PortInfo& right) {
+				return left.index < right.index;
+			});
+			return;
+		}
+	}
+	throw std::runtime_error("Plugin " + pluginUri + " not found in " + bundlePath.string());
+}
+
+bool TtlPluginInfo::Scan(const std::filesystem::path& ttlFile)
+{
+	std::string text;
+	{
+		std::ifstream f(ttlFile);
+		if (!f)
+		{
+			return false;
+		}
+		std::stringstream s;
+		s << f.rdbuf();
+		text = s.str();
+	}
+	if (text.find(uri) == std::string::npos)
+	{
+		return false;
+	}
+	try
+	{
+		TtlParser parser(TtlTokenizer(text).Tokenize());
+		bool found = false;
+
+		while (!parser.AtEnd())
+		{
+			if (parser.AcceptPrefix())
+			{
+				continue;
+			}
+			std::string subject = parser.Expand(parser.Peek());
+			if (subject != uri)
+			{
+				parser.SkipStatement();
+				continue;
+			}
+			parser.Get();
+			found = true;
+			while (!parser.AtEnd() && !parser.Accept("."))
+			{
+				std::string predicate = parser.Expand(parser.Get());
+				do
+				{
+					if (predicate == LV2_PORT && parser.Accept("["))
+					{
+						ports.push_back(ParsePort(parser));
+					}
+					else if (predicate == PATCH_WRITABLE && parser.Peek() != "[")
+					{
+						writableProperties.push_back(parser.Expand(parser.Get()));
+					}
+					else if (predicate == LV2_REQUIRED_FEATURE && parser.Peek() != "[")
+					{
+						// Some of the .ttl files give feature URIs as string literals.
+						requiredFeatures.push_back(parser.Expand(TtlParser::LiteralValue(parser.Get())));
+						parser.SkipAnnotation();
+					}
+					else
+					{
+						parser.SkipObject();
+					}
+				} while (parser.Accept(","));
+				parser.Accept(";");
+			}
+		}
+		return found;
+	}
+	catch (const std::exception& e)
+	{
+		throw std::runtime_error(ttlFile.string() + ": " + e.what());
+	}
+}
+
+std::vector<std::string> TtlPluginInfo::BundlePlugins(const std::filesystem::path& bundlePath)
+{
+	std::filesystem::path manifest = bundlePath / "manifest.ttl";
+	std::string text;
+	{
+		std::ifstream f(manifest);
+		if (!f)
+		{
+			throw std::runtime_error("Can't read " + manifest.string());
+		}
+		std::stringstream s;
+		s << f.rdbuf();
+		text = s.str();
+	}
+	std::vector<std::string> result;
+	try
+	{
+		TtlParser parser(TtlTokenizer(text).Tokenize());
+		while (!parser.AtEnd())
+		{
+			if (parser.AcceptPrefix())
+			{
+				continue;
+			}
+			if (parser.Peek() == "[")
+			{
+				parser.SkipStatement();
+				continue;
+			}
+			std::string subject = parser.Expand(parser.Get());
+			while (!parser.AtEnd() && !parser.Accept("."))
+			{
+				std::string predicate = parser.Expand(parser.Get());
+				do
+				{
+					if (predicate == RDF_TYPE && parser.Peek() != "[")
+					{
+						if (parser.Expand(parser.Get()) == LV2_PLUGIN)
+						{
+							result.push_back(subject);
+						}
+					}
+					else
+					{
+						parser.SkipObject();
+					}
+				} while (parser.Accept(","));
+				parser.Accept(";");
+			}
+		}
+	}
+	catch (const std::exception& e)
+	{
+		throw std::runtime_error(manifest.string() + ": " + e.what());
+	}
+	return result;
+}
+
+const TtlPluginInfo::PortInfo* TtlPluginInfo::FindPort(const std::string& symbol) const
+{
+	for (const auto& port : ports)
+	{
+		if (port.symbol == symbol)
+		{
+			return &port;
+		}
+	}
+	return nullptr;
+}
+
+std::string TtlPluginInfo::ResolveWritableProperty(const std::string& name) const
+{
+	if (name.find("://") != std::string::npos)
+	{
+		return name;
+	}
+	for (const auto& property : writableProperties)
+	{
+		size_t pos = property.find_last_of("#/");
+		if (pos != std::string::npos && property.substr(pos + 1) == name)
+		{
+			return property;
+		}
+	}
+	throw std::runtime_error("Plugin " + uri + " has no writable property named '" + name + "'.");
+}
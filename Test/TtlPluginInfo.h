@@ -0,0 +1,90 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <filesystem>
+
+namespace toob {
+
+	/// Port and parameter declarations for a plugin, read from the .ttl files in its bundle.
+	///
+	/// This is a minimal Turtle scanner, not a general RDF parser. It handles the way
+	/// ToobAmp's own .ttl files are written: one plugin per file, ports declared in
+	/// lv2:port [ ... ] blocks, and file properties declared with patch:writable.
+	class TtlPluginInfo {
+	public:
+		enum class PortKind {
+			Audio,
+			Control,
+			Atom,
+			CV,
+			Unknown
+		};
+		struct PortInfo {
+			int index = -1;
+			std::string symbol;
+			PortKind kind = PortKind::Unknown;
+			bool isInput = false;
+			float defaultValue = 0;
+			float minValue = 0;
+			float maxValue = 1;
+			bool hasRange = false;
+		};
+
+		/// Load the declarations for pluginUri from the .ttl files in bundlePath.
+		/// Throws std::runtime_error if the plugin isn't found.
+		TtlPluginInfo(const std::filesystem::path& bundlePath, const std::string& pluginUri);
+
+		const std::string& Uri() const { return uri; }
+
+		/// Ports, ordered by port index.
+		const std::vector<PortInfo>& Ports() const { return ports; }
+
+		const PortInfo* FindPort(const std::string& symbol) const;
+
+		/// Full URIs of patch:writable properties.
+		const std::vector<std::string>& WritableProperties() const { return writableProperties; }
+
+		/// Full URIs of lv2:requiredFeature features.
+		const std::vector<std::string>& RequiredFeatures() const { return requiredFeatures; }
+
+		/// Resolve a writable property given either its full URI, or the part after the final '#' or '/'.
+		std::string ResolveWritableProperty(const std::string& name) const;
+
+		/// URIs of the plugins declared in the bundle's manifest.ttl, in declaration order.
+		static std::vector<std::string> BundlePlugins(const std::filesystem::path& bundlePath);
+
+	private:
+		bool Scan(const std::filesystem::path& ttlFile);
+
+		std::string uri;
+		std::vector<PortInfo> ports;
+		std::vector<std::string> writableProperties;
+		std::vector<std::string> requiredFeatures;
+	};
+}
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
 #include "CabSim.h"
+#include "LsNumerics/Denorms.hpp"
 
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
@@ -96,6 +97,7 @@ CabSim::CabSim(double _rate,
 	this->loCutFilter.SetSampleRate((float)_rate);
 	this->brightFilter.SetSampleRate((float)_rate);
 	this->combFilter.SetSampleRate(_rate);
+	cpuLoadMeter.SetSampleRate(_rate);
 
 	this->updateSampleDelay = (int)(_rate/MAX_UPDATES_PER_SECOND);
 	this->updateMsDelay = (1000/MAX_UPDATES_PER_SECOND);
@@ -143,6 +145,12 @@ void CabSim::ConnectPort(uint32_t port, void* data)
 	case PortId::COMBF:
 		this->combFilter.CombF.SetData(data);
 		break;
+	case PortId::CPU_LOAD:
+		this->cpuLoadMeter.SetLoadData(data);
+		break;
+	case PortId::CPU_PEAK:
+		this->cpuLoadMeter.SetPeakData(data);
+		break;
 
 	}
 }
@@ -156,6 +164,7 @@ void CabSim::Activate()
 	this->loCutFilter.Reset();
 	this->highCutFilter.Reset();
 	this->brightFilter.Reset();
+	this->filterCascade.Reset();
 	this->combFilter.Reset();
 	this->peakValueL = 0;
 }
@@ -166,6 +175,9 @@ void CabSim::Deactivate()
 
 void CabSim::Run(uint32_t n_samples)
 {
+	RtTraceScope traceScope(traceSource);
+	CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+	LsNumerics::AutoDenorm autoDenorm;
 	// prepare forge to write to notify output port.
 	// Set up forge to write directly to notify output port.
 	const uint32_t notify_capacity = this->notifyOut->atom.size;
@@ -212,16 +224,21 @@ void CabSim::Run(uint32_t n_samples)
 	}
 
 
+	filterCascade.SetStage(0, loCutFilter.GetZTransformCoefficients());
+	filterCascade.SetStage(1, highCutFilter.GetZTransformCoefficients());
+	filterCascade.SetStage(2, brightFilter.GetZTransformCoefficients());
+
+	for (uint32_t i = 0; i < n_samples; ++i)
+	{
+		outputL[i] = trim * inputL[i];
+	}
+	filterCascade.Process(outputL, outputL, n_samples);
+
 	for (uint32_t i = 0; i < n_samples; ++i)
 	{
 
-		float xL = Undenormalize((float)
-			this->combFilter.Tick(
-				this->brightFilter.Tick(
-					this->highCutFilter.Tick(
-						this->loCutFilter.Tick(
-							trim*inputL[i]
-						)))));
+		float xL = (float)
+			this->combFilter.Tick(outputL[i]);
 		float absXL = std::abs(xL);
 		if (absXL > this->peakValueL)
 		{
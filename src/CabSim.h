@@ -43,9 +43,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "OutputPort.h"
 #include "Filters/AudioFilter2.h"
 #include "Filters/ShelvingLowCutFilter2.h"
+#include "Filters/BiquadCascade.hpp"
 #include "CombFilter2.h"
 #include "NoiseGate.h"
 #include "GainStage.h"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 
@@ -69,6 +72,8 @@ namespace toob {
 			AUDIO_OUT,
 			CONTROL_IN,
 			NOTIFY_OUT,
+			CPU_LOAD,
+			CPU_PEAK,
 		};
 
 		double rate;
@@ -86,7 +91,10 @@ namespace toob {
 		static FilterCoefficients2 HIPASS_PROTOTYPE;
 		AudioFilter2 loCutFilter = AudioFilter2(HIPASS_PROTOTYPE,30.0f,300.0f,30.0f);
 		ShelvingLowCutFilter2 brightFilter = ShelvingLowCutFilter2();
+		BiquadCascade<3> filterCascade; // block form of loCutFilter, highCutFilter, brightFilter.
 		CombFilter combFilter;
+		RtTraceSource traceSource{"CabSim"};
+		CpuLoadMeter cpuLoadMeter;
 
 
 		const float* inputL = NULL;
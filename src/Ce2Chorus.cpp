@@ -23,6 +23,7 @@
 
 #include "Ce2Chorus.hpp"
 #include "Filters/LowPassFilter.h"
+#include <algorithm>
 
 using namespace toob;
 using namespace LsNumerics;
@@ -72,8 +73,8 @@ inline void Ce2Chorus::ClearBucketBrigade()
     bbX = 0;
 
 }
-inline float Ce2Chorus::TickBucketBrigade(float voltage) {
-
+inline float Ce2Chorus::BucketBrigadeClockRate(float voltage)
+{
     // guard against out-of-range voltage swings because of the lfo filter.
     if (voltage < 0.1f) voltage = 0.1f;
     if (voltage > 10) voltage = 10;
@@ -82,7 +83,11 @@ inline float Ce2Chorus::TickBucketBrigade(float voltage) {
 
     float fBB = BUCKET_BRIGADE_V0_RATE*voltage/LFO_V0;
     if (fBB < 1) fBB = 1; 
+    return fBB;
+}
 
+inline float Ce2Chorus::ClockBucketBrigade(float fBB)
+{
     float bbDelay = 1/fBB;
 
     double clocksThisSample = fBB/sampleRate + bbX;
@@ -105,6 +110,10 @@ inline float Ce2Chorus::TickBucketBrigade(float voltage) {
 
 }
 
+inline float Ce2Chorus::TickBucketBrigade(float voltage) {
+    return ClockBucketBrigade(BucketBrigadeClockRate(voltage));
+}
+
 inline double Ce2Chorus::TickLfo()
 {
     lfoValue += lfoDx;
@@ -128,6 +137,89 @@ inline double Ce2Chorus::TickLfo()
 }
 
 
+void Ce2Chorus::ProcessLfo(float *delaySec, size_t n)
+{
+    // Same arithmetic as TickLfo(), a stage at a time. Only the bucket-brigade clocking 
+    // and the lfo filter carry state from sample to sample.
+    float values[MAX_BLOCK_SIZE];
+    for (size_t i = 0; i < n; ++i)
+    {
+        lfoValue += lfoDx;
+        if (lfoValue >= 1)
+        {
+            lfoValue = lfoValue-2;
+            lfoSign = -lfoSign;
+        }
+        values[i] = lfoValue*lfoSign;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        values[i] = lfoLowpassFilter.Tick(values[i]);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        values[i] = BucketBrigadeClockRate(values[i]*depthFactor+LFO_V0);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        delaySec[i] = ClockBucketBrigade(values[i]);
+    }
+}
+
+void Ce2Chorus::ProcessDelay(const float*input, float*delayed, size_t n)
+{
+    // The chorus has no feedback, so the whole block can be written to the delay line 
+    // before it is read, with read positions offset by the n samples just written.
+    float delaySec[MAX_BLOCK_SIZE];
+    double index[MAX_BLOCK_SIZE];
+    ProcessLfo(delaySec, n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        index[i] = delaySec[i]*sampleRate + n;
+    }
+    delayLine.Write(input, n);
+    delayLine.Read(index, delayed, n);
+    antiAliasingLowpassFilter.Process(delayed, delayed, n);
+}
+
+void Ce2Chorus::Process(const float*input, float*output, size_t n)
+{
+    float delayed[MAX_BLOCK_SIZE];
+    while (n != 0)
+    {
+        size_t m = std::min(n, MAX_BLOCK_SIZE);
+        ProcessDelay(input, delayed, m);
+        for (size_t i = 0; i < m; ++i)
+        {
+            output[i] = 0.5f*(delayed[i]+input[i]);
+        }
+        input += m;
+        output += m;
+        n -= m;
+    }
+}
+
+void Ce2Chorus::Process(const float*input, float*outL, float*outR, size_t n)
+{
+    float delayed[MAX_BLOCK_SIZE];
+    while (n != 0)
+    {
+        size_t m = std::min(n, MAX_BLOCK_SIZE);
+        ProcessDelay(input, delayed, m);
+        for (size_t i = 0; i < m; ++i)
+        {
+            float value = input[i];
+            float t = delayed[i];
+            outL[i] = 0.5f*(value+t);
+            outR[i] = 0.5f*(value-t);
+        }
+        input += m;
+        outL += m;
+        outR += m;
+        n -= m;
+    }
+}
+
 void Ce2Chorus::SetRate(float rate)
 {
     this->rate = rate;
@@ -176,3 +268,14 @@ float Ce2Chorus::Instrumentation::TickLfo()
     return delay;
 
 }
+
+void Ce2Chorus::Instrumentation::ProcessLfo(float *delaySec, size_t n)
+{
+    while (n != 0)
+    {
+        size_t m = std::min(n, MAX_BLOCK_SIZE);
+        pChorus->ProcessLfo(delaySec, m);
+        delaySec += m;
+        n -= m;
+    }
+}
@@ -45,6 +45,11 @@ namespace toob
         float Tick(float value);
         void Tick(float value,float*outL, float*outR);
 
+        // Block processing, equivalent to calling Tick() for each sample. The anti-aliasing 
+        // filter keeps separate state for Tick() and Process(); use one or the other.
+        void Process(const float*input, float*output, size_t n);
+        void Process(const float*input, float*outL, float*outR, size_t n);
+
         void Clear();
 
         class Instrumentation // test instrumentation
@@ -58,6 +63,8 @@ namespace toob
 
             }
             float TickLfo();
+            // Block equivalent of TickLfo().
+            void ProcessLfo(float *delaySec, size_t n);
              
         };
     private:
@@ -68,8 +75,14 @@ namespace toob
         float bucketBrigadeTotal;
         double bbX = 0;
 
+        static constexpr size_t MAX_BLOCK_SIZE = 64;
+
         void ClearBucketBrigade();
+        float BucketBrigadeClockRate(float voltage);
+        float ClockBucketBrigade(float fBB);
         float TickBucketBrigade(float value);
+        void ProcessLfo(float *delaySec, size_t n);
+        void ProcessDelay(const float*input, float*delayed, size_t n);
 
 
         double TickLfo();
@@ -24,12 +24,17 @@
 #include "Ce2Chorus.hpp"
 #include "Tf2Flanger.hpp"
 #include "Filters/ShelvingLowCutFilter2.h"
+#include "TestAssert.hpp"
 
 
 #include <iostream>
 #include <fstream>
 #include <filesystem>
 #include <limits>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
 
 using namespace toob;
 using namespace std;
@@ -257,8 +262,146 @@ void TestFilter()
     }
 }
 
+static std::vector<float> MakeTestSignal(size_t n)
+{
+    // a decaying 220Hz tone with some noise, at roughly guitar level.
+    std::vector<float> result(n);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < n; ++i)
+    {
+        seed = seed * 1664525 + 1013904223;
+        float noise = (seed >> 8) * (1.0f / (1 << 24)) - 0.5f;
+        result[i] = (float)(0.4 * std::sin(i * 2 * 3.141592653589793 * 220 / 48000) * std::exp(-(double)(i % 24000) / 12000)) + 0.01f * noise;
+    }
+    return result;
+}
+
+static size_t NextBlockSize(size_t i)
+{
+    // ragged block sizes, to exercise block boundaries.
+    static const size_t sizes[] = {1, 16, 64, 200, 37, 128};
+    return sizes[i % (sizeof(sizes) / sizeof(sizes[0]))];
+}
+
+template <typename T>
+static void TestLfoEquivalence(T &tickEffect, T &blockEffect)
+{
+    typename T::Instrumentation tickTest(&tickEffect);
+    typename T::Instrumentation blockTest(&blockEffect);
+
+    constexpr size_t N = 48000;
+    std::vector<float> block(N);
+    size_t position = 0;
+    for (size_t i = 0; position < N; ++i)
+    {
+        size_t n = std::min(NextBlockSize(i), N - position);
+        blockTest.ProcessLfo(block.data() + position, n);
+        position += n;
+    }
+    // Not bit-exact: with -ffast-math the compiler is free to contract or reassociate the two paths differently.
+    for (size_t i = 0; i < N; ++i)
+    {
+        float expected = tickTest.TickLfo();
+        TEST_ASSERT(std::abs(expected - block[i]) <= 1E-6f * std::max(1.0f, std::abs(expected)));
+    }
+}
+
+template <typename T>
+static double BlockOutputError(T &tickEffect, T &blockEffect, bool stereo)
+{
+    constexpr size_t N = 48000 * 2;
+    std::vector<float> input = MakeTestSignal(N);
+    std::vector<float> tickL(N), tickR(N), blockL(N), blockR(N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (stereo)
+        {
+            tickEffect.Tick(input[i], &tickL[i], &tickR[i]);
+        }
+        else
+        {
+            tickL[i] = tickEffect.Tick(input[i]);
+        }
+    }
+    size_t position = 0;
+    for (size_t i = 0; position < N; ++i)
+    {
+        size_t n = std::min(NextBlockSize(i), N - position);
+        if (stereo)
+        {
+            blockEffect.Process(input.data() + position, blockL.data() + position, blockR.data() + position, n);
+        }
+        else
+        {
+            blockEffect.Process(input.data() + position, blockL.data() + position, n);
+        }
+        position += n;
+    }
+    double maxError = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        maxError = std::max(maxError, (double)std::abs(tickL[i] - blockL[i]));
+        if (stereo)
+        {
+            maxError = std::max(maxError, (double)std::abs(tickR[i] - blockR[i]));
+        }
+    }
+    return maxError;
+}
+
+static void TestChorusBlockEquivalence()
+{
+    for (bool stereo : {false, true})
+    {
+        Ce2Chorus tickChorus(48000), blockChorus(48000);
+        for (Ce2Chorus *chorus : {&tickChorus, &blockChorus})
+        {
+            chorus->SetRate(0.7f);
+            chorus->SetDepth(0.8f);
+        }
+        TestLfoEquivalence(tickChorus, blockChorus);
+        double error = BlockOutputError(tickChorus, blockChorus, stereo);
+        cout << "    Chorus " << (stereo ? "stereo" : "mono") << " max error: " << error << endl;
+        TEST_ASSERT(error < 1E-5);
+    }
+}
+
+static void TestFlangerBlockEquivalence()
+{
+    for (bool stereo : {false, true})
+    {
+        for (float res : {0.0f, 0.9f})
+        {
+            Tf2Flanger tickFlanger(48000), blockFlanger(48000);
+            for (Tf2Flanger *flanger : {&tickFlanger, &blockFlanger})
+            {
+                flanger->SetManual(0.3f);
+                flanger->SetRate(0.8f);
+                flanger->SetDepth(0.7f);
+                flanger->SetRes(res);
+            }
+            TestLfoEquivalence(tickFlanger, blockFlanger);
+            double error = BlockOutputError(tickFlanger, blockFlanger, stereo);
+            cout << "    Flanger " << (stereo ? "stereo" : "mono") << " res=" << res << " max error: " << error << endl;
+            TEST_ASSERT(error < 1E-4);
+        }
+    }
+}
+
 int main(int argc, char **argv)
 {
+    try
+    {
+        cout << "TestChorusBlockEquivalence" << endl;
+        TestChorusBlockEquivalence();
+        cout << "TestFlangerBlockEquivalence" << endl;
+        TestFlangerBlockEquivalence();
+    }
+    catch (const std::exception &e)
+    {
+        cout << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
     TestFilter();
 
     // TestFlanger();
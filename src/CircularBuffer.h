@@ -72,7 +72,7 @@ namespace toob {
             } else {
                 size_t ix = 0;
                 size_t start = this->head + this->buffer.size()-count;
-                for (size_t i = start; i < buffer.size(); ++i)
+                for (size_t i = start; i < this->buffer.size(); ++i)
                 {
                     buffer[ix++] = this->buffer[i]; 
                 }
@@ -25,6 +25,7 @@
 
 
 #include <cstdint>
+#include <cstddef>
 #include <cmath>
 
 namespace toob {
@@ -72,6 +73,34 @@ public:
         }
     }
 
+    // Block processing: the next RampLength(n) values returned by Tick() are 
+    // RampStart() + RampDx()*i. Call Skip() to consume them.
+    size_t RampLength(size_t n) const
+    {
+        if (samplesRemaining == 0 || samplesRemaining >= n)
+        {
+            return n;
+        }
+        return samplesRemaining;
+    }
+    float RampStart() const { return samplesRemaining == 0 ? x : x + dx; }
+    float RampDx() const { return samplesRemaining == 0 ? 0 : dx; }
+
+    void Skip(size_t n)
+    {
+        if (samplesRemaining != 0)
+        {
+            if (n >= samplesRemaining)
+            {
+                samplesRemaining = 0;
+                x = targetX;
+            } else {
+                x += dx*n;
+                samplesRemaining -= n;
+            }
+        }
+    }
+
     float Tick()
     {
         if (samplesRemaining != 0)
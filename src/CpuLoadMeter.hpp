@@ -0,0 +1,150 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+namespace toob
+{
+    /// @brief Measures the time a plugin spends in Run(), as a percentage of the block deadline.
+    ///
+    /// Publishes a smoothed load and a held peak to (optional) output control ports, so that
+    /// the instance that is eating the DSP budget can be identified on the device. Measurement
+    /// is skipped entirely when neither port is connected.
+    class CpuLoadMeter
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        static constexpr double SMOOTHING_SECONDS = 0.5;
+        static constexpr double PEAK_HOLD_SECONDS = 2.0;
+        static constexpr float MAX_VALUE = 100.0f;
+
+        void SetSampleRate(double sampleRate)
+        {
+            this->sampleRate = sampleRate;
+            Reset();
+        }
+        void SetLoadData(void *data)
+        {
+            this->loadData = (float *)data;
+            if (loadData)
+            {
+                *loadData = 0;
+            }
+        }
+        void SetPeakData(void *data)
+        {
+            this->peakData = (float *)data;
+            if (peakData)
+            {
+                *peakData = 0;
+            }
+        }
+        bool IsConnected() const { return loadData != nullptr || peakData != nullptr; }
+
+        void Reset()
+        {
+            smoothedLoad = 0;
+            peak = 0;
+            heldPeak = 0;
+            peakHoldSamples = 0;
+        }
+
+        /// @brief Record the time taken to process n_samples frames.
+        void Update(uint32_t n_samples, clock::duration elapsed)
+        {
+            if (n_samples == 0)
+            {
+                return;
+            }
+            double blockSeconds = n_samples / sampleRate;
+            double load = 100.0 * std::chrono::duration<double>(elapsed).count() / blockSeconds;
+
+            double alpha = blockSeconds / (SMOOTHING_SECONDS + blockSeconds);
+            smoothedLoad += (load - smoothedLoad) * alpha;
+
+            // peak is the max over a hold period, and is published immediately when it rises.
+            peak = std::max(peak, load);
+            heldPeak = std::max(heldPeak, load);
+            peakHoldSamples += n_samples;
+            if (peakHoldSamples >= (uint64_t)(PEAK_HOLD_SECONDS * sampleRate))
+            {
+                heldPeak = peak;
+                peak = 0;
+                peakHoldSamples = 0;
+            }
+
+            if (loadData)
+            {
+                *loadData = (float)std::min(smoothedLoad, (double)MAX_VALUE);
+            }
+            if (peakData)
+            {
+                *peakData = (float)std::min(heldPeak, (double)MAX_VALUE);
+            }
+        }
+
+        /// @brief Times the enclosing scope (typically the body of Run()).
+        class Scope
+        {
+        public:
+            Scope(CpuLoadMeter &meter, uint32_t n_samples)
+                : meter(meter), n_samples(n_samples), active(meter.IsConnected())
+            {
+                if (active)
+                {
+                    start = clock::now();
+                }
+            }
+            ~Scope()
+            {
+                if (active)
+                {
+                    meter.Update(n_samples, clock::now() - start);
+                }
+            }
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            CpuLoadMeter &meter;
+            uint32_t n_samples;
+            bool active;
+            clock::time_point start;
+        };
+
+    private:
+        double sampleRate = 48000;
+        float *loadData = nullptr;
+        float *peakData = nullptr;
+        double smoothedLoad = 0;
+        double peak = 0;
+        double heldPeak = 0;
+        uint64_t peakHoldSamples = 0;
+    };
+}
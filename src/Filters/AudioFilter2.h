@@ -113,13 +113,13 @@ namespace toob {
 			double y1 = y[0];
 			double y2 = y[1];
 
-			double y0 = LsNumerics::Undenormalize(x0 * (zTransformCoefficients.b[0])
+			double y0 = x0 * (zTransformCoefficients.b[0])
 				+ x1 * zTransformCoefficients.b[1]
 				+ x2 * zTransformCoefficients.b[2]
 				- (
 					y1* zTransformCoefficients.a[1]
 					+ y2* zTransformCoefficients.a[2]
-					));
+					);
 			y[0] = y0;
 			y[1] = y1;
 			x[0] = x0;
@@ -134,13 +134,13 @@ namespace toob {
 			double y1 = yR[0];
 			double y2 = yR[1];
 
-			double y0 = Undenormalize(x0 * (zTransformCoefficients.b[0])
+			double y0 = x0 * (zTransformCoefficients.b[0])
 				+ x1 * zTransformCoefficients.b[1]
 				+ x2 * zTransformCoefficients.b[2]
 				- (
 					y1* zTransformCoefficients.a[1]
 					+ y2* zTransformCoefficients.a[2]
-					));
+					);
 			yR[0] = y0;
 			yR[1] = y1;
 			xR[0] = x0;
@@ -150,6 +150,8 @@ namespace toob {
 		}
 
 		double GetFrequencyResponse(float frequency);
+
+		const FilterCoefficients2 &GetZTransformCoefficients() const { return zTransformCoefficients; }
 	protected:
 		void BilinearTransform(float frequency, const FilterCoefficients2& prototype, FilterCoefficients2* result);
 
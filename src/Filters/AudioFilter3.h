@@ -110,7 +110,7 @@ namespace toob {
 			double y2 = y[1];
 			double y3 = y[2];
 
-			double y0 = Undenormalize(x0 * (zTransformCoefficients.b[0])
+			double y0 = x0 * (zTransformCoefficients.b[0])
 				+ x1 * zTransformCoefficients.b[1]
 				+ x2 * zTransformCoefficients.b[2]
 				+ x3 * zTransformCoefficients.b[3]
@@ -118,7 +118,7 @@ namespace toob {
 					y1* zTransformCoefficients.a[1]
 					+ y2* zTransformCoefficients.a[2]
 					+ y3* zTransformCoefficients.a[3]
-					));
+					);
 			y[0] = y0;
 			y[1] = y1;
 			y[2] = y2;
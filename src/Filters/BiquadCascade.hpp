@@ -0,0 +1,356 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "FilterCoefficients2.h"
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+namespace toob
+{
+    /**
+     * @brief Block processor for a fixed-length cascade of biquad sections.
+     *
+     * Sections are evaluated in transposed direct form II, stage by stage over a block of
+     * samples, so that each stage's coefficients and state stay in registers for the whole
+     * block. The left and right channels of a stereo pair share one two-lane SIMD vector.
+     *
+     * Mono input is processed time-parallel in chunks of BLOCK_SIZE samples: the chunk is split
+     * into SEGMENTS segments which run in the lanes of two vectors, all but the first starting
+     * from zero state. Each segment is then corrected, in order, with the zero-input response
+     * of the previous segment's final state, which is precomputed per stage whenever
+     * coefficients change. This shortens the serial recurrence, which is what limits biquad
+     * throughput. Remainders shorter than BLOCK_SIZE are processed serially.
+     *
+     * Coefficients are copied from the existing AudioFilter2/FilterCoefficients2 designs with
+     * SetStage(); setting unchanged coefficients is cheap, so callers can refresh every cycle.
+     */
+    template <size_t STAGES>
+    class BiquadCascade
+    {
+    public:
+        static constexpr size_t SEGMENTS = 4;
+        static constexpr size_t SEGMENT_SIZE = 32;
+        static constexpr size_t BLOCK_SIZE = SEGMENTS * SEGMENT_SIZE;
+
+        BiquadCascade()
+        {
+            for (size_t i = 0; i < STAGES; ++i)
+            {
+                stages[i] = Stage{1, 0, 0, 0, 0};
+            }
+            Reset();
+        }
+
+        // z-transform coefficients. As in AudioFilter2::Tick(), a[0] is assumed to be 1.
+        void SetStage(size_t stage, const FilterCoefficients2 &coefficients)
+        {
+            SetStage(stage,
+                     coefficients.b[0], coefficients.b[1], coefficients.b[2],
+                     coefficients.a[1], coefficients.a[2]);
+        }
+        void SetStage(size_t stage, double b0, double b1, double b2, double a1, double a2)
+        {
+            Stage &s = stages[stage];
+            if (s.b0 != b0 || s.b1 != b1 || s.b2 != b2 || s.a1 != a1 || s.a2 != a2)
+            {
+                s = Stage{b0, b1, b2, a1, a2};
+                tablesValid = false;
+            }
+        }
+
+        // Run only the first n stages (n <= STAGES), for designs whose order is chosen at runtime.
+        void SetStageCount(size_t n)
+        {
+            stageCount = std::min(n, STAGES);
+        }
+        size_t GetStageCount() const { return stageCount; }
+
+        void Reset()
+        {
+            for (size_t i = 0; i < STAGES; ++i)
+            {
+                s1[i] = vec2{0, 0};
+                s2[i] = vec2{0, 0};
+            }
+        }
+
+        // Mono. Uses the left-channel state. output may be the same buffer as input.
+        void Process(const float *input, float *output, size_t n_samples);
+
+        // Stereo. outputs may be the same buffers as inputs.
+        void Process(
+            const float *inputL, const float *inputR,
+            float *outputL, float *outputR,
+            size_t n_samples);
+
+    private:
+        typedef double vec2 __attribute__((vector_size(16)));
+
+        struct Stage
+        {
+            double b0, b1, b2, a1, a2;
+        };
+
+        void UpdateTables();
+        void ProcessSerial(size_t stage, double *buffer, size_t n);
+        void ProcessTimeParallel(size_t stage, vec2 *buffer);
+        void ApplyState(size_t stage, double &state1, double &state2, double *segment, size_t stride);
+        void FlushDenorms();
+
+        Stage stages[STAGES];
+        size_t stageCount = STAGES;
+        vec2 s1[STAGES];
+        vec2 s2[STAGES];
+
+        // time-parallel tables: zero-input response to unit s1 and s2, and the
+        // state-transition matrix for SEGMENT_SIZE samples.
+        bool tablesValid = false;
+        double g1[STAGES][SEGMENT_SIZE];
+        double g2[STAGES][SEGMENT_SIZE];
+        double phi[STAGES][2][2];
+
+        double monoBuffer[BLOCK_SIZE];
+        vec2 vectorBuffer[BLOCK_SIZE];
+    };
+
+    // //////////////////
+
+    template <size_t STAGES>
+    void BiquadCascade<STAGES>::UpdateTables()
+    {
+        for (size_t k = 0; k < STAGES; ++k)
+        {
+            const Stage &s = stages[k];
+            for (size_t column = 0; column < 2; ++column)
+            {
+                double state1 = column == 0 ? 1 : 0;
+                double state2 = column == 0 ? 0 : 1;
+                double *g = column == 0 ? g1[k] : g2[k];
+                for (size_t t = 0; t < SEGMENT_SIZE; ++t)
+                {
+                    double y = state1;
+                    g[t] = y;
+                    state1 = state2 - s.a1 * y;
+                    state2 = -s.a2 * y;
+                }
+                phi[k][0][column] = state1;
+                phi[k][1][column] = state2;
+            }
+        }
+        tablesValid = true;
+    }
+
+    template <size_t STAGES>
+    void BiquadCascade<STAGES>::ProcessSerial(size_t stage, double *buffer, size_t n)
+    {
+        const Stage &s = stages[stage];
+        double z1 = s1[stage][0];
+        double z2 = s2[stage][0];
+        for (size_t i = 0; i < n; ++i)
+        {
+            double x = buffer[i];
+            double y = z1 + s.b0 * x;
+            z1 = (s.b1 * x + z2) - s.a1 * y;
+            z2 = s.b2 * x - s.a2 * y;
+            buffer[i] = y;
+        }
+        s1[stage][0] = z1;
+        s2[stage][0] = z2;
+    }
+
+    template <size_t STAGES>
+    void BiquadCascade<STAGES>::ApplyState(size_t stage, double &state1, double &state2, double *segment, size_t stride)
+    {
+        // Add the zero-input response of the incoming state to a segment that was processed
+        // from zero state, and advance the incoming state to the end of the segment. The
+        // caller adds the segment's own zero-state final state.
+        const double *pG1 = g1[stage];
+        const double *pG2 = g2[stage];
+        for (size_t t = 0; t < SEGMENT_SIZE; ++t)
+        {
+            segment[t * stride] += pG1[t] * state1 + pG2[t] * state2;
+        }
+        const auto &m = phi[stage];
+        double next1 = m[0][0] * state1 + m[0][1] * state2;
+        double next2 = m[1][0] * state1 + m[1][1] * state2;
+        state1 = next1;
+        state2 = next2;
+    }
+
+    template <size_t STAGES>
+    void BiquadCascade<STAGES>::ProcessTimeParallel(size_t stage, vec2 *buffer)
+    {
+        // Segments 0 and 1 are in the lanes of buffer[0..SEGMENT_SIZE), segments 2 and 3
+        // in the lanes of buffer[SEGMENT_SIZE..2*SEGMENT_SIZE).
+        const Stage &s = stages[stage];
+        vec2 *bufferA = buffer;
+        vec2 *bufferB = buffer + SEGMENT_SIZE;
+        vec2 za1{s1[stage][0], 0};
+        vec2 za2{s2[stage][0], 0};
+        vec2 zb1{0, 0};
+        vec2 zb2{0, 0};
+        for (size_t t = 0; t < SEGMENT_SIZE; ++t)
+        {
+            vec2 xa = bufferA[t];
+            vec2 xb = bufferB[t];
+            vec2 ya = za1 + s.b0 * xa;
+            vec2 yb = zb1 + s.b0 * xb;
+            za1 = (s.b1 * xa + za2) - s.a1 * ya;
+            zb1 = (s.b1 * xb + zb2) - s.a1 * yb;
+            za2 = s.b2 * xa - s.a2 * ya;
+            zb2 = s.b2 * xb - s.a2 * yb;
+            bufferA[t] = ya;
+            bufferB[t] = yb;
+        }
+        // propagate the final state of each segment into the next.
+        double state1 = za1[0];
+        double state2 = za2[0];
+        ApplyState(stage, state1, state2, ((double *)bufferA) + 1, 2);
+        state1 += za1[1];
+        state2 += za2[1];
+        ApplyState(stage, state1, state2, ((double *)bufferB) + 0, 2);
+        state1 += zb1[0];
+        state2 += zb2[0];
+        ApplyState(stage, state1, state2, ((double *)bufferB) + 1, 2);
+        state1 += zb1[1];
+        state2 += zb2[1];
+
+        s1[stage][0] = state1;
+        s2[stage][0] = state2;
+    }
+
+    template <size_t STAGES>
+    void BiquadCascade<STAGES>::FlushDenorms()
+    {
+        constexpr double DENORM_LIMIT = 1E-20;
+        for (size_t k = 0; k < STAGES; ++k)
+        {
+            for (size_t lane = 0; lane < 2; ++lane)
+            {
+                if (std::abs(s1[k][lane]) < DENORM_LIMIT)
+                    s1[k][lane] = 0;
+                if (std::abs(s2[k][lane]) < DENORM_LIMIT)
+                    s2[k][lane] = 0;
+            }
+        }
+    }
+
+    template <size_t STAGES>
+    void BiquadCascade<STAGES>::Process(const float *input, float *output, size_t n_samples)
+    {
+        if (!tablesValid)
+        {
+            UpdateTables();
+        }
+        while (n_samples != 0)
+        {
+            size_t n = std::min(n_samples, BLOCK_SIZE);
+            if (n == BLOCK_SIZE)
+            {
+                constexpr size_t S = SEGMENT_SIZE;
+                for (size_t t = 0; t < S; ++t)
+                {
+                    vectorBuffer[t] = vec2{input[t], input[t + S]};
+                    vectorBuffer[t + S] = vec2{input[t + 2 * S], input[t + 3 * S]};
+                }
+                for (size_t k = 0; k < stageCount; ++k)
+                {
+                    ProcessTimeParallel(k, vectorBuffer);
+                }
+                for (size_t t = 0; t < S; ++t)
+                {
+                    output[t] = (float)vectorBuffer[t][0];
+                    output[t + S] = (float)vectorBuffer[t][1];
+                    output[t + 2 * S] = (float)vectorBuffer[t + S][0];
+                    output[t + 3 * S] = (float)vectorBuffer[t + S][1];
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    monoBuffer[i] = input[i];
+                }
+                for (size_t k = 0; k < stageCount; ++k)
+                {
+                    ProcessSerial(k, monoBuffer, n);
+                }
+                for (size_t i = 0; i < n; ++i)
+                {
+                    output[i] = (float)monoBuffer[i];
+                }
+            }
+            input += n;
+            output += n;
+            n_samples -= n;
+        }
+        FlushDenorms();
+    }
+
+    template <size_t STAGES>
+    void BiquadCascade<STAGES>::Process(
+        const float *inputL, const float *inputR,
+        float *outputL, float *outputR,
+        size_t n_samples)
+    {
+        while (n_samples != 0)
+        {
+            size_t n = std::min(n_samples, BLOCK_SIZE);
+            for (size_t i = 0; i < n; ++i)
+            {
+                vectorBuffer[i] = vec2{inputL[i], inputR[i]};
+            }
+            for (size_t k = 0; k < stageCount; ++k)
+            {
+                const Stage &s = stages[k];
+                vec2 z1 = s1[k];
+                vec2 z2 = s2[k];
+                for (size_t i = 0; i < n; ++i)
+                {
+                    vec2 x = vectorBuffer[i];
+                    vec2 y = z1 + s.b0 * x;
+                    z1 = (s.b1 * x + z2) - s.a1 * y;
+                    z2 = s.b2 * x - s.a2 * y;
+                    vectorBuffer[i] = y;
+                }
+                s1[k] = z1;
+                s2[k] = z2;
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                outputL[i] = (float)vectorBuffer[i][0];
+                outputR[i] = (float)vectorBuffer[i][1];
+            }
+            inputL += n;
+            inputR += n;
+            outputL += n;
+            outputR += n;
+            n_samples -= n;
+        }
+        FlushDenorms();
+    }
+}
@@ -42,8 +42,27 @@ void ChebyshevDownsamplingFilter::Design(double samplingFrequency,
         Iir::complex_t response = filter.response(bandstopFrequency/samplingFrequency);    
 
         double db = a2db(std::abs(response));
-        if (db < bandstopDb) return;
+        if (db < bandstopDb) 
+        {
+            UpdateBlockFilter();
+            return;
+        }
     }
     throw std::invalid_argument("Downsampling filter design failed.");
 
 }
+
+void ChebyshevDownsamplingFilter::UpdateBlockFilter()
+{
+    int nStages = filter.getNumStages();
+    blockFilter.SetStageCount(nStages);
+    for (int i = 0; i < nStages; ++i)
+    {
+        const Iir::Biquad &stage = filter[i];
+        double a0 = stage.getA0();
+        blockFilter.SetStage(i,
+            stage.getB0()/a0, stage.getB1()/a0, stage.getB2()/a0,
+            stage.getA1()/a0, stage.getA2()/a0);
+    }
+    blockFilter.Reset();
+}
@@ -23,11 +23,15 @@
 
 #pragma once
 #include "../iir/ChebyshevI.h"
+#include "BiquadCascade.hpp"
 namespace toob {
 
     class ChebyshevDownsamplingFilter {
     private:
-        Iir::ChebyshevI::LowPass<20> filter;
+        static constexpr int MAX_ORDER = 20;
+        Iir::ChebyshevI::LowPass<MAX_ORDER> filter;
+        BiquadCascade<(MAX_ORDER+1)/2> blockFilter;
+        void UpdateBlockFilter();
     public:
         /// Design the Chebyshev filter of minimum order than can attenuate bandstopDb at bandstopFrequency
         void Design(double samplingFrequency, 
@@ -37,10 +41,17 @@ namespace toob {
         void Reset()
         {
             filter.reset();
+            blockFilter.Reset();
         }
         double Tick(double input)
         {
             return filter.filter(input);
         }
+        /// Block processing with the same sections as Tick(), run as a BiquadCascade. 
+        /// Process() and Tick() keep separate state; use one or the other.
+        void Process(const float *input, float *output, size_t n)
+        {
+            blockFilter.Process(input, output, n);
+        }
     };
 }
\ No newline at end of file
@@ -35,7 +35,9 @@ void GainSection::SetSampleRate(double rate)
     hpFilter.SetSampleRate(rate);
     lpFilter.SetSampleRate(rate);
     this->trimVolume.SetSampleRate(rate);
-    gain.SetSampleRate(rate);
+    // filter coefficients depend on the sample rate.
+    LoCut.Invalidate();
+    HiCut.Invalidate();
 }
 
 GainSection::GainSection()
@@ -45,7 +47,6 @@ GainSection::GainSection()
 
 void GainSection::Reset()
 {
-    gain.Reset();
     hpFilter.Reset();
     lpFilter.Reset();
     peakMax = 0;
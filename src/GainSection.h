@@ -39,6 +39,7 @@
 #include "lv2/units/units.h"
 #include "FilterResponse.h"
 #include <string>
+#include <algorithm>
 
 #include <lv2_plugin/Lv2Plugin.hpp>
 
@@ -146,17 +147,6 @@ namespace toob
                 peakMax = 0;
             }
 
-            inline float TickSupersampled(float value) { 
-                if (!Enable) return value;
-                value *= trimVolume.Tick();
-
-                value = lpFilter.Tick(hpFilter.Tick(value));
-                if (value > peakMax) peakMax = value;
-                if (value < peakMin) peakMin = value;
-                float x = 
-                    gain.TickSupersampled(value);
-                return Undenormalize(x);
-            }
             inline float Tick(float value) { 
                 if (!Enable) return value;
                 value *= trimVolume.Tick();
@@ -167,7 +157,28 @@ namespace toob
 
                 float x = 
                     gain.Tick( value);
-                return Undenormalize(x);
+                return x;
+            }
+
+            // Block equivalent of Tick(), in place. The filters run per sample; the waveshaper
+            // runs over the whole block in one pass.
+            void Process(float *buffer, size_t n)
+            {
+                if (!Enable) return;
+                float tMax = peakMax;
+                float tMin = peakMin;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    float value = buffer[i] * trimVolume.Tick();
+                    value = lpFilter.Tick(hpFilter.Tick(value));
+                    tMax = std::max(tMax, value);
+                    tMin = std::min(tMin, value);
+                    buffer[i] = value;
+                }
+                peakMax = tMax;
+                peakMin = tMin;
+
+                gain.Process(buffer, n);
             }
 
     };
@@ -32,18 +32,6 @@
 using namespace toob;
 
 
-static const float CUTOFF_FREQUENCY = 16000;
-
-void GainStage::SetSampleRate(double rate)
-{
-    this->upsamplingFilter.SetSampleRate(rate*4);
-    this->downsamplingFilter.SetSampleRate(rate*4);
-    this->upsamplingFilter.SetCutoffFrequency(CUTOFF_FREQUENCY);
-    #if OLD_GAIN_FILTER
-        this->downsamplingFilter.SetCutoffFrequency(CUTOFF_FREQUENCY);
-    #endif
-}
-
 
 
 static inline double TubeFn(double value)
@@ -60,6 +48,29 @@ double GainStage::GainFn(double value)
         return (TubeFn(value*effectiveGain-bias)+postAdd)*gainScale;
 }
 
+void GainStage::Process(float *buffer, size_t n)
+{
+    if (shape == EShape::ATAN)
+    {
+        float inputScale = (float)effectiveGain;
+        float inputOffset = (float)-bias;
+        float outputOffset = (float)postAdd;
+        float outputScale = (float)-gainScale;
+        for (size_t i = 0; i < n; ++i)
+        {
+            buffer[i] = (AtanBranchFree(buffer[i]*inputScale+inputOffset)+outputOffset)*outputScale;
+        }
+    }
+    else
+    {
+        // -((TubeFn(x)+postAdd)*gainScale) == (At(x)-postAdd)*gainScale
+        LsNumerics::gTubeStageApproximation.Process(
+            buffer, buffer, n,
+            (float)effectiveGain, (float)-bias,
+            (float)-postAdd, (float)gainScale);
+    }
+}
+
 void GainStage::SetShape(GainStage::EShape shape)
 {
     this->shape = shape;
@@ -131,17 +142,3 @@ void GainStage::SetTubeGain(float value)
 
     this->gainScale = 1.0/max;
 }
-
-float GainStage::TickSupersampled(float value)
-{
-    double x0 = upsamplingFilter.Tick(value);
-    double x1 = upsamplingFilter.Tick(value);
-    double x2 = upsamplingFilter.Tick(value);
-    double x3 = upsamplingFilter.Tick(value);
-
-    downsamplingFilter.Tick(GainFn(x0));
-    downsamplingFilter.Tick(GainFn(x1));
-    downsamplingFilter.Tick(GainFn(x2));
-    return Undenormalize((float)downsamplingFilter.Tick(GainFn(x3)));
-
-}
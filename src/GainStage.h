@@ -23,13 +23,9 @@
 
 #pragma once
 
-#include "Filters/LowPassFilter.h"
-#include "Filters/DownsamplingLowPassFilter.h"
 #include "WaveShapes.h"
 #include "LsNumerics/TubeStageApproximation.hpp"
 
-#define OLD_GAIN_FILTER 0
-
 namespace toob {
     class GainStage {
     public:
@@ -38,13 +34,6 @@ namespace toob {
             TUBE,
         };
     private:
-        LowPassFilter upsamplingFilter;
-        #if OLD_GAIN_FILTER
-            LowPassFilter downsamplingFilter;
-        #else
-            DownsamplingLowPassFilter downsamplingFilter;
-        #endif
-
         double gain = 1;
         double effectiveGain = 1;
         double bias = 0;
@@ -60,16 +49,8 @@ namespace toob {
         void SetShape(EShape shape);
         void SetBias(float value);
 
-        void Reset() 
-        {
-            upsamplingFilter.Reset();
-            downsamplingFilter.Reset();
-        }
         void SetGain(float value);
 
-        void SetSampleRate(double rate);
-        float TickSupersampled(float value);
-
         double GainFn(double value);
 
         float Tick(float value)
@@ -77,5 +58,8 @@ namespace toob {
             // invert phase (useful for chaining)
             return -GainFn(value);
         }
+
+        // Block equivalent of Tick(), in place.
+        void Process(float *buffer, size_t n);
     };
 }
\ No newline at end of file
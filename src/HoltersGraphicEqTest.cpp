@@ -26,6 +26,7 @@
 #include "LsNumerics/LsMath.hpp"
 #include <cassert>
 #include <stdexcept>
+#include <chrono>
 #include "LsNumerics/Denorms.hpp"
 
 
@@ -375,6 +376,102 @@ void TestEquation13()
     cout << endl;
 
 }
+template <typename T>
+static double MaxBlockError(GraphicEq &eq, size_t blockSize)
+{
+    // compare GraphicEqBlock against the per-sample reference implementation.
+    GraphicEqBlock<T> blockEq{eq};
+    eq.reset();
+
+    constexpr size_t N = 48000;
+    std::vector<float> input(N), expected(N), actual(N);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < N; ++i)
+    {
+        seed = seed * 1664525 + 1013904223;
+        input[i] = (float)((seed >> 8) / double(1 << 24) - 0.5) + 0.3f * (float)std::sin(i * 0.002);
+    }
+    eq.process(input.data(), expected.data(), N);
+
+    for (size_t i = 0; i < N; i += blockSize)
+    {
+        size_t n = std::min(blockSize, N - i);
+        blockEq.process(input.data() + i, actual.data() + i, n);
+    }
+    double maxError = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        maxError = std::max(maxError, (double)std::abs(expected[i] - actual[i]));
+    }
+    return maxError;
+}
+
+void TestBlock()
+{
+    cout << "Block processing" << endl;
+    GraphicEq eq(48000, 7, 100, 2);
+    for (size_t i = 0; i < eq.getNumBands(); ++i)
+    {
+        eq.setGain(i, Db2Af((i & 1) ? -12.0 : 9.0));
+    }
+    for (size_t blockSize : {1, 2, 3, 5, 64, 1000})
+    {
+        double doubleError = MaxBlockError<double>(eq, blockSize);
+        double floatError = MaxBlockError<float>(eq, blockSize);
+        cout << "   block size " << blockSize
+             << " max error (double): " << doubleError
+             << " (float): " << floatError << endl;
+        test_assert(doubleError < 1E-6);
+        // float error is dominated by rounding in the lowest band's allpass state (~2E-5).
+        test_assert(floatError < 1E-4);
+    }
+    cout << endl;
+}
+
+template <typename PROCESS>
+static double BenchmarkRun(PROCESS &&process)
+{
+    constexpr size_t BLOCK_SIZE = 64;
+    constexpr size_t SECONDS = 10;
+    constexpr size_t SAMPLE_RATE = 48000;
+    std::vector<float> input(BLOCK_SIZE), output(BLOCK_SIZE);
+    for (size_t i = 0; i < BLOCK_SIZE; ++i)
+    {
+        input[i] = (float)std::sin(i * 0.1);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < SECONDS * SAMPLE_RATE / BLOCK_SIZE; ++i)
+    {
+        process(input.data(), output.data(), BLOCK_SIZE);
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // ms per second of audio.
+    return elapsed * 1000.0 / SECONDS;
+}
+
+void Benchmark()
+{
+    cout << "Benchmark (7 bands, 64-sample blocks, ms per second of audio)" << endl;
+    GraphicEq eq(48000, 7, 100, 2);
+    for (size_t i = 0; i < eq.getNumBands(); ++i)
+    {
+        eq.setGain(i, Db2Af(6.0));
+    }
+    GraphicEqBlock<double> blockDouble{eq};
+    GraphicEqBlock<float> blockFloat{eq};
+
+    double tReference = BenchmarkRun([&](const float *in, float *out, size_t n)
+                                     { eq.process(in, out, n); });
+    double tDouble = BenchmarkRun([&](const float *in, float *out, size_t n)
+                                  { blockDouble.process(in, out, n); });
+    double tFloat = BenchmarkRun([&](const float *in, float *out, size_t n)
+                                 { blockFloat.process(in, out, n); });
+    cout << "   GraphicEq:              " << tReference << endl;
+    cout << "   GraphicEqBlock<double>: " << tDouble << endl;
+    cout << "   GraphicEqBlock<float>:  " << tFloat << endl;
+    cout << endl;
+}
+
 int main(int argc, char **argv)
 {
     AutoDenorm disableDenorms{};
@@ -382,5 +479,7 @@ int main(int argc, char **argv)
     TestBands();
     TestBand();
     TestEquation13();
+    TestBlock();
+    Benchmark();
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -61,6 +61,14 @@ namespace toob {
         {
             return buffer[(head + delay ) & ixMask];
         }
+        // Read n samples in forward time order: Tap(delay), Tap(delay-1), ... Tap(delay-n+1).
+        void Read(int32_t delay, float *output, size_t n) const
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                output[i] = buffer[(head + delay - (int32_t)i) & ixMask];
+            }
+        }
         // float operator[](int32_t delay) const
         // {
         //     return buffer[(head -1- delay) & ixMask];
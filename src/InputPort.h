@@ -90,6 +90,12 @@ namespace toob {
 			return lastValue = ClampedValue();
 		}
 
+		// Force the next HasChanged() to return true.
+		void Invalidate()
+		{
+			lastValue = -std::numeric_limits<float>::max();
+		}
+
 	};
 	class EnumeratedInputPort {
 	private:
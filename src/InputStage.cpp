@@ -25,6 +25,7 @@
 //
 
 #include "InputStage.h"
+#include "LsNumerics/Denorms.hpp"
 
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
@@ -95,9 +96,9 @@ InputStage::InputStage(double _rate,
     this->loCutFilter.SetSampleRate((float)_rate);
     this->brightFilter.SetSampleRate((float)_rate);
     this->noiseGate.SetSampleRate(_rate);
-    this->gainStage.SetSampleRate(_rate);
     this->trimOut.SetSampleRate(_rate);
     this->gateOut.SetSampleRate(_rate);
+    cpuLoadMeter.SetSampleRate(_rate);
 
     this->updateSampleDelay = (int)(_rate / MAX_UPDATES_PER_SECOND);
     this->updateMsDelay = (1000 / MAX_UPDATES_PER_SECOND);
@@ -147,6 +148,12 @@ void InputStage::ConnectPort(uint32_t port, void *data)
     case PortId::NOTIFY_OUT:
         this->notifyOut = (LV2_Atom_Sequence *)data;
         break;
+    case PortId::CPU_LOAD:
+        this->cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::CPU_PEAK:
+        this->cpuLoadMeter.SetPeakData(data);
+        break;
     }
 }
 
@@ -161,7 +168,6 @@ void InputStage::Activate()
     this->highCutFilter.Reset();
     this->brightFilter.Reset();
     this->noiseGate.Reset();
-    this->gainStage.Reset();
     this->gateOut.Reset(0);
 }
 void InputStage::Deactivate()
@@ -171,6 +177,9 @@ void InputStage::Deactivate()
 
 void InputStage::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     // prepare forge to write to notify output port.
     // Set up forge to write directly to notify output port.
     const uint32_t notify_capacity = this->notifyOut->atom.size;
@@ -232,10 +241,10 @@ void InputStage::Run(uint32_t n_samples)
     for (uint32_t i = 0; i < n_samples; ++i)
     {
 
-        float x = Undenormalize((float)this->brightFilter.Tick(
+        float x = (float)this->brightFilter.Tick(
             this->highCutFilter.Tick(
                 this->loCutFilter.Tick(
-                    trim * input[i]))));
+                    trim * input[i])));
 
         trimOut.AddValue(x);
 
@@ -49,6 +49,8 @@
 #include "Filters/ShelvingLowCutFilter2.h"
 #include "NoiseGate.h"
 #include "GainStage.h"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 
@@ -73,6 +75,8 @@ namespace toob {
 			AUDIO_OUT,
 			CONTROL_IN,
 			NOTIFY_OUT,
+			CPU_LOAD,
+			CPU_PEAK,
 		};
 
 		double rate;
@@ -86,6 +90,8 @@ namespace toob {
 		RangedDbInputPort gateT;
 		VuOutputPort trimOut;
 		RateLimitedOutputPort gateOut;
+		RtTraceSource traceSource{"InputStage"};
+		CpuLoadMeter cpuLoadMeter;
 
 		const float* input = NULL;
 		float* output = NULL;
@@ -170,7 +176,6 @@ namespace toob {
 		NoiseGate noiseGate;
 
 		ShelvingLowCutFilter2 brightFilter = ShelvingLowCutFilter2();
-		GainStage gainStage;
 
 		FilterResponse filterResponse;
 		//int32_t peakDelay = 0;
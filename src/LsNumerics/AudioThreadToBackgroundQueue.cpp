@@ -23,6 +23,7 @@
  */
 
 #include "AudioThreadToBackgroundQueue.hpp"
+#include "Denorms.hpp"
 #include <iostream>
 #include <exception>
 #include <pthread.h> // for changing thread priorit.
@@ -31,6 +32,7 @@
 #include <iostream>
 #include <cstring> // for memset.
 #include "../util.hpp"
+#include "../ThreadManager.hpp"
 #include "../ss.hpp"
 
 using namespace LsNumerics;
@@ -230,25 +232,12 @@ AudioThreadToBackgroundQueue::~AudioThreadToBackgroundQueue()
     }
 }
 
-static int convolutionThreadPriorities[] =
-    {
-        -1,
-        45,
-        44,
-        4,
-        3,
-        2,
-        1,
-        1,
-        1,
-        1,
-        1,
-        1,
-};
+// Priorities are assigned by toob::ThreadManager (ThreadRole::ConvolutionSection).
+static constexpr int MAX_CONVOLUTION_THREAD_NUMBER = 11;
 
 void AudioThreadToBackgroundQueue::CreateThread(const std::function<void(void)> &threadProc, int threadNumber)
 {
-    if ((size_t)threadNumber > sizeof(convolutionThreadPriorities) / sizeof(convolutionThreadPriorities[0]) || threadNumber == 0)
+    if (threadNumber > MAX_CONVOLUTION_THREAD_NUMBER || threadNumber <= 0)
     {
         throw std::logic_error("Invalid thread number.");
     }
@@ -258,10 +247,11 @@ void AudioThreadToBackgroundQueue::CreateThread(const std::function<void(void)>
     thread_ptr thread = std::make_unique<std::thread>(
         [this, threadProc, threadNumber]()
         {
-            toob::SetThreadName(SS("crvb" << threadNumber));
-
+            // FTZ/DAZ for the life of the thread; section code relies on it instead of per-sample undenormalizing.
+            disable_denorms();
             if (this->schedulerPolicy == SchedulerPolicy::UnitTest)
             {
+                toob::ThreadManager::Get().ConfigureCurrentThreadNonRealtime(toob::ThreadRole::ConvolutionSection, threadNumber);
                 errno = 0;
                 int ret = nice(threadNumber);
                 if (ret < 0 && errno != 0)
@@ -276,8 +266,7 @@ void AudioThreadToBackgroundQueue::CreateThread(const std::function<void(void)>
             {
                 try
                 {
-                    int schedPriority = convolutionThreadPriorities[threadNumber];
-                    toob::SetRtThreadPriority(schedPriority);
+                    toob::ThreadManager::Get().ConfigureCurrentThread(toob::ThreadRole::ConvolutionSection, threadNumber);
                 }
                 catch (const std::exception &e)
                 {
@@ -25,10 +25,14 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
 
 namespace LsNumerics {
     namespace CacheInfo {
-        // not currently used.
+        // Fallback values, used when cache sizes can't be read from sysfs.
 
         // Rasberry Pi 4
         constexpr size_t L1InstructionCacheSize = 192*1024;
@@ -42,5 +46,144 @@ namespace LsNumerics {
         constexpr size_t L2CacheSize = 1024*1024;
         constexpr size_t L2CacheAssociativity = 16;
         constexpr size_t L2BlockSize = L2CacheAssociativity/16; // 16-way associative.
+
+        /// @brief Data cache sizes of the processor we are running on (cpu0).
+        struct CacheSizes
+        {
+            size_t l1DataSize = L1DataBlockSize;
+            size_t l2Size = L2CacheSize;
+            size_t l3Size = 0; // 0 if there is no L3 cache.
+            size_t lineSize = 64;
+            bool detected = false; // false if the fallback values are being used.
+        };
+
+        namespace Implementation
+        {
+            // "48K" -> 49152.
+            inline size_t ParseSysfsSize(const std::string &text)
+            {
+                size_t value = 0;
+                size_t i = 0;
+                while (i < text.length() && text[i] >= '0' && text[i] <= '9')
+                {
+                    value = value * 10 + (text[i] - '0');
+                    ++i;
+                }
+                if (i < text.length())
+                {
+                    switch (text[i])
+                    {
+                    case 'K':
+                        value *= 1024;
+                        break;
+                    case 'M':
+                        value *= 1024 * 1024;
+                        break;
+                    case 'G':
+                        value *= 1024 * 1024 * 1024;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+                return value;
+            }
+
+            inline std::string ReadSysfsLine(const std::filesystem::path &path)
+            {
+                std::ifstream f(path);
+                std::string result;
+                if (f.is_open())
+                {
+                    std::getline(f, result);
+                }
+                return result;
+            }
+
+            inline CacheSizes DetectCacheSizes(const std::filesystem::path &cacheDirectory = "/sys/devices/system/cpu/cpu0/cache")
+            {
+                CacheSizes result;
+                bool l1Found = false, l2Found = false;
+                std::error_code ec;
+                for (size_t index = 0; index < 16; ++index)
+                {
+                    std::filesystem::path indexDirectory = cacheDirectory / ("index" + std::to_string(index));
+                    if (!std::filesystem::exists(indexDirectory, ec))
+                    {
+                        break;
+                    }
+                    std::string type = ReadSysfsLine(indexDirectory / "type");
+                    if (type != "Data" && type != "Unified")
+                    {
+                        continue;
+                    }
+                    size_t level = ParseSysfsSize(ReadSysfsLine(indexDirectory / "level"));
+                    size_t size = ParseSysfsSize(ReadSysfsLine(indexDirectory / "size"));
+                    if (size == 0)
+                    {
+                        continue;
+                    }
+                    switch (level)
+                    {
+                    case 1:
+                    {
+                        result.l1DataSize = size;
+                        l1Found = true;
+                        size_t lineSize = ParseSysfsSize(ReadSysfsLine(indexDirectory / "coherency_line_size"));
+                        if (lineSize != 0)
+                        {
+                            result.lineSize = lineSize;
+                        }
+                        break;
+                    }
+                    case 2:
+                        result.l2Size = size;
+                        l2Found = true;
+                        break;
+                    case 3:
+                        result.l3Size = size;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+                result.detected = l1Found && l2Found;
+                if (!result.detected)
+                {
+                    return CacheSizes();
+                }
+                return result;
+            }
+        }
+
+        /// @brief Cache sizes of the current processor, read from sysfs on first use.
+        inline const CacheSizes &GetCacheSizes()
+        {
+            static CacheSizes cacheSizes = Implementation::DetectCacheSizes();
+            return cacheSizes;
+        }
+
+        /// @brief Largest power-of-two block size (within [minBlockSize, maxBlockSize]) whose working set
+        /// fits in half of the L2 cache.
+        inline size_t L2BlockSizeForWorkingSet(size_t bytesPerFrame, size_t minBlockSize, size_t maxBlockSize)
+        {
+            size_t budget = GetCacheSizes().l2Size / 2;
+            size_t blockSize = minBlockSize;
+            while (blockSize * 2 <= maxBlockSize && blockSize * 2 * bytesPerFrame <= budget)
+            {
+                blockSize *= 2;
+            }
+            return blockSize < maxBlockSize ? blockSize : maxBlockSize;
+        }
+
+        /// @brief Rough per-frame working set of a NAM model: activations of two WaveNet layer arrays
+        /// with up to 16 channels, plus head buffers.
+        constexpr size_t NamBytesPerFrame = 512;
+
+        /// @brief Number of frames to pass to a NAM model at a time.
+        inline size_t NamProcessingBlockSize(size_t maxBufferSize)
+        {
+            return L2BlockSizeForWorkingSet(NamBytesPerFrame, 64, maxBufferSize);
+        }
     }
-}
\ No newline at end of file
+}
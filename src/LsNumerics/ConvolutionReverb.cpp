@@ -25,6 +25,7 @@
 #include "ConvolutionReverb.hpp"
 #include "../ss.hpp"
 #include "Denorms.hpp"
+#include "CpuFeatures.hpp"
 #include <memory>
 #include <cassert>
 #include <limits>
@@ -41,6 +42,7 @@
 #include "BinaryWriter.hpp"
 #include "BinaryReader.hpp"
 #include "../util.hpp"
+#include "../ThreadManager.hpp"
 #include <memory.h>
 #include <iostream>
 
@@ -1218,7 +1220,8 @@ Implementation::DirectConvolutionSection::DirectConvolutionSection(
 {
     buffer.resize(size * 2);
     inputBuffer.resize(size * 2);
-    impulseFft.resize(size * 2);
+    spectrum.resize(size + 1);
+    impulseFft.resize(size + 1);
     size_t len = size;
 
     const float norm = (float)(std::sqrt(2 * size));
@@ -1232,44 +1235,46 @@ Implementation::DirectConvolutionSection::DirectConvolutionSection(
         len = impulseData.size() - sampleOffset;
     }
 
+    std::vector<float> paddedImpulse(size * 2);
     for (size_t i = 0; i < len; ++i)
     {
-        impulseFft[i + size] = norm * impulseData[i + sampleOffset];
+        paddedImpulse[i + size] = norm * impulseData[i + sampleOffset];
     }
-    fftPlan.Compute(impulseFft, impulseFft, Fft::Direction::Forward);
+    fftPlan.Compute(paddedImpulse, impulseFft, Fft::Direction::Forward);
     bufferIndex = 0;
     if (impulseDataRightOpt != nullptr)
     {
         bufferRight.resize(size * 2);
         inputBufferRight.resize(size * 2);
-        impulseFftRight.resize(size * 2);
+        impulseFftRight.resize(size + 1);
         for (size_t i = 0; i < len; ++i)
         {
-            impulseFftRight[i + size] = norm * (*impulseDataRightOpt)[i + sampleOffset];
+            paddedImpulse[i + size] = norm * (*impulseDataRightOpt)[i + sampleOffset];
         }
-        fftPlan.Compute(impulseFftRight, impulseFftRight, Fft::Direction::Forward);
+        fftPlan.Compute(paddedImpulse, impulseFftRight, Fft::Direction::Forward);
     }
 }
 
+LS_KERNEL_CLONES
 void Implementation::DirectConvolutionSection::UpdateBuffer()
 {
-    fftPlan.Compute(inputBuffer, buffer, Fft::Direction::Forward);
-    size_t size2 = size * 2;
-    for (size_t i = 0; i < size2; ++i)
+    size_t spectrumSize = size + 1;
+
+    fftPlan.Compute(inputBuffer, spectrum, Fft::Direction::Forward);
+    for (size_t i = 0; i < spectrumSize; ++i)
     {
-        buffer[i] *= impulseFft[i];
+        spectrum[i] *= impulseFft[i];
     }
-    fftPlan.Compute(buffer, buffer, Fft::Direction::Backward);
+    fftPlan.Compute(spectrum, buffer, Fft::Direction::Backward);
 
     if (isStereo)
     {
-        fftPlan.Compute(inputBufferRight, bufferRight, Fft::Direction::Forward);
-        size_t size2 = size * 2;
-        for (size_t i = 0; i < size2; ++i)
+        fftPlan.Compute(inputBufferRight, spectrum, Fft::Direction::Forward);
+        for (size_t i = 0; i < spectrumSize; ++i)
         {
-            bufferRight[i] *= impulseFftRight[i];
+            spectrum[i] *= impulseFftRight[i];
         }
-        fftPlan.Compute(bufferRight, bufferRight, Fft::Direction::Backward);
+        fftPlan.Compute(spectrum, bufferRight, Fft::Direction::Backward);
     }
     bufferIndex = 0;
 }
@@ -1326,7 +1331,6 @@ void DirectConvolutionSection::Execute(AudioThreadToBackgroundQueue &input, size
     auto writeCount = output.GetWriteCount();
 
 #endif
-    disable_denorms();
 
     {
         if (isStereo)
@@ -1405,8 +1409,7 @@ void BalancedConvolution::OnSynchronizedSingleReaderDelayLineReady()
 
 void BalancedConvolution::DirectSectionThread::Execute(AudioThreadToBackgroundQueue &inputDelayLine)
 {
-    disable_denorms();
-
+    // FTZ/DAZ has already been set by AudioThreadToBackgroundQueue::CreateThread.
     size_t tailPosition = inputDelayLine.GetReadTailPosition();
     while (true)
     {
@@ -1434,11 +1437,9 @@ void BalancedConvolution::AssemblyThreadProc()
 
     disable_denorms();
     
-    toob::SetThreadName("cr_assembly");
     try
     {
-        // 76 slots into pipewire priorities nicely.
-        toob::SetRtThreadPriority(76);
+        toob::ThreadManager::Get().ConfigureCurrentThread(toob::ThreadRole::ConvolutionAssembly);
     }
     catch (const std::exception &e)
     {
@@ -64,11 +64,6 @@ namespace LsNumerics
         Reverse = -1
     };
 
-    inline float UndenormalizeValue(float value)
-    {
-        return 1.0f + value - 1.0f;
-    }
-
     namespace Implementation
     {
         class AssemblyQueue
@@ -412,7 +407,7 @@ namespace LsNumerics
 
                 inputBuffer[bufferIndex] = inputBuffer[bufferIndex + size];
                 inputBuffer[bufferIndex + size] = input;
-                float result = (float(buffer[bufferIndex].real()));
+                float result = buffer[bufferIndex];
                 ++bufferIndex;
                 return result;
             }
@@ -444,7 +439,7 @@ namespace LsNumerics
 #endif
 
         private:
-            using Fft = StagedFft;
+            using Fft = StagedRealFft;
 
             void UpdateBuffer();
 
@@ -455,14 +450,16 @@ namespace LsNumerics
             size_t size;
             size_t sampleOffset;
             size_t inputDelay;
+            // half-spectra (size+1 bins) of the zero-padded impulse.
             std::vector<fft_complex_t> impulseFft;
             std::vector<fft_complex_t> impulseFftRight;
 
             size_t bufferIndex;
             std::vector<float> inputBuffer;
             std::vector<float> inputBufferRight;
-            std::vector<fft_complex_t> buffer;
-            std::vector<fft_complex_t> bufferRight;
+            std::vector<fft_complex_t> spectrum;
+            std::vector<float> buffer;
+            std::vector<float> bufferRight;
         };
     }
 
@@ -487,7 +484,8 @@ namespace LsNumerics
         /// determines how the thread priority is set. If Scheduler::Realtime, the worker threads' scheduler policy
         /// is set to SCHED_RR (realtime). Actually priorities are chosen to provide optimal priorities for Linux
         /// audio systems. Very large FFTs are schedule below +6 inorder not to interfere with USB audio services
-        /// which run at RT priority +6.
+        /// which run at RT priority +6. Priorities and CPU affinity are assigned by toob::ThreadManager, and can be
+        /// configured there.
         ///
         /// If Scheduler::Normal is specified, the thread priorities are set using nice (3). When running in
         /// realtime, the schedulerPolicy should always be SchedulerPolicy::Realtime.
@@ -860,7 +858,7 @@ namespace LsNumerics
         // float TickUnsynchronizedWithFeedback(float value)
         // {
         //     float recirculationValue = feedbackDelay.Value() * feedbackScale;
-        //     float input = Undenormalize(value + recirculationValue);
+        //     float input = value + recirculationValue;
         //     float reverb = convolution.TickUnsynchronized(input);
         //     feedbackDelay.Put(reverb);
 
@@ -870,7 +868,6 @@ namespace LsNumerics
         // float TickUnsynchronizedWithoutFeedback(float value)
         // {
 
-        //     value  = Undenormalize(value);
         //     float reverb = convolution.TickUnsynchronized(value);
 
         //     return value * directMix + (reverb)*reverbMix;
@@ -936,11 +933,11 @@ namespace LsNumerics
                     {
                         float valueL = inputL[ix + i];
                         float recirculationValueL = feedbackDelay.Value() * feedbackScale;
-                        float inputL = Undenormalize(valueL + recirculationValueL);
+                        float inputL = valueL + recirculationValueL;
 
                         float valueR = inputR[ix + i];
                         float recirculationValueR = feedbackDelayRight.Value() * feedbackScale;
-                        float inputR = Undenormalize(valueR + recirculationValueR);
+                        float inputR = valueR + recirculationValueR;
 
                         float reverbL, reverbR;
                         convolution.TickUnsynchronized(inputL, 0, inputR, 0, &reverbL, &reverbR);
@@ -972,11 +969,11 @@ namespace LsNumerics
                         {
                             float valueL = inputL[ix + i];
                             float recirculationValueL = feedbackDelay.Value() * feedbackScale;
-                            float inputL = Undenormalize(valueL + recirculationValueL);
+                            float inputL = valueL + recirculationValueL;
 
                             float valueR = inputR[ix + i];
                             float recirculationValueR = feedbackDelayRight.Value() * feedbackScale;
-                            float inputR = Undenormalize(valueR + recirculationValueR);
+                            float inputR = valueR + recirculationValueR;
 
                             float reverbL, reverbR;
                             convolution.TickUnsynchronized(
@@ -1140,7 +1137,7 @@ namespace LsNumerics
                     {
                         float value = input[ix + i];
                         float recirculationValue = feedbackDelay.Value() * feedbackScale;
-                        float input = Undenormalize(value + recirculationValue);
+                        float input = value + recirculationValue;
 
                         float reverb = convolution.TickUnsynchronized(input, 0);
                         feedbackDelay.Put(reverb);
@@ -1166,7 +1163,7 @@ namespace LsNumerics
                         {
                             float value = input[ix + i];
                             float recirculationValue = feedbackDelay.Value() * feedbackScale;
-                            float input = Undenormalize(value + recirculationValue);
+                            float input = value + recirculationValue;
 
                             float reverb = convolution.TickUnsynchronized(input, convolution.assemblyInputBuffer[i]);
                             feedbackDelay.Put(reverb);
@@ -0,0 +1,85 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "CpuFeatures.hpp"
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+using namespace LsNumerics;
+
+// bit values from <asm/hwcap.h>, which isn't available on all distros.
+#if defined(__aarch64__)
+static constexpr unsigned long LS_HWCAP_ASIMDHP = 1UL << 10;
+static constexpr unsigned long LS_HWCAP_ASIMDDP = 1UL << 20;
+#endif
+
+static CpuFeatures DetectCpuFeatures()
+{
+    CpuFeatures result;
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    result.avx2 = __builtin_cpu_supports("avx2");
+    result.fma = __builtin_cpu_supports("fma");
+    result.avx512f = __builtin_cpu_supports("avx512f");
+#elif defined(__aarch64__) && defined(__linux__)
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    result.asimdDotProduct = (hwcap & LS_HWCAP_ASIMDDP) != 0;
+    result.asimdHalfPrecision = (hwcap & LS_HWCAP_ASIMDHP) != 0;
+#endif
+    return result;
+}
+
+const CpuFeatures &CpuFeatures::Get()
+{
+    static CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
+
+std::string CpuFeatures::ToString() const
+{
+    std::string result;
+    auto add = [&result](bool present, const char *name)
+    {
+        if (present)
+        {
+            if (!result.empty())
+            {
+                result += ' ';
+            }
+            result += name;
+        }
+    };
+    add(avx2, "avx2");
+    add(fma, "fma");
+    add(avx512f, "avx512f");
+    add(asimdDotProduct, "asimddp");
+    add(asimdHalfPrecision, "asimdhp");
+    if (result.empty())
+    {
+        result = "baseline";
+    }
+    return result;
+}
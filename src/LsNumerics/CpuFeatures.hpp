@@ -0,0 +1,81 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+/*
+    Runtime CPU feature detection, and function multi-versioning for hot DSP kernels.
+
+    Functions marked LS_KERNEL_CLONES are compiled several times with different
+    instruction-set targets; the dynamic loader picks the best version for the
+    running CPU (via an ifunc resolver) when the library is loaded. This lets a single
+    ToobAmp.so use AVX2/FMA or AVX-512 on x64, and dot-product/fp16 NEON extensions
+    on ARMv8.2+ processors, while still running on baseline processors.
+
+    Only use LS_KERNEL_CLONES on out-of-line, non-template functions. Callees
+    that should be specialized along with the kernel must be inlined into it.
+    Each call goes through the resolved function pointer and can't be inlined, so clone
+    functions that process a block, not helpers that are called once per sample.
+
+    Define LS_NO_KERNEL_CLONES to disable multi-versioning. Clones are also omitted when
+    the whole build already targets the corresponding extensions (e.g. -mcpu=cortex-a76).
+*/
+
+#if !defined(LS_NO_KERNEL_CLONES) && defined(__GNUC__) && !defined(__clang__) && defined(__linux__)
+#if defined(__x86_64__) && __GNUC__ >= 12 && !defined(__AVX2__)
+#define LS_KERNEL_CLONES __attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+#elif defined(__aarch64__) && __GNUC__ >= 14 && !defined(__ARM_FEATURE_DOTPROD)
+#define LS_KERNEL_CLONES __attribute__((target_clones("default", "dotprod+fp16")))
+#endif
+#endif
+
+#ifndef LS_KERNEL_CLONES
+#define LS_KERNEL_CLONES
+#endif
+
+#include <string>
+
+namespace LsNumerics
+{
+    struct CpuFeatures
+    {
+        // x64
+        bool avx2 = false;
+        bool fma = false;
+        bool avx512f = false;
+
+        // aarch64
+        bool asimdDotProduct = false; // ARMv8.2 SDOT/UDOT (Cortex-A75, A76 and later)
+        bool asimdHalfPrecision = false; // ARMv8.2 fp16 arithmetic.
+
+        /// @brief Features of the processor we are running on.
+        static const CpuFeatures &Get();
+
+        /// @brief True if the processor supports the ARMv8.2 extensions that ToobAmp-a76.so is compiled for.
+        bool IsArmV82OrBetter() const { return asimdDotProduct && asimdHalfPrecision; }
+
+        /// @brief A short list of detected features, for diagnostic output.
+        std::string ToString() const;
+    };
+}
@@ -0,0 +1,137 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "Decimator.hpp"
+#include "Oversampler.hpp"
+#include "../restrict.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace LsNumerics;
+
+Decimator::Stage::Stage(double transition, double attenuationDb)
+{
+    std::vector<double> evenTaps = Oversampler::DesignHalfbandFir(transition, attenuationDb);
+    taps.resize(evenTaps.size());
+    for (size_t i = 0; i < evenTaps.size(); ++i)
+    {
+        taps[i] = (float)evenTaps[i];
+    }
+    nTaps = 2 * taps.size() - 1;
+    history.resize(2 * nTaps);
+    Reset();
+}
+
+void Decimator::Stage::Reset()
+{
+    std::fill(history.begin(), history.end(), 0.0f);
+    head = 0;
+    odd = false;
+}
+
+size_t Decimator::Stage::Process(float *buffer, size_t n)
+{
+    // The filter is symmetric, so with w = the last nTaps samples (oldest first),
+    // y = sum(taps[j]*w[2j]) + 0.5*w[nTaps/2].
+    const float *restrict pTaps = taps.data();
+    const size_t nEven = taps.size();
+    const size_t center = nTaps / 2;
+    size_t nOut = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        float x = buffer[i];
+        history[head] = x;
+        history[head + nTaps] = x;
+        if (++head == nTaps)
+        {
+            head = 0;
+        }
+        odd = !odd;
+        if (!odd)
+        {
+            const float *restrict w = history.data() + head;
+            float sum = 0.5f * w[center];
+            for (size_t j = 0; j < nEven; ++j)
+            {
+                sum += pTaps[j] * w[2 * j];
+            }
+            buffer[nOut++] = sum;
+        }
+    }
+    return nOut;
+}
+
+void Decimator::Prepare(double sampleRate, double maxOutputRate, double passbandHz, double attenuationDb)
+{
+    if (passbandHz * 2 >= maxOutputRate)
+    {
+        throw std::invalid_argument("Decimator passband must be less than half the output rate.");
+    }
+    stages.clear();
+    factor = 1;
+    double rate = sampleRate;
+    while (rate > maxOutputRate)
+    {
+        // Only [0,passband] of the output has to be alias-free, so the stopband starts at
+        // (outputRate-passband) rather than at outputRate/2.
+        double transition = 0.5 - 2 * passbandHz / rate;
+        stages.emplace_back(transition, attenuationDb);
+        rate /= 2;
+        factor *= 2;
+    }
+    outputRate = rate;
+    buffer.resize(BLOCK_SIZE);
+    Reset();
+}
+
+void Decimator::Reset()
+{
+    for (auto &stage : stages)
+    {
+        stage.Reset();
+    }
+}
+
+size_t Decimator::Process(const float *input, size_t n, float *output)
+{
+    size_t nOut = 0;
+    while (n != 0)
+    {
+        size_t nBlock = std::min(n, BLOCK_SIZE);
+        float *p = buffer.data();
+        std::memcpy(p, input, nBlock * sizeof(float));
+        size_t nStage = nBlock;
+        for (auto &stage : stages)
+        {
+            nStage = stage.Process(p, nStage);
+        }
+        std::memcpy(output + nOut, p, nStage * sizeof(float));
+        nOut += nStage;
+
+        input += nBlock;
+        n -= nBlock;
+    }
+    return nOut;
+}
@@ -0,0 +1,82 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace LsNumerics
+{
+    // Power-of-two decimator for analysis paths (tuners, meters) that only need a narrow
+    // low-frequency band.
+    //
+    // Decimation is done as a cascade of 2:1 linear-phase half-band FIR stages. Each stage only
+    // has to keep its own stopband from folding into [0, passband] of the final output, so
+    // stages are short (typically 7 to 15 taps), and only every other output of each stage is
+    // computed. Realtime-safe after Prepare().
+    class Decimator
+    {
+    public:
+        // Not realtime-safe. Chooses the smallest power-of-two factor that brings sampleRate down
+        // to maxOutputRate or below, and protects [0,passbandHz] of the output from aliasing.
+        void Prepare(double sampleRate, double maxOutputRate, double passbandHz, double attenuationDb = 60);
+
+        size_t GetFactor() const { return factor; }
+        double GetOutputRate() const { return outputRate; }
+
+        // The number of output samples that n input samples can produce.
+        size_t GetMaxOutputSize(size_t n) const { return n / factor + 1; }
+
+        void Reset();
+
+        // Decimates n input samples, and returns the number of samples written to output.
+        // output must have room for GetMaxOutputSize(n) samples.
+        size_t Process(const float *input, size_t n, float *output);
+
+    private:
+        class Stage
+        {
+        public:
+            Stage(double transition, double attenuationDb);
+            void Reset();
+            // In place. Returns the number of output samples.
+            size_t Process(float *buffer, size_t n);
+
+        private:
+            std::vector<float> taps; // even-indexed taps.
+            std::vector<float> history; // doubled, so that the last nTaps samples are always contiguous.
+            size_t nTaps;
+            size_t head = 0;
+            bool odd = false;
+        };
+
+        static constexpr size_t BLOCK_SIZE = 256;
+
+        size_t factor = 1;
+        double outputRate = 0;
+        std::vector<Stage> stages;
+        std::vector<float> buffer;
+    };
+}
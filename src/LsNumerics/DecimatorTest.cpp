@@ -0,0 +1,168 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "Decimator.hpp"
+#include "LsMath.hpp"
+#include "../TestAssert.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace LsNumerics;
+
+static constexpr double MAX_OUTPUT_RATE = 6000;
+static constexpr double PASSBAND = 1200;
+
+static std::vector<float> Decimate(Decimator &decimator, const std::vector<float> &input, size_t blockSize)
+{
+    std::vector<float> result(decimator.GetMaxOutputSize(input.size()));
+    size_t nOut = 0;
+    for (size_t i = 0; i < input.size(); i += blockSize)
+    {
+        size_t n = std::min(blockSize, input.size() - i);
+        nOut += decimator.Process(input.data() + i, n, result.data() + nOut);
+    }
+    result.resize(nOut);
+    return result;
+}
+
+static std::vector<float> Tone(double frequency, double sampleRate, size_t n)
+{
+    std::vector<float> result(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        result[i] = (float)std::sin(2 * Pi * frequency * i / sampleRate);
+    }
+    return result;
+}
+
+// Amplitude of the component of signal at frequency, skipping the filter's settling time.
+static double Amplitude(const std::vector<float> &signal, double frequency, double sampleRate)
+{
+    size_t start = signal.size() / 4;
+    double sumSin = 0, sumCos = 0;
+    for (size_t i = start; i < signal.size(); ++i)
+    {
+        double w = 2 * Pi * frequency * i / sampleRate;
+        sumSin += signal[i] * std::sin(w);
+        sumCos += signal[i] * std::cos(w);
+    }
+    size_t n = signal.size() - start;
+    return 2 * std::sqrt(sumSin * sumSin + sumCos * sumCos) / n;
+}
+
+static void TestRate(double sampleRate)
+{
+    Decimator decimator;
+    decimator.Prepare(sampleRate, MAX_OUTPUT_RATE, PASSBAND);
+    double outputRate = decimator.GetOutputRate();
+    std::cout << "    " << sampleRate << " -> " << outputRate << " (x" << decimator.GetFactor() << ")" << std::endl;
+    TEST_ASSERT(outputRate <= MAX_OUTPUT_RATE);
+    TEST_ASSERT(outputRate * 2 > MAX_OUTPUT_RATE || decimator.GetFactor() == 1);
+
+    size_t n = (size_t)sampleRate;
+
+    // passband.
+    for (double f : {82.0, 440.0, 1100.0})
+    {
+        decimator.Reset();
+        std::vector<float> output = Decimate(decimator, Tone(f, sampleRate, n), 64);
+        double gain = Amplitude(output, f, outputRate);
+        TEST_ASSERT(std::abs(gain - 1) < 0.01);
+    }
+    // frequencies that would alias into the passband.
+    double worstDb = -200;
+    for (double f = outputRate - PASSBAND; f < sampleRate / 2; f += 97.3)
+    {
+        double alias = std::fmod(f, outputRate);
+        if (alias > outputRate / 2)
+            alias = outputRate - alias;
+        if (alias > PASSBAND)
+            continue;
+        decimator.Reset();
+        std::vector<float> output = Decimate(decimator, Tone(f, sampleRate, n / 4), 64);
+        double db = Af2Db(Amplitude(output, alias, outputRate));
+        worstDb = std::max(worstDb, db);
+    }
+    std::cout << "        worst alias: " << worstDb << "dB" << std::endl;
+    TEST_ASSERT(worstDb < -55);
+}
+
+static void TestBlockSizes()
+{
+    Decimator decimator;
+    decimator.Prepare(96000, MAX_OUTPUT_RATE, PASSBAND);
+    std::vector<float> input = Tone(440, 96000, 10000);
+    std::vector<float> expected = Decimate(decimator, input, input.size());
+    for (size_t blockSize : {1, 7, 15, 16, 17, 300, 1000})
+    {
+        decimator.Reset();
+        std::vector<float> output = Decimate(decimator, input, blockSize);
+        TEST_ASSERT(output.size() == expected.size());
+        for (size_t i = 0; i < output.size(); ++i)
+        {
+            TEST_ASSERT(output[i] == expected[i]);
+        }
+    }
+}
+
+static void Benchmark()
+{
+    Decimator decimator;
+    decimator.Prepare(96000, MAX_OUTPUT_RATE, PASSBAND);
+    std::vector<float> input = Tone(440, 96000, 96000);
+    std::vector<float> output(decimator.GetMaxOutputSize(128));
+
+    auto start = std::chrono::steady_clock::now();
+    size_t total = 0;
+    for (size_t i = 0; i + 128 <= input.size(); i += 128)
+    {
+        total += decimator.Process(input.data() + i, 128, output.data());
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "    1s of 96kHz audio: " << std::chrono::duration<double, std::milli>(elapsed).count() << "ms"
+              << " (" << total << " samples)" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::cout << "DecimatorTest" << std::endl;
+        for (double sampleRate : {22050.0, 44100.0, 48000.0, 88200.0, 96000.0, 192000.0})
+        {
+            TestRate(sampleRate);
+        }
+        TestBlockSizes();
+        Benchmark();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -6,6 +6,9 @@
 #include <iostream>
 #include <numbers>
 #include <random>
+#include <sstream>
+#include <filesystem>
+#include <optional>
 
 
 using namespace LsNumerics;
@@ -93,12 +96,113 @@ static void fftTest(FftType& fft)
 
 }
 
+static void realFftTest(size_t N)
+{
+    // half-spectra must match the first N/2+1 bins of the complex transform, in both directions.
+    StagedFft fft(N);
+    StagedRealFft realFft(N);
+    TEST_ASSERT(realFft.GetSpectrumSize() == N / 2 + 1);
+
+    static std::mt19937 randomDevice;
+    static std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+
+    std::vector<float> input(N);
+    std::vector<std::complex<double>> complexInput(N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        input[i] = distribution(randomDevice);
+        complexInput[i] = input[i];
+    }
+    std::vector<std::complex<double>> expected(N);
+    std::vector<std::complex<double>> halfSpectrum(N / 2 + 1);
+
+    for (auto direction : {StagedFft::Direction::Forward, StagedFft::Direction::Backward})
+    {
+        fft.Compute(complexInput, expected, direction);
+        realFft.Compute(input, halfSpectrum, direction);
+        for (size_t k = 0; k < halfSpectrum.size(); ++k)
+        {
+            TEST_ASSERT(std::abs(halfSpectrum[k] - expected[k]) < 1E-9);
+        }
+    }
+
+    // inverse of a half-spectrum matches the inverse of the full hermitian spectrum.
+    std::vector<std::complex<double>> spectrum(N);
+    fft.Forward(complexInput, spectrum);
+    realFft.Forward(input, halfSpectrum);
+    for (size_t k = 0; k < halfSpectrum.size(); ++k)
+    {
+        halfSpectrum[k] *= spectrum[k];
+    }
+    for (size_t k = 0; k < N; ++k)
+    {
+        spectrum[k] *= spectrum[k];
+    }
+    fft.Backward(spectrum, expected);
+    std::vector<double> output(N);
+    realFft.Backward(halfSpectrum, output);
+    for (size_t i = 0; i < N; ++i)
+    {
+        TEST_ASSERT(std::abs(output[i] - expected[i].real()) < 1E-9);
+    }
+
+    // round trip.
+    std::vector<float> roundTrip(N);
+    realFft.Forward(input, halfSpectrum);
+    realFft.Backward(halfSpectrum, roundTrip);
+    for (size_t i = 0; i < N; ++i)
+    {
+        TEST_ASSERT(std::abs(roundTrip[i] - input[i]) < 1E-6);
+    }
+}
+
 extern void TestFftShuffle();
 
+static void wisdomTest()
+{
+    // must run before any plans are created.
+    std::cout << "Wisdom" << std::endl;
+
+    constexpr size_t MAX_LOG2 = 13;
+    std::ostringstream log;
+    StagedFftWisdom::Measure(MAX_LOG2, &log);
+    // every candidate plan must produce the same result as a direct plan.
+    TEST_ASSERT(log.str().find("INVALID") == std::string::npos);
+
+    std::vector<std::optional<StagedFftWisdom::PlanChoice>> measured;
+    for (size_t log2Size = 0; log2Size <= MAX_LOG2; ++log2Size)
+    {
+        measured.push_back(StagedFftWisdom::GetPlanChoice(log2Size));
+    }
+    TEST_ASSERT(measured[MAX_LOG2].has_value());
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "FftTest.wisdom.txt";
+    StagedFftWisdom::Save(path);
+    StagedFftWisdom::Clear();
+    TEST_ASSERT(!StagedFftWisdom::GetPlanChoice(MAX_LOG2).has_value());
+    StagedFftWisdom::Load(path);
+    std::filesystem::remove(path);
+
+    for (size_t log2Size = 0; log2Size <= MAX_LOG2; ++log2Size)
+    {
+        TEST_ASSERT(StagedFftWisdom::GetPlanChoice(log2Size) == measured[log2Size]);
+    }
+    StagedFft fft(1 << MAX_LOG2);
+    fftTest<LsNumerics::StagedFft>(fft);
+}
+
 int main(int argc, const char**argv)
 {
     std::cout << "== FftTest ====" << std::endl;
 
+    try {
+        wisdomTest();
+    } catch (const std::exception&e)
+    {
+        std::cout << "FftTest failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
 
     {
         StagedFft stagedFft(64*1024);
@@ -114,6 +218,11 @@ int main(int argc, const char**argv)
 
         Fft fft(n);
         fftTest<Fft>(fft);
+
+        if (n >= 4)
+        {
+            realFftTest(n);
+        }
     }
     } catch (const std::exception&e)
     {
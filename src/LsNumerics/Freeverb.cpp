@@ -52,7 +52,10 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 /***********************************************************************/
 
 #include "Freeverb.hpp"
+#include "LsMath.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 
 using namespace LsNumerics;
@@ -122,6 +125,7 @@ void Freeverb::Init(StkFloat sampleRate)
     allPassDelayR_[i].setMaximumDelay(m_aDelayLengths[i] + stereoSpread);
     allPassDelayR_[i].setDelay(m_aDelayLengths[i] + stereoSpread);
   }
+  InitBlockProcessing();
 }
 
 Freeverb::~Freeverb()
@@ -237,6 +241,7 @@ void Freeverb::clear()
     allPassDelayL_[i].clear();
     allPassDelayR_[i].clear();
   }
+  ClearBlockProcessing();
 }
 
 void Freeverb::setTails(bool value)
@@ -244,4 +249,185 @@ void Freeverb::setTails(bool value)
     this->tails_ = value;
 }
 
+void Freeverb::InitBlockProcessing()
+{
+  size_t maxCombDelay = 0;
+  for (int i = 0; i < nCombs; i++)
+  {
+    combLaneDelays[i] = (size_t)std::max(1, m_cDelayLengths[i]);
+    combLaneDelays[i + nCombs] = (size_t)std::max(1, m_cDelayLengths[i] + stereoSpread);
+    maxCombDelay = std::max(maxCombDelay, combLaneDelays[i + nCombs]);
+  }
+  size_t combFrames = NextPowerOfTwo((uint32_t)(maxCombDelay + 1));
+  combBufferMask = combFrames - 1;
+  combBuffer.resize(combFrames * nCombLanes);
+
+  blockSize = MAX_BLOCK_SIZE;
+  for (int i = 0; i < nAllpasses; i++)
+  {
+    blockAllpassL_[i].delay = (size_t)std::max(1, m_aDelayLengths[i]);
+    blockAllpassR_[i].delay = (size_t)std::max(1, m_aDelayLengths[i] + stereoSpread);
+    for (BlockAllpass *allpass : {&blockAllpassL_[i], &blockAllpassR_[i]})
+    {
+      size_t size = NextPowerOfTwo((uint32_t)(allpass->delay + 1));
+      allpass->mask = size - 1;
+      allpass->buffer.resize(size);
+    }
+    blockSize = std::min(blockSize, blockAllpassL_[i].delay);
+  }
+  ClearBlockProcessing();
+}
+
+void Freeverb::ClearBlockProcessing()
+{
+  std::fill(combBuffer.begin(), combBuffer.end(), 0.0f);
+  std::fill(std::begin(combLaneState), std::end(combLaneState), 0.0f);
+  combBufferIndex = 0;
+  for (int i = 0; i < nAllpasses; i++)
+  {
+    std::fill(blockAllpassL_[i].buffer.begin(), blockAllpassL_[i].buffer.end(), 0.0f);
+    std::fill(blockAllpassR_[i].buffer.begin(), blockAllpassR_[i].buffer.end(), 0.0f);
+  }
+  allpassIndex = 0;
+}
 
+namespace
+{
+  typedef float v8sf __attribute__((vector_size(32)));
+
+  inline v8sf Load8(const float *p)
+  {
+    v8sf result;
+    std::memcpy(&result, p, sizeof(result));
+    return result;
+  }
+
+  // Copy n samples from/to a power-of-two ring buffer, starting at (unmasked) position index.
+  void ReadRing(const std::vector<float> &buffer, size_t mask, size_t index, float *output, size_t n)
+  {
+    size_t start = index & mask;
+    size_t n0 = std::min(n, mask + 1 - start);
+    std::memcpy(output, buffer.data() + start, n0 * sizeof(float));
+    std::memcpy(output + n0, buffer.data(), (n - n0) * sizeof(float));
+  }
+  void WriteRing(std::vector<float> &buffer, size_t mask, size_t index, const float *input, size_t n)
+  {
+    size_t start = index & mask;
+    size_t n0 = std::min(n, mask + 1 - start);
+    std::memcpy(buffer.data() + start, input, n0 * sizeof(float));
+    std::memcpy(buffer.data(), input + n0, (n - n0) * sizeof(float));
+  }
+}
+
+void Freeverb::Process(
+    const float *inputL, const float *inputR,
+    float *outputL, float *outputR,
+    size_t n)
+{
+  // same coefficient roundings as OnePole::setCoefficients(1.0 - damp_, -damp_).
+  const float b0 = (float)(1.0 - damp_);
+  const float a1 = -damp_;
+  const float roomSize = roomSize_;
+  const float g = g_;
+  const float gPlusOne = (float)(1.0 + g_);
+
+  v8sf stateL = Load8(combLaneState);
+  v8sf stateR = Load8(combLaneState + nCombs);
+
+  float bypassLevels[MAX_BLOCK_SIZE];
+  float outL[MAX_BLOCK_SIZE];
+  float outR[MAX_BLOCK_SIZE];
+  float vm[MAX_BLOCK_SIZE];
+
+  while (n != 0)
+  {
+    size_t m = std::min(n, blockSize);
+
+    // Parallel LBCF filters.
+    float *buffer = combBuffer.data();
+    for (size_t j = 0; j < m; ++j)
+    {
+      float bypassLevel = bypassDezipper.Tick();
+      bypassLevels[j] = bypassLevel;
+
+      float fInput = (inputL[j] + inputR[j]) * gain_;
+      if (tails_)
+      {
+        fInput *= bypassLevel;
+      }
+      const float *frame = buffer + (combBufferIndex & combBufferMask) * nCombLanes;
+      stateL = b0 * Load8(frame) - a1 * stateL;
+      stateR = b0 * Load8(frame + nCombs) - a1 * stateR;
+      v8sf ynL = fInput + roomSize * stateL;
+      v8sf ynR = fInput + roomSize * stateR;
+
+      float sumL = 0;
+      float sumR = 0;
+      for (int i = 0; i < nCombs; ++i)
+      {
+        buffer[((combBufferIndex + combLaneDelays[i]) & combBufferMask) * nCombLanes + i] = ynL[i];
+        buffer[((combBufferIndex + combLaneDelays[i + nCombs]) & combBufferMask) * nCombLanes + i + nCombs] = ynR[i];
+        sumL += ynL[i];
+        sumR += ynR[i];
+      }
+      outL[j] = sumL;
+      outR[j] = sumR;
+      ++combBufferIndex;
+    }
+
+    // Series allpass filters. m <= the allpass delay, so the whole sub-block's delayed
+    // values are already in the buffer, and each stage vectorizes across time.
+    for (int i = 0; i < nAllpasses; ++i)
+    {
+      for (int channel = 0; channel < 2; ++channel)
+      {
+        BlockAllpass &allpass = channel == 0 ? blockAllpassL_[i] : blockAllpassR_[i];
+        float *out = channel == 0 ? outL : outR;
+        ReadRing(allpass.buffer, allpass.mask, allpassIndex - allpass.delay, vm, m);
+        for (size_t j = 0; j < m; ++j)
+        {
+          float vn = out[j] + g * vm[j];
+          out[j] = -vn + gPlusOne * vm[j];
+          vm[j] = vn;
+        }
+        WriteRing(allpass.buffer, allpass.mask, allpassIndex, vm, m);
+      }
+    }
+    allpassIndex += m;
+
+    // Mix output
+    if (tails_)
+    {
+      for (size_t j = 0; j < m; ++j)
+      {
+        float bypassLevel = bypassLevels[j];
+        float effectiveDry = (1.0f - bypassLevel) * 1.0f + (bypassLevel)*dry_;
+        float l = outL[j];
+        float r = outR[j];
+        outputL[j] = l * wet1_ + r * wet2_ + inputL[j] * effectiveDry;
+        outputR[j] = r * wet1_ + l * wet2_ + inputR[j] * effectiveDry;
+      }
+    }
+    else
+    {
+      for (size_t j = 0; j < m; ++j)
+      {
+        float l = outL[j];
+        float r = outR[j];
+        float effectLeft = l * wet1_ + r * wet2_ + inputL[j] * dry_;
+        float effectRight = r * wet1_ + l * wet2_ + inputR[j] * dry_;
+        float wet = bypassLevels[j];
+        float dry = 1.0f - wet;
+        outputL[j] = dry * inputL[j] + wet * effectLeft;
+        outputR[j] = dry * inputR[j] + wet * effectRight;
+      }
+    }
+    inputL += m;
+    inputR += m;
+    outputL += m;
+    outputR += m;
+    n -= m;
+  }
+  std::memcpy(combLaneState, &stateL, sizeof(stateL));
+  std::memcpy(combLaneState + nCombs, &stateR, sizeof(stateR));
+}
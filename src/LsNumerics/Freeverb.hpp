@@ -343,6 +343,17 @@ namespace LsNumerics
             StkFloat inputL, StkFloat inputR,
             StkFloat *pOutL, StkFloat *pOutR);
 
+        //! Process a block of samples.
+        /*!
+          Same tuning and output as calling tick() on each sample (to within float rounding), 
+          but the eight combs of each channel run in parallel SIMD lanes. tick() and Process()
+          keep separate delay lines, so use one or the other on any given instance.
+        */
+        void Process(
+            const float *inputL, const float *inputR,
+            float *outputL, float *outputR,
+            size_t n);
+
     protected:
         //! Update interdependent parameters.
         void update(void);
@@ -391,6 +402,35 @@ namespace LsNumerics
         Delay allPassDelayL_[nAllpasses];
         Delay allPassDelayR_[nAllpasses];
 
+        // Block processing state.
+        //
+        // Comb lanes 0..7 are the left combs, lanes 8..15 the right combs. All 16 delay lines 
+        // share one interleaved buffer of 16-float frames: lane i's output for time t is written
+        // to frame t+delay[i], so the comb inputs for time t are the single contiguous frame t.
+        // Allpasses run a sub-block at a time, which requires blockSize <= the shortest allpass delay.
+        static constexpr size_t MAX_BLOCK_SIZE = 64;
+        static constexpr size_t nCombLanes = 2 * nCombs;
+
+        void InitBlockProcessing();
+        void ClearBlockProcessing();
+
+        size_t blockSize = MAX_BLOCK_SIZE;
+        std::vector<float> combBuffer;
+        size_t combBufferMask = 0;
+        size_t combBufferIndex = 0;
+        size_t combLaneDelays[nCombLanes];
+        float combLaneState[nCombLanes];
+
+        struct BlockAllpass
+        {
+            std::vector<float> buffer;
+            size_t mask = 0;
+            size_t delay = 0;
+        };
+        BlockAllpass blockAllpassL_[nAllpasses];
+        BlockAllpass blockAllpassR_[nAllpasses];
+        size_t allpassIndex = 0;
+
         bool tailProcesing = true;
         bool enabled = true;
 
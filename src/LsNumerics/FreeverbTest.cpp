@@ -0,0 +1,174 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "Freeverb.hpp"
+#include "../TestAssert.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace LsNumerics;
+
+static void MakeInput(std::vector<float> &left, std::vector<float> &right, size_t n)
+{
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+    left.resize(n);
+    right.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        // noise bursts, so the test covers both excitation and decaying tails.
+        bool on = (i / 4096) % 3 == 0;
+        left[i] = on ? distribution(random) : 0;
+        right[i] = on ? distribution(random) : 0;
+    }
+}
+
+static void SetPreset(Freeverb &freeverb, bool tails)
+{
+    freeverb.setEffectMix(0.3);
+    freeverb.setRoomSize(0.8);
+    freeverb.setDamping(0.35);
+    freeverb.setTails(tails);
+    freeverb.setBypass(true, true);
+}
+
+static void TestBlockMatchesTick()
+{
+    for (double sampleRate : {22050.0, 44100.0, 48000.0, 96000.0})
+    {
+        for (bool tails : {true, false})
+        {
+            Freeverb reference(sampleRate);
+            Freeverb block(sampleRate);
+            SetPreset(reference, tails);
+            SetPreset(block, tails);
+
+            constexpr size_t N = 48000;
+            std::vector<float> inL, inR;
+            MakeInput(inL, inR, N);
+            std::vector<float> refL(N), refR(N), outL(N), outR(N);
+
+            // toggle bypass mid-stream to exercise the dezipper.
+            size_t bypassOff = N / 2;
+            size_t bypassOn = N * 3 / 4;
+            for (size_t i = 0; i < N; ++i)
+            {
+                if (i == bypassOff || i == bypassOn)
+                {
+                    reference.setBypass(i == bypassOn, false);
+                }
+                reference.tick(inL[i], inR[i], &refL[i], &refR[i]);
+            }
+            // ragged block sizes.
+            size_t blockSizes[] = {1, 17, 64, 256, 1000, 37};
+            size_t position = 0;
+            size_t b = 0;
+            while (position < N)
+            {
+                size_t n = std::min(blockSizes[b++ % std::size(blockSizes)], N - position);
+                if (position < bypassOff && position + n > bypassOff)
+                {
+                    n = bypassOff - position;
+                }
+                if (position < bypassOn && position + n > bypassOn)
+                {
+                    n = bypassOn - position;
+                }
+                if (position == bypassOff || position == bypassOn)
+                {
+                    block.setBypass(position == bypassOn, false);
+                }
+                block.Process(inL.data() + position, inR.data() + position, outL.data() + position, outR.data() + position, n);
+                position += n;
+            }
+
+            double maxError = 0;
+            double maxValue = 0;
+            for (size_t i = 0; i < N; ++i)
+            {
+                maxError = std::max(maxError, (double)std::abs(refL[i] - outL[i]));
+                maxError = std::max(maxError, (double)std::abs(refR[i] - outR[i]));
+                maxValue = std::max(maxValue, (double)std::abs(refL[i]));
+            }
+            std::cout << "    " << sampleRate << " tails=" << tails
+                      << " max error: " << maxError << " (peak " << maxValue << ")" << std::endl;
+            TEST_ASSERT(maxValue > 0.01);
+            TEST_ASSERT(maxError < 1E-5);
+        }
+    }
+}
+
+static void BenchmarkFreeverb()
+{
+    constexpr double SAMPLE_RATE = 48000;
+    constexpr size_t FRAME_SIZE = 64;
+    constexpr size_t N = 48000 * 10;
+    std::vector<float> inL, inR;
+    MakeInput(inL, inR, N);
+    std::vector<float> outL(N), outR(N);
+
+    Freeverb reference(SAMPLE_RATE);
+    SetPreset(reference, true);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < N; ++i)
+    {
+        reference.tick(inL[i], inR[i], &outL[i], &outR[i]);
+    }
+    auto tickTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    Freeverb block(SAMPLE_RATE);
+    SetPreset(block, true);
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < N; i += FRAME_SIZE)
+    {
+        block.Process(inL.data() + i, inR.data() + i, outL.data() + i, outR.data() + i, FRAME_SIZE);
+    }
+    auto blockTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    double audioTime = N / SAMPLE_RATE;
+    std::cout << "    tick():    " << (tickTime / audioTime * 100) << "% of one core" << std::endl;
+    std::cout << "    Process(): " << (blockTime / audioTime * 100) << "% of one core" << std::endl;
+    std::cout << "    speedup:   " << (tickTime / blockTime) << "x" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::cout << "TestBlockMatchesTick" << std::endl;
+        TestBlockMatchesTick();
+        std::cout << "BenchmarkFreeverb" << std::endl;
+        BenchmarkFreeverb();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
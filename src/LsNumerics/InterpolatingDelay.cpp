@@ -22,6 +22,7 @@
  */
 
 #include "InterpolatingDelay.hpp"
+#include <algorithm>
 
 using namespace LsNumerics;
 
@@ -35,7 +36,7 @@ InterpolatingDelay::InterpolatingDelay(uint32_t maxDelay)
 
 void InterpolatingDelay::SetMaxDelay(uint32_t maxDelay)
 {
-    uint32_t size = LsNumerics::NextPowerOfTwo(maxDelay + 2); // +one for the interpolator, +one to prevent wrapping.
+    uint32_t size = LsNumerics::NextPowerOfTwo(maxDelay + 3); // +two for the interpolators, +one to prevent wrapping.
     delayLine.resize(size);
     indexMask = size - 1;
     Clear();
@@ -49,3 +50,36 @@ void InterpolatingDelay::Clear()
         delayLine[i] = 0;
     }
 }
+
+// Put() writes at descending addresses, so both block operations walk each of 
+// their (at most two) contiguous segments backwards.
+void InterpolatingDelay::Write(const float *input, size_t n)
+{
+    float *p = delayLine.data();
+    size_t start = (delayIndex - 1) & indexMask;
+    size_t n0 = std::min(n, start + 1);
+    for (size_t i = 0; i < n0; ++i)
+    {
+        p[start - i] = input[i];
+    }
+    for (size_t i = n0; i < n; ++i)
+    {
+        p[indexMask - (i - n0)] = input[i];
+    }
+    delayIndex = (uint32_t)((delayIndex - n) & indexMask);
+}
+
+void InterpolatingDelay::Read(uint32_t index, float *output, size_t n) const
+{
+    const float *p = delayLine.data();
+    size_t start = (delayIndex + index) & indexMask;
+    size_t n0 = std::min(n, start + 1);
+    for (size_t i = 0; i < n0; ++i)
+    {
+        output[i] = p[start - i];
+    }
+    for (size_t i = n0; i < n; ++i)
+    {
+        output[i] = p[indexMask - (i - n0)];
+    }
+}
@@ -61,6 +61,41 @@ namespace LsNumerics
             return (float)(v0*(1-frac)+v1*frac);
         }
 
+        // Third-order Lagrange interpolation between Get(floor(index)-1) .. Get(floor(index)+2).
+        // Smoother than linear interpolation under modulation. Requires index >= 1.
+        float GetLagrange(float index) const {
+            uint32_t iIndex = (uint32_t)index;
+            float f = index-iIndex;
+            float xm1 = Get(iIndex-1);
+            float x0 = Get(iIndex);
+            float x1 = Get(iIndex+1);
+            float x2 = Get(iIndex+2);
+            float fp1 = f+1, fm1 = f-1, fm2 = f-2;
+            return 
+                -f*fm1*fm2*(1.0f/6)*xm1
+                + fp1*fm1*fm2*0.5f*x0
+                - fp1*f*fm2*0.5f*x1
+                + fp1*f*fm1*(1.0f/6)*x2;
+        }
+
+        // Block equivalent of calling Put(input[i]) for i in [0,n).
+        void Write(const float *input, size_t n);
+
+        // Block read of a fixed delay: output[i] is the value Get(index) would return 
+        // after the first i of the next n Put() calls. Requires n <= index+1, so that 
+        // no output depends on a value that hasn't been written yet.
+        void Read(uint32_t index, float *output, size_t n) const;
+
+        // Block read of a modulated delay: output[i] is the value Get(index[i]) would return 
+        // after the first i of the next n Put() calls. Requires index[i] >= i.
+        void Read(const double *index, float *output, size_t n) const
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                output[i] = Get(index[i] - i);
+            }
+        }
+
     private:
         uint32_t delayIndex = 0;
         uint32_t indexMask = 0;
@@ -0,0 +1,108 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "InterpolatingDelay.hpp"
+#include "LsMath.hpp"
+#include "../TestAssert.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace LsNumerics;
+
+static void TestBlockReadWrite()
+{
+    // Block Read()/Write() must match Get()/Put() sample for sample, including across the wrap point.
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+
+    for (uint32_t delay : {1u, 7u, 100u, 1000u})
+    {
+        InterpolatingDelay reference(1000);
+        InterpolatingDelay block(1000);
+        size_t blockSizes[] = {1, 5, 64, 128, 3};
+        size_t b = 0;
+        for (size_t iteration = 0; iteration < 200; ++iteration)
+        {
+            size_t n = std::min(blockSizes[b++ % std::size(blockSizes)], (size_t)delay + 1);
+            std::vector<float> input(n), expected(n), actual(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                input[i] = distribution(random);
+                expected[i] = reference.Get(delay);
+                reference.Put(input[i]);
+            }
+            block.Read(delay, actual.data(), n);
+            block.Write(input.data(), n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                TEST_ASSERT(actual[i] == expected[i]);
+            }
+        }
+    }
+}
+
+static void TestLagrange()
+{
+    // A slow sine, read at fractional delays: third-order interpolation should be near exact,
+    // and exact at integer delays.
+    InterpolatingDelay delay(100);
+    const double f = 0.02;
+    for (size_t i = 0; i < 200; ++i)
+    {
+        delay.Put((float)std::sin(2 * Pi * f * i));
+    }
+    double maxError = 0;
+    for (float index = 1; index < 90; index += 0.13f)
+    {
+        double expected = std::sin(2 * Pi * f * (199 - (double)index));
+        maxError = std::max(maxError, std::abs(delay.GetLagrange(index) - expected));
+    }
+    std::cout << "    GetLagrange max error: " << maxError << std::endl;
+    TEST_ASSERT(maxError < 1E-4);
+
+    for (uint32_t index = 1; index < 90; ++index)
+    {
+        TEST_ASSERT(delay.GetLagrange((float)index) == delay.Get(index));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::cout << "TestBlockReadWrite" << std::endl;
+        TestBlockReadWrite();
+        std::cout << "TestLagrange" << std::endl;
+        TestLagrange();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -119,6 +119,11 @@ namespace LsNumerics
             return result;
         }
 
+        double GetMinX() const { return minX; }
+        double GetMaxX() const { return maxX; }
+        // Polynomial in u, where u runs from -1 at minX to 1 at maxX.
+        const Polynomial &GetPolynomial() const { return polynomial; }
+
         double At(double x) const
         {
             double u = XtoU(x);
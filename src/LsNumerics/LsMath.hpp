@@ -71,15 +71,6 @@ namespace LsNumerics {
 	
 	uint32_t NextPowerOfTwo(uint32_t value);
 
-	inline double Undenormalize(double value)
-	{
-		return 1E-18 +value+ 1E-18;
-	}
-	inline float Undenormalize(float value)
-	{
-		return 1E-6f +value+ 1E-6f;
-	}
-
 	constexpr int MIDI_A440_NOTE = 69;
 
 	inline double FrequencyToMidiNote(double frequency, double aReference = 440.0)
@@ -0,0 +1,284 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+
+#ifndef RESTRICT
+#define RESTRICT __restrict
+#endif
+
+/*
+    Block mixing kernels for the looper, player and recorder plugins.
+
+    Gains are expressed as linear ramps (g0 + dg*i) rather than as per-sample 
+    ControlDezipper::Tick() calls, so that the loop bodies carry no dependencies 
+    between samples. The 4-lane bodies use GCC/Clang vector extensions, which map onto NEON
+    on aarch64 and SSE on x64; the scalar tails handle the remaining 0..3 samples.
+
+    Ramps follow ControlDezipper::Tick() conventions: sample i of a block gets gain g0 + dg*i.
+*/
+
+namespace LsNumerics::MixKernels
+{
+    namespace detail
+    {
+        typedef float v4sf __attribute__((vector_size(16)));
+
+        inline v4sf Load(const float *p)
+        {
+            v4sf result;
+            std::memcpy(&result, p, sizeof(result));
+            return result;
+        }
+        inline void Store(float *p, v4sf v)
+        {
+            std::memcpy(p, &v, sizeof(v));
+        }
+        inline v4sf Broadcast(float v)
+        {
+            return v4sf{v, v, v, v};
+        }
+        inline v4sf RampStart(float g0, float dg)
+        {
+            return v4sf{g0, g0 + dg, g0 + 2 * dg, g0 + 3 * dg};
+        }
+    }
+
+    inline void Zero(float *dst, size_t n)
+    {
+        std::memset(dst, 0, n * sizeof(float));
+    }
+
+    // dst and src may be the same buffer (lv2 hosts are allowed to process in place).
+    inline void Copy(float *dst, const float *src, size_t n)
+    {
+        if (dst != src)
+        {
+            std::memcpy(dst, src, n * sizeof(float));
+        }
+    }
+
+    // dst[i] *= gain
+    inline void Scale(float *dst, float gain, size_t n)
+    {
+        using namespace detail;
+        size_t i = 0;
+        v4sf g = Broadcast(gain);
+        for (; i + 4 <= n; i += 4)
+        {
+            Store(dst + i, Load(dst + i) * g);
+        }
+        for (; i < n; ++i)
+        {
+            dst[i] *= gain;
+        }
+    }
+
+    // dst[i] = src[i]*gain. dst may be the same buffer as src.
+    inline void Gain(float *dst, const float *src, float gain, size_t n)
+    {
+        using namespace detail;
+        size_t i = 0;
+        v4sf g = Broadcast(gain);
+        for (; i + 4 <= n; i += 4)
+        {
+            Store(dst + i, Load(src + i) * g);
+        }
+        for (; i < n; ++i)
+        {
+            dst[i] = src[i] * gain;
+        }
+    }
+
+    // dst[i] *= g0 + dg*i
+    inline void ScaleRamp(float *dst, float g0, float dg, size_t n)
+    {
+        using namespace detail;
+        size_t i = 0;
+        v4sf g = RampStart(g0, dg);
+        v4sf dg4 = Broadcast(dg * 4);
+        for (; i + 4 <= n; i += 4)
+        {
+            Store(dst + i, Load(dst + i) * g);
+            g += dg4;
+        }
+        for (; i < n; ++i)
+        {
+            dst[i] *= g0 + dg * i;
+        }
+    }
+
+    // dst[i] = src[i] * (g0 + dg*i). dst may be the same buffer as src.
+    inline void GainRamp(float *dst, const float *src, float g0, float dg, size_t n)
+    {
+        using namespace detail;
+        size_t i = 0;
+        v4sf g = RampStart(g0, dg);
+        v4sf dg4 = Broadcast(dg * 4);
+        for (; i + 4 <= n; i += 4)
+        {
+            Store(dst + i, Load(src + i) * g);
+            g += dg4;
+        }
+        for (; i < n; ++i)
+        {
+            dst[i] = src[i] * (g0 + dg * i);
+        }
+    }
+
+    // dst[i] += src[i]*gain
+    inline void MixAccumulate(float *RESTRICT dst, const float *RESTRICT src, float gain, size_t n)
+    {
+        using namespace detail;
+        size_t i = 0;
+        v4sf g = Broadcast(gain);
+        for (; i + 4 <= n; i += 4)
+        {
+            Store(dst + i, Load(dst + i) + Load(src + i) * g);
+        }
+        for (; i < n; ++i)
+        {
+            dst[i] += src[i] * gain;
+        }
+    }
+
+    // dst[i] += src[i] * (g0 + dg*i)
+    inline void MixAccumulateRamp(float *RESTRICT dst, const float *RESTRICT src, float g0, float dg, size_t n)
+    {
+        using namespace detail;
+        size_t i = 0;
+        v4sf g = RampStart(g0, dg);
+        v4sf dg4 = Broadcast(dg * 4);
+        for (; i + 4 <= n; i += 4)
+        {
+            Store(dst + i, Load(dst + i) + Load(src + i) * g);
+            g += dg4;
+        }
+        for (; i < n; ++i)
+        {
+            dst[i] += src[i] * (g0 + dg * i);
+        }
+    }
+
+    // dst[i] = from[i]*(1-t) + to[i]*t, where t = t0 + dt*i.
+    // Use for correlated material (e.g. blending across a loop point in the same file).
+    inline void LinearCrossfade(
+        float *RESTRICT dst,
+        const float *RESTRICT from, const float *RESTRICT to,
+        float t0, float dt, size_t n)
+    {
+        using namespace detail;
+        size_t i = 0;
+        v4sf t = RampStart(t0, dt);
+        v4sf dt4 = Broadcast(dt * 4);
+        v4sf one = Broadcast(1.0f);
+        for (; i + 4 <= n; i += 4)
+        {
+            Store(dst + i, Load(from + i) * (one - t) + Load(to + i) * t);
+            t += dt4;
+        }
+        for (; i < n; ++i)
+        {
+            float tt = t0 + dt * i;
+            dst[i] = from[i] * (1.0f - tt) + to[i] * tt;
+        }
+    }
+
+    // dst[i] = from[i]*sqrt(1-t) + to[i]*sqrt(t), where t = t0 + dt*i.
+    // Constant-power crossfade for uncorrelated material.
+    inline void EqualPowerCrossfade(
+        float *RESTRICT dst,
+        const float *RESTRICT from, const float *RESTRICT to,
+        float t0, float dt, size_t n)
+    {
+        using namespace detail;
+        size_t i = 0;
+        v4sf t = RampStart(t0, dt);
+        v4sf dt4 = Broadcast(dt * 4);
+        v4sf one = Broadcast(1.0f);
+        for (; i + 4 <= n; i += 4)
+        {
+            v4sf tFrom = one - t;
+            v4sf gFrom, gTo;
+            // vector extensions don't provide sqrt, so compute the gains per lane.
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                gFrom[lane] = std::sqrt(tFrom[lane]);
+                gTo[lane] = std::sqrt(t[lane]);
+            }
+            Store(dst + i, Load(from + i) * gFrom + Load(to + i) * gTo);
+            t += dt4;
+        }
+        for (; i < n; ++i)
+        {
+            float tt = t0 + dt * i;
+            dst[i] = from[i] * std::sqrt(1.0f - tt) + to[i] * std::sqrt(tt);
+        }
+    }
+
+    // Stereo pan with independently ramped left and right gains.
+    // dstL[i] += srcL[i]*(gL0 + dgL*i); dstR[i] += srcR[i]*(gR0 + dgR*i)
+    inline void StereoPanRampAccumulate(
+        float *RESTRICT dstL, float *RESTRICT dstR,
+        const float *RESTRICT srcL, const float *RESTRICT srcR,
+        float gL0, float dgL,
+        float gR0, float dgR,
+        size_t n)
+    {
+        using namespace detail;
+        size_t i = 0;
+        v4sf gL = RampStart(gL0, dgL);
+        v4sf gR = RampStart(gR0, dgR);
+        v4sf dgL4 = Broadcast(dgL * 4);
+        v4sf dgR4 = Broadcast(dgR * 4);
+        for (; i + 4 <= n; i += 4)
+        {
+            Store(dstL + i, Load(dstL + i) + Load(srcL + i) * gL);
+            Store(dstR + i, Load(dstR + i) + Load(srcR + i) * gR);
+            gL += dgL4;
+            gR += dgR4;
+        }
+        for (; i < n; ++i)
+        {
+            dstL[i] += srcL[i] * (gL0 + dgL * i);
+            dstR[i] += srcR[i] * (gR0 + dgR * i);
+        }
+    }
+
+    // dstL[i] = srcL[i]*(gL0 + dgL*i); dstR[i] = srcR[i]*(gR0 + dgR*i). May be used in place.
+    inline void StereoPanRamp(
+        float *dstL, float *dstR,
+        const float *srcL, const float *srcR,
+        float gL0, float dgL,
+        float gR0, float dgR,
+        size_t n)
+    {
+        GainRamp(dstL, srcL, gL0, dgL, n);
+        GainRamp(dstR, srcR, gR0, dgR, n);
+    }
+
+}
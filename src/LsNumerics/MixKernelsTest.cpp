@@ -0,0 +1,266 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+#include "MixKernels.hpp"
+#include "../ControlDezipper.h"
+#include "../TestAssert.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+using namespace LsNumerics;
+using namespace toob;
+using namespace std;
+
+static constexpr size_t LOOPS = 4;
+static constexpr size_t BLOCK_SIZE = 32;
+static constexpr double SAMPLE_RATE = 48000;
+
+static void TestRamp(size_t n)
+{
+    // ControlDezipper block ramps must match a sample-at-a-time Tick().
+    ControlDezipper a, b;
+    a.SetSampleRate(SAMPLE_RATE);
+    b.SetSampleRate(SAMPLE_RATE);
+    a.To(1.0f, 0.001f);
+    b.To(1.0f, 0.001f);
+
+    std::vector<float> src(n * 4), expected(n * 4), actual(n * 4);
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = std::sin(i * 0.01);
+    }
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        expected[i] = src[i] * a.Tick();
+    }
+    for (size_t i = 0; i < src.size(); /**/)
+    {
+        size_t m = b.RampLength(std::min(n, src.size() - i));
+        MixKernels::GainRamp(actual.data() + i, src.data() + i, b.RampStart(), b.RampDx(), m);
+        b.Skip(m);
+        i += m;
+    }
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        TEST_ASSERT(std::abs(expected[i] - actual[i]) < 1E-5);
+    }
+}
+
+static void TestCrossfades()
+{
+    constexpr size_t N = 37;
+    std::vector<float> from(N, 1.0f), to(N, -1.0f), out(N);
+    float dt = 1.0f / (N - 1);
+
+    MixKernels::LinearCrossfade(out.data(), from.data(), to.data(), 0.0f, dt, N);
+    TEST_ASSERT(std::abs(out[0] - 1.0f) < 1E-6);
+    TEST_ASSERT(std::abs(out[N - 1] + 1.0f) < 1E-5);
+    TEST_ASSERT(std::abs(out[N / 2]) < 1E-5);
+
+    // equal power: gains sum to unit power at every point.
+    std::vector<float> ones(N, 1.0f), zeros(N, 0.0f), gFrom(N), gTo(N);
+    MixKernels::EqualPowerCrossfade(gFrom.data(), ones.data(), zeros.data(), 0.0f, dt, N);
+    MixKernels::EqualPowerCrossfade(gTo.data(), zeros.data(), ones.data(), 0.0f, dt, N);
+    for (size_t i = 0; i < N; ++i)
+    {
+        TEST_ASSERT(std::abs(gFrom[i] * gFrom[i] + gTo[i] * gTo[i] - 1.0f) < 1E-5);
+    }
+}
+
+struct LoopSim
+{
+    std::vector<float> left, right;
+    ControlDezipper playLevel, recordLevel;
+    size_t cursor = 0;
+};
+
+static void InitLoops(std::vector<LoopSim> &loops)
+{
+    loops.resize(LOOPS);
+    for (size_t l = 0; l < LOOPS; ++l)
+    {
+        auto &loop = loops[l];
+        size_t length = (size_t)(SAMPLE_RATE * (2.0 + l * 0.37));
+        loop.left.resize(length);
+        loop.right.resize(length);
+        for (size_t i = 0; i < length; ++i)
+        {
+            loop.left[i] = std::sin(i * 0.001 * (l + 1));
+            loop.right[i] = std::cos(i * 0.001 * (l + 1));
+        }
+        loop.playLevel.SetSampleRate(SAMPLE_RATE);
+        loop.recordLevel.SetSampleRate(SAMPLE_RATE);
+        loop.playLevel.To(1.0f, 0);
+        loop.recordLevel.To(0.0f, 0);
+    }
+}
+
+static void RetargetLoops(std::vector<LoopSim> &loops, size_t block)
+{
+    // keep the dezippers busy a good part of the time.
+    if (block % 1000 == 0)
+    {
+        for (size_t l = 0; l < loops.size(); ++l)
+        {
+            bool on = ((block / 1000 + l) & 1) != 0;
+            loops[l].playLevel.To(on ? 1.0f : 0.25f, 0.1f);
+            loops[l].recordLevel.To(on ? 0.0f : 1.0f, 0.1f);
+        }
+    }
+}
+
+static void ScalarMix(std::vector<LoopSim> &loops, const float *inL, const float *inR, float *outL, float *outR, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        outL[i] = inL[i];
+        outR[i] = inR[i];
+    }
+    for (auto &loop : loops)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            float recordLevel = loop.recordLevel.Tick();
+            float playLevel = loop.playLevel.Tick();
+            float &vLeft = loop.left[loop.cursor];
+            float &vRight = loop.right[loop.cursor];
+            outL[i] += playLevel * vLeft;
+            outR[i] += playLevel * vRight;
+            vLeft += recordLevel * inL[i];
+            vRight += recordLevel * inR[i];
+            if (++loop.cursor == loop.left.size())
+            {
+                loop.cursor = 0;
+            }
+        }
+    }
+}
+
+static void KernelMix(std::vector<LoopSim> &loops, const float *inL, const float *inR, float *outL, float *outR, size_t n_samples)
+{
+    MixKernels::Copy(outL, inL, n_samples);
+    MixKernels::Copy(outR, inR, n_samples);
+    for (auto &loop : loops)
+    {
+        size_t index = 0;
+        while (index < n_samples)
+        {
+            size_t n = std::min(n_samples - index, loop.left.size() - loop.cursor);
+            n = loop.recordLevel.RampLength(n);
+            n = loop.playLevel.RampLength(n);
+
+            float *vLeft = loop.left.data() + loop.cursor;
+            float *vRight = loop.right.data() + loop.cursor;
+            MixKernels::StereoPanRampAccumulate(
+                outL + index, outR + index, vLeft, vRight,
+                loop.playLevel.RampStart(), loop.playLevel.RampDx(),
+                loop.playLevel.RampStart(), loop.playLevel.RampDx(),
+                n);
+            MixKernels::MixAccumulateRamp(vLeft, inL + index, loop.recordLevel.RampStart(), loop.recordLevel.RampDx(), n);
+            MixKernels::MixAccumulateRamp(vRight, inR + index, loop.recordLevel.RampStart(), loop.recordLevel.RampDx(), n);
+            loop.playLevel.Skip(n);
+            loop.recordLevel.Skip(n);
+
+            index += n;
+            loop.cursor += n;
+            if (loop.cursor == loop.left.size())
+            {
+                loop.cursor = 0;
+            }
+        }
+    }
+}
+
+template <typename MIX_FN>
+static double Benchmark(const char *name, MIX_FN mixFn, std::vector<float> &outputL, std::vector<float> &outputR)
+{
+    std::vector<LoopSim> loops;
+    InitLoops(loops);
+
+    size_t seconds = 60;
+    size_t blocks = (size_t)(SAMPLE_RATE * seconds / BLOCK_SIZE);
+    outputL.resize(blocks * BLOCK_SIZE);
+    outputR.resize(blocks * BLOCK_SIZE);
+
+    float inL[BLOCK_SIZE], inR[BLOCK_SIZE];
+    for (size_t i = 0; i < BLOCK_SIZE; ++i)
+    {
+        inL[i] = 0.001f * i;
+        inR[i] = -0.001f * i;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t block = 0; block < blocks; ++block)
+    {
+        RetargetLoops(loops, block);
+        mixFn(loops, inL, inR, outputL.data() + block * BLOCK_SIZE, outputR.data() + block * BLOCK_SIZE, BLOCK_SIZE);
+    }
+    auto elapsed = std::chrono::high_resolution_clock::now() - start;
+    double ms = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / 1000.0;
+
+    cout << "    " << setw(8) << name << ": " << setw(8) << setprecision(4) << ms << "ms for " << seconds << "s of audio"
+         << " (" << setprecision(4) << ms * 1000000.0 / (blocks * BLOCK_SIZE) << "ns/frame)" << endl;
+    return ms;
+}
+
+static void BenchmarkLooperMix()
+{
+    cout << "Benchmark: " << LOOPS << " stereo loops, " << BLOCK_SIZE << " frame blocks" << endl;
+
+    std::vector<float> scalarL, scalarR, kernelL, kernelR;
+    double scalarMs = Benchmark("scalar", ScalarMix, scalarL, scalarR);
+    double kernelMs = Benchmark("kernels", KernelMix, kernelL, kernelR);
+    cout << "    speedup: " << setprecision(3) << scalarMs / kernelMs << "x" << endl;
+
+    double maxError = 0;
+    for (size_t i = 0; i < scalarL.size(); ++i)
+    {
+        maxError = std::max(maxError, (double)std::abs(scalarL[i] - kernelL[i]));
+        maxError = std::max(maxError, (double)std::abs(scalarR[i] - kernelR[i]));
+    }
+    cout << "    max error: " << maxError << endl;
+    TEST_ASSERT(maxError < 1E-3);
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        for (size_t n : {1, 3, 4, 7, 16, 32, 33, 128})
+        {
+            TestRamp(n);
+        }
+        TestCrossfades();
+        BenchmarkLooperMix();
+    }
+    catch (const std::exception &e)
+    {
+        cerr << "ERROR: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,287 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "MultiResolutionSpectrum.hpp"
+#include "LsMath.hpp"
+#include "Window.hpp"
+#include "../restrict.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace LsNumerics;
+
+static bool IsPowerOfTwo(size_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+void MultiResolutionSpectrum::RealPowerFft::SetSize(size_t size)
+{
+    if (!IsPowerOfTwo(size) || size < 4)
+    {
+        throw std::invalid_argument("RealPowerFft: size must be a power of two.");
+    }
+    this->size = size;
+    size_t m = size / 2;
+
+    size_t bits = 0;
+    while (((size_t)1 << bits) < m)
+    {
+        ++bits;
+    }
+    bitReverse.resize(m);
+    for (size_t i = 0; i < m; ++i)
+    {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b)
+        {
+            if (i & ((size_t)1 << b))
+            {
+                r |= (size_t)1 << (bits - 1 - b);
+            }
+        }
+        bitReverse[i] = (uint32_t)r;
+    }
+    re.resize(m);
+    im.resize(m);
+
+    twiddleRe.resize(m);
+    twiddleIm.resize(m);
+    for (size_t h = 1; h < m; h *= 2)
+    {
+        for (size_t j = 0; j < h; ++j)
+        {
+            double angle = -Pi * j / h;
+            twiddleRe[h + j] = (float)std::cos(angle);
+            twiddleIm[h + j] = (float)std::sin(angle);
+        }
+    }
+    postRe.resize(m);
+    postIm.resize(m);
+    for (size_t k = 0; k < m; ++k)
+    {
+        double angle = -2 * Pi * k / size;
+        postRe[k] = (float)std::cos(angle);
+        postIm[k] = (float)std::sin(angle);
+    }
+}
+
+void MultiResolutionSpectrum::RealPowerFft::Compute(const float *input, const float *window, float *power)
+{
+    // Pack even/odd samples into a complex FFT of half the size.
+    size_t m = size / 2;
+    float *restrict pRe = re.data();
+    float *restrict pIm = im.data();
+    const uint32_t *pReverse = bitReverse.data();
+    if (window)
+    {
+        for (size_t k = 0; k < m; ++k)
+        {
+            uint32_t ix = pReverse[k];
+            pRe[ix] = input[2 * k] * window[2 * k];
+            pIm[ix] = input[2 * k + 1] * window[2 * k + 1];
+        }
+    }
+    else
+    {
+        for (size_t k = 0; k < m; ++k)
+        {
+            uint32_t ix = pReverse[k];
+            pRe[ix] = input[2 * k];
+            pIm[ix] = input[2 * k + 1];
+        }
+    }
+
+    // first stage has unit twiddles.
+    for (size_t k = 0; k < m; k += 2)
+    {
+        float ar = pRe[k], ai = pIm[k];
+        float br = pRe[k + 1], bi = pIm[k + 1];
+        pRe[k] = ar + br;
+        pIm[k] = ai + bi;
+        pRe[k + 1] = ar - br;
+        pIm[k + 1] = ai - bi;
+    }
+    for (size_t h = 2; h < m; h *= 2)
+    {
+        const float *restrict wr = twiddleRe.data() + h;
+        const float *restrict wi = twiddleIm.data() + h;
+        for (size_t k = 0; k < m; k += 2 * h)
+        {
+            float *restrict ar = pRe + k;
+            float *restrict ai = pIm + k;
+            float *restrict br = pRe + k + h;
+            float *restrict bi = pIm + k + h;
+            for (size_t j = 0; j < h; ++j)
+            {
+                float tr = br[j] * wr[j] - bi[j] * wi[j];
+                float ti = br[j] * wi[j] + bi[j] * wr[j];
+                float xr = ar[j];
+                float xi = ai[j];
+                br[j] = xr - tr;
+                bi[j] = xi - ti;
+                ar[j] = xr + tr;
+                ai[j] = xi + ti;
+            }
+        }
+    }
+
+    // Split into the spectrum of the real input:
+    // X[k] = (Z[k] + conj(Z[m-k]))/2 - i*exp(-2 pi i k/size)*(Z[k] - conj(Z[m-k]))/2
+    {
+        float dc = pRe[0] + pIm[0];
+        float nyquist = pRe[0] - pIm[0];
+        power[0] = dc * dc;
+        power[m] = nyquist * nyquist;
+    }
+    const float *restrict wr = postRe.data();
+    const float *restrict wi = postIm.data();
+    for (size_t k = 1; k < m; ++k)
+    {
+        float ar = pRe[k], ai = pIm[k];
+        float br = pRe[m - k], bi = -pIm[m - k];
+        float er = 0.5f * (ar + br);
+        float ei = 0.5f * (ai + bi);
+        float or_ = 0.5f * (ai - bi);
+        float oi = -0.5f * (ar - br);
+        float xr = er + wr[k] * or_ - wi[k] * oi;
+        float xi = ei + wr[k] * oi + wi[k] * or_;
+        power[k] = xr * xr + xi * xi;
+    }
+}
+
+void MultiResolutionSpectrum::Prepare(double sampleRate, size_t fftSize, size_t resolutions, float minFrequency, float maxFrequency, size_t points)
+{
+    constexpr size_t MIN_FFT_SIZE = 64;
+    if (!IsPowerOfTwo(fftSize) || fftSize < MIN_FFT_SIZE)
+    {
+        throw std::invalid_argument("MultiResolutionSpectrum: fftSize must be a power of two.");
+    }
+    if (points < 2 || minFrequency <= 0 || maxFrequency <= minFrequency)
+    {
+        throw std::invalid_argument("MultiResolutionSpectrum: invalid frequency range.");
+    }
+    resolutions = std::clamp(resolutions, (size_t)1, MAX_RESOLUTIONS);
+    while (resolutions > 1 && (fftSize >> (resolutions - 1)) < MIN_FFT_SIZE)
+    {
+        --resolutions;
+    }
+    this->sampleRate = sampleRate;
+    this->fftSize = fftSize;
+    this->minFrequency = minFrequency;
+    this->maxFrequency = maxFrequency;
+
+    levels.resize(resolutions);
+    for (size_t l = 0; l < resolutions; ++l)
+    {
+        size_t n = fftSize >> l;
+        Level &level = levels[l];
+        level.fft.SetSize(n);
+        level.window = Window::FlatTop<float>((int)n);
+        level.power.resize(n / 2 + 1);
+        // amplitude scale of 2/n, as for a one-sided spectrum.
+        level.dbOffset = (float)(20 * std::log10(2.0 / n));
+    }
+
+    pointMap.resize(points);
+    double bandRatio = std::sqrt(std::pow((double)maxFrequency / minFrequency, 1.0 / (points - 1)));
+    for (size_t i = 0; i < points; ++i)
+    {
+        double f = GetPointFrequency(i);
+        double fLow = f / bandRatio;
+        double fHigh = f * bandRatio;
+
+        // the shortest FFT with at least one bin per band.
+        size_t l = resolutions - 1;
+        while (l > 0 && sampleRate / (fftSize >> l) > fHigh - fLow)
+        {
+            --l;
+        }
+        size_t n = fftSize >> l;
+        double binWidth = sampleRate / n;
+        PointMap &point = pointMap[i];
+        point.level = (uint32_t)l;
+        size_t binStart = std::max((size_t)1, (size_t)std::ceil(fLow / binWidth));
+        size_t binEnd = std::min(n / 2, (size_t)std::floor(fHigh / binWidth));
+        if (binStart <= binEnd)
+        {
+            point.binStart = (uint32_t)binStart;
+            point.binEnd = (uint32_t)binEnd;
+            point.blend = 0;
+        }
+        else
+        {
+            double x = std::min(f / binWidth, n / 2 - 1.0);
+            point.binStart = (uint32_t)(n / 2 + 1);
+            point.binEnd = (uint32_t)std::floor(x);
+            point.blend = (float)(x - std::floor(x));
+        }
+    }
+}
+
+float MultiResolutionSpectrum::GetPointFrequency(size_t point) const
+{
+    return (float)(minFrequency * std::pow((double)maxFrequency / minFrequency, (double)point / (pointMap.size() - 1)));
+}
+
+void MultiResolutionSpectrum::Process(const float *input, float *outputDb)
+{
+    // Only compute the FFTs that some point uses.
+    bool used[MAX_RESOLUTIONS] = {};
+    for (const PointMap &point : pointMap)
+    {
+        used[point.level] = true;
+    }
+    for (size_t l = 0; l < levels.size(); ++l)
+    {
+        if (used[l])
+        {
+            Level &level = levels[l];
+            size_t n = level.fft.GetSize();
+            level.fft.Compute(input + (fftSize - n), level.window.data(), level.power.data());
+        }
+    }
+
+    for (size_t i = 0; i < pointMap.size(); ++i)
+    {
+        const PointMap &point = pointMap[i];
+        const Level &level = levels[point.level];
+        const float *power = level.power.data();
+        float value;
+        if (point.binStart <= point.binEnd)
+        {
+            value = power[point.binStart];
+            for (size_t bin = point.binStart + 1; bin <= point.binEnd; ++bin)
+            {
+                value = std::max(value, power[bin]);
+            }
+        }
+        else
+        {
+            value = power[point.binEnd] + (power[point.binEnd + 1] - power[point.binEnd]) * point.blend;
+        }
+        outputDb[i] = 10 * std::log10(std::max(value, 1E-30f)) + level.dbOffset;
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LsNumerics
+{
+    // Float32 spectrum analysis on a logarithmic frequency axis, for display.
+    //
+    // Up to MAX_RESOLUTIONS windowed real FFTs of halving size are taken over the most recent
+    // samples. Each output point uses the shortest FFT that still resolves the band it covers,
+    // so high frequencies come from short FFTs (fast, with good time resolution), and low
+    // frequencies from long ones. Point values are the peak bin level in the point's band, in
+    // dB, which keeps a sinusoid's level the same whichever FFT it was measured with.
+    //
+    // Prepare() allocates; Process() does not.
+    class MultiResolutionSpectrum
+    {
+    public:
+        static constexpr size_t MAX_RESOLUTIONS = 8;
+
+        // Not realtime-safe.
+        // fftSize: size of the longest FFT (a power of two).
+        // resolutions: number of FFTs, of size fftSize, fftSize/2, ... (1 for a single FFT).
+        // points: number of output points, logarithmically spaced from minFrequency to maxFrequency inclusive.
+        void Prepare(double sampleRate, size_t fftSize, size_t resolutions, float minFrequency, float maxFrequency, size_t points);
+
+        // Number of samples of history that Process() reads.
+        size_t GetFftSize() const { return fftSize; }
+        size_t GetPointCount() const { return pointMap.size(); }
+        size_t GetResolutionCount() const { return levels.size(); }
+        float GetPointFrequency(size_t point) const;
+
+        // input: the most recent GetFftSize() samples, oldest first.
+        // output: GetPointCount() values, in dB. A sine with amplitude 1.0 reads as the
+        // window's coherent gain (-13.3dB for the flat-top window).
+        void Process(const float *input, float *outputDb);
+
+        // A power-of-two real-input FFT that only returns the power spectrum. Split real/imaginary
+        // arrays so that the butterflies vectorize.
+        class RealPowerFft
+        {
+        public:
+            void SetSize(size_t size);
+            size_t GetSize() const { return size; }
+
+            // input: size() samples. window: size() values, or nullptr.
+            // power: size()/2+1 values of |X[k]|^2 (unnormalized).
+            void Compute(const float *input, const float *window, float *power);
+
+        private:
+            size_t size = 0;
+            std::vector<uint32_t> bitReverse;
+            std::vector<float> re, im;
+            std::vector<float> twiddleRe, twiddleIm; // twiddles for the butterfly stage with span h start at index h.
+            std::vector<float> postRe, postIm;       // exp(-2 pi i k/size), k < size/2
+        };
+
+    private:
+        struct Level
+        {
+            RealPowerFft fft;
+            std::vector<float> window;
+            std::vector<float> power;
+            float dbOffset;
+        };
+        struct PointMap
+        {
+            uint32_t level;
+            uint32_t binStart; // peak over [binStart,binEnd] if binStart <= binEnd,
+            uint32_t binEnd;   // otherwise interpolate between binEnd and binEnd+1.
+            float blend;
+        };
+
+        double sampleRate = 0;
+        size_t fftSize = 0;
+        float minFrequency = 0;
+        float maxFrequency = 0;
+        std::vector<Level> levels;
+        std::vector<PointMap> pointMap;
+    };
+}
@@ -0,0 +1,155 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "MultiResolutionSpectrum.hpp"
+#include "StagedFft.hpp"
+#include "LsMath.hpp"
+#include "../TestAssert.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace LsNumerics;
+
+static void TestRealPowerFft()
+{
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    for (size_t n : {4, 8, 64, 1024})
+    {
+        std::vector<float> input(n);
+        for (auto &v : input)
+        {
+            v = distribution(random);
+        }
+        MultiResolutionSpectrum::RealPowerFft fft;
+        fft.SetSize(n);
+        std::vector<float> power(n / 2 + 1);
+        fft.Compute(input.data(), nullptr, power.data());
+
+        double maxError = 0;
+        for (size_t k = 0; k <= n / 2; ++k)
+        {
+            double sumRe = 0, sumIm = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                double w = -2 * Pi * k * i / n;
+                sumRe += input[i] * std::cos(w);
+                sumIm += input[i] * std::sin(w);
+            }
+            double expected = sumRe * sumRe + sumIm * sumIm;
+            maxError = std::max(maxError, std::abs(power[k] - expected) / n);
+        }
+        std::cout << "    RealPowerFft(" << n << ") error: " << maxError << std::endl;
+        TEST_ASSERT(maxError < 1E-4);
+    }
+}
+
+static void TestSineLevels()
+{
+    // A sine reads the flat-top window's coherent gain at every resolution.
+    constexpr double SAMPLE_RATE = 48000;
+    constexpr size_t FFT_SIZE = 16384;
+    const double expectedDb = 20 * std::log10(0.21557895 * 0.5);
+
+    MultiResolutionSpectrum spectrum;
+    spectrum.Prepare(SAMPLE_RATE, FFT_SIZE, 4, 20, 20000, 201);
+    TEST_ASSERT(spectrum.GetResolutionCount() == 4);
+
+    std::vector<float> input(FFT_SIZE);
+    std::vector<float> output(spectrum.GetPointCount());
+    for (size_t point = 10; point < spectrum.GetPointCount(); point += 15)
+    {
+        double f = spectrum.GetPointFrequency(point);
+        for (size_t i = 0; i < FFT_SIZE; ++i)
+        {
+            input[i] = (float)(0.5 * std::sin(2 * Pi * f * i / SAMPLE_RATE));
+        }
+        spectrum.Process(input.data(), output.data());
+        double error = output[point] - expectedDb;
+        std::cout << "    " << f << "Hz: " << output[point] << "dB" << std::endl;
+        TEST_ASSERT(std::abs(error) < 0.1);
+
+        // well away from the tone, the level is far down.
+        size_t farPoint = point > 100 ? point - 60 : point + 60;
+        TEST_ASSERT(output[farPoint] < expectedDb - 60);
+    }
+}
+
+static void Benchmark()
+{
+    constexpr double SAMPLE_RATE = 48000;
+    constexpr size_t FFT_SIZE = 16384;
+    constexpr size_t ITERATIONS = 100;
+    std::vector<float> input(FFT_SIZE);
+    for (size_t i = 0; i < FFT_SIZE; ++i)
+    {
+        input[i] = (float)std::sin(i * 0.1);
+    }
+
+    MultiResolutionSpectrum spectrum;
+    spectrum.Prepare(SAMPLE_RATE, FFT_SIZE, 4, 10, 22000, 201);
+    std::vector<float> output(spectrum.GetPointCount());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ITERATIONS; ++i)
+    {
+        spectrum.Process(input.data(), output.data());
+    }
+    double floatMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+
+    // for comparison: a single complex<double> FFT of the same length.
+    StagedFft fft(FFT_SIZE);
+    std::vector<std::complex<double>> buffer(FFT_SIZE);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ITERATIONS; ++i)
+    {
+        for (size_t j = 0; j < FFT_SIZE; ++j)
+        {
+            buffer[j] = input[j];
+        }
+        fft.Forward(buffer, buffer);
+    }
+    double doubleMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+    std::cout << "    Frame: " << floatMs << "ms (4 resolutions, float). StagedFft(" << FFT_SIZE << "): " << doubleMs << "ms" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::cout << "MultiResolutionSpectrumTest" << std::endl;
+        TestRealPowerFft();
+        TestSineLevels();
+        Benchmark();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,544 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#include "Oversampler.hpp"
+#include "LsMath.hpp"
+#include "../restrict.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using namespace LsNumerics;
+
+class Oversampler::HalfbandStage
+{
+public:
+    virtual ~HalfbandStage() = default;
+
+    virtual void Reset() = 0;
+    // n_samples of input to 2*n_samples of output.
+    virtual void Upsample(const float *input, float *output, size_t n_samples) = 0;
+    // 2*n_samples of input to n_samples of output.
+    virtual void Downsample(const float *input, float *output, size_t n_samples) = 0;
+    // Round-trip latency in samples at the stage's lower rate.
+    virtual double GetLatency() const = 0;
+};
+
+namespace
+{
+    // Passband edge, as a fraction of the base sample rate.
+    constexpr double PASSBAND = 0.4;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Linear-phase half-band FIR (Kaiser-windowed sinc).
+    //
+    // Taps are h[0..4K-2], centered on c = 2K-1. Every odd offset from the center is zero,
+    // so one polyphase branch is the even-indexed taps, and the other is a pure delay.
+    class FirHalfbandStage : public Oversampler::HalfbandStage
+    {
+    public:
+        FirHalfbandStage(double transition, double attenuationDb, size_t maxBlockSize)
+            : maxBlockSize(maxBlockSize)
+        {
+            std::vector<double> evenTaps = Oversampler::DesignHalfbandFir(transition, attenuationDb);
+            K = evenTaps.size() / 2;
+
+            // even taps, reversed so that the convolution runs forward through the history.
+            taps.resize(2 * K);
+            for (size_t j = 0; j < 2 * K; ++j)
+            {
+                taps[2 * K - 1 - j] = (float)evenTaps[j];
+            }
+
+            upHistory.resize(2 * K - 1 + maxBlockSize);
+            downEven.resize(2 * K - 1 + maxBlockSize);
+            downOdd.resize(K + maxBlockSize);
+            Reset();
+        }
+
+        virtual void Reset() override
+        {
+            std::fill(upHistory.begin(), upHistory.end(), 0.0f);
+            std::fill(downEven.begin(), downEven.end(), 0.0f);
+            std::fill(downOdd.begin(), downOdd.end(), 0.0f);
+        }
+
+        virtual void Upsample(const float *input, float *output, size_t n_samples) override
+        {
+            while (n_samples != 0)
+            {
+                size_t n = std::min(n_samples, maxBlockSize);
+                const size_t historySize = 2 * K - 1;
+                float *history = upHistory.data();
+                std::memcpy(history + historySize, input, n * sizeof(float));
+
+                const float *restrict pTaps = taps.data();
+                const size_t nTaps = taps.size();
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const float *restrict x = history + i;
+                    float sum = 0;
+                    for (size_t m = 0; m < nTaps; ++m)
+                    {
+                        sum += pTaps[m] * x[m];
+                    }
+                    output[2 * i] = 2 * sum;
+                    output[2 * i + 1] = history[K + i];
+                }
+                std::memmove(history, history + n, historySize * sizeof(float));
+
+                input += n;
+                output += 2 * n;
+                n_samples -= n;
+            }
+        }
+
+        virtual void Downsample(const float *input, float *output, size_t n_samples) override
+        {
+            while (n_samples != 0)
+            {
+                size_t n = std::min(n_samples, maxBlockSize);
+                const size_t evenHistorySize = 2 * K - 1;
+                const size_t oddHistorySize = K;
+                float *even = downEven.data();
+                float *odd = downOdd.data();
+                for (size_t i = 0; i < n; ++i)
+                {
+                    even[evenHistorySize + i] = input[2 * i];
+                    odd[oddHistorySize + i] = input[2 * i + 1];
+                }
+
+                const float *restrict pTaps = taps.data();
+                const size_t nTaps = taps.size();
+                for (size_t i = 0; i < n; ++i)
+                {
+                    const float *restrict x = even + i;
+                    float sum = 0;
+                    for (size_t m = 0; m < nTaps; ++m)
+                    {
+                        sum += pTaps[m] * x[m];
+                    }
+                    output[i] = sum + 0.5f * odd[i];
+                }
+                std::memmove(even, even + n, evenHistorySize * sizeof(float));
+                std::memmove(odd, odd + n, oddHistorySize * sizeof(float));
+
+                input += 2 * n;
+                output += n;
+                n_samples -= n;
+            }
+        }
+
+        virtual double GetLatency() const override
+        {
+            // group delay of c samples at the higher rate, in each direction.
+            return (double)(2 * K - 1);
+        }
+
+    private:
+        size_t K;
+        size_t maxBlockSize;
+        std::vector<float> taps;
+        std::vector<float> upHistory;
+        std::vector<float> downEven;
+        std::vector<float> downOdd;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Polyphase IIR half-band: two parallel chains of first-order allpass sections in z^-2
+    // (Valenzuela & Constantinides). The two chains run in the two lanes of one vector.
+    // Coefficient design follows Laurent de Soras' HIIR.
+    class IirHalfbandStage : public Oversampler::HalfbandStage
+    {
+    public:
+        IirHalfbandStage(double transition, double attenuationDb)
+        {
+            double k, q;
+            ComputeTransitionParameters(transition, k, q);
+            size_t order = ComputeOrder(attenuationDb, q);
+            size_t nCoefficients = (order - 1) / 2;
+            // both chains get the same number of sections.
+            if (nCoefficients & 1)
+            {
+                ++nCoefficients;
+                order = 2 * nCoefficients + 1;
+            }
+
+            std::vector<double> coefficients(nCoefficients);
+            for (size_t i = 0; i < nCoefficients; ++i)
+            {
+                coefficients[i] = ComputeCoefficient(i, k, q, order);
+            }
+            nPairs = nCoefficients / 2;
+            pairs.resize(nPairs);
+            upX.resize(nPairs);
+            upY.resize(nPairs);
+            downX.resize(nPairs);
+            downY.resize(nPairs);
+
+            double groupDelay0 = 0, groupDelay1 = 0;
+            for (size_t i = 0; i < nPairs; ++i)
+            {
+                double c0 = coefficients[2 * i];
+                double c1 = coefficients[2 * i + 1];
+                pairs[i] = vec2{c0, c1};
+                // DC group delay of (c + z^-2)/(1 + c z^-2), in samples at the higher rate.
+                groupDelay0 += 2 * (1 - c0) / (1 + c0);
+                groupDelay1 += 2 * (1 - c1) / (1 + c1);
+            }
+            // H(z) = (A0(z^2) + z^-1 A1(z^2))/2
+            this->groupDelay = (groupDelay0 + groupDelay1 + 1) / 2;
+            Reset();
+        }
+
+        virtual void Reset() override
+        {
+            for (size_t i = 0; i < nPairs; ++i)
+            {
+                upX[i] = upY[i] = downX[i] = downY[i] = vec2{0, 0};
+            }
+        }
+
+        virtual void Upsample(const float *input, float *output, size_t n_samples) override
+        {
+            vec2 *restrict x = upX.data();
+            vec2 *restrict y = upY.data();
+            const vec2 *restrict c = pairs.data();
+            for (size_t i = 0; i < n_samples; ++i)
+            {
+                vec2 v = {input[i], input[i]};
+                for (size_t p = 0; p < nPairs; ++p)
+                {
+                    vec2 t = (v - y[p]) * c[p] + x[p];
+                    x[p] = v;
+                    y[p] = t;
+                    v = t;
+                }
+                output[2 * i] = (float)v[0];
+                output[2 * i + 1] = (float)v[1];
+            }
+            FlushDenorms(upX);
+            FlushDenorms(upY);
+        }
+
+        virtual void Downsample(const float *input, float *output, size_t n_samples) override
+        {
+            vec2 *restrict x = downX.data();
+            vec2 *restrict y = downY.data();
+            const vec2 *restrict c = pairs.data();
+            for (size_t i = 0; i < n_samples; ++i)
+            {
+                vec2 v = {input[2 * i + 1], input[2 * i]};
+                for (size_t p = 0; p < nPairs; ++p)
+                {
+                    vec2 t = (v - y[p]) * c[p] + x[p];
+                    x[p] = v;
+                    y[p] = t;
+                    v = t;
+                }
+                output[i] = (float)(0.5 * (v[0] + v[1]));
+            }
+            FlushDenorms(downX);
+            FlushDenorms(downY);
+        }
+
+        virtual double GetLatency() const override
+        {
+            // groupDelay at the higher rate on the way up; one sample less on the way down,
+            // since each output is taken from the odd input phase.
+            return (2 * groupDelay - 1) / 2;
+        }
+
+    private:
+        typedef double vec2 __attribute__((vector_size(16)));
+
+        void FlushDenorms(std::vector<vec2> &values)
+        {
+            for (auto &v : values)
+            {
+                for (size_t lane = 0; lane < 2; ++lane)
+                {
+                    if (std::abs(v[lane]) < 1E-20)
+                    {
+                        v[lane] = 0;
+                    }
+                }
+            }
+        }
+
+        static void ComputeTransitionParameters(double transition, double &k, double &q)
+        {
+            k = std::tan((1 - transition * 2) * Pi / 4);
+            k *= k;
+            double kksqrt = std::pow(1 - k * k, 0.25);
+            double e = 0.5 * (1 - kksqrt) / (1 + kksqrt);
+            double e2 = e * e;
+            double e4 = e2 * e2;
+            q = e * (1 + e4 * (2 + e4 * (15 + 150 * e4)));
+        }
+
+        static size_t ComputeOrder(double attenuationDb, double q)
+        {
+            double attenuationP2 = std::pow(10.0, -attenuationDb / 10);
+            double a = attenuationP2 / (1 - attenuationP2);
+            size_t order = (size_t)std::ceil(std::log(a * a / 16) / std::log(q));
+            if ((order & 1) == 0)
+            {
+                ++order;
+            }
+            return std::max(order, (size_t)3);
+        }
+
+        static double ComputeAccumulatedNumerator(double q, size_t order, size_t c)
+        {
+            double result = 0;
+            double sign = 1;
+            for (size_t i = 0;; ++i)
+            {
+                double term = std::pow(q, (double)(i * (i + 1))) * std::sin((i * 2 + 1) * c * Pi / order) * sign;
+                result += term;
+                sign = -sign;
+                if (std::abs(term) <= 1E-100)
+                    break;
+            }
+            return result;
+        }
+        static double ComputeAccumulatedDenominator(double q, size_t order, size_t c)
+        {
+            double result = 0;
+            double sign = -1;
+            for (size_t i = 1;; ++i)
+            {
+                double term = std::pow(q, (double)(i * i)) * std::cos(i * 2 * c * Pi / order) * sign;
+                result += term;
+                sign = -sign;
+                if (std::abs(term) <= 1E-100)
+                    break;
+            }
+            return result;
+        }
+
+        static double ComputeCoefficient(size_t index, double k, double q, size_t order)
+        {
+            size_t c = index + 1;
+            double num = ComputeAccumulatedNumerator(q, order, c) * std::pow(q, 0.25);
+            double den = ComputeAccumulatedDenominator(q, order, c) + 0.5;
+            double ww = num / den;
+            double wwsq = ww * ww;
+            double x = std::sqrt((1 - wwsq * k) * (1 - wwsq / k)) / (1 + wwsq);
+            return (1 - x) / (1 + x);
+        }
+
+        size_t nPairs;
+        double groupDelay;
+        std::vector<vec2> pairs;
+        std::vector<vec2> upX, upY;
+        std::vector<vec2> downX, downY;
+    };
+}
+
+std::vector<double> Oversampler::DesignHalfbandFir(double transition, double attenuationDb)
+{
+    // Kaiser's estimate of filter length.
+    double length = (attenuationDb - 8) / (2.285 * 2 * Pi * transition) + 1;
+    size_t K = std::max((size_t)2, (size_t)std::ceil((length + 1) / 4));
+    size_t nTaps = 4 * K - 1;
+    size_t c = 2 * K - 1;
+
+    double beta;
+    if (attenuationDb > 50)
+    {
+        beta = 0.1102 * (attenuationDb - 8.7);
+    }
+    else if (attenuationDb >= 21)
+    {
+        beta = 0.5842 * std::pow(attenuationDb - 21, 0.4) + 0.07886 * (attenuationDb - 21);
+    }
+    else
+    {
+        beta = 0;
+    }
+    double i0Beta = std::cyl_bessel_i(0.0, beta);
+
+    std::vector<double> result(2 * K);
+    double sum = 0;
+    for (size_t j = 0; j < nTaps; j += 2)
+    {
+        double offset = (double)j - (double)c;
+        double r = offset / c;
+        double window = std::cyl_bessel_i(0.0, beta * std::sqrt(std::max(0.0, 1 - r * r))) / i0Beta;
+        double h = std::sin(Pi * offset / 2) / (Pi * offset) * window;
+        result[j / 2] = h;
+        sum += h;
+    }
+    // normalize the branch for unity gain at DC.
+    for (auto &tap : result)
+    {
+        tap *= 0.5 / sum;
+    }
+    return result;
+}
+
+Oversampler::Oversampler()
+{
+}
+
+Oversampler::~Oversampler()
+{
+}
+
+void Oversampler::Prepare(double sampleRate, size_t maxBlockSize, double attenuationDb)
+{
+    this->sampleRate = sampleRate;
+    this->maxBlockSize = maxBlockSize;
+
+    iirStages.clear();
+    firStages.clear();
+    for (size_t stage = 0; stage < MAX_STAGES; ++stage)
+    {
+        // stage runs from 2^stage * sampleRate to 2^(stage+1) * sampleRate. Later stages
+        // only have to reject images of the (base-rate) passband, so their transition bands
+        // are wider.
+        double lowRateMultiple = (double)(1 << stage);
+        double transition = 0.5 - PASSBAND / lowRateMultiple; // full width, relative to the higher rate.
+        firStages.push_back(std::make_unique<FirHalfbandStage>(transition, attenuationDb, maxBlockSize << stage));
+        iirStages.push_back(std::make_unique<IirHalfbandStage>(transition / 2, attenuationDb));
+    }
+
+    upBuffer[0].resize(maxBlockSize * MAX_FACTOR);
+    upBuffer[1].resize(maxBlockSize * MAX_FACTOR);
+    downBuffer[0].resize(maxBlockSize * MAX_FACTOR / 2);
+    downBuffer[1].resize(maxBlockSize * MAX_FACTOR / 2);
+
+    nActiveStages = 0;
+    factor = 1;
+    SetOversampling(this->factor, this->filter);
+}
+
+void Oversampler::SetOversampling(size_t factor, OversamplerFilter filter)
+{
+    size_t nStages;
+    switch (factor)
+    {
+    case 1:
+        nStages = 0;
+        break;
+    case 2:
+        nStages = 1;
+        break;
+    case 4:
+        nStages = 2;
+        break;
+    case 8:
+        nStages = 3;
+        break;
+    default:
+        throw std::invalid_argument("Oversampler: factor must be 1, 2, 4 or 8.");
+    }
+    auto &stages = filter == OversamplerFilter::LinearPhase ? firStages : iirStages;
+    if (stages.size() < nStages)
+    {
+        throw std::logic_error("Oversampler: Prepare() has not been called.");
+    }
+    bool changed = factor != this->factor || filter != this->filter;
+    this->factor = factor;
+    this->filter = filter;
+    this->nActiveStages = nStages;
+    for (size_t i = 0; i < nStages; ++i)
+    {
+        activeStages[i] = stages[i].get();
+    }
+    if (changed)
+    {
+        Reset();
+    }
+}
+
+double Oversampler::GetLatency() const
+{
+    double result = 0;
+    for (size_t i = 0; i < nActiveStages; ++i)
+    {
+        result += activeStages[i]->GetLatency() / (double)(1 << i);
+    }
+    return result;
+}
+
+void Oversampler::Reset()
+{
+    for (size_t i = 0; i < nActiveStages; ++i)
+    {
+        activeStages[i]->Reset();
+    }
+}
+
+float *Oversampler::Upsample(const float *input, size_t n_samples)
+{
+    if (n_samples > maxBlockSize)
+    {
+        throw std::logic_error("Oversampler: block too large.");
+    }
+    if (nActiveStages == 0)
+    {
+        std::memcpy(upBuffer[0].data(), input, n_samples * sizeof(float));
+        return upBuffer[0].data();
+    }
+    const float *in = input;
+    float *out = nullptr;
+    size_t n = n_samples;
+    for (size_t i = 0; i < nActiveStages; ++i)
+    {
+        out = upBuffer[i & 1].data();
+        activeStages[i]->Upsample(in, out, n);
+        in = out;
+        n *= 2;
+    }
+    return out;
+}
+
+void Oversampler::Downsample(const float *input, float *output, size_t n_samples)
+{
+    if (n_samples > maxBlockSize)
+    {
+        throw std::logic_error("Oversampler: block too large.");
+    }
+    if (nActiveStages == 0)
+    {
+        if (output != input)
+        {
+            std::memmove(output, input, n_samples * sizeof(float));
+        }
+        return;
+    }
+    const float *in = input;
+    for (size_t i = nActiveStages; i-- > 0;)
+    {
+        size_t n = n_samples << i; // outputs of this stage.
+        float *out = (i == 0) ? output : downBuffer[i & 1].data();
+        activeStages[i]->Downsample(in, out, n);
+        in = out;
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace LsNumerics
+{
+    enum class OversamplerFilter
+    {
+        // Polyphase IIR allpass half-band filters. Low latency, non-linear phase.
+        MinimumPhase = 0,
+        // Polyphase FIR half-band filters. Linear phase, higher latency.
+        LinearPhase = 1,
+    };
+
+    // Block-based 2x/4x/8x oversampler for nonlinear stages.
+    //
+    // Oversampling is done as a cascade of 2x half-band stages; later stages have wider
+    // transition bands and so are much cheaper than the first. Both directions keep their own
+    // state, so a block is processed with Upsample(), the nonlinear stage run at the
+    // oversampled rate, and then Downsample().
+    //
+    // Prepare() designs the filters for every factor and filter type and allocates buffers.
+    // SetOversampling(), Upsample() and Downsample() are realtime-safe.
+    class Oversampler
+    {
+    public:
+        static constexpr size_t MAX_FACTOR = 8;
+
+        Oversampler();
+        ~Oversampler();
+
+        // Not realtime-safe.
+        void Prepare(double sampleRate, size_t maxBlockSize, double attenuationDb = 90.0);
+
+        // factor: 1, 2, 4 or 8. Resets filter state if the configuration changes.
+        void SetOversampling(size_t factor, OversamplerFilter filter);
+
+        size_t GetFactor() const { return factor; }
+        OversamplerFilter GetFilter() const { return filter; }
+        size_t GetMaxBlockSize() const { return maxBlockSize; }
+
+        // Round-trip (Upsample() + Downsample()) latency, in samples at the base rate.
+        double GetLatency() const;
+
+        void Reset();
+
+        // Upsample n_samples (<= GetMaxBlockSize()). Returns a buffer of n_samples*GetFactor()
+        // samples, which remains valid until the next call to Upsample().
+        float *Upsample(const float *input, size_t n_samples);
+
+        // Downsample n_samples*GetFactor() samples of input to n_samples of output. input
+        // may be the buffer returned by Upsample().
+        void Downsample(const float *input, float *output, size_t n_samples);
+
+        // Kaiser-windowed half-band FIR design. transition is the full transition width as a
+        // fraction of the (higher) sample rate. Returns the even-indexed taps h[0], h[2] ... h[4K-2]
+        // of a 4K-1 tap filter centered on h[2K-1] = 0.5 (every other odd tap is zero). The even
+        // taps sum to 0.5.
+        static std::vector<double> DesignHalfbandFir(double transition, double attenuationDb);
+
+    public:
+        class HalfbandStage;
+
+    private:
+        static constexpr size_t MAX_STAGES = 3;
+
+        double sampleRate = 0;
+        size_t maxBlockSize = 0;
+        size_t factor = 1;
+        OversamplerFilter filter = OversamplerFilter::MinimumPhase;
+
+        std::vector<std::unique_ptr<HalfbandStage>> iirStages;
+        std::vector<std::unique_ptr<HalfbandStage>> firStages;
+        HalfbandStage *activeStages[MAX_STAGES];
+        size_t nActiveStages = 0;
+
+        std::vector<float> upBuffer[2];
+        std::vector<float> downBuffer[2];
+    };
+}
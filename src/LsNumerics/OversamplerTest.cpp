@@ -0,0 +1,228 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+
+#include "Oversampler.hpp"
+#include "LsMath.hpp"
+#include "../TestAssert.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace LsNumerics;
+
+static constexpr double SAMPLE_RATE = 48000;
+static constexpr size_t BLOCK_SIZE = 64;
+
+static const char *FilterName(OversamplerFilter filter)
+{
+    return filter == OversamplerFilter::LinearPhase ? "linear" : "minimum";
+}
+
+// Amplitude and phase of the component of `signal` at `frequency` (cycles/sample).
+static void Measure(const std::vector<float> &signal, size_t start, double frequency, double &amplitude, double &phase)
+{
+    double sumSin = 0, sumCos = 0;
+    size_t n = signal.size() - start;
+    for (size_t i = start; i < signal.size(); ++i)
+    {
+        double w = 2 * Pi * frequency * i;
+        sumSin += signal[i] * std::sin(w);
+        sumCos += signal[i] * std::cos(w);
+    }
+    sumSin *= 2.0 / n;
+    sumCos *= 2.0 / n;
+    amplitude = std::sqrt(sumSin * sumSin + sumCos * sumCos);
+    phase = std::atan2(sumCos, sumSin);
+}
+
+static std::vector<float> Sine(size_t n, double frequency)
+{
+    std::vector<float> result(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        result[i] = (float)std::sin(2 * Pi * frequency * i);
+    }
+    return result;
+}
+
+static void RoundTrip(Oversampler &oversampler, const std::vector<float> &input, std::vector<float> &output, size_t blockSize)
+{
+    output.resize(input.size());
+    for (size_t i = 0; i < input.size(); i += blockSize)
+    {
+        size_t n = std::min(blockSize, input.size() - i);
+        float *upsampled = oversampler.Upsample(input.data() + i, n);
+        oversampler.Downsample(upsampled, output.data() + i, n);
+    }
+}
+
+static void TestRoundTrip(size_t factor, OversamplerFilter filter)
+{
+    Oversampler oversampler;
+    oversampler.Prepare(SAMPLE_RATE, BLOCK_SIZE);
+    oversampler.SetOversampling(factor, filter);
+
+    // passband gain, and latency measured as phase delay at a low frequency.
+    double f = 200 / SAMPLE_RATE;
+    auto input = Sine(48000, f);
+    std::vector<float> output;
+    RoundTrip(oversampler, input, output, BLOCK_SIZE);
+
+    double amplitude, phase;
+    Measure(output, 4800, f, amplitude, phase);
+    double measuredLatency = -phase / (2 * Pi * f);
+    std::cout << "   " << factor << "x " << FilterName(filter)
+              << " latency: " << oversampler.GetLatency()
+              << " measured: " << measuredLatency
+              << " gain: " << amplitude << std::endl;
+    TEST_ASSERT(std::abs(amplitude - 1) < 1E-3);
+    TEST_ASSERT(std::abs(measuredLatency - oversampler.GetLatency()) < 0.05);
+
+    // passband edge.
+    f = 18000 / SAMPLE_RATE;
+    input = Sine(48000, f);
+    oversampler.Reset();
+    RoundTrip(oversampler, input, output, BLOCK_SIZE);
+    Measure(output, 4800, f, amplitude, phase);
+    TEST_ASSERT(std::abs(amplitude - 1) < 0.01);
+}
+
+static void TestImageRejection(size_t factor, OversamplerFilter filter)
+{
+    // a 1kHz tone, upsampled, should have no image at fs-1kHz.
+    Oversampler oversampler;
+    oversampler.Prepare(SAMPLE_RATE, BLOCK_SIZE);
+    oversampler.SetOversampling(factor, filter);
+
+    double f = 1000 / SAMPLE_RATE;
+    auto input = Sine(24000, f);
+    std::vector<float> upsampled;
+    for (size_t i = 0; i < input.size(); i += BLOCK_SIZE)
+    {
+        float *p = oversampler.Upsample(input.data() + i, BLOCK_SIZE);
+        upsampled.insert(upsampled.end(), p, p + BLOCK_SIZE * factor);
+    }
+    double signal, image, phase;
+    Measure(upsampled, 4800 * factor, f / factor, signal, phase);
+    Measure(upsampled, 4800 * factor, (1 - f) / factor, image, phase);
+    double rejectionDb = 20 * std::log10(image / signal);
+    std::cout << "   " << factor << "x " << FilterName(filter) << " image rejection: " << rejectionDb << " dB" << std::endl;
+    TEST_ASSERT(rejectionDb < -80);
+}
+
+static void TestAliasRejection(size_t factor, OversamplerFilter filter)
+{
+    // a tone above the base-rate Nyquist frequency, downsampled, should not alias.
+    Oversampler oversampler;
+    oversampler.Prepare(SAMPLE_RATE, BLOCK_SIZE);
+    oversampler.SetOversampling(factor, filter);
+
+    double fHigh = 30000 / (SAMPLE_RATE * factor); // aliases to 18kHz.
+    auto input = Sine(24000 * factor, fHigh);
+    std::vector<float> output(24000);
+    for (size_t i = 0; i < output.size(); i += BLOCK_SIZE)
+    {
+        oversampler.Downsample(input.data() + i * factor, output.data() + i, BLOCK_SIZE);
+    }
+    double alias, phase;
+    Measure(output, 4800, 18000 / SAMPLE_RATE, alias, phase);
+    double rejectionDb = 20 * std::log10(alias);
+    std::cout << "   " << factor << "x " << FilterName(filter) << " alias rejection: " << rejectionDb << " dB" << std::endl;
+    TEST_ASSERT(rejectionDb < -80);
+}
+
+static void TestBlockSizes(size_t factor, OversamplerFilter filter)
+{
+    Oversampler a, b;
+    a.Prepare(SAMPLE_RATE, BLOCK_SIZE);
+    b.Prepare(SAMPLE_RATE, BLOCK_SIZE);
+    a.SetOversampling(factor, filter);
+    b.SetOversampling(factor, filter);
+
+    auto input = Sine(4000, 440 / SAMPLE_RATE);
+    std::vector<float> outputA, outputB;
+    RoundTrip(a, input, outputA, BLOCK_SIZE);
+    RoundTrip(b, input, outputB, 13);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        TEST_ASSERT(outputA[i] == outputB[i]);
+    }
+}
+
+static void Benchmark()
+{
+    std::cout << std::endl
+              << "Benchmark (round trip, " << BLOCK_SIZE << "-sample blocks, ms per second of audio)" << std::endl;
+    auto input = Sine(48000, 440 / SAMPLE_RATE);
+    std::vector<float> output;
+    for (auto filter : {OversamplerFilter::MinimumPhase, OversamplerFilter::LinearPhase})
+    {
+        for (size_t factor : {2, 4, 8})
+        {
+            Oversampler oversampler;
+            oversampler.Prepare(SAMPLE_RATE, BLOCK_SIZE);
+            oversampler.SetOversampling(factor, filter);
+            constexpr size_t ITERATIONS = 20;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < ITERATIONS; ++i)
+            {
+                RoundTrip(oversampler, input, output, BLOCK_SIZE);
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            double ms = std::chrono::duration<double, std::milli>(elapsed).count() / ITERATIONS;
+            std::cout << "   " << factor << "x " << FilterName(filter) << ": " << ms << std::endl;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::cout << "OversamplerTest" << std::endl;
+        for (auto filter : {OversamplerFilter::MinimumPhase, OversamplerFilter::LinearPhase})
+        {
+            for (size_t factor : {1, 2, 4, 8})
+            {
+                TestRoundTrip(factor, filter);
+                TestBlockSizes(factor, filter);
+                if (factor != 1)
+                {
+                    TestImageRejection(factor, filter);
+                    TestAliasRejection(factor, filter);
+                }
+            }
+        }
+        Benchmark();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,432 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "PhaseVocoder.hpp"
+#include "LsMath.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace LsNumerics;
+
+namespace
+{
+    inline double WrapPhase(double phase)
+    {
+        return phase - 2 * Pi * std::round(phase * (1.0 / (2 * Pi)));
+    }
+
+    template <typename T>
+    void EraseFront(std::vector<T> &v, size_t n)
+    {
+        v.erase(v.begin(), v.begin() + std::min(n, v.size()));
+    }
+}
+
+PhaseVocoder::PhaseVocoder(size_t channels, size_t fftSize)
+    : channels(channels),
+      fftSize(fftSize),
+      synthesisHop(fftSize / OVERLAP),
+      fft(fftSize)
+{
+    if (channels < 1 || channels > 2)
+    {
+        throw std::invalid_argument("PhaseVocoder: channels must be 1 or 2.");
+    }
+    // periodic Hann, applied at both analysis and synthesis.
+    window.resize(fftSize);
+    for (size_t i = 0; i < fftSize; ++i)
+    {
+        window[i] = (float)(0.5 - 0.5 * std::cos(2 * Pi * i / fftSize));
+    }
+    // sum of overlapped Hann^2 windows is 3/8 * fftSize / synthesisHop.
+    olaScale = (float)(synthesisHop / (fftSize * 3.0 / 8.0));
+
+    size_t half = fftSize / 2 + 1;
+    frame.resize(fftSize);
+    spectrum.resize(fftSize);
+    magnitude.resize(half);
+    analysisPhase.resize(half);
+    peaks.reserve(half);
+    for (size_t c = 0; c < 2; ++c)
+    {
+        channelSpectrum[c].resize(half);
+        lastAnalysisPhase[c].resize(half);
+        synthesisPhase[c].resize(half);
+    }
+    SetRate(1.0, 1.0);
+}
+
+void PhaseVocoder::SetRate(double speed, double pitch)
+{
+    if (speed <= 0 || pitch <= 0)
+    {
+        throw std::invalid_argument("PhaseVocoder: invalid rate.");
+    }
+    this->speed = speed;
+    this->pitch = pitch;
+    this->analysisHop = synthesisHop * speed / pitch;
+    Reset();
+}
+
+void PhaseVocoder::ChangeRate(double speed, double pitch)
+{
+    if (speed <= 0 || pitch <= 0)
+    {
+        throw std::invalid_argument("PhaseVocoder: invalid rate.");
+    }
+    // Phase propagation uses the actual distance between analysis frames, and the resampler
+    // just changes step, so neither needs to be reset.
+    rateChangeOutputFrames += (inputFrames - rateChangeInputFrames) / this->speed;
+    rateChangeInputFrames = inputFrames;
+    this->speed = speed;
+    this->pitch = pitch;
+    this->analysisHop = synthesisHop * speed / pitch;
+}
+
+void PhaseVocoder::Reset()
+{
+    // Prime the input with a frame of silence so that the first analysis frame is centered
+    // before the start of the stream, and discard the corresponding stretched output.
+    // A window centered at input x maps to (x - N/2) * Hs / Ha + N/2.
+    size_t prime = fftSize;
+    for (size_t c = 0; c < 2; ++c)
+    {
+        input[c].assign(prime, 0.0f);
+        ola[c].assign(fftSize, 0.0f);
+        stretched[c].clear();
+        std::fill(lastAnalysisPhase[c].begin(), lastAnalysisPhase[c].end(), 0.0);
+        std::fill(synthesisPhase[c].begin(), synthesisPhase[c].end(), 0.0);
+    }
+    stretchedDiscard = (size_t)std::round((prime - fftSize / 2.0) * synthesisHop / analysisHop + fftSize / 2.0);
+    analysisPos = 0;
+    lastFrameStart = -1;
+    resamplePos = 0;
+    inputFrames = 0;
+    rateChangeInputFrames = 0;
+    rateChangeOutputFrames = 0;
+    stretchedProduced = 0;
+    outputProduced = 0;
+    ended = false;
+    firstFrame = true;
+}
+
+void PhaseVocoder::Write(const float *const *data, size_t frames)
+{
+    for (size_t c = 0; c < channels; ++c)
+    {
+        input[c].insert(input[c].end(), data[c], data[c] + frames);
+    }
+    inputFrames += frames;
+
+    while ((size_t)std::round(analysisPos) + fftSize <= input[0].size())
+    {
+        ProcessFrame();
+    }
+    Compact();
+}
+
+void PhaseVocoder::WriteEnd()
+{
+    if (ended)
+    {
+        return;
+    }
+    // enough trailing silence to flush the last input sample through the overlap-add at any rate.
+    size_t tail = fftSize * 2 + (size_t)std::ceil(analysisHop);
+    for (size_t c = 0; c < channels; ++c)
+    {
+        input[c].insert(input[c].end(), tail, 0.0f);
+    }
+    while ((size_t)std::round(analysisPos) + fftSize <= input[0].size())
+    {
+        ProcessFrame();
+    }
+    Compact();
+    ended = true;
+}
+
+void PhaseVocoder::Compact()
+{
+    size_t consumed = (size_t)std::floor(analysisPos);
+    if (consumed > fftSize * 4)
+    {
+        for (size_t c = 0; c < channels; ++c)
+        {
+            EraseFront(input[c], consumed);
+        }
+        analysisPos -= consumed;
+        lastFrameStart -= (int64_t)consumed;
+    }
+}
+
+void PhaseVocoder::ProcessFrame()
+{
+    int64_t frameStart = (int64_t)std::round(analysisPos);
+    double hop = firstFrame ? analysisHop : (double)(frameStart - lastFrameStart);
+    if (hop < 1)
+    {
+        hop = 1;
+    }
+
+    const float *inL = input[0].data() + frameStart;
+    const float *inR = channels > 1 ? input[1].data() + frameStart : nullptr;
+    for (size_t i = 0; i < fftSize; ++i)
+    {
+        frame[i] = complex_t(inL[i] * window[i], inR ? inR[i] * window[i] : 0.0f);
+    }
+    fft.Forward(frame, spectrum);
+
+    size_t half = fftSize / 2;
+    if (channels == 1)
+    {
+        for (size_t k = 0; k <= half; ++k)
+        {
+            channelSpectrum[0][k] = spectrum[k];
+        }
+        ProcessChannel(channelSpectrum[0], 0, hop);
+        for (size_t k = 0; k <= half; ++k)
+        {
+            spectrum[k] = channelSpectrum[0][k];
+        }
+        for (size_t k = 1; k < half; ++k)
+        {
+            spectrum[fftSize - k] = std::conj(channelSpectrum[0][k]);
+        }
+    }
+    else
+    {
+        // unpack two real signals from one complex transform.
+        for (size_t k = 0; k <= half; ++k)
+        {
+            complex_t a = spectrum[k];
+            complex_t b = std::conj(spectrum[(fftSize - k) & (fftSize - 1)]);
+            channelSpectrum[0][k] = (a + b) * 0.5;
+            channelSpectrum[1][k] = (a - b) * complex_t(0, -0.5);
+        }
+        ProcessChannel(channelSpectrum[0], 0, hop);
+        ProcessChannel(channelSpectrum[1], 1, hop);
+        const complex_t I(0, 1);
+        for (size_t k = 0; k <= half; ++k)
+        {
+            spectrum[k] = channelSpectrum[0][k] + I * channelSpectrum[1][k];
+        }
+        for (size_t k = 1; k < half; ++k)
+        {
+            spectrum[fftSize - k] = std::conj(channelSpectrum[0][k]) + I * std::conj(channelSpectrum[1][k]);
+        }
+    }
+    fft.Backward(spectrum, frame);
+
+    for (size_t c = 0; c < channels; ++c)
+    {
+        float *p = ola[c].data();
+        for (size_t i = 0; i < fftSize; ++i)
+        {
+            float v = (float)(c == 0 ? frame[i].real() : frame[i].imag());
+            p[i] += v * window[i] * olaScale;
+        }
+        // the first synthesisHop samples are complete.
+        size_t n = synthesisHop;
+        size_t skip = 0;
+        if (stretchedProduced < stretchedDiscard)
+        {
+            skip = std::min(n, stretchedDiscard - stretchedProduced);
+        }
+        stretched[c].insert(stretched[c].end(), p + skip, p + n);
+        std::copy(p + n, p + fftSize, p);
+        std::fill(p + fftSize - n, p + fftSize, 0.0f);
+    }
+    stretchedProduced += synthesisHop;
+
+    firstFrame = false;
+    lastFrameStart = frameStart;
+    analysisPos += analysisHop;
+}
+
+void PhaseVocoder::ProcessChannel(std::vector<complex_t> &bins, size_t channel, double hop)
+{
+    size_t half = fftSize / 2;
+    std::vector<double> &lastPhase = lastAnalysisPhase[channel];
+    std::vector<double> &synthPhase = synthesisPhase[channel];
+
+    // StagedFft's forward transform uses a positive exponent, so phase advances negatively
+    // with time. Work with negated phases.
+    for (size_t k = 0; k <= half; ++k)
+    {
+        magnitude[k] = std::abs(bins[k]);
+        analysisPhase[k] = -std::arg(bins[k]);
+    }
+    if (firstFrame)
+    {
+        for (size_t k = 0; k <= half; ++k)
+        {
+            synthPhase[k] = analysisPhase[k];
+        }
+    }
+    else
+    {
+        // identity phase locking: propagate phase at spectral peaks, and lock the
+        // surrounding bins to their peak's phase.
+        peaks.clear();
+        for (size_t k = 1; k < half; ++k)
+        {
+            if (magnitude[k] > magnitude[k - 1] && magnitude[k] >= magnitude[k + 1])
+            {
+                peaks.push_back(k);
+            }
+        }
+        double binFrequency = 2 * Pi / fftSize;
+        auto propagate = [&](size_t k)
+        {
+            double omega = binFrequency * k;
+            double delta = WrapPhase(analysisPhase[k] - lastPhase[k] - omega * hop);
+            synthPhase[k] = WrapPhase(synthPhase[k] + (omega + delta / hop) * synthesisHop);
+        };
+        if (peaks.empty())
+        {
+            for (size_t k = 0; k <= half; ++k)
+            {
+                propagate(k);
+            }
+        }
+        else
+        {
+            for (size_t peak : peaks)
+            {
+                propagate(peak);
+            }
+            size_t region = 0;
+            for (size_t k = 0; k <= half; ++k)
+            {
+                while (region + 1 < peaks.size() && k > (peaks[region] + peaks[region + 1]) / 2)
+                {
+                    ++region;
+                }
+                size_t peak = peaks[region];
+                if (k != peak)
+                {
+                    synthPhase[k] = synthPhase[peak] + analysisPhase[k] - analysisPhase[peak];
+                }
+            }
+        }
+    }
+    for (size_t k = 0; k <= half; ++k)
+    {
+        lastPhase[k] = analysisPhase[k];
+        bins[k] = std::polar(magnitude[k], -synthPhase[k]);
+    }
+    // DC and Nyquist must stay real.
+    bins[0] = complex_t(bins[0].real(), 0);
+    bins[half] = complex_t(bins[half].real(), 0);
+}
+
+size_t PhaseVocoder::TotalOutput() const
+{
+    return (size_t)std::floor(rateChangeOutputFrames + (inputFrames - rateChangeInputFrames) / speed);
+}
+
+size_t PhaseVocoder::ResampledAvailable() const
+{
+    // cubic interpolation needs one sample of history and two of lookahead.
+    double last = (double)stretched[0].size() - 3;
+    if (last < resamplePos)
+    {
+        return 0;
+    }
+    return (size_t)std::floor((last - resamplePos) / pitch) + 1;
+}
+
+size_t PhaseVocoder::Read(float *const *output, size_t frames)
+{
+    size_t limit = frames;
+    if (ended)
+    {
+        size_t totalOutput = TotalOutput();
+        limit = std::min(limit, totalOutput - std::min(totalOutput, outputProduced));
+    }
+
+    size_t n;
+    if (pitch == 1.0)
+    {
+        n = std::min(limit, stretched[0].size());
+        for (size_t c = 0; c < channels; ++c)
+        {
+            std::copy(stretched[c].begin(), stretched[c].begin() + n, output[c]);
+            EraseFront(stretched[c], n);
+        }
+    }
+    else
+    {
+        n = std::min(limit, ResampledAvailable());
+        for (size_t c = 0; c < channels; ++c)
+        {
+            const float *s = stretched[c].data();
+            float *out = output[c];
+            double pos = resamplePos;
+            for (size_t i = 0; i < n; ++i)
+            {
+                size_t ix = (size_t)pos;
+                float t = (float)(pos - ix);
+                float y0 = ix == 0 ? s[0] : s[ix - 1];
+                float y1 = s[ix];
+                float y2 = s[ix + 1];
+                float y3 = s[ix + 2];
+                // Catmull-Rom
+                float c1 = 0.5f * (y2 - y0);
+                float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+                float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+                out[i] = ((c3 * t + c2) * t + c1) * t + y1;
+                pos += pitch;
+            }
+        }
+        resamplePos += n * pitch;
+        size_t consumed = (size_t)resamplePos;
+        if (consumed > 1)
+        {
+            consumed -= 1; // keep one sample of history.
+            for (size_t c = 0; c < channels; ++c)
+            {
+                EraseFront(stretched[c], consumed);
+            }
+            resamplePos -= consumed;
+        }
+    }
+    outputProduced += n;
+    return n;
+}
+
+bool PhaseVocoder::IsFinished() const
+{
+    if (!ended)
+    {
+        return false;
+    }
+    size_t totalOutput = TotalOutput();
+    if (outputProduced >= totalOutput)
+    {
+        return true;
+    }
+    return pitch == 1.0 ? stretched[0].empty() : ResampledAvailable() == 0;
+}
@@ -0,0 +1,122 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include "StagedFft.hpp"
+
+namespace LsNumerics
+{
+    // Streaming time-stretch and pitch-shift.
+    //
+    // A phase vocoder with identity phase locking (Laroche & Dolson) stretches the input by
+    // pitch/speed; the result is then resampled by `pitch` (cubic Hermite), giving a net
+    // duration change of 1/speed and a pitch change of `pitch`. Stereo input is processed with
+    // one complex FFT per frame by packing the two channels as real and imaginary parts.
+    //
+    // Not realtime-safe. Intended for use on a background reader thread, which pushes decoded
+    // input with Write() and pulls output with Read().
+    class PhaseVocoder
+    {
+    public:
+        using complex_t = std::complex<double>;
+
+        static constexpr size_t DEFAULT_FFT_SIZE = 2048;
+        static constexpr size_t OVERLAP = 4;
+
+        PhaseVocoder(size_t channels, size_t fftSize = DEFAULT_FFT_SIZE);
+
+        // speed: playback speed (0.5 = half speed). pitch: frequency ratio (2.0 = up one octave).
+        // Resets the stream.
+        void SetRate(double speed, double pitch);
+        // Change the rate mid-stream, without resetting. Input that has already been written
+        // but not yet analyzed is played at the new rate.
+        void ChangeRate(double speed, double pitch);
+        double GetSpeed() const { return speed; }
+        double GetPitch() const { return pitch; }
+
+        void Reset();
+
+        // input[1] is ignored for mono streams.
+        void Write(const float *const *input, size_t frames);
+        // Signal end of input. Remaining output can then be drained with Read().
+        void WriteEnd();
+
+        // Returns the number of frames produced, which may be less than `frames` if more input is required.
+        size_t Read(float *const *output, size_t frames);
+
+        // True once WriteEnd() has been called and all output has been read.
+        bool IsFinished() const;
+
+    private:
+        void ProcessFrame();
+        void ProcessChannel(std::vector<complex_t> &spectrum, size_t channel, double analysisHop);
+        size_t ResampledAvailable() const;
+        size_t TotalOutput() const;
+        void Compact();
+
+        size_t channels;
+        size_t fftSize;
+        size_t synthesisHop;
+        double speed = 1.0;
+        double pitch = 1.0;
+        double analysisHop;
+
+        StagedFft fft;
+        std::vector<float> window;
+        float olaScale;
+
+        // input fifo. analysisPos is relative to the start of the fifo.
+        std::vector<float> input[2];
+        double analysisPos = 0;
+        int64_t lastFrameStart = -1;
+
+        // overlap-add accumulator, and stretched (pre-resampling) output.
+        std::vector<float> ola[2];
+        std::vector<float> stretched[2];
+        double resamplePos = 0;
+        size_t stretchedDiscard = 0;
+
+        // total output expected, given the input written so far, and the rate changes along the way.
+        size_t inputFrames = 0;
+        size_t rateChangeInputFrames = 0;
+        double rateChangeOutputFrames = 0;
+        size_t stretchedProduced = 0;
+        size_t outputProduced = 0;
+        bool ended = false;
+
+        std::vector<complex_t> frame;
+        std::vector<complex_t> spectrum;
+        std::vector<complex_t> channelSpectrum[2];
+        std::vector<double> magnitude;
+        std::vector<double> analysisPhase;
+        std::vector<double> lastAnalysisPhase[2];
+        std::vector<double> synthesisPhase[2];
+        std::vector<size_t> peaks;
+        bool firstFrame = true;
+    };
+}
@@ -0,0 +1,265 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "PhaseVocoder.hpp"
+#include "../TestAssert.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace LsNumerics;
+using namespace std;
+
+static constexpr double SAMPLE_RATE = 48000;
+
+struct StereoSignal
+{
+    vector<float> left;
+    vector<float> right;
+};
+
+static StereoSignal MakeSignal(size_t frames, double frequency)
+{
+    StereoSignal result;
+    result.left.resize(frames);
+    result.right.resize(frames);
+    for (size_t i = 0; i < frames; ++i)
+    {
+        result.left[i] = (float)(0.5 * std::sin(2 * Pi * frequency * i / SAMPLE_RATE));
+        result.right[i] = (float)(0.25 * std::sin(2 * Pi * frequency * 1.5 * i / SAMPLE_RATE));
+    }
+    return result;
+}
+
+// Optionally changes the rate in place once `changeAt` input frames have been written.
+static StereoSignal Process(
+    PhaseVocoder &vocoder, const StereoSignal &input, size_t blockSize,
+    size_t changeAt = SIZE_MAX, double newSpeed = 1.0, double newPitch = 1.0)
+{
+    StereoSignal output;
+    vector<float> bufferL(blockSize * 4), bufferR(blockSize * 4);
+    float *outputBuffers[2] = {bufferL.data(), bufferR.data()};
+
+    auto drain = [&]()
+    {
+        while (true)
+        {
+            size_t n = vocoder.Read(outputBuffers, bufferL.size());
+            if (n == 0)
+                break;
+            output.left.insert(output.left.end(), bufferL.begin(), bufferL.begin() + n);
+            output.right.insert(output.right.end(), bufferR.begin(), bufferR.begin() + n);
+        }
+    };
+    for (size_t i = 0; i < input.left.size(); i += blockSize)
+    {
+        if (i == changeAt)
+        {
+            vocoder.ChangeRate(newSpeed, newPitch);
+        }
+        size_t n = std::min(blockSize, input.left.size() - i);
+        const float *inputBuffers[2] = {input.left.data() + i, input.right.data() + i};
+        vocoder.Write(inputBuffers, n);
+        drain();
+    }
+    vocoder.WriteEnd();
+    drain();
+    TEST_ASSERT(vocoder.IsFinished());
+    return output;
+}
+
+static double MeasureFrequency(const vector<float> &signal, size_t start, size_t end)
+{
+    size_t crossings = 0;
+    size_t first = 0, last = 0;
+    for (size_t i = start + 1; i < end; ++i)
+    {
+        if (signal[i - 1] < 0 && signal[i] >= 0)
+        {
+            if (crossings == 0)
+                first = i;
+            last = i;
+            ++crossings;
+        }
+    }
+    return (crossings - 1) * SAMPLE_RATE / (last - first);
+}
+
+static double MeasureFrequency(const vector<float> &signal)
+{
+    // count rising zero crossings over the middle half, avoiding start-up and tail effects.
+    return MeasureFrequency(signal, signal.size() / 4, signal.size() * 3 / 4);
+}
+
+static double MeasureRms(const vector<float> &signal)
+{
+    size_t start = signal.size() / 4;
+    size_t end = signal.size() * 3 / 4;
+    double sum = 0;
+    for (size_t i = start; i < end; ++i)
+    {
+        sum += signal[i] * signal[i];
+    }
+    return std::sqrt(sum / (end - start));
+}
+
+static void TestIdentity()
+{
+    // unit rates reconstruct the input exactly, with no delay.
+    StereoSignal input = MakeSignal((size_t)SAMPLE_RATE, 440);
+    PhaseVocoder vocoder(2);
+    StereoSignal output = Process(vocoder, input, 4800);
+    TEST_ASSERT(output.left.size() == input.left.size());
+    double maxError = 0;
+    for (size_t i = 0; i < input.left.size(); ++i)
+    {
+        maxError = std::max(maxError, (double)std::abs(output.left[i] - input.left[i]));
+        maxError = std::max(maxError, (double)std::abs(output.right[i] - input.right[i]));
+    }
+    TEST_ASSERT(maxError < 1E-4);
+}
+
+static void TestRate(double speed, double pitch)
+{
+    constexpr double FREQUENCY = 440;
+    StereoSignal input = MakeSignal((size_t)(SAMPLE_RATE * 2), FREQUENCY);
+    PhaseVocoder vocoder(2);
+    vocoder.SetRate(speed, pitch);
+    StereoSignal output = Process(vocoder, input, 4096);
+
+    size_t expectedLength = (size_t)std::floor(input.left.size() / speed);
+    TEST_ASSERT(output.left.size() == expectedLength);
+
+    double frequency = MeasureFrequency(output.left);
+    TEST_ASSERT(std::abs(frequency / (FREQUENCY * pitch) - 1) < 0.005);
+    double rightFrequency = MeasureFrequency(output.right);
+    TEST_ASSERT(std::abs(rightFrequency / (FREQUENCY * 1.5 * pitch) - 1) < 0.005);
+
+    double rms = MeasureRms(output.left);
+    TEST_ASSERT(std::abs(rms / (0.5 / std::sqrt(2.0)) - 1) < 0.1);
+}
+
+static void TestRateChange()
+{
+    // a mid-stream rate change takes effect without a reset: no gap, and no lost or repeated input.
+    constexpr double FREQUENCY = 440;
+    constexpr size_t BLOCK_SIZE = 4800;
+    constexpr double NEW_SPEED = 0.75;
+    const double NEW_PITCH = std::pow(2.0, 4.0 / 12);
+    StereoSignal input = MakeSignal((size_t)(SAMPLE_RATE * 2), FREQUENCY);
+    size_t changeAt = (size_t)SAMPLE_RATE;
+    PhaseVocoder vocoder(2);
+    StereoSignal output = Process(vocoder, input, BLOCK_SIZE, changeAt, NEW_SPEED, NEW_PITCH);
+
+    double expectedLength = changeAt + (input.left.size() - changeAt) / NEW_SPEED;
+    // a reset would discard the input still buffered in the analysis fifo.
+    TEST_ASSERT(std::abs(output.left.size() - expectedLength) <= 1);
+
+    double before = MeasureFrequency(output.left, changeAt / 4, changeAt / 2);
+    TEST_ASSERT(std::abs(before / FREQUENCY - 1) < 0.005);
+    double after = MeasureFrequency(output.left, output.left.size() * 3 / 4, output.left.size() - 4096);
+    TEST_ASSERT(std::abs(after / (FREQUENCY * NEW_PITCH) - 1) < 0.005);
+
+    constexpr size_t WINDOW = 1024;
+    double nominalRms = 0.5 / std::sqrt(2.0);
+    for (size_t i = WINDOW; i + 2 * WINDOW < output.left.size(); i += WINDOW)
+    {
+        double sum = 0;
+        for (size_t j = i; j < i + WINDOW; ++j)
+        {
+            sum += output.left[j] * output.left[j];
+        }
+        double rms = std::sqrt(sum / WINDOW);
+        TEST_ASSERT(rms > nominalRms * 0.7);
+    }
+}
+
+static void Benchmark()
+{
+    using clock_t = std::chrono::steady_clock;
+    constexpr double SECONDS = 30;
+
+    // a chord, so that there is more than one spectral peak per channel.
+    StereoSignal input;
+    size_t frames = (size_t)(SAMPLE_RATE * SECONDS);
+    input.left.resize(frames);
+    input.right.resize(frames);
+    for (size_t i = 0; i < frames; ++i)
+    {
+        double t = i / SAMPLE_RATE;
+        input.left[i] = (float)(0.2 * (std::sin(2 * Pi * 220 * t) + std::sin(2 * Pi * 277.2 * t) + std::sin(2 * Pi * 329.6 * t)));
+        input.right[i] = (float)(0.2 * (std::sin(2 * Pi * 110 * t) + std::sin(2 * Pi * 164.8 * t) + std::sin(2 * Pi * 440 * t)));
+    }
+
+    cout << "PhaseVocoder benchmark (stereo, " << PhaseVocoder::DEFAULT_FFT_SIZE << "-point FFT)" << endl;
+    cout << "   speed   semitones   ms CPU per s of output" << endl;
+    for (double speed : {0.5, 0.75, 1.0, 1.25, 1.5})
+    {
+        for (double semitones : {0.0, 2.0})
+        {
+            if (speed == 1.0 && semitones == 0.0)
+            {
+                continue; // bypassed by the player.
+            }
+            double pitch = std::pow(2.0, semitones / 12);
+            PhaseVocoder vocoder(2);
+            vocoder.SetRate(speed, pitch);
+
+            auto start = clock_t::now();
+            StereoSignal output = Process(vocoder, input, 4800);
+            auto elapsed = std::chrono::duration<double>(clock_t::now() - start).count();
+
+            double outputSeconds = output.left.size() / SAMPLE_RATE;
+            cout << "   " << setw(5) << speed << "   " << setw(9) << semitones << "   "
+                 << fixed << setprecision(2) << setw(8) << (elapsed * 1000 / outputSeconds)
+                 << defaultfloat << setprecision(6) << endl;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        TestIdentity();
+        for (double speed : {0.5, 0.75, 1.25, 1.5})
+        {
+            TestRate(speed, 1.0);
+        }
+        TestRate(1.0, std::pow(2.0, 3.0 / 12));
+        TestRate(0.75, std::pow(2.0, -5.0 / 12));
+        TestRate(1.5, 0.5);
+        TestRateChange();
+        Benchmark();
+    }
+    catch (const std::exception &e)
+    {
+        cerr << "ERROR: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "PiecewiseBlockEvaluator.hpp"
+#include "PiecewiseChebyshevApproximation.hpp"
+#include "CpuFeatures.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace LsNumerics;
+
+namespace
+{
+    constexpr size_t LANES = PiecewiseBlockEvaluator::LANES;
+    typedef float vfloat __attribute__((vector_size(sizeof(float) * LANES)));
+    typedef int32_t vint __attribute__((vector_size(sizeof(int32_t) * LANES)));
+
+    inline vfloat Broadcast(float v)
+    {
+        return vfloat{} + v;
+    }
+
+    constexpr size_t MAX_COEFFICIENTS = PiecewiseBlockEvaluator::MAX_COEFFICIENTS;
+    typedef float row4 __attribute__((vector_size(16)));
+
+    // out[k][lane] = rows[lane][k] for k < COEFFICIENTS: one vector load per row per 4 coefficients,
+    // then a 4x4 transpose.
+    template <size_t COEFFICIENTS>
+    inline void Transpose4(const float *p0, const float *p1, const float *p2, const float *p3, row4 out[MAX_COEFFICIENTS])
+    {
+        for (size_t h = 0; h < COEFFICIENTS; h += 4)
+        {
+            row4 r0, r1, r2, r3;
+            std::memcpy(&r0, p0 + h, sizeof(row4));
+            std::memcpy(&r1, p1 + h, sizeof(row4));
+            std::memcpy(&r2, p2 + h, sizeof(row4));
+            std::memcpy(&r3, p3 + h, sizeof(row4));
+            row4 t0 = __builtin_shufflevector(r0, r1, 0, 4, 1, 5);
+            row4 t1 = __builtin_shufflevector(r2, r3, 0, 4, 1, 5);
+            row4 t2 = __builtin_shufflevector(r0, r1, 2, 6, 3, 7);
+            row4 t3 = __builtin_shufflevector(r2, r3, 2, 6, 3, 7);
+            out[h + 0] = __builtin_shufflevector(t0, t1, 0, 1, 4, 5);
+            out[h + 1] = __builtin_shufflevector(t0, t1, 2, 3, 6, 7);
+            out[h + 2] = __builtin_shufflevector(t2, t3, 0, 1, 4, 5);
+            out[h + 3] = __builtin_shufflevector(t2, t3, 2, 3, 6, 7);
+        }
+    }
+
+    // c[k][lane] = table[index[lane]].c[k] for k < COEFFICIENTS.
+    // (VINT is a template parameter so that the lane indices in the unused branch aren't range-checked.)
+    template <size_t COEFFICIENTS, typename SEGMENT, typename VINT>
+    inline void Transpose(const SEGMENT *table, VINT index, vfloat c[MAX_COEFFICIENTS])
+    {
+        if constexpr (LANES == 4)
+        {
+            Transpose4<COEFFICIENTS>(
+                table[index[0]].c, table[index[1]].c, table[index[2]].c, table[index[3]].c, c);
+        }
+        else if constexpr (LANES == 8)
+        {
+            row4 lo[MAX_COEFFICIENTS], hi[MAX_COEFFICIENTS];
+            Transpose4<COEFFICIENTS>(
+                table[index[0]].c, table[index[1]].c, table[index[2]].c, table[index[3]].c, lo);
+            Transpose4<COEFFICIENTS>(
+                table[index[4]].c, table[index[5]].c, table[index[6]].c, table[index[7]].c, hi);
+            for (size_t k = 0; k < COEFFICIENTS; ++k)
+            {
+                c[k] = __builtin_shufflevector(lo[k], hi[k], 0, 1, 2, 3, 4, 5, 6, 7);
+            }
+        }
+    }
+
+    // Re-express p(u) as q(t), where u = 2t-1.
+    std::vector<double> UToT(const Polynomial &polynomial)
+    {
+        std::vector<double> result(polynomial.Size(), 0.0);
+        // Horner in polynomial arithmetic: result = result*(2t-1) + a[k]
+        for (size_t k = polynomial.Size(); k-- != 0;)
+        {
+            for (size_t i = result.size() - 1; i != 0; --i)
+            {
+                result[i] = 2 * result[i - 1] - result[i];
+            }
+            result[0] = polynomial[k] - result[0];
+        }
+        return result;
+    }
+}
+
+PiecewiseBlockEvaluator::PiecewiseBlockEvaluator(const PiecewiseChebyshevApproximation &approximation)
+{
+    size_t segmentCount = approximation.GetSegmentCount();
+    if (segmentCount == 0)
+    {
+        throw std::invalid_argument("Approximation has no segments.");
+    }
+    minValue = (float)approximation.GetMinValue();
+    maxValue = (float)approximation.GetMaxValue();
+    valueToIndexSlope = (float)(segmentCount / (approximation.GetMaxValue() - approximation.GetMinValue()));
+    maxSegment = (int32_t)(segmentCount - 1);
+
+    minSlope = (float)approximation.DerivativeAt(approximation.GetMinValue());
+    maxSlope = (float)approximation.DerivativeAt(approximation.GetMaxValue());
+
+    segments.resize(segmentCount);
+    coefficientCount = 0;
+    for (size_t i = 0; i < segmentCount; ++i)
+    {
+        const Polynomial &polynomial = approximation.GetSegment(i).GetPolynomial();
+        if (polynomial.Size() > MAX_COEFFICIENTS)
+        {
+            throw std::invalid_argument("Polynomial order is too high.");
+        }
+        coefficientCount = std::max(coefficientCount, polynomial.Size());
+
+        std::vector<double> t = UToT(polynomial);
+        Segment &segment = segments[i];
+        for (size_t k = 0; k < MAX_COEFFICIENTS; ++k)
+        {
+            segment.c[k] = k < t.size() ? (float)t[k] : 0.0f;
+        }
+    }
+}
+
+float PiecewiseBlockEvaluator::At(float x) const
+{
+    float result;
+    Process(&x, &result, 1);
+    return result;
+}
+
+// always_inline, so that each LS_KERNEL_CLONES version of Process() gets its own specialization.
+template <size_t COEFFICIENTS>
+__attribute__((always_inline)) inline void PiecewiseBlockEvaluator::Process(
+    const float *input, float *output, size_t n,
+    float inputScale, float inputOffset,
+    float outputOffset, float outputScale) const
+{
+    const Segment *table = segments.data();
+    const vfloat vMin = Broadcast(minValue);
+    const vfloat vMax = Broadcast(maxValue);
+    const vfloat vSlope = Broadcast(valueToIndexSlope);
+    const vfloat vMinSlope = Broadcast(minSlope);
+    const vfloat vMaxSlope = Broadcast(maxSlope);
+    const vint vMaxSegment = vint{} + maxSegment;
+
+    auto evaluate = [&](vfloat x) -> vfloat
+    {
+        x = x * inputScale + inputOffset;
+
+        vfloat xc = x < vMin ? vMin : x;
+        xc = xc > vMax ? vMax : xc;
+        vfloat s = (xc - vMin) * vSlope;
+        vint index = __builtin_convertvector(s, vint); // s >= 0, so truncation is floor.
+        index = index > vMaxSegment ? vMaxSegment : index;
+        vfloat t = s - __builtin_convertvector(index, vfloat);
+
+        vfloat c[MAX_COEFFICIENTS];
+        Transpose<COEFFICIENTS>(table, index, c);
+
+        vfloat y = c[COEFFICIENTS - 1];
+        for (size_t k = COEFFICIENTS - 1; k-- != 0;)
+        {
+            y = y * t + c[k];
+        }
+        vfloat extrapolation = x - xc;
+        y += extrapolation * (x < vMin ? vMinSlope : vMaxSlope);
+
+        return (y + outputOffset) * outputScale;
+    };
+
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES)
+    {
+        vfloat x;
+        std::memcpy(&x, input + i, sizeof(x));
+        vfloat y = evaluate(x);
+        std::memcpy(output + i, &y, sizeof(y));
+    }
+    if (i != n)
+    {
+        vfloat x = vfloat{};
+        for (size_t j = 0; j < n - i; ++j)
+        {
+            x[j] = input[i + j];
+        }
+        vfloat y = evaluate(x);
+        for (size_t j = 0; j < n - i; ++j)
+        {
+            output[i + j] = y[j];
+        }
+    }
+}
+
+LS_KERNEL_CLONES
+void PiecewiseBlockEvaluator::Process(
+    const float *input, float *output, size_t n,
+    float inputScale, float inputOffset,
+    float outputOffset, float outputScale) const
+{
+    // Horner evaluation needs a compile-time coefficient count to keep the coefficients in registers.
+    switch (coefficientCount)
+    {
+    case 1: Process<1>(input, output, n, inputScale, inputOffset, outputOffset, outputScale); break;
+    case 2: Process<2>(input, output, n, inputScale, inputOffset, outputOffset, outputScale); break;
+    case 3: Process<3>(input, output, n, inputScale, inputOffset, outputOffset, outputScale); break;
+    case 4: Process<4>(input, output, n, inputScale, inputOffset, outputOffset, outputScale); break;
+    case 5: Process<5>(input, output, n, inputScale, inputOffset, outputOffset, outputScale); break;
+    case 6: Process<6>(input, output, n, inputScale, inputOffset, outputOffset, outputScale); break;
+    case 7: Process<7>(input, output, n, inputScale, inputOffset, outputOffset, outputScale); break;
+    default: Process<8>(input, output, n, inputScale, inputOffset, outputOffset, outputScale); break;
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LsNumerics
+{
+    class PiecewiseChebyshevApproximation;
+
+    /*
+        Block evaluator for a PiecewiseChebyshevApproximation.
+
+        PiecewiseChebyshevApproximation::At() does a range check, a segment lookup and a
+        double-precision polynomial evaluation per call. This class evaluates the same curve over
+        a buffer, LANES samples at a time:
+
+        - segment indices are computed without branches: x is clamped to the approximation's
+          range, scaled, truncated, and the index clamped to the last segment.
+
+        - each segment's coefficients are stored contiguously (one 32-byte row per segment) so that
+          assembling a lane's coefficients touches a single row, and never a separate table per
+          coefficient.
+
+        - polynomials are re-expressed in t = the fractional position within the segment, so
+          Horner evaluation runs directly on the truncation remainder.
+
+        Values outside the approximation's range are extrapolated linearly using the slope at each
+        end of the range (the same behaviour as TubeStageApproximation::At()).
+
+        Output is (f(x*inputScale+inputOffset)+outputOffset)*outputScale, which lets a gain stage
+        fold its drive, bias and makeup gain into the same pass.
+    */
+    class PiecewiseBlockEvaluator
+    {
+    public:
+#ifdef __AVX__
+        static constexpr size_t LANES = 8;
+#else
+        static constexpr size_t LANES = 4;
+#endif
+        static constexpr size_t MAX_COEFFICIENTS = 8;
+
+        PiecewiseBlockEvaluator() = default;
+        PiecewiseBlockEvaluator(const PiecewiseChebyshevApproximation &approximation);
+
+        // input and output may be the same buffer.
+        void Process(
+            const float *input, float *output, size_t n,
+            float inputScale = 1, float inputOffset = 0,
+            float outputOffset = 0, float outputScale = 1) const;
+
+        // Scalar evaluation with the same arithmetic as Process().
+        float At(float x) const;
+
+    private:
+        template <size_t COEFFICIENTS>
+        void Process(
+            const float *input, float *output, size_t n,
+            float inputScale, float inputOffset,
+            float outputOffset, float outputScale) const;
+
+        struct alignas(32) Segment
+        {
+            float c[MAX_COEFFICIENTS];
+        };
+
+        std::vector<Segment> segments;
+        size_t coefficientCount = 0;
+        int32_t maxSegment = 0;
+        float minValue = 0;
+        float maxValue = 0;
+        float valueToIndexSlope = 0;
+        float minSlope = 0;
+        float maxSlope = 0;
+    };
+}
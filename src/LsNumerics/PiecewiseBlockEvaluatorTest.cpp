@@ -0,0 +1,175 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "PiecewiseBlockEvaluator.hpp"
+#include "TubeStageApproximation.hpp"
+#include "../TestAssert.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace LsNumerics;
+
+static std::vector<float> Ramp(double minX, double maxX, size_t n)
+{
+    std::vector<float> result(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        result[i] = (float)(minX + (maxX - minX) * i / (n - 1));
+    }
+    return result;
+}
+
+static void TestTubeStage()
+{
+    std::cout << "    TubeStageApproximation" << std::endl;
+
+    // includes values on both sides of the approximation's range, which are extrapolated.
+    std::vector<float> x = Ramp(-15, 15, 10001);
+    std::vector<float> y(x.size());
+    gTubeStageApproximation.Process(x.data(), y.data(), x.size());
+
+    double maxError = 0;
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        double expected = gTubeStageApproximation.At(x[i]);
+        maxError = std::max(maxError, std::abs(y[i] - expected));
+    }
+    std::cout << "        max error: " << maxError << std::endl;
+    TEST_ASSERT(maxError < 1E-5);
+
+    // scale and offset
+    const float inputScale = 3.5f, inputOffset = -0.7f, outputOffset = 0.25f, outputScale = -1.5f;
+    gTubeStageApproximation.Process(x.data(), y.data(), x.size(), inputScale, inputOffset, outputOffset, outputScale);
+    maxError = 0;
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        double expected = (gTubeStageApproximation.At(x[i] * inputScale + inputOffset) + outputOffset) * outputScale;
+        maxError = std::max(maxError, std::abs(y[i] - expected));
+    }
+    std::cout << "        max error (scaled): " << maxError << std::endl;
+    TEST_ASSERT(maxError < 1E-4);
+}
+
+static void TestBlockSizes()
+{
+    std::cout << "    Block sizes" << std::endl;
+    std::vector<float> x = Ramp(-12, 12, 1000);
+    std::vector<float> expected(x.size());
+    gTubeStageApproximation.Process(x.data(), expected.data(), x.size());
+
+    for (size_t blockSize : {1, 3, 7, 8, 13, 64})
+    {
+        // in place.
+        std::vector<float> y = x;
+        for (size_t i = 0; i < y.size(); i += blockSize)
+        {
+            size_t n = std::min(blockSize, y.size() - i);
+            gTubeStageApproximation.Process(y.data() + i, y.data() + i, n);
+        }
+        for (size_t i = 0; i < y.size(); ++i)
+        {
+            TEST_ASSERT(y[i] == expected[i]);
+        }
+    }
+}
+
+static void TestGenericFunction()
+{
+    std::cout << "    Generic approximation" << std::endl;
+    std::function<double(double)> fn = [](double x)
+    { return std::tanh(x) + 0.1 * x * x; };
+    PiecewiseChebyshevApproximation approximation(fn, -4, 4, 64, 5, false);
+    PiecewiseBlockEvaluator evaluator(approximation);
+
+    std::vector<float> x = Ramp(-4, 4, 4001);
+    std::vector<float> y(x.size());
+    evaluator.Process(x.data(), y.data(), x.size());
+    double maxError = 0;
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        maxError = std::max(maxError, std::abs(y[i] - fn(x[i])));
+        TEST_ASSERT(evaluator.At(x[i]) == y[i]);
+    }
+    std::cout << "        max error: " << maxError << std::endl;
+    TEST_ASSERT(maxError < 1E-5);
+}
+
+static void Benchmark()
+{
+    std::cout << "    Benchmark" << std::endl;
+    const size_t BLOCK_SIZE = 256;
+    const size_t ITERATIONS = 10000;
+    std::vector<float> x(BLOCK_SIZE);
+    for (size_t i = 0; i < BLOCK_SIZE; ++i)
+    {
+        x[i] = (float)(9 * std::sin(i * 0.05));
+    }
+    std::vector<float> y(BLOCK_SIZE);
+    double sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t iteration = 0; iteration < ITERATIONS; ++iteration)
+    {
+        for (size_t i = 0; i < BLOCK_SIZE; ++i)
+        {
+            y[i] = (float)gTubeStageApproximation.At(x[i]);
+        }
+        sum += y[iteration % BLOCK_SIZE];
+    }
+    auto scalarTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t iteration = 0; iteration < ITERATIONS; ++iteration)
+    {
+        gTubeStageApproximation.Process(x.data(), y.data(), BLOCK_SIZE);
+        sum += y[iteration % BLOCK_SIZE];
+    }
+    auto blockTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "        scalar: " << std::chrono::duration<double, std::milli>(scalarTime).count() << "ms"
+              << "  block (" << PiecewiseBlockEvaluator::LANES << " lanes): "
+              << std::chrono::duration<double, std::milli>(blockTime).count() << "ms"
+              << "  (" << sum << ")" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::cout << "PiecewiseBlockEvaluatorTest" << std::endl;
+        TestTubeStage();
+        TestBlockSizes();
+        TestGenericFunction();
+        Benchmark();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
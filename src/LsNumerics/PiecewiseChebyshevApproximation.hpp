@@ -112,6 +112,12 @@ namespace LsNumerics {
 			if (!checkMaxError) throw std::invalid_argument("constructed with calculateMaxError=false");
 			return maxDerivativeError;
 		}
+		double GetMinValue() const { return minValue; }
+		double GetMaxValue() const { return maxValue; }
+		// Number of segments spanning [minValue,maxValue].
+		size_t GetSegmentCount() const { return maxIndex; }
+		const ChebyshevApproximation &GetSegment(size_t index) const { return interpolators[index]; }
+
 		double At(double x) const
 		{
 			if (x < minValue || x > maxValue)
@@ -27,6 +27,8 @@
 #include <limits>
 #include "Window.hpp"
 #include <exception>
+#include <algorithm>
+#include <cmath>
 
 using namespace LsNumerics;
 
@@ -987,12 +989,12 @@ PitchDetector::PitchDetector()
     binPeaks.reserve(MAX_BIN_PEAK);
 }
 
-PitchDetector::PitchDetector(int sampleRate, int bufferSize)
+PitchDetector::PitchDetector(double sampleRate, int bufferSize)
 : PitchDetector()
 {
     Initialize(sampleRate, bufferSize);
 }
-void PitchDetector::Initialize(int sampleRate, int bufferSize)
+void PitchDetector::Initialize(double sampleRate, int bufferSize)
 {
     if (sampleRate > 48000/2) {
         throw std::runtime_error("Must be downsampled to a sample rate of either 24000 or 22050");
@@ -1002,9 +1004,11 @@ void PitchDetector::Initialize(int sampleRate, int bufferSize)
     this->bufferSize = bufferSize;
     this->autoCorrelationFftSize = bufferSize*2; // extra for zero-padding.
     this->fftPlan.SetSize(autoCorrelationFftSize);
+    this->ifFftPlan.SetSize(bufferSize);
 
     //this->window = Window::Hann<double>(bufferSize); // Grandke interpolation REQUIRES a Hann window.
     this->window = Window::Rect<double>(bufferSize);
+    this->ifWindow = Window::Hann<double>(bufferSize);
 
     allocateBuffers();
     // f = this->sampleRate/(cepstrumIndex)
@@ -1013,24 +1017,29 @@ void PitchDetector::Initialize(int sampleRate, int bufferSize)
 
 }
 
-PitchDetector::PitchDetector(int sampleRate)
+PitchDetector::PitchDetector(double sampleRate)
 : PitchDetector()
 {
 
     Initialize(sampleRate);
 }
 
-void PitchDetector::Initialize(int sampleRate)
+void PitchDetector::Initialize(double sampleRate)
 {
-    Initialize(sampleRate,4096);
+    // about 170ms of audio.
+    Initialize(sampleRate,(int)NextPowerOfTwo((uint32_t)(sampleRate*0.17)));
 }
 
 void PitchDetector::allocateBuffers()
 {
     this->inputBuffer.resize(autoCorrelationFftSize);
-    this->fftBuffer.resize(autoCorrelationFftSize);
+    this->fftBuffer.resize(fftPlan.GetSpectrumSize());
     this->cepstrumBuffer.resize(autoCorrelationFftSize);
     this->cepstrum.resize(bufferSize);
+    this->ifInputBuffer.resize(bufferSize);
+    this->ifFftBuffer.resize(ifFftPlan.GetSpectrumSize());
+    this->lastFftBuffer.resize(ifFftPlan.GetSpectrumSize());
+    this->lastFftValid = false;
 
 }
 
@@ -1210,16 +1219,173 @@ double PitchDetector::getGrandkeEstimate(double minFrequency, double maxFrequenc
 
 double PitchDetector::ifPhase(size_t bin)
 {
-    std::complex<double> t = fftBuffer[bin] / lastFftBuffer[bin];
+    // StagedFft's forward transform uses a positive exponent, so phase advances are negated.
+    std::complex<double> t = lastFftBuffer[bin] * std::conj(ifFftBuffer[bin]);
 
     double phase = atan2(t.imag(), t.real());
     return phase / Pi;
 }
 
-inline std::complex<double> sq(std::complex<double> v)
+double PitchDetector::detectPitchIncremental(const float *signal, size_t hopSamples)
 {
-    return v*v;
+    for (size_t i = 0; i < bufferSize; ++i)
+    {
+        inputBuffer[i] = window[i] * signal[i];
+        ifInputBuffer[i] = ifWindow[i] * signal[i];
+    }
+    double frequency = detectPitchAutocorrelation();
+
+    ifFftPlan.Forward(ifInputBuffer, ifFftBuffer);
+    if (frequency != 0)
+    {
+        frequency = refinePitch(frequency, (lastFftValid && hopSamples <= bufferSize / 2) ? hopSamples : 0);
+    }
+    std::swap(ifFftBuffer, lastFftBuffer);
+    lastFftValid = true;
+    return frequency;
+}
+
+double PitchDetector::detectPitchAutocorrelation()
+{
+    // Coarse estimate from the autocorrelation: the first peak that is nearly as large as the
+    // largest peak. Unlike the squared autocorrelation used by detectPitch(), this isn't thrown
+    // by strong 2nd harmonics.
+    constexpr double PEAK_THRESHOLD = 0.8;
+    constexpr double MINIMUM_CLARITY = 0.3;
+
+    fftPlan.Forward(inputBuffer, fftBuffer);
+    for (size_t i = 0; i < fftBuffer.size(); ++i)
+    {
+        std::complex<double> t = fftBuffer[i];
+        fftBuffer[i] = t * std::conj(t);
+    }
+    fftPlan.Backward(fftBuffer, cepstrumBuffer);
+
+    double energy = cepstrumBuffer[0];
+    if (energy <= 0)
+    {
+        return 0;
+    }
+    size_t minLag = std::max((size_t)2, (size_t)std::floor(sampleRate / MAXIMUM_DETECTABLE_FREQUENCY));
+    size_t maxLag = std::min(bufferSize / 2, (size_t)std::ceil(sampleRate / MINIMUM_DETECTABLE_FREQUENCY));
+    for (size_t lag = minLag - 1; lag <= maxLag + 1; ++lag)
+    {
+        // unbiased, normalized.
+        cepstrum[lag] = cepstrumBuffer[lag] / energy * bufferSize / (bufferSize - lag);
+    }
+    // Peaks are only a few samples wide at low sample rates, so compare interpolated peak values.
+    auto interpolatedPeak = [this](size_t lag, double *peakLag)
+    {
+        double p0 = cepstrum[lag - 1], p1 = cepstrum[lag], p2 = cepstrum[lag + 1];
+        double curvature = p0 - 2 * p1 + p2;
+        if (curvature >= 0)
+        {
+            *peakLag = lag;
+            return p1;
+        }
+        double offset = 0.5 * (p0 - p2) / curvature;
+        *peakLag = lag + offset;
+        return p1 - 0.25 * (p0 - p2) * offset;
+    };
+    auto isPeak = [this](size_t lag)
+    {
+        return cepstrum[lag] > cepstrum[lag - 1] && cepstrum[lag] >= cepstrum[lag + 1];
+    };
+
+    double bestValue = 0;
+    double peakLag;
+    for (size_t lag = minLag; lag <= maxLag; ++lag)
+    {
+        if (isPeak(lag))
+        {
+            bestValue = std::max(bestValue, interpolatedPeak(lag, &peakLag));
+        }
+    }
+    if (bestValue < MINIMUM_CLARITY)
+    {
+        return 0;
+    }
+    for (size_t lag = minLag; lag <= maxLag; ++lag)
+    {
+        if (isPeak(lag) && interpolatedPeak(lag, &peakLag) >= bestValue * PEAK_THRESHOLD)
+        {
+            return sampleRate / peakLag;
+        }
+    }
+    return 0;
 }
+
+double PitchDetector::refinePitch(double frequency, size_t hopSamples)
+{
+    constexpr int MAX_HARMONIC = 3;
+    constexpr double MAX_CORRECTION_CENTS = 100;
+
+    // Use the strongest of the first few harmonics. The fundamental of a low guitar string is
+    // often weaker than its second or third harmonic.
+    double binsPerHz = (double)bufferSize / sampleRate;
+    size_t bestBin = 0;
+    int bestHarmonic = 0;
+    double bestMagnitude = 0;
+    for (int harmonic = 1; harmonic <= MAX_HARMONIC; ++harmonic)
+    {
+        double f = frequency * harmonic;
+        if (f > MAXIMUM_DETECTABLE_FREQUENCY * 1.2 && harmonic != 1)
+        {
+            break;
+        }
+        // the coarse estimate is good to a couple of percent.
+        size_t centerBin = (size_t)std::round(f * binsPerHz);
+        size_t searchBins = std::max((size_t)1, (size_t)std::round(f * binsPerHz * 0.03));
+        for (size_t bin = std::max(centerBin, searchBins + 1) - searchBins; bin <= centerBin + searchBins; ++bin)
+        {
+            if (bin + 1 >= bufferSize / 2)
+                continue;
+            double magnitude = std::norm(ifFftBuffer[bin]);
+            if (magnitude > bestMagnitude && magnitude > std::norm(ifFftBuffer[bin - 1]) && magnitude >= std::norm(ifFftBuffer[bin + 1]))
+            {
+                bestMagnitude = magnitude;
+                bestBin = bin;
+                bestHarmonic = harmonic;
+            }
+        }
+    }
+    if (bestHarmonic == 0)
+    {
+        return frequency;
+    }
+    // Interpolated peak of the Hann-windowed spectrum. Good to a few percent of a bin, which
+    // puts it well inside the range that the phase advance can resolve.
+    QuadResult quadResult;
+    double f = bestBin / binsPerHz;
+    if (findQuadraticMaximum(
+            (int)bestBin,
+            std::log(std::max(1E-300, std::norm(ifFftBuffer[bestBin - 1]))),
+            std::log(std::max(1E-300, std::norm(ifFftBuffer[bestBin]))),
+            std::log(std::max(1E-300, std::norm(ifFftBuffer[bestBin + 1]))),
+            quadResult))
+    {
+        f = quadResult.x / binsPerHz;
+    }
+
+    if (hopSamples != 0 && std::norm(lastFftBuffer[bestBin]) != 0)
+    {
+        // The phase of every bin in a sinusoid's main lobe advances at the sinusoid's frequency.
+        // The deviation from the advance expected at f must lie in (-pi,pi], which holds
+        // as long as f is within sampleRate/(2*hop) Hz of the true frequency.
+        double expectedPhase = 2 * Pi * f * hopSamples / sampleRate;
+        double deviation = ifPhase(bestBin) * Pi - expectedPhase;
+        deviation -= 2 * Pi * std::round(deviation / (2 * Pi));
+        f += deviation * sampleRate / (2 * Pi * hopSamples);
+    }
+
+    double refined = f / bestHarmonic;
+    if (std::abs(1200 * std::log2(refined / frequency)) > MAX_CORRECTION_CENTS)
+    {
+        return frequency;
+    }
+    return refined;
+}
+
 double PitchDetector::detectPitch()
 {
 
@@ -1229,7 +1395,7 @@ double PitchDetector::detectPitch()
     {
         while (start < bufferSize)
         {
-            if (inputBuffer[start].real() <= 0 && inputBuffer[start+1].real() > 0)
+            if (inputBuffer[start] <= 0 && inputBuffer[start+1] > 0)
             {
                 ++start;
                 break;
@@ -1238,7 +1404,7 @@ double PitchDetector::detectPitch()
         }
         while (end > start)
         {
-            if (inputBuffer[end-1].real() <= 0 && inputBuffer[end].real() > 0) 
+            if (inputBuffer[end-1] <= 0 && inputBuffer[end] > 0) 
             {
                 break;
             }
@@ -1271,7 +1437,7 @@ double PitchDetector::detectPitch()
     fftPlan.Forward(inputBuffer, fftBuffer);
 
 
-    for (size_t i = 0; i < autoCorrelationFftSize; ++i)
+    for (size_t i = 0; i < fftBuffer.size(); ++i)
     {
         std::complex<double> t = fftBuffer[i];
         fftBuffer[i] = t * std::conj(t);
@@ -1281,8 +1447,8 @@ double PitchDetector::detectPitch()
     //double frameSize = end-start;
     for (size_t i = 0; i < cepstrum.size(); ++i)
     {
-        complex t = cepstrumBuffer[i];
-        double v = sq(t).real();
+        double t = cepstrumBuffer[i];
+        double v = t*t;
         cepstrum[i] = v;
     }
 
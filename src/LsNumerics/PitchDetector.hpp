@@ -24,9 +24,10 @@
 /********************************************************
  * class PitchDetector - pitch detector optimized for use as in a guitar tuner.
  *
- * PitchDetector currently only works with a sample rate of 22050, or 24000hz.
- * (There are manually fittted adjustments that improve pitch accuracy which
- * currently can't be accounted for in closed form).
+ * detectPitch() was tuned at sample rates of 22050, or 24000hz.
+ * detectPitchIncremental() is intended for heavily decimated input (4kHz to
+ * 6kHz; see Decimator), where the coarse autocorrelation estimate is refined
+ * using the phase advance between successive frames.
  *
  * Downssampling is neccessary both for efficiency and stability. Running
  * pitch detection at higher sample rates does not increase accuracy,
@@ -49,7 +50,7 @@
 #pragma once
 
 #include <cstdint>
-#include "Fft.hpp"
+#include "StagedFft.hpp"
 #include <vector>
 #include "LsMath.hpp"
 
@@ -90,7 +91,8 @@ namespace LsNumerics
      */
     class PitchDetector
     {
-        Fft fftPlan;
+        StagedRealFft fftPlan;
+        StagedRealFft ifFftPlan;
 
     private:
         size_t bufferSize = -1;
@@ -108,7 +110,7 @@ namespace LsNumerics
 
         using complex = std::complex<double>;
 
-        int sampleRate;
+        double sampleRate;
         std::vector<complex> stagingBuffer;
 
     public:
@@ -116,12 +118,17 @@ namespace LsNumerics
 
     private:
         WindowT window;
-        std::vector<complex> inputBuffer;
+        std::vector<double> inputBuffer;
         std::vector<complex> fftBuffer;
-        std::vector<complex> cepstrumBuffer;
+        std::vector<double> cepstrumBuffer;
         std::vector<double> cepstrum;
 
+        // Hann-windowed spectra of the current and previous frames, for instantaneous-frequency refinement.
+        WindowT ifWindow;
+        std::vector<double> ifInputBuffer;
+        std::vector<complex> ifFftBuffer;
         std::vector<complex> lastFftBuffer;
+        bool lastFftValid = false;
 
         struct BinPeak {
             size_t index;
@@ -158,7 +165,8 @@ namespace LsNumerics
         /**
          * @brief Initialize the pitch detector.
          * 
-         * PitchDetector will choose the optimum FFT size for the selected sample rate.
+         * PitchDetector will choose the optimum FFT size for the selected sample rate (about 170ms
+         * of audio: 4096 samples at 24000Hz, 1024 samples at 6000Hz).
          * 
          * For best results, choose a sample rate of either 22050 or 24000, and downsample 
          * (decimate) audio data when detecting pitch. 
@@ -168,7 +176,7 @@ namespace LsNumerics
          * 
          * @param sampleRate Audio sample rate.
          */
-        void Initialize(int sampleRate);
+        void Initialize(double sampleRate);
 
         /**
          * @brief Initialize the pitch detector with an explicit FFT size.
@@ -180,7 +188,7 @@ namespace LsNumerics
          * @param sampleRate 
          * @param fftSize 
          */
-        void Initialize(int sampleRate, int fftSize);
+        void Initialize(double sampleRate, int fftSize);
 
     public:
         
@@ -197,7 +205,7 @@ namespace LsNumerics
          * @param sampleRate sample rate.
          */
 
-        PitchDetector(int sampleRate);
+        PitchDetector(double sampleRate);
 
         /**
          * @brief Construct a new Pitch Detector object with an explicit FFT size.
@@ -208,7 +216,7 @@ namespace LsNumerics
          * @param sampleRate audio sample rate.
          * @param fftSize size of the FFT.
          */
-        PitchDetector(int sampleRate, int fftSize);
+        PitchDetector(double sampleRate, int fftSize);
 
         
         /**
@@ -284,6 +292,30 @@ namespace LsNumerics
             return debias(detectPitch());
         }
 
+        /**
+         * @brief Detect pitch from a sliding sequence of frames.
+         * 
+         * Each call supplies the most recent getFftSize() samples, and the number of samples 
+         * that the signal has advanced since the previous call. The spectrum of the previous frame is
+         * kept, and the phase advance of the strongest low harmonic between the two frames refines the
+         * coarse autocorrelation estimate. That makes the result accurate at low (decimated) sample 
+         * rates, where the autocorrelation peak is only a few samples wide.
+         * 
+         * The refinement is skipped for the first frame after resetIncremental(), and when 
+         * hopSamples is zero or larger than getFftSize()/2. Hops of getFftSize()/4 or less
+         * work best.
+         * 
+         * @param signal getFftSize() samples of audio.
+         * @param hopSamples Number of samples between the start of the previous frame and the start of this one.
+         * @return double Frequency in Hz, or zero if no pitch was detected.
+         */
+        double detectPitchIncremental(const float *signal, size_t hopSamples);
+
+        /**
+         * @brief Discard the previous frame used by detectPitchIncremental().
+         */
+        void resetIncremental() { lastFftValid = false; }
+
         double detectPitchNoDebias(const float *signal)
         {
             for (size_t i = 0; i < bufferSize; ++i)
@@ -295,6 +327,8 @@ namespace LsNumerics
 
     private:
         double ifPhase(size_t bin);
+        double detectPitchAutocorrelation();
+        double refinePitch(double frequency, size_t hopSamples);
         double detectPitch();
         double debias(double frequency);
     public:
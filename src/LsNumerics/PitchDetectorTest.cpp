@@ -474,6 +474,41 @@ void testGuitarSample()
 }
 
 
+static void testIncrementalPitchDetection()
+{
+    // Decimated tuner rates, with strong low harmonics, at 30 updates per second.
+    std::vector<double> sampleRates{{5512.5, 6000, 24000}};
+    for (auto sampleRate : sampleRates)
+    {
+        PitchDetector pitchDetector(sampleRate);
+        size_t fftSize = pitchDetector.getFftSize();
+        size_t hop = (size_t)(sampleRate / 30);
+        cout << "Incremental Fs: " << sampleRate << " fftSize: " << fftSize << endl;
+
+        double maxCents = 0;
+        std::vector<float> buffer(fftSize + hop * 8);
+        for (double f = 82; f < 923; f *= 1.0137)
+        {
+            for (size_t i = 0; i < buffer.size(); ++i)
+            {
+                double phase = 2 * Pi * f * i / sampleRate;
+                buffer[i] = (float)(sin(phase) + 0.5 * sin(2 * phase + 1) + 0.3 * sin(3 * phase + 2) + 0.01 * randDist(randEngine));
+            }
+            pitchDetector.resetIncremental();
+            double fResult = 0;
+            for (size_t frame = 0; frame < 8; ++frame)
+            {
+                fResult = pitchDetector.detectPitchIncremental(&buffer[frame * hop], hop);
+            }
+            TEST_ASSERT(fResult > 0);
+            double cents = std::abs(1200 * std::log2(fResult / f));
+            maxCents = std::max(maxCents, cents);
+        }
+        cout << "   max error: " << maxCents << " cents" << endl;
+        TEST_ASSERT(maxCents < 1.0);
+    }
+}
+
 int main(int argc, char **argv)
 {
 
@@ -495,6 +530,7 @@ int main(int argc, char **argv)
             testGuitarSample();
             fftCheck();
             testPitchDetection();
+            testIncrementalPitchDetection();
         }
     }
     catch (const std::exception &e)
@@ -24,9 +24,18 @@
 
 #include "StagedFft.hpp"
 #include "CacheInfo.hpp"
+#include "CpuFeatures.hpp"
 #include <iostream>
 #include "LsMath.hpp"
+#include "../util.hpp"
 #include <cassert>
+#include <chrono>
+#include <limits>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 
 static constexpr bool disableShuffleOptimization = true;
 
@@ -35,12 +44,23 @@ using namespace LsNumerics::Implementation;
 
 using complex_t = std::complex<double>;
 
-static constexpr size_t maxL2CacheSize = CacheInfo::L2CacheSize / 2;
-static constexpr size_t l2CacheFftSize = maxL2CacheSize / (sizeof(complex_t));
+static size_t FloorPowerOf2(size_t value)
+{
+    size_t result = 1;
+    while (result * 2 <= value)
+    {
+        result *= 2;
+    }
+    return result;
+}
+
+// Largest FFTs whose data fits in half of the L2 cache, and in the L1 data cache of the current processor.
+static size_t maxL2CacheSize = CacheInfo::GetCacheSizes().l2Size / 2;
+static size_t l2CacheFftSize = FloorPowerOf2(maxL2CacheSize / (sizeof(complex_t)));
 static size_t l2Log2CacheSize = log2(l2CacheFftSize);
 
-static constexpr size_t maxL1CacheSize = CacheInfo::L1DataBlockSize;
-static constexpr size_t l1CacheFftSize = maxL1CacheSize / (sizeof(complex_t));
+static size_t maxL1CacheSize = CacheInfo::GetCacheSizes().l1DataSize;
+static size_t l1CacheFftSize = FloorPowerOf2(maxL1CacheSize / (sizeof(complex_t)));
 static size_t l1Log2CacheSize = log2(l1CacheFftSize);
 
 // static inline size_t pow2(size_t x)
@@ -87,15 +107,99 @@ static uint32_t BitReverse(uint32_t value, size_t bits)
 
 void StagedFftPlan::SetSize(size_t size)
 {
+    LoadDefaultWisdom();
+    size_t log2Size = log2(size);
+    std::optional<PlanChoice> wisdomChoice = StagedFftWisdom::GetPlanChoice(log2Size);
+    SetSize(size, wisdomChoice ? *wisdomChoice : DefaultPlanChoice(log2Size));
+}
 
-    ops.resize(0);
-    if (this->fftSize == size)
+StagedFftPlan::PlanChoice StagedFftPlan::DefaultPlanChoice(size_t log2Size)
+{
+    // There are three straegies:
+    // 1) execute sub-DFTs one by one, in order to exploit L1 cache.
+    // 2) execute sub-DFTs one by one, in order to exploit L2 cache.
+    // 3) Shuffle pass data to place data in order so that shuffled stages can be run with modified sub-DFTs
+    //   that will fit in L1 cache again.
+    //
+    // Shuffling requires two extra passes that will destroy the L1 and L2 cache; so one has to choose carefully
+    // whether to use shuffling or explot L2 cache, and take a beating on the last couple of stages. However,
+    // there are huge advantages to operating in L1 cache, especially when FFTs are running concurrently.
+    // Whether to use Shuffles, or L2 cache optimizations is a tuning decision, which StagedFftWisdom
+    // makes by measurement, when wisdom is available.
+
+    // DFTs smaller than one cache block operate within a single cache page, so they should get a huge performance boost.
+    // 9 stages in the DFT(512) operate in a single cache block, on Pi 4, so no fetches for partial cache lines occur,
+    // and there's a significant opportunity for writes in subsequent passes to discard pending writes. The same argument extends
+    // to L2 blocks, where executing sub-DFTs in their entirety avoids spilling the L2 cache.
+    //
+
+    // size_t shuffleLog2CacheSize = l1Log2CacheSize*2;
+
+    bool useShuffle = (!disableShuffleOptimization) && log2Size > l1Log2CacheSize; // + 3;
+
+    if (log2Size > l2Log2CacheSize && !useShuffle)
+    {
+        return PlanChoice{PlanStrategy::Blocked, (uint8_t)l2Log2CacheSize};
+    }
+    else if (log2Size > l1Log2CacheSize)
+    {
+        return PlanChoice{useShuffle ? PlanStrategy::BlockedShuffle : PlanStrategy::Blocked, (uint8_t)l1Log2CacheSize};
+    }
+    return PlanChoice{PlanStrategy::Direct, 0};
+}
+
+std::vector<StagedFftPlan::PlanChoice> StagedFftPlan::CandidatePlanChoices(size_t log2Size)
+{
+    std::vector<PlanChoice> result;
+    result.push_back(PlanChoice{PlanStrategy::Direct, 0});
+
+    // block sizes from a quarter of the L1 block size up to the L2 cache size.
+    size_t minBlockLog2 = l1Log2CacheSize > 4 ? l1Log2CacheSize - 2 : 2;
+    for (size_t blockLog2 = minBlockLog2; blockLog2 <= l2Log2CacheSize && blockLog2 < log2Size; ++blockLog2)
+    {
+        result.push_back(PlanChoice{PlanStrategy::Blocked, (uint8_t)blockLog2});
+    }
+    if (log2Size > l1Log2CacheSize)
+    {
+        result.push_back(PlanChoice{PlanStrategy::BlockedShuffle, (uint8_t)l1Log2CacheSize});
+    }
+    return result;
+}
+
+size_t StagedFftPlan::L1BlockSize()
+{
+    return l1CacheFftSize;
+}
+size_t StagedFftPlan::L2BlockSize()
+{
+    return l2CacheFftSize;
+}
+
+std::string StagedFftPlan::ToString(const PlanChoice &planChoice)
+{
+    switch (planChoice.strategy)
+    {
+    case PlanStrategy::Direct:
+        return "direct";
+    case PlanStrategy::Blocked:
+        return "blocked " + std::to_string(1 << planChoice.blockLog2);
+    case PlanStrategy::BlockedShuffle:
+        return "shuffled " + std::to_string(1 << planChoice.blockLog2);
+    }
+    return "?";
+}
+
+void StagedFftPlan::SetSize(size_t size, const PlanChoice &planChoice)
+{
+    if (this->fftSize == size && this->planChoice == planChoice)
     {
         return;
     }
+    ops.resize(0);
     assert((size & (size - 1)) == 0); // must be power of 2!
 
     this->fftSize = size;
+    this->planChoice = planChoice;
     bitReverse.resize(fftSize);
 
     log2N = log2(fftSize);
@@ -124,79 +228,44 @@ void StagedFftPlan::SetSize(size_t size)
     CalculateTwiddleFactors(Direction::Forward, forwardTwiddle);
     CalculateTwiddleFactors(Direction::Backward, backwardTwiddle);
 
-    // There are three straegies:
-    // 1) execute sub-DFTs one by one, in order to exploit L1 cache.
-    // 2) execute sub-DFTs one by one, in order to exploit L2 cache.
-    // 3) Shuffle pass data to place data in order so that shuffled stages can be run with modified sub-DFTs
-    //   that will fit in L1 cache again.
-    //
-    // Shuffling requires two extra passes that will destroy the L1 and L2 cache; so one has to choose carefully
-    // whether to use shuffling or explot L2 cache, and take a beating on the last couple of stages. However,
-    // there are huge advantages to operating in L1 cache, especially when FFTs are running concurrently.
-    // Whether to use Shuffles, or L2 cache optimizations is a tuning decision.
-
-    // DFTs smaller than one cache block operate within a single cache page, so they should get a huge performance boost.
-    // 9 stages in the DFT(512) operate in a single cache block, on Pi 4, so no fetches for partial cache lines occur,
-    // and there's a significant opportunity for writes in subsequent passes to discard pending writes. The same argument extends
-    // to L2 blocks, where executing sub-DFTs in their entirety avoids spilling the L2 cache.
-    //
-
-    // size_t shuffleLog2CacheSize = l1Log2CacheSize*2;
+    isL1Optimized = false;
+    isL2Optimized = false;
+    isShuffleOptimized = false;
+    cacheEfficientFft = nullptr;
 
-    bool useShuffle = (!disableShuffleOptimization) && this->log2N > l1Log2CacheSize; // + 3;
-
-    if (this->log2N > l2Log2CacheSize && !useShuffle)
+    if (planChoice.strategy != PlanStrategy::Direct && planChoice.blockLog2 < log2N && planChoice.blockLog2 > 0)
     {
-
-        isL2Optimized = true;
-        cacheEfficientFft = &GetCachedInstance(l2CacheFftSize);
-        size_t currentPass = 1;
-
-        ops.push_back(
-            [this](InstanceData &instanceData, VectorRange<complex_t> &outputs, Direction dir)
-            {
-                size_t size = this->GetSize();
-                for (size_t i = 0; i < size; i += l2CacheFftSize)
-                {
-                    auto subRange = VectorRange<complex_t>(i, i + l2CacheFftSize, outputs);
-                    cacheEfficientFft->ComputeInner(instanceData, subRange, dir);
-                }
-            });
-        currentPass += l2Log2CacheSize;
-
-        for (size_t pass = currentPass; pass <= log2N; ++pass)
+        size_t blockLog2 = planChoice.blockLog2;
+        size_t blockSize = ((size_t)1) << blockLog2;
+        if (blockLog2 > l1Log2CacheSize)
         {
-            ops.push_back(
-                [this, pass](InstanceData &instanceData, VectorRange<complex_t> &outputs, Direction dir)
-                {
-                    ComputePass(pass, outputs, dir);
-                });
+            isL2Optimized = true;
         }
-    }
-    else if (log2N > l1Log2CacheSize)
-    {
-        // Perform L1 cache optimization.
-        // std::cout << "L1 CACHE OPTIMIZATION USED n=" << this->fftSize << std::endl;
-        isL1Optimized = true;
-        cacheEfficientFft = &GetCachedInstance(l1CacheFftSize);
+        else
+        {
+            // std::cout << "L1 CACHE OPTIMIZATION USED n=" << this->fftSize << std::endl;
+            isL1Optimized = true;
+        }
+        cacheEfficientFft = &GetCachedInstance(blockSize);
         size_t currentPass = 1;
+
         ops.push_back(
-            [this](InstanceData &instanceData, VectorRange<complex_t> &outputs, Direction dir)
+            [this, blockSize](InstanceData &instanceData, VectorRange<complex_t> &outputs, Direction dir)
             {
                 size_t size = this->GetSize();
-                for (size_t i = 0; i < size; i += l1CacheFftSize)
+                for (size_t i = 0; i < size; i += blockSize)
                 {
-                    auto subRange = VectorRange<complex_t>(i, i + l1CacheFftSize, outputs);
+                    auto subRange = VectorRange<complex_t>(i, i + blockSize, outputs);
                     cacheEfficientFft->ComputeInner(instanceData, subRange, dir);
                 }
             });
-        currentPass += l1Log2CacheSize;
+        currentPass += blockLog2;
 
-        if (useShuffle)
+        if (planChoice.strategy == PlanStrategy::BlockedShuffle && blockLog2 == l1Log2CacheSize)
         {
             currentPass = AddShuffleOps(currentPass, fftSize);
         }
-        // hammer out the last few passes (which will all fit in L2 cache)
+        // hammer out the last few passes.
         for (size_t pass = currentPass; pass <= log2N; ++pass)
         {
             if (pass > l1Log2CacheSize)
@@ -312,6 +381,7 @@ void StagedFftPlan::CalculateTwiddleFactors(Direction dir, std::vector<complex_t
     }
 }
 
+LS_KERNEL_CLONES
 void StagedFftPlan::ComputeInner0(VectorRange<complex_t> &output, Direction dir)
 {
     constexpr size_t pass = 1;
@@ -331,6 +401,7 @@ void StagedFftPlan::ComputeInner0(VectorRange<complex_t> &output, Direction dir)
     }
 }
 
+LS_KERNEL_CLONES
 void StagedFftPlan::ComputePass(size_t pass, VectorRange<complex_t> &output, Direction dir)
 {
     // For small sections, do butterflies in the most compute-efficient order.
@@ -374,6 +445,7 @@ void StagedFftPlan::ComputePass(size_t pass, VectorRange<complex_t> &output, Dir
         wj = wj2 * wInc;
     }
 }
+LS_KERNEL_CLONES
 void StagedFftPlan::ComputePassLarge(size_t pass, VectorRange<complex_t> &output, Direction dir)
 {
     // same as ComputePass, but periodically re-syncs the value of wj in order
@@ -432,6 +504,31 @@ void StagedFftPlan::ComputePassLarge(size_t pass, VectorRange<complex_t> &output
 
 std::recursive_mutex StagedFftPlan::cacheMutex;
 std::vector<std::unique_ptr<StagedFftPlan>> StagedFftPlan::cache(64);
+bool StagedFftPlan::defaultWisdomLoaded = false;
+std::vector<std::optional<StagedFftPlan::PlanChoice>> StagedFftPlan::wisdom(64);
+
+void StagedFftPlan::LoadDefaultWisdom()
+{
+    std::lock_guard<std::recursive_mutex> lock{cacheMutex};
+    if (defaultWisdomLoaded)
+    {
+        return;
+    }
+    defaultWisdomLoaded = true;
+    std::filesystem::path wisdomPath = StagedFftWisdom::DefaultPath();
+    std::error_code ec;
+    if (!wisdomPath.empty() && std::filesystem::exists(wisdomPath, ec))
+    {
+        try
+        {
+            StagedFftWisdom::Load(wisdomPath);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+    }
+}
 
 StagedFftPlan &StagedFftPlan::GetCachedInstance(size_t size)
 {
@@ -692,6 +789,7 @@ struct StageNShuffleFactor
 
 using StageNShuffleVector = std::vector<StageNShuffleFactor>;
 
+LS_KERNEL_CLONES
 static void StageNShufflePass(VectorRange<complex_t> &output, const StageNShuffleVector &shuffleVector, size_t stageIndex, StagedFft::Direction dir)
 {
 
@@ -850,3 +948,417 @@ size_t StagedFftPlan::AddShuffleOps(size_t currentPass, size_t fftSize)
     return finalPass;
 }
 
+
+void StagedRealFft::SetSize(size_t size)
+{
+    if (size == fftSize)
+    {
+        return;
+    }
+    if (size == 0)
+    {
+        plan = nullptr;
+        fftSize = 0;
+        instanceData.SetSize(0);
+        buffer.resize(0);
+        twiddles.resize(0);
+        return;
+    }
+    if (size < 4 || (size & (size - 1)) != 0)
+    {
+        throw std::invalid_argument("StagedRealFft size must be a power of two, 4 or greater.");
+    }
+    size_t halfSize = size / 2;
+    plan = &StagedFftPlan::GetCachedInstance(halfSize);
+    instanceData.SetSize(halfSize);
+    fftSize = size;
+    buffer.resize(halfSize);
+    twiddles.resize(halfSize);
+    for (size_t k = 0; k < halfSize; ++k)
+    {
+        twiddles[k] = std::exp(complex_t(0, 2 * Pi * k / size));
+    }
+}
+
+template <typename T>
+void StagedRealFft::RealToComplex(const T *input, complex_t *output, Direction direction)
+{
+    // Pack even and odd samples into the real and imaginary parts of a half-size complex
+    // transform, then separate the two spectra:
+    //   E[k] = (Z[k] + conj(Z[M-k]))/2,  O[k] = (Z[k] - conj(Z[M-k]))/2i,  X[k] = E[k] + W^k O[k].
+    // The half-size plan normalizes by 1/sqrt(M); the remaining 1/sqrt(2) makes it 1/sqrt(N).
+    const size_t halfSize = fftSize / 2;
+    for (size_t m = 0; m < halfSize; ++m)
+    {
+        buffer[m] = complex_t(input[2 * m], input[2 * m + 1]);
+    }
+    plan->Compute(instanceData, buffer, buffer, direction);
+
+    constexpr double scale = 0.70710678118654752440; // 1/sqrt(2)
+    constexpr double halfScale = scale * 0.5;
+
+    complex_t z0 = buffer[0];
+    output[0] = complex_t(scale * (z0.real() + z0.imag()), 0);
+    output[halfSize] = complex_t(scale * (z0.real() - z0.imag()), 0);
+
+    const bool forward = direction == Direction::Forward;
+    for (size_t k = 1; k < halfSize; ++k)
+    {
+        complex_t zk = buffer[k];
+        complex_t zc = std::conj(buffer[halfSize - k]);
+        complex_t even = zk + zc;
+        complex_t d = zk - zc;
+        complex_t odd{d.imag(), -d.real()}; // d/i
+        complex_t w = forward ? twiddles[k] : std::conj(twiddles[k]);
+        output[k] = halfScale * (even + w * odd);
+    }
+}
+
+template <typename T>
+void StagedRealFft::ComplexToReal(const complex_t *input, T *output, Direction direction)
+{
+    // Inverse of RealToComplex: rebuild the packed half-size spectrum
+    //   Z[k] = (X[k] + conj(X[M-k])) + i W^k (X[k] - conj(X[M-k]))
+    // whose transform has the even samples in its real part, and the odd samples in its imaginary part.
+    const size_t halfSize = fftSize / 2;
+    const bool forward = direction == Direction::Forward;
+
+    for (size_t k = 0; k < halfSize; ++k)
+    {
+        complex_t xk = input[k];
+        complex_t xc = std::conj(input[halfSize - k]);
+        complex_t w = forward ? twiddles[k] : std::conj(twiddles[k]);
+        complex_t t = w * (xk - xc);
+        buffer[k] = (xk + xc) + complex_t(-t.imag(), t.real()); // + i*t
+    }
+    if (halfSize != 0)
+    {
+        // bins 0 and N/2 are real.
+        buffer[0] = complex_t(input[0].real() + input[halfSize].real(), input[0].real() - input[halfSize].real());
+    }
+    plan->Compute(instanceData, buffer, buffer, direction);
+
+    constexpr double scale = 0.70710678118654752440; // 1/sqrt(2)
+    for (size_t m = 0; m < halfSize; ++m)
+    {
+        complex_t z = buffer[m];
+        output[2 * m] = (T)(scale * z.real());
+        output[2 * m + 1] = (T)(scale * z.imag());
+    }
+}
+
+void StagedRealFft::Compute(const std::vector<float> &input, std::vector<complex_t> &output, Direction direction)
+{
+    if (plan) // zero-length Compute does nothing.
+    {
+        assert(input.size() >= fftSize);
+        assert(output.size() >= GetSpectrumSize());
+        RealToComplex(input.data(), output.data(), direction);
+    }
+}
+void StagedRealFft::Compute(const std::vector<double> &input, std::vector<complex_t> &output, Direction direction)
+{
+    if (plan)
+    {
+        assert(input.size() >= fftSize);
+        assert(output.size() >= GetSpectrumSize());
+        RealToComplex(input.data(), output.data(), direction);
+    }
+}
+void StagedRealFft::Compute(const std::vector<complex_t> &input, std::vector<float> &output, Direction direction)
+{
+    if (plan)
+    {
+        assert(input.size() >= GetSpectrumSize());
+        assert(output.size() >= fftSize);
+        ComplexToReal(input.data(), output.data(), direction);
+    }
+}
+void StagedRealFft::Compute(const std::vector<complex_t> &input, std::vector<double> &output, Direction direction)
+{
+    if (plan)
+    {
+        assert(input.size() >= GetSpectrumSize());
+        assert(output.size() >= fftSize);
+        ComplexToReal(input.data(), output.data(), direction);
+    }
+}
+
+static const char *WISDOM_HEADER = "# ToobAmp StagedFft wisdom";
+static constexpr int WISDOM_VERSION = 1;
+
+std::filesystem::path StagedFftWisdom::DefaultPath()
+{
+    const char *env = std::getenv("TOOB_FFT_WISDOM");
+    if (env && env[0] != '\0')
+    {
+        return env;
+    }
+    std::filesystem::path cacheDirectory = toob::GetUserCacheDirectory();
+    if (cacheDirectory.empty())
+    {
+        return std::filesystem::path();
+    }
+    return cacheDirectory / "StagedFftWisdom.txt";
+}
+
+std::optional<StagedFftWisdom::PlanChoice> StagedFftWisdom::GetPlanChoice(size_t log2Size)
+{
+    std::lock_guard<std::recursive_mutex> lock{StagedFftPlan::cacheMutex};
+    if (log2Size >= StagedFftPlan::wisdom.size())
+    {
+        return std::nullopt;
+    }
+    return StagedFftPlan::wisdom[log2Size];
+}
+
+void StagedFftWisdom::Clear()
+{
+    std::lock_guard<std::recursive_mutex> lock{StagedFftPlan::cacheMutex};
+    for (auto &entry : StagedFftPlan::wisdom)
+    {
+        entry = std::nullopt;
+    }
+}
+
+void StagedFftWisdom::Load(const std::filesystem::path &path)
+{
+    std::ifstream f(path);
+    if (!f.is_open())
+    {
+        throw std::runtime_error("Can't open FFT wisdom file " + path.string());
+    }
+    auto formatError = [&path]()
+    {
+        return std::runtime_error("Invalid FFT wisdom file " + path.string());
+    };
+
+    std::string line;
+    if (!std::getline(f, line) || line != WISDOM_HEADER)
+    {
+        throw formatError();
+    }
+    std::vector<std::optional<PlanChoice>> entries(StagedFftPlan::wisdom.size());
+    bool cacheSizesMatch = false;
+    bool versionSeen = false;
+
+    while (std::getline(f, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream s(line);
+        std::string tag;
+        s >> tag;
+        if (tag == "version")
+        {
+            int version = 0;
+            s >> version;
+            if (s.fail() || version != WISDOM_VERSION)
+            {
+                throw formatError();
+            }
+            versionSeen = true;
+        }
+        else if (tag == "cache")
+        {
+            size_t l1Log2 = 0, l2Log2 = 0;
+            s >> l1Log2 >> l2Log2;
+            if (s.fail())
+            {
+                throw formatError();
+            }
+            cacheSizesMatch = l1Log2 == l1Log2CacheSize && l2Log2 == l2Log2CacheSize;
+        }
+        else if (tag == "plan")
+        {
+            size_t log2Size = 0, blockLog2 = 0;
+            std::string strategy;
+            s >> log2Size >> strategy >> blockLog2;
+            if (s.fail() || log2Size > MAX_LOG2_SIZE || (blockLog2 >= log2Size && strategy != "direct"))
+            {
+                throw formatError();
+            }
+            PlanChoice choice;
+            choice.blockLog2 = (uint8_t)blockLog2;
+            if (strategy == "direct")
+            {
+                choice.strategy = StagedFftPlan::PlanStrategy::Direct;
+                choice.blockLog2 = 0;
+            }
+            else if (strategy == "blocked")
+            {
+                choice.strategy = StagedFftPlan::PlanStrategy::Blocked;
+            }
+            else if (strategy == "shuffled")
+            {
+                choice.strategy = StagedFftPlan::PlanStrategy::BlockedShuffle;
+            }
+            else
+            {
+                throw formatError();
+            }
+            entries[log2Size] = choice;
+        }
+        else
+        {
+            throw formatError();
+        }
+    }
+    if (!versionSeen)
+    {
+        throw formatError();
+    }
+    if (!cacheSizesMatch)
+    {
+        // measured against a build with different cache-blocking parameters.
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> lock{StagedFftPlan::cacheMutex};
+    StagedFftPlan::defaultWisdomLoaded = true;
+    StagedFftPlan::wisdom = std::move(entries);
+}
+
+void StagedFftWisdom::Save(const std::filesystem::path &path)
+{
+    if (path.has_parent_path())
+    {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream f(path);
+    if (!f.is_open())
+    {
+        throw std::runtime_error("Can't write to " + path.string());
+    }
+    f << WISDOM_HEADER << '\n';
+    f << "version " << WISDOM_VERSION << '\n';
+    f << "cache " << l1Log2CacheSize << ' ' << l2Log2CacheSize << '\n';
+
+    std::lock_guard<std::recursive_mutex> lock{StagedFftPlan::cacheMutex};
+    for (size_t log2Size = 0; log2Size < StagedFftPlan::wisdom.size(); ++log2Size)
+    {
+        const auto &entry = StagedFftPlan::wisdom[log2Size];
+        if (entry)
+        {
+            const char *strategy = "direct";
+            switch (entry->strategy)
+            {
+            case StagedFftPlan::PlanStrategy::Direct:
+                strategy = "direct";
+                break;
+            case StagedFftPlan::PlanStrategy::Blocked:
+                strategy = "blocked";
+                break;
+            case StagedFftPlan::PlanStrategy::BlockedShuffle:
+                strategy = "shuffled";
+                break;
+            }
+            f << "plan " << log2Size << ' ' << strategy << ' ' << (int)entry->blockLog2 << '\n';
+        }
+    }
+    if (!f)
+    {
+        throw std::runtime_error("Can't write to " + path.string());
+    }
+}
+
+// nanoseconds per point; best of several trials.
+static double TimePlan(StagedFftPlan &plan, const std::vector<complex_t> &input, std::vector<complex_t> &output)
+{
+    using clock = std::chrono::steady_clock;
+
+    size_t size = plan.GetSize();
+    StagedFftPlan::InstanceData instanceData(size);
+    size_t repetitions = std::max((size_t)1, ((size_t)1 << 18) / size);
+
+    plan.Compute(instanceData, input, output, StagedFftPlan::Direction::Forward); // warm the cache.
+
+    double best = std::numeric_limits<double>::max();
+    for (size_t trial = 0; trial < 7; ++trial)
+    {
+        auto start = clock::now();
+        for (size_t i = 0; i < repetitions; ++i)
+        {
+            plan.Compute(instanceData, input, output, StagedFftPlan::Direction::Forward);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+        best = std::min(best, (double)elapsed / (double)(repetitions * size));
+    }
+    return best;
+}
+
+void StagedFftWisdom::Measure(size_t maxLog2Size, std::ostream *log)
+{
+    if (maxLog2Size > MAX_LOG2_SIZE)
+    {
+        throw std::invalid_argument("FFT size too large.");
+    }
+    std::lock_guard<std::recursive_mutex> lock{StagedFftPlan::cacheMutex};
+    for (const auto &plan : StagedFftPlan::cache)
+    {
+        if (plan)
+        {
+            throw std::logic_error("StagedFftWisdom::Measure() must be called before any FFT plans are created.");
+        }
+    }
+    StagedFftPlan::defaultWisdomLoaded = true;
+    Clear();
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+    // Smallest first, so that blocked plans use the sub-plans that have already been chosen.
+    for (size_t log2Size = 1; log2Size <= maxLog2Size; ++log2Size)
+    {
+        size_t size = ((size_t)1) << log2Size;
+        std::vector<PlanChoice> candidates = StagedFftPlan::CandidatePlanChoices(log2Size);
+        if (candidates.size() == 1)
+        {
+            StagedFftPlan::wisdom[log2Size] = candidates[0];
+            continue;
+        }
+        std::vector<complex_t> input(size);
+        for (auto &value : input)
+        {
+            value = complex_t(distribution(random), distribution(random));
+        }
+        std::vector<complex_t> expected(size);
+        std::vector<complex_t> output(size);
+        {
+            StagedFftPlan directPlan(size, PlanChoice{StagedFftPlan::PlanStrategy::Direct, 0});
+            StagedFftPlan::InstanceData instanceData(size);
+            directPlan.Compute(instanceData, input, expected, StagedFftPlan::Direction::Forward);
+        }
+
+        PlanChoice bestChoice = StagedFftPlan::DefaultPlanChoice(log2Size);
+        double bestTime = std::numeric_limits<double>::max();
+        for (const auto &candidate : candidates)
+        {
+            StagedFftPlan plan(size, candidate);
+            double time = TimePlan(plan, input, output);
+
+            double error = 0;
+            for (size_t i = 0; i < size; ++i)
+            {
+                error = std::max(error, std::abs(output[i] - expected[i]));
+            }
+            bool valid = error < 1E-8;
+            if (log)
+            {
+                (*log) << "    " << size << " " << StagedFftPlan::ToString(candidate) << ": "
+                       << time << " ns/point" << (valid ? "" : " (INVALID)") << std::endl;
+            }
+            if (valid && time < bestTime)
+            {
+                bestTime = time;
+                bestChoice = candidate;
+            }
+        }
+        StagedFftPlan::wisdom[log2Size] = bestChoice;
+        if (log)
+        {
+            (*log) << size << ": " << StagedFftPlan::ToString(bestChoice) << std::endl;
+        }
+    }
+}
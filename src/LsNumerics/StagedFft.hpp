@@ -37,6 +37,9 @@
 #include "LsMath.hpp"
 #include "Window.hpp"
 #include <functional>
+#include <filesystem>
+#include <optional>
+#include <iosfwd>
 
 #ifndef RESTRICT
 #define RESTRICT __restrict // equivalent of C99 restrict keyword. Valid for MSVC,GCC and CLANG.
@@ -44,6 +47,8 @@
 
 namespace LsNumerics
 {
+    class StagedFftWisdom;
+
     namespace Implementation
     {
         // minimal implementation of the subrange of a vector.
@@ -124,11 +129,36 @@ namespace LsNumerics
                 std::vector<complex_t> workingBuffer;
             };
 
+            // How the butterfly passes of a plan are ordered.
+            enum class PlanStrategy : uint8_t
+            {
+                // One pass at a time over the entire buffer.
+                Direct,
+                // Run complete sub-DFTs of size 2^blockLog2 one at a time, so that the first passes
+                // stay in cache; then the remaining passes over the entire buffer.
+                Blocked,
+                // As Blocked, with L1-sized blocks; then shuffle the data so that the following
+                // passes can also be run in L1-sized slices.
+                BlockedShuffle
+            };
+
+            struct PlanChoice
+            {
+                PlanStrategy strategy = PlanStrategy::Direct;
+                uint8_t blockLog2 = 0;
+
+                bool operator==(const PlanChoice &other) const = default;
+            };
+
         private:
             StagedFftPlan(size_t size)
             {
                 SetSize(size);
             }
+            StagedFftPlan(size_t size, const PlanChoice &planChoice)
+            {
+                SetSize(size, planChoice);
+            }
 
         public:
             StagedFftPlan() = delete;
@@ -138,6 +168,19 @@ namespace LsNumerics
 
             size_t GetSize() const { return fftSize; }
             void SetSize(size_t size);
+            void SetSize(size_t size, const PlanChoice &planChoice);
+
+            const PlanChoice &GetPlanChoice() const { return planChoice; }
+
+            // The plan that is used in the absence of wisdom, based on detected cache sizes.
+            static PlanChoice DefaultPlanChoice(size_t log2Size);
+            // The plans that StagedFftWisdom measures for a given size.
+            static std::vector<PlanChoice> CandidatePlanChoices(size_t log2Size);
+            static std::string ToString(const PlanChoice &planChoice);
+
+            // FFT sizes used for L1 and L2 cache blocking, derived from the detected cache sizes.
+            static size_t L1BlockSize();
+            static size_t L2BlockSize();
 
             void Compute(InstanceData &instanceData, const std::vector<complex_t> &input, std::vector<complex_t> &output, Direction dir);
 
@@ -156,10 +199,17 @@ namespace LsNumerics
             }
 
         private:
+            friend class LsNumerics::StagedFftWisdom;
+
             bool isL1Optimized = false;
             bool isShuffleOptimized = false;
             bool isL2Optimized = false;
+            PlanChoice planChoice;
             static std::recursive_mutex cacheMutex;
+            static bool defaultWisdomLoaded;
+            // Loads wisdom from StagedFftWisdom::DefaultPath() the first time a plan is created.
+            static void LoadDefaultWisdom();
+            static std::vector<std::optional<PlanChoice>> wisdom;
             static std::vector<std::unique_ptr<StagedFftPlan>> cache;
             std::vector<std::vector<complex_t>> stageFactors;
 
@@ -252,6 +302,117 @@ namespace LsNumerics
         InstanceData instanceData;
     };
 
+    /// @brief FFT of real-valued data.
+    ///
+    /// Computes bins 0..N/2 of the transform of N real samples using a complex StagedFft of
+    /// size N/2 plus a post-processing pass; and the reverse, from a half-spectrum back to N real samples.
+    /// Signs and normalization match StagedFft(N), so the half-spectrum is identical to the
+    /// first N/2+1 bins of the equivalent complex transform. The remaining bins are the
+    /// complex conjugates of bins N/2-1..1, and are never stored.
+    class StagedRealFft
+    {
+    public:
+        using complex_t = std::complex<double>;
+        using Direction = Implementation::StagedFftPlan::Direction;
+
+        StagedRealFft(size_t size)
+        {
+            SetSize(size);
+        }
+        StagedRealFft()
+        {
+        }
+        /// @brief Set the size of the real input.
+        /// @param size A power of two >= 4, or zero.
+        void SetSize(size_t size);
+        size_t GetSize() const
+        {
+            return fftSize;
+        }
+        /// @brief Number of bins in the half-spectrum (N/2+1).
+        size_t GetSpectrumSize() const
+        {
+            return fftSize == 0 ? 0 : fftSize / 2 + 1;
+        }
+
+        /// @brief Real input to half-spectrum. output must have at least GetSpectrumSize() elements.
+        void Compute(const std::vector<float> &input, std::vector<complex_t> &output, Direction direction);
+        void Compute(const std::vector<double> &input, std::vector<complex_t> &output, Direction direction);
+        /// @brief Half-spectrum to real output. The imaginary parts of bins 0 and N/2 are ignored.
+        void Compute(const std::vector<complex_t> &input, std::vector<float> &output, Direction direction);
+        void Compute(const std::vector<complex_t> &input, std::vector<double> &output, Direction direction);
+
+        void Forward(const std::vector<float> &input, std::vector<complex_t> &output)
+        {
+            Compute(input, output, Direction::Forward);
+        }
+        void Forward(const std::vector<double> &input, std::vector<complex_t> &output)
+        {
+            Compute(input, output, Direction::Forward);
+        }
+        void Backward(const std::vector<complex_t> &input, std::vector<float> &output)
+        {
+            Compute(input, output, Direction::Backward);
+        }
+        void Backward(const std::vector<complex_t> &input, std::vector<double> &output)
+        {
+            Compute(input, output, Direction::Backward);
+        }
+
+        bool IsL1Optimized() const { return plan->IsL1Optimized(); }
+        bool IsL2Optimized() const { return plan->IsL2Optimized(); }
+        bool IsShuffleOptimized() const { return plan->IsShuffleOptimized(); }
+
+    private:
+        template <typename T>
+        void RealToComplex(const T *input, complex_t *output, Direction direction);
+        template <typename T>
+        void ComplexToReal(const complex_t *input, T *output, Direction direction);
+
+        using InstanceData = Implementation::StagedFftPlan::InstanceData;
+        Implementation::StagedFftPlan *plan = nullptr;
+        InstanceData instanceData{0};
+        size_t fftSize = 0;
+        std::vector<complex_t> buffer;
+        // exp(i*2*pi*k/N) for k in [0,N/2)
+        std::vector<complex_t> twiddles;
+    };
+
+    /// @brief Measured plan choices for StagedFft on the current machine.
+    ///
+    /// Without wisdom, plans are chosen using the detected cache sizes. Measure() times each
+    /// candidate plan for each size, and records the fastest; Save() writes the results to a text file, which is
+    /// loaded from DefaultPath() the first time that a plan is created. Wisdom only affects plans created after it
+    /// has been loaded.
+    class StagedFftWisdom
+    {
+    public:
+        using PlanChoice = Implementation::StagedFftPlan::PlanChoice;
+
+        static constexpr size_t MAX_LOG2_SIZE = 24;
+
+        /// @brief $TOOB_FFT_WISDOM if set; otherwise StagedFftWisdom.txt in GetUserCacheDirectory().
+        static std::filesystem::path DefaultPath();
+
+        /// @brief Load wisdom from a file.
+        /// @throws std::runtime_error if the file can't be read, or is not a valid wisdom file.
+        /// Files measured with different cache block sizes (e.g. on another machine) are ignored.
+        static void Load(const std::filesystem::path &path);
+
+        /// @brief Save current wisdom.
+        /// @throws std::runtime_error on errors.
+        static void Save(const std::filesystem::path &path);
+
+        /// @brief Time the candidate plans for FFT sizes 2..2^maxLog2Size, and use the fastest of each.
+        /// Must be called before any StagedFft plans have been created.
+        static void Measure(size_t maxLog2Size, std::ostream *log = nullptr);
+
+        /// @brief Discard all wisdom.
+        static void Clear();
+
+        static std::optional<PlanChoice> GetPlanChoice(size_t log2Size);
+    };
+
 } // namespace
 
 #endif // DJ_INCLUDE_FFT_H
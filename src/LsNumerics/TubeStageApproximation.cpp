@@ -551,6 +551,6 @@ TubeStageApproximation::TubeStageApproximation()
     {10, 10.0390625, {0.1975569252627747, -0.0001403506557901335, 4.36149142357678e-08, -4.352909144245132e-11, -3.472377940738625e-12}, {-0.007185953576454836, 4.466167217742623e-06, -6.686068445560523e-09, -7.111430022632704e-10}},
 } }
 {
-    
+    blockEvaluator = PiecewiseBlockEvaluator(*this);
 }
 TubeStageApproximation LsNumerics::gTubeStageApproximation;
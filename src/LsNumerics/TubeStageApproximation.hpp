@@ -23,6 +23,7 @@
 
 #pragma once
 #include "PiecewiseChebyshevApproximation.hpp"
+#include "PiecewiseBlockEvaluator.hpp"
 namespace LsNumerics {
 
 class TubeStageApproximation: public PiecewiseChebyshevApproximation {
@@ -44,6 +45,18 @@ public:
         }
         return PiecewiseChebyshevApproximation::At(x);
     }
+
+    // Block equivalent of At(): output[i] = (At(input[i]*inputScale+inputOffset)+outputOffset)*outputScale.
+    void Process(
+        const float *input, float *output, size_t n,
+        float inputScale = 1, float inputOffset = 0,
+        float outputOffset = 0, float outputScale = 1) const
+    {
+        blockEvaluator.Process(input, output, n, inputScale, inputOffset, outputOffset, outputScale);
+    }
+
+private:
+    PiecewiseBlockEvaluator blockEvaluator;
 };
 
 extern TubeStageApproximation gTubeStageApproximation;
@@ -24,6 +24,8 @@ SOFTWARE.
 #include "NamBackgroundProcessor.hpp"
 #include "namFixes/dsp_ex.h"
 #include "LsNumerics/LsMath.hpp"
+#include "LsNumerics/Denorms.hpp"
+#include "ThreadManager.hpp"
 #include <iostream>
 
 using namespace toob;
@@ -50,19 +52,16 @@ static void bufferScale4(float *restrict buffer, float scale, size_t size)
 }
 void NamBackgroundProcessor::ThreadProc()
 {
-    // set RT scheduling priority (if able)
-
-    struct sched_param param;
-    memset(&param, 0, sizeof(param));
-    param.sched_priority = 75;
-
-    pthread_t pid = pthread_self();
-    pthread_setname_np(pid, "tnam_bg");
+    LsNumerics::disable_denorms();
 
-    int result = sched_setscheduler(0, SCHED_RR, &param);
-    if (result != 0)
+    // set RT scheduling priority (if able)
+    try
+    {
+        ThreadManager::Get().ConfigureCurrentThread(ThreadRole::NamBackground);
+    }
+    catch (const std::exception &e)
     {
-        std::cout << "ToobNAM: Failed to set background thread priority. (" << strerror(result) << ")";
+        std::cout << "ToobNAM: Failed to set background thread priority. (" << e.what() << ")" << std::endl;
     }
 
     uint8_t messageBuffer[1024 + 100];
@@ -104,10 +103,7 @@ void NamBackgroundProcessor::ThreadProc()
         }
         case NamBgMessageType::SampleData:
         {
-            TraceProcessing('b', 0, clock_t::duration(0));
-#if TRACE_PROCESSING
-            auto start = clock_t::now();
-#endif
+            RtTraceScope traceScope(traceSource, RtTrace::Phase::Background);
             SampleDataMessage *source = (SampleDataMessage *)message;
             size_t length = source->length;
 
@@ -142,9 +138,9 @@ void NamBackgroundProcessor::ThreadProc()
                         bufferScale4(input, bgInputVolume, frameSize);
                         float *output = backgroundReturnBuffer.data() + backgroundOutputTailPosition;
 
-                        bgDsp->Process(
-                            input, output,
-                            frameSize);
+                        ProcessInBlocks(
+                            bgDsp.get(), input, output,
+                            frameSize, namBlockSize);
 
                         bufferScale4(output, bgOutputVolume, frameSize);
                     }
@@ -161,9 +157,6 @@ void NamBackgroundProcessor::ThreadProc()
                 }
                 for (size_t frameIndex = 0; frameIndex < backgroundOutputTailPosition; frameIndex += MAX_DATA_MESSAGE_SAMPLES)
                 {
-#if TRACE_PROCESSING
-                    TraceProcessing('b', 1, start - clock_t::now());
-#endif
                     size_t thisTime = std::min(MAX_DATA_MESSAGE_SAMPLES, backgroundOutputTailPosition - frameIndex);
                     SampleDataMessage message(bgInstanceId, thisTime);
                     pIn = backgroundReturnBuffer.data() + frameIndex;
@@ -200,6 +193,7 @@ void NamBackgroundProcessor::ThreadProc()
 
     QuitMessage quitMessage{};
     bgToFgQueue.write(&quitMessage, sizeof(quitMessage));
+    RtTrace::ReleaseThread();
 }
 
 void NamBackgroundProcessor::fgWrite(const float *samples, size_t nFrames)
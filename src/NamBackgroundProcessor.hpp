@@ -34,6 +34,8 @@ SOFTWARE.
 #include <atomic>
 #include <array>
 #include "restrict.hpp"
+#include "RtTrace.hpp"
+#include "LsNumerics/CacheInfo.hpp"
 #include <chrono>
 
 #pragma GCC diagnostic push
@@ -43,7 +45,6 @@ SOFTWARE.
 
 #pragma GCC diagnostic pop
 
-#define TRACE_PROCESSING false
 #define NBG_MINIMUM_THREADING_BUFFER_SIZE 64
 namespace toob
 {
@@ -307,44 +308,20 @@ namespace toob::nam_impl
         NamBackgroundProcessorListener *listener = nullptr;
         uint32_t sampleRate = 48000;
         size_t frameSize = 0;
+        size_t namBlockSize = 64;
         std::atomic<bool> backgroundQueueComplete = false;
 
     public:
-        using clock_t = std::chrono::system_clock;
-        using trace_duration_t = std::chrono::microseconds;
-
-        struct TraceRecord {
-            trace_duration_t time;
-            trace_duration_t elapsed;
-            char fgBg;
-            uint16_t phase; 
-        };
-        std::mutex traceMutex;
-        size_t traceIndex = 0;
-        std::vector<TraceRecord> traces{10000};
-
-        void TraceProcessing(char fgBg, uint16_t phase, clock_t::duration duration)
-        {
-            #if TRACE_PROCESSING
-            std::lock_guard lock{traceMutex};
-            traces[traceIndex++] = {
-                std::chrono::duration_cast<std::chrono::microseconds>(clock_t::now().time_since_epoch()),
-                std::chrono::duration_cast<std::chrono::microseconds>(duration),
-                fgBg,
-                phase
-            };
-            if (traceIndex >= traces.size())
-            {
-                traceIndex = 0;
-            }
-            #endif
-        }
+        RtTraceSource traceSource{"NamBackgroundProcessor"};
+        const uint16_t tracePhaseFgRead = RtTrace::RegisterName("fg_read");
+        const uint16_t tracePhaseFgWrite = RtTrace::RegisterName("fg_write");
         void SetSampleRate(double sampleRate)
         {
             this->sampleRate = (uint32_t)sampleRate;
         }
         void SetFrameSize(size_t frameSize) {
             this->frameSize = frameSize;
+            this->namBlockSize = LsNumerics::CacheInfo::NamProcessingBlockSize(std::max((size_t)64, frameSize));
             size_t bufferSize = std::max((size_t)64,frameSize);
             this->backgroundReturnBuffer.resize(2*bufferSize);
             this->backgroundInputBuffer.resize(2*bufferSize);
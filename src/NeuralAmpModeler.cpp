@@ -51,6 +51,8 @@ SOFTWARE.
 #include "ss.hpp"
 #include <cfenv>
 #include "LsNumerics/Denorms.hpp"
+#include "LsNumerics/CacheInfo.hpp"
+#include "ThreadManager.hpp"
 #include <Eigen/Dense>
 #include <filesystem>
 
@@ -199,6 +201,7 @@ NeuralAmpModeler::NeuralAmpModeler(
 {
     backgroundProcessor.SetSampleRate(rate);
     backgroundProcessor.SetListener(this);
+    cpuLoadMeter.SetSampleRate(rate);
 #if NAM_RMS_METER
     cInputLevelOut.SetSampleRate(rate);
 #endif
@@ -603,6 +606,12 @@ void NeuralAmpModeler::ConnectPort(uint32_t port, void *data)
     case EParams::kControlOut:
         controlOut = (LV2_Atom_Sequence *)data;
         break;
+    case EParams::kCpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case EParams::kCpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
     default:
         LogWarning("Invalid ConnectPort call.\n");
         break;
@@ -623,6 +632,7 @@ void NeuralAmpModeler::Activate()
         maxBufferSize = 2048;
     }
     this->maxBufferSize = maxBufferSize;
+    this->namBlockSize = LsNumerics::CacheInfo::NamProcessingBlockSize(maxBufferSize);
 
     backgroundProcessor.SetFrameSize(maxBufferSize);
 
@@ -651,6 +661,10 @@ void NeuralAmpModeler::Activate()
 }
 void NeuralAmpModeler::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    ThreadManager::NoteAudioThread();
+    LsNumerics::AutoDenorm autoDenorm;
 
     BeginAtomOutput(this->controlOut);
     HandleEvents(this->controlIn);
@@ -755,10 +769,6 @@ void NeuralAmpModeler::ProcessBlock(int nFrames)
     constexpr size_t numChannelsInternal = 1;
     const size_t numFrames = (size_t)nFrames;
 
-    // Disable floating point denormals
-
-    fp_state_t fp_state = LsNumerics::disable_denorms();
-
     this->_PrepareBuffers(numFrames);
 
     if (cCalibrationValue.HasChanged() || cInputCalibrationMode.HasChanged() || cOutputCalibrationMode.HasChanged())
@@ -857,8 +867,6 @@ void NeuralAmpModeler::ProcessBlock(int nFrames)
         sendFileName = false;
         this->PutPatchPropertyPath(0, urids.nam__ModelFileName, mNAMPath.c_str());
     }
-    // restore previous floating point state
-    LsNumerics::restore_denorms(fp_state);
 }
 
 void NeuralAmpModeler::OnReset()
@@ -1253,7 +1261,7 @@ void NeuralAmpModeler::ProcessNam(float *restrict input, float *restrict output,
             {
                 input[i] *= fgInputVolume;
             }
-            mNAM->Process(const_cast<float *>(input), output, numFrames);
+            ProcessInBlocks(mNAM.get(), const_cast<float *>(input), output, numFrames, namBlockSize);
             for (size_t i = 0; i < numFrames; ++i)
             {
                 output[i] *= fgOutputVolume;
@@ -1349,21 +1357,14 @@ void NeuralAmpModeler::ProcessNam(float *restrict input, float *restrict output,
                 }
                 else
                 {
-#if TRACE_PROCESSING
-                    using clock_t = ::toob::nam_impl::NamBackgroundProcessor::clock_t;
-                    auto start = clock_t::now();
-                    backgroundProcessor.TraceProcessing('f', 0, clock_t::duration(0));
-#endif
-                    this->backgroundProcessor.fgRead(output, numFrames);
-#if TRACE_PROCESSING
-                    auto writeStart = clock_t::now();
-                    backgroundProcessor.TraceProcessing('f', 1, writeStart - start);
-#endif
-                    this->backgroundProcessor.fgWrite(input, numFrames);
-#if TRACE_PROCESSING
-                    auto writeEnd = clock_t::now();
-                    backgroundProcessor.TraceProcessing('f', 2, writeEnd - writeStart);
-#endif
+                    {
+                        RtTraceScope readScope(backgroundProcessor.traceSource, backgroundProcessor.tracePhaseFgRead);
+                        this->backgroundProcessor.fgRead(output, numFrames);
+                    }
+                    {
+                        RtTraceScope writeScope(backgroundProcessor.traceSource, backgroundProcessor.tracePhaseFgWrite);
+                        this->backgroundProcessor.fgWrite(input, numFrames);
+                    }
                 }
             }
         }
@@ -53,6 +53,8 @@ SOFTWARE.
 #include "namFixes/NoiseGate.h"
 #include "NamBackgroundProcessor.hpp"
 #include "NeuralAmpModeler_Lv2Extensions.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 #define NAM_RMS_METER 0
@@ -121,7 +123,10 @@ namespace toob
             kAudioIn,
             kAudioOut,
             kControlIn,
-            kControlOut
+            kControlOut,
+
+            kCpuLoad,
+            kCpuPeak
         };
         bool LoadModel(const std::string&filename); // (for tests)
 
@@ -228,6 +233,7 @@ namespace toob
 
     private:
         size_t maxBufferSize = 64;
+        size_t namBlockSize = 64;
         double rate = 44100;
         std::string bundle_path;
 
@@ -286,6 +292,8 @@ namespace toob
         int gateOutputUpdateRate = 100;
         int gateOutputUpdateCount = 0;
         bool isActivated = false;
+        RtTraceSource traceSource{"NeuralAmpModeler"};
+        CpuLoadMeter cpuLoadMeter;
         bool requestFileUpdate = true;
 
 
@@ -38,6 +38,17 @@
     hmf.SetSampleRate(sampleRate);
  }
 
+ void ParametricEq::UpdateCascade()
+ {
+    // same order as Tick().
+    cascade.SetStage(0, hmf.GetCoefficients());
+    cascade.SetStage(1, lmf.GetCoefficients());
+    cascade.SetStage(2, highShelf.GetZTransformCoefficients());
+    cascade.SetStage(3, lowShelf.GetZTransformCoefficients());
+    cascade.SetStage(4, highCut.GetZTransformCoefficients());
+    cascade.SetStage(5, lowCut.GetZTransformCoefficients());
+ }
+
  double ParametricEq::GetFrequencyResponse(float frequency)
  {
     double result = lowCut.GetFrequencyResponse(frequency);
@@ -27,6 +27,7 @@
 #include "Filters/LowPassFilter.h"
 #include "Filters/HighPassFilter.h"
 #include "Filters/PeakingFilter2.h"
+#include "Filters/BiquadCascade.hpp"
 
 #include <vector>
 #include <cmath>
@@ -133,6 +134,11 @@ public:
         
         return abs(H);
     }
+
+    toob::FilterCoefficients2 GetCoefficients() const
+    {
+        return toob::FilterCoefficients2(b0, b1, b2, 1.0, a1, a2);
+    }
 };
 
 
@@ -183,9 +189,28 @@ namespace toob {
                 )
             );
         }
+        // Block equivalents of Tick() and TickR(), with independent filter state.
+        void Process(const float *input, float *output, size_t n_samples)
+        {
+            UpdateCascade();
+            cascade.Process(input, output, n_samples);
+        }
+        void Process(
+            const float *inputL, const float *inputR,
+            float *outputL, float *outputR,
+            size_t n_samples)
+        {
+            UpdateCascade();
+            cascade.Process(inputL, inputR, outputL, outputR, n_samples);
+        }
+        void ResetCascade() { cascade.Reset(); }
+
         double GetFrequencyResponse(float f);
     private: 
+        void UpdateCascade();
+
         double sampleRate;
+        BiquadCascade<6> cascade;
 
     };
 
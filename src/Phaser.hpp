@@ -33,6 +33,7 @@
 
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include "LsNumerics/LsMath.hpp"
 
 namespace toob
@@ -171,24 +172,43 @@ namespace toob
             phase = 0;
         }
 
-        float tick() {
+        // Frequency at the current LFO position.
+        float value() {
             // sawtooth, [0..1]
             double x = phase*2;
 
             if (x > 1.0f) { x = 2.0-x; };
+            return lfoToFreq(x);
+        }
+        void skip(size_t samples) {
+            // step by step, so that phase follows exactly the same path as it does with tick().
+            for (size_t i = 0; i < samples; ++i)
+            {
+                phase += dPhase;
+                if (phase >= 1.0) { phase -= 1.0; }
+            }
+        }
+
+        float tick() {
+            float result = value();
         
             phase += dPhase;
             if (phase >= 1.0) { phase -= 1.0; }
 
-            return lfoToFreq(x);
+            return result;
 
         }
     };
 
     class Phaser
     {
+    public:
+        // Block processing recalculates filter coefficients every CONTROL_INTERVAL samples.
+        static constexpr size_t CONTROL_INTERVAL = 16;
     private:
-        std::vector<AllPassFilter> allPassFilters;
+        static constexpr size_t STAGES = 4;
+        // AllPassFilter state for each stage, held here so that the block loop can keep it in registers.
+        float allPassState[STAGES];
         Phase90Lfo lfo;
         float sampleRate;
         float feedback = 0;
@@ -197,15 +217,24 @@ namespace toob
         float zm1 = 0;
         float frequencyScale;
 
+        // block processing: coefficient ramp across the current control interval.
+        bool blockCoefficientValid = false;
+        float blockA1 = 0;
+        float blockDA1 = 0;
+        float blockTargetA1 = 0;
+        size_t controlSamplesRemaining = 0;
+
+        float lfoCoefficient() 
+        {
+            return AllPassFilter::frequencyToCoefficient(sampleRate,lfo.value()*frequencyScale);
+        }
+
     public:
         Phaser(float sampleRate = 4800.0f)
             : sampleRate(sampleRate),
               lfo(sampleRate),
               trim(LsNumerics::Db2Af(0))
         {
-            // Initialize filters
-            allPassFilters.resize(4);
-
             // Default settings
             setLfoRate(0.5f);     
 
@@ -242,32 +271,89 @@ namespace toob
             freq *= frequencyScale;
             float a1 = AllPassFilter::frequencyToCoefficient(sampleRate,freq);
             
-            for (size_t i = 0; i < this->allPassFilters.size(); ++i)
-            {
-                allPassFilters[i].setCoefficient(a1);
-            }
-
             // Apply feedback and process through all stages
             float input = (1.0-feedback)*inputSample - feedback*zm1;
             float output = input;
 
-            for (size_t i = 0; i < allPassFilters.size(); ++i)
+            for (size_t i = 0; i < STAGES; ++i)
             {
-                output = allPassFilters[i].process(output);
+                float y = a1 * output + allPassState[i];
+                allPassState[i] = output - a1 * y;
+                output = y;
             }
             output = 0.5*(input + output);
             zm1 = output;
             return trim*output;
         }
 
+        /**
+         * @brief Block processing.
+         * 
+         * Filter coefficients are calculated at control rate, and linearly interpolated 
+         * in between, which takes the LFO and tanf() out of the per-sample loop. 
+         * Use either this or process(float), not both, on any one instance.
+         */
+        void process(const float *input, float *output, size_t n)
+        {
+            if (!blockCoefficientValid)
+            {
+                blockA1 = blockTargetA1 = lfoCoefficient();
+                blockDA1 = 0;
+                controlSamplesRemaining = 0;
+                blockCoefficientValid = true;
+            }
+            float s0 = allPassState[0], s1 = allPassState[1], s2 = allPassState[2], s3 = allPassState[3];
+            float zm1 = this->zm1;
+            const float inputGain = (float)(1.0-feedback);
+            const float feedback = this->feedback;
+            const float trim = this->trim;
+            while (n != 0)
+            {
+                if (controlSamplesRemaining == 0)
+                {
+                    blockA1 = blockTargetA1;
+                    lfo.skip(CONTROL_INTERVAL);
+                    blockTargetA1 = lfoCoefficient();
+                    blockDA1 = (blockTargetA1-blockA1)*(1.0f/CONTROL_INTERVAL);
+                    controlSamplesRemaining = CONTROL_INTERVAL;
+                }
+                size_t m = std::min(n, controlSamplesRemaining);
+                float a1 = blockA1;
+                const float dA1 = blockDA1;
+                for (size_t i = 0; i < m; ++i)
+                {
+                    float x = inputGain*input[i] - feedback*zm1;
+                    float y0 = a1 * x + s0;
+                    s0 = x - a1 * y0;
+                    float y1 = a1 * y0 + s1;
+                    s1 = y0 - a1 * y1;
+                    float y2 = a1 * y1 + s2;
+                    s2 = y1 - a1 * y2;
+                    float y3 = a1 * y2 + s3;
+                    s3 = y2 - a1 * y3;
+                    zm1 = 0.5f*(x + y3);
+                    output[i] = trim*zm1;
+                    a1 += dA1;
+                }
+                blockA1 = a1;
+                controlSamplesRemaining -= m;
+                input += m;
+                output += m;
+                n -= m;
+            }
+            allPassState[0] = s0; allPassState[1] = s1; allPassState[2] = s2; allPassState[3] = s3;
+            this->zm1 = zm1;
+        }
+
         // Reset all internal states
         void reset()
         {
             lfo.reset();
-            for (size_t i = 0; i < allPassFilters.size(); ++i)
+            for (size_t i = 0; i < STAGES; ++i)
             {
-                allPassFilters[i].reset();
+                allPassState[i] = 0;
             }
+            blockCoefficientValid = false;
         }
     };
 } // namespace
\ No newline at end of file
@@ -29,6 +29,8 @@
 #include <vector>
 #include <sstream>
 #include <cassert>
+#include <chrono>
+#include <algorithm>
 
 
 using namespace toob;
@@ -179,6 +181,83 @@ void TestFrequencyResponse() {
 
 }
 
+static std::vector<float> MakeTestSignal(size_t n, float sampleRate)
+{
+    std::vector<float> result(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        result[i] = 0.3f*std::sin(2*M_PI*110*i/sampleRate) + 0.2f*std::sin(2*M_PI*1234*i/sampleRate);
+    }
+    return result;
+}
+
+static void TestBlockProcessing(float sampleRate)
+{
+    // Block processing interpolates coefficients at control rate, so it matches process(float) closely but not exactly.
+    // The largest differences are at the LFO turning points, at the maximum LFO rate (-54dB at 44.1kHz).
+    const size_t N = (size_t)(sampleRate*4);
+    std::vector<float> input = MakeTestSignal(N, sampleRate);
+    std::vector<float> reference(N), block(N);
+
+    Phaser referencePhaser(sampleRate), blockPhaser(sampleRate);
+    referencePhaser.setLfoRate(6.0f);
+    blockPhaser.setLfoRate(6.0f);
+    for (size_t i = 0; i < N; ++i)
+    {
+        reference[i] = referencePhaser.process(input[i]);
+    }
+    const size_t blockSizes[] = {16, 1, 7, 64, 33};
+    size_t position = 0;
+    for (size_t i = 0; position < N; ++i)
+    {
+        size_t n = std::min(blockSizes[i % std::size(blockSizes)], N - position);
+        blockPhaser.process(input.data() + position, block.data() + position, n);
+        position += n;
+    }
+    double maxError = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        maxError = std::max(maxError, (double)std::abs(reference[i] - block[i]));
+    }
+    cout << "TestBlockProcessing(" << sampleRate << ") max error: " << maxError << endl;
+    if (maxError > 5E-3)
+    {
+        throw std::runtime_error("Block processing doesn't match process(float).");
+    }
+}
+
+static void BenchmarkPhaser()
+{
+    // 16-frame buffers, as on a Raspberry Pi 4 running at minimum latency.
+    constexpr float SAMPLE_RATE = 48000;
+    constexpr size_t FRAME_SIZE = 16;
+    constexpr size_t N = 48000*20;
+    std::vector<float> input = MakeTestSignal(N, SAMPLE_RATE);
+    std::vector<float> output(N);
+
+    Phaser referencePhaser(SAMPLE_RATE);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < N; ++i)
+    {
+        output[i] = referencePhaser.process(input[i]);
+    }
+    double tickTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    Phaser blockPhaser(SAMPLE_RATE);
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < N; i += FRAME_SIZE)
+    {
+        blockPhaser.process(input.data() + i, output.data() + i, FRAME_SIZE);
+    }
+    double blockTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    double audioTime = N / SAMPLE_RATE;
+    cout << "BenchmarkPhaser" << endl;
+    cout << "    process(float):  " << (tickTime / audioTime * 100) << "% of one core" << endl;
+    cout << "    process(block):  " << (blockTime / audioTime * 100) << "% of one core" << endl;
+    cout << "    speedup:         " << (tickTime / blockTime) << "x" << endl;
+}
+
 int main(int argc, char **argv)
 {
     try
@@ -195,6 +274,9 @@ int main(int argc, char **argv)
 
             return EXIT_SUCCESS;
         } else {
+            TestBlockProcessing(44100);
+            TestBlockProcessing(96000);
+            BenchmarkPhaser();
             TestFrequencyResponse();
             return EXIT_SUCCESS;
         }
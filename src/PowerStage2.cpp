@@ -23,6 +23,7 @@
 
 
 #include "PowerStage2.h"
+#include "LsNumerics/Denorms.hpp"
 
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
@@ -46,10 +47,14 @@ using namespace toob;
 #include <unistd.h>
 #include <signal.h>
 #include <csignal>
+#include <algorithm>
+#include <cmath>
 #endif
 
 
 const int MAX_UPDATES_PER_SECOND = 10;
+const size_t OVERSAMPLE_BLOCK_SIZE = 64;
+const size_t DEFAULT_OVERSAMPLE = 4;
 //const int UPSAMPLING_BUFFER_SIZE = 128;
 
 const char* PowerStage2::URI= POWER_STAGE_2_URI;
@@ -67,31 +72,16 @@ PowerStage2::PowerStage2(double _rate,
 	LogTrace("PowerStage2: Loading");
 
 	uris.Map(this);
+	cpuLoadMeter.SetSampleRate(_rate);
 	gain1.InitUris(this);
 	gain2.InitUris(this);
 	gain3.InitUris(this);
 	lv2_atom_forge_init(&forge, map);
 	LogTrace("PowerStage2: Loadedx");
 
-	double downsamplingCutoff = 18000;
-	if (rate < 48000)
-	{
-		downsamplingCutoff = rate*18000/48000;
-	}
-	double downsamplingBandStop = (rate-downsamplingCutoff);
-	const double BANDSTOP_DB = -80;
-
-	double supersampledRate = _rate*4;
-
-	upsamplingFilter.Design(supersampledRate,0.5,downsamplingCutoff,BANDSTOP_DB,downsamplingBandStop);
-	downsamplingFilter.Design(supersampledRate,0.5,downsamplingCutoff,BANDSTOP_DB,downsamplingBandStop);
-
-
-	this->gain1.SetSampleRate(supersampledRate);
-	this->gain2.SetSampleRate(supersampledRate);
-	this->gain3.SetSampleRate(supersampledRate);
-	this->masterVolumeDezipped.SetSampleRate(supersampledRate);
-	this->sagProcessor.SetSampleRate(supersampledRate);
+	oversampler.Prepare(_rate, OVERSAMPLE_BLOCK_SIZE);
+	oversampler.SetOversampling(DEFAULT_OVERSAMPLE, LsNumerics::OversamplerFilter::MinimumPhase);
+	SetOversampledRate(_rate * DEFAULT_OVERSAMPLE);
 
 	this->updateSampleDelay = (int)(_rate/MAX_UPDATES_PER_SECOND) + 40;
 }
@@ -194,6 +184,54 @@ void PowerStage2::ConnectPort(uint32_t port, void* data)
 	case PortId::NOTIFY_OUT:
 		this->notifyOut = (LV2_Atom_Sequence*)data;
 		break;
+	case PortId::OVERSAMPLE:
+		this->oversample.SetData(data);
+		break;
+	case PortId::OVERSAMPLE_FILTER:
+		this->oversampleFilter.SetData(data);
+		break;
+	case PortId::LATENCY:
+		this->latencyOut = (float*)data;
+		break;
+	case PortId::CPU_LOAD:
+		this->cpuLoadMeter.SetLoadData(data);
+		break;
+	case PortId::CPU_PEAK:
+		this->cpuLoadMeter.SetPeakData(data);
+		break;
+	}
+}
+
+void PowerStage2::SetOversampledRate(double oversampledRate)
+{
+	this->gain1.SetSampleRate(oversampledRate);
+	this->gain2.SetSampleRate(oversampledRate);
+	this->gain3.SetSampleRate(oversampledRate);
+	this->masterVolumeDezipped.SetSampleRate(oversampledRate);
+	this->sagProcessor.SetSampleRate(oversampledRate);
+}
+
+void PowerStage2::UpdateOversampling()
+{
+	if (!oversample.HasChanged() && !oversampleFilter.HasChanged())
+	{
+		return;
+	}
+	float value = oversample.GetValue();
+	size_t factor = value < 1.5f ? 1 : value < 3.0f ? 2 : value < 6.0f ? 4 : 8;
+	auto filter = oversampleFilter.GetValue() >= 0.5f
+		? LsNumerics::OversamplerFilter::LinearPhase
+		: LsNumerics::OversamplerFilter::MinimumPhase;
+
+	if (factor != oversampler.GetFactor() || filter != oversampler.GetFilter())
+	{
+		oversampler.SetOversampling(factor, filter);
+		SetOversampledRate(rate * factor);
+		gain1.Reset();
+		gain2.Reset();
+		gain3.Reset();
+		sagProcessor.Reset();
+		sagInputScale = sagProcessor.GetInputScale();
 	}
 }
 
@@ -207,7 +245,9 @@ void PowerStage2::Activate()
 	this->gain2.Reset();
 	this->gain3.Reset();
 	this->sagProcessor.Reset();
+	this->sagInputScale = this->sagProcessor.GetInputScale();
 	this->masterVolumeDezipped.Reset();
+	this->oversampler.Reset();
 }
 void PowerStage2::Deactivate()
 {
@@ -216,6 +256,9 @@ void PowerStage2::Deactivate()
 
 void PowerStage2::Run(uint32_t n_samples)
 {
+	RtTraceScope traceScope(traceSource);
+	CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+	LsNumerics::AutoDenorm autoDenorm;
 	// prepare forge to write to notify output port.
 	// Set up forge to write directly to notify output port.
 	const uint32_t notify_capacity = this->notifyOut->atom.size;
@@ -230,6 +273,7 @@ void PowerStage2::Run(uint32_t n_samples)
 	this->gain2.Enable = this->gain2_enable.GetValue() > 0.5f;
 	this->gain3.Enable = this->gain3_enable.GetValue() > 0.5f;
 
+	UpdateOversampling();
 	gain1.UpdateControls();
 	gain2.UpdateControls();
 	gain3.UpdateControls();
@@ -244,26 +288,35 @@ void PowerStage2::Run(uint32_t n_samples)
 	}
 
 
+	size_t factor = oversampler.GetFactor();
 	uint32_t ix = 0;
-	float lastValue = this->lastvalue;
 	while (ix < n_samples)
 	{
-		float input = this->input[ix];
+		size_t n = std::min((size_t)(n_samples - ix), oversampler.GetMaxBlockSize());
+		float *buffer = oversampler.Upsample(this->input + ix, n);
+		size_t nOversampled = n * factor;
+
+		// Sag moves at sub-audio rates, so its input scale is ramped across the block
+		// (from the value at the end of the previous block) rather than fed back per sample.
+		// That lets each gain stage run over the whole block in a single pass.
+		float targetInputScale = sagProcessor.GetInputScale();
+		float dInputScale = (targetInputScale - sagInputScale) / nOversampled;
+		float inputScale = sagInputScale;
+		for (size_t i = 0; i < nOversampled; ++i)
+		{
+			inputScale += dInputScale;
+			buffer[i] *= inputScale;
+		}
+		sagInputScale = targetInputScale;
 
-		double dx = (input-lastValue)*0.25;
+		gain1.Process(buffer, nOversampled);
+		gain2.Process(buffer, nOversampled);
+		gain3.Process(buffer, nOversampled);
 
-		double lastOutput = 0;
-		for (int i = 0; i < 4; ++i)
+		for (size_t i = 0; i < nOversampled; ++i)
 		{
-			lastValue += dx;
-			float x = (float)(this->upsamplingFilter.Tick(lastValue));
 			//=========
-			float x1 = gain1.Tick(
-						x*sagProcessor.GetInputScale()
-							);
-			float x2 = gain2.Tick(x1);
-			float x3 = gain3.Tick(x2);
-			float x4 = sagProcessor.TickOutput(x3);
+			float x4 = sagProcessor.TickOutput(buffer[i]);
 			float xOut = masterVolumeDezipped.Tick()*x4;
 
 			float absX = std::abs(xOut);
@@ -274,14 +327,15 @@ void PowerStage2::Run(uint32_t n_samples)
 			}
 
 			//=========
-
-			lastOutput = this->downsamplingFilter.Tick(xOut);
+			buffer[i] = xOut;
 		}
-		this->output[ix] = Undenormalize(lastOutput);
-		lastValue = input;
-		++ix;
-	}	
-	this->lastvalue = lastValue;
+		oversampler.Downsample(buffer, this->output + ix, n);
+		ix += n;
+	}
+	if (latencyOut)
+	{
+		*latencyOut = (float)std::round(oversampler.GetLatency());
+	}
 	
 	frameTime += n_samples;
 
@@ -51,7 +51,9 @@
 #include "GainSection.h"
 #include "DbDezipper.h"
 #include "SagProcessor.h"
-#include "Filters/ChebyshevDownsamplingFilter.h"
+#include "LsNumerics/Oversampler.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 
@@ -100,6 +102,11 @@ namespace toob {
 
 			// Non-gui controls
 			SAGF,    //21
+			OVERSAMPLE,
+			OVERSAMPLE_FILTER,
+			LATENCY,
+			CPU_LOAD,
+			CPU_PEAK,
 		};
 
 		double rate;
@@ -122,11 +129,12 @@ namespace toob {
 
 		DbDezipper masterVolumeDezipped;
 
-		ChebyshevDownsamplingFilter upsamplingFilter;
-		ChebyshevDownsamplingFilter downsamplingFilter;
-		float *upsampledInputBuffer = nullptr;
-		float *upsampledOutputBuffer = nullptr;
-		float lastvalue = 0;
+		RangedInputPort oversample = RangedInputPort(1.0f, 8.0f);
+		RangedInputPort oversampleFilter = RangedInputPort(0.0f, 1.0f);
+		float *latencyOut = nullptr;
+		LsNumerics::Oversampler oversampler;
+		RtTraceSource traceSource{"PowerStage2"};
+		CpuLoadMeter cpuLoadMeter;
 
 
 		uint64_t frameTime = 0;
@@ -194,6 +202,7 @@ namespace toob {
 
 		int32_t peakDelay = 0;
 		float peakValue = 0;
+		float sagInputScale = 1;
 	private:
 		LV2_Atom_Forge_Ref WriteWaveShape(LV2_URID propertyUrid,GainSection *pGain);
 
@@ -204,6 +213,8 @@ namespace toob {
 		void SetProgram(uint8_t programNumber);
 		LV2_Atom_Forge_Ref WriteFrequencyResponse();
 		void WriteUiState();
+		void UpdateOversampling();
+		void SetOversampledRate(double oversampledRate);
 	protected:
 		double getRate() { return rate; }
 		std::string getBundlePath() { return bundle_path.c_str(); }
@@ -0,0 +1,380 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "RtTrace.hpp"
+#include "ThreadManager.hpp"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+using namespace toob;
+
+namespace
+{
+    struct Ring
+    {
+        std::atomic<uint64_t> writeIndex{0};
+        std::atomic<bool> claimed{false};
+        std::atomic<int> tid{0};
+
+        // dumper thread only.
+        uint64_t readIndex = 0;
+
+        RtTrace::Record records[RtTrace::RING_SIZE];
+    };
+
+    class TraceWriter
+    {
+    public:
+        TraceWriter(const std::string &path);
+        ~TraceWriter();
+
+        uint16_t RegisterName(const std::string &name, bool isInstance);
+        Ring *ClaimRing() noexcept;
+
+    private:
+        void StartThread();
+        void ThreadProc();
+        void Drain();
+        void WriteThreadName(int tid);
+        static std::string Escape(const std::string &text);
+
+        std::ofstream f;
+        int pid;
+        bool firstEvent = true;
+        std::unique_ptr<Ring[]> rings;
+
+        std::mutex nameMutex;
+        std::vector<std::string> names;
+        std::map<std::string, uint16_t> nameIds;
+        std::map<std::string, size_t> instanceCounts;
+
+        std::mutex threadMutex;
+        std::condition_variable threadCv;
+        bool threadStarted = false;
+        bool stopping = false;
+        std::thread thread;
+
+        std::vector<RtTrace::Record> drainBuffer;
+        std::set<int> namedThreads;
+        uint64_t droppedRecords = 0;
+    };
+
+    std::unique_ptr<TraceWriter> traceWriter;
+
+    // initial-exec, so that the first access from a thread doesn't allocate.
+    thread_local Ring *threadRing __attribute__((tls_model("initial-exec"))) = nullptr;
+}
+
+bool RtTrace::enabled = RtTrace::Initialize();
+
+bool RtTrace::Initialize()
+{
+    const char *path = getenv("TOOB_TRACE");
+    if (path == nullptr || path[0] == '\0')
+    {
+        return false;
+    }
+    try
+    {
+        traceWriter = std::make_unique<TraceWriter>(path);
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+    return true;
+}
+
+uint16_t RtTrace::RegisterName(const std::string &name)
+{
+    if (!traceWriter)
+    {
+        return 0;
+    }
+    return traceWriter->RegisterName(name, false);
+}
+
+uint16_t RtTrace::RegisterInstance(const std::string &name)
+{
+    if (!traceWriter)
+    {
+        return 0;
+    }
+    return traceWriter->RegisterName(name, true);
+}
+
+void RtTrace::Write(uint16_t source, uint16_t phase, clock::time_point start, clock::time_point end) noexcept
+{
+    Ring *ring = threadRing;
+    if (ring == nullptr)
+    {
+        if (!traceWriter)
+        {
+            return;
+        }
+        ring = traceWriter->ClaimRing();
+        if (ring == nullptr)
+        {
+            return;
+        }
+        threadRing = ring;
+    }
+    uint64_t index = ring->writeIndex.load(std::memory_order_relaxed);
+    Record &record = ring->records[index & (RING_SIZE - 1)];
+
+    int64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    record.startNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+    record.durationNs = (uint32_t)std::min(duration, (int64_t)UINT32_MAX);
+    record.source = source;
+    record.phase = phase;
+
+    ring->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void RtTrace::ReleaseThread() noexcept
+{
+    if (threadRing)
+    {
+        threadRing->claimed.store(false, std::memory_order_release);
+        threadRing = nullptr;
+    }
+}
+
+TraceWriter::TraceWriter(const std::string &path)
+    : f(path, std::ios_base::trunc),
+      pid((int)getpid()),
+      rings(new Ring[RtTrace::MAX_THREADS])
+{
+    if (!f.is_open())
+    {
+        throw std::runtime_error("Can't open trace file.");
+    }
+    drainBuffer.resize(RtTrace::RING_SIZE);
+
+    // predefined phases, in RtTrace::Phase order.
+    RegisterName("run", false);
+    RegisterName("work", false);
+    RegisterName("work_response", false);
+    RegisterName("background", false);
+
+    f << "[";
+}
+
+TraceWriter::~TraceWriter()
+{
+    {
+        std::lock_guard lock{threadMutex};
+        stopping = true;
+    }
+    threadCv.notify_all();
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+    Drain();
+    if (droppedRecords != 0)
+    {
+        f << (firstEvent ? "\n" : ",\n");
+        f << "{\"name\":\"dropped records\",\"ph\":\"i\",\"s\":\"g\",\"ts\":0,\"pid\":" << pid
+          << ",\"tid\":0,\"args\":{\"count\":" << droppedRecords << "}}";
+    }
+    f << "\n]\n";
+}
+
+uint16_t TraceWriter::RegisterName(const std::string &baseName, bool isInstance)
+{
+    std::string name = baseName;
+    uint16_t id;
+    {
+        std::lock_guard lock{nameMutex};
+        if (isInstance)
+        {
+            name = name + " " + std::to_string(++instanceCounts[name]);
+        }
+        auto iName = nameIds.find(name);
+        if (iName != nameIds.end())
+        {
+            return iName->second;
+        }
+        if (names.size() >= RtTrace::MAX_NAMES)
+        {
+            return 0;
+        }
+        id = (uint16_t)names.size();
+        names.push_back(name);
+        nameIds[name] = id;
+    }
+    if (isInstance)
+    {
+        StartThread();
+    }
+    return id;
+}
+
+Ring *TraceWriter::ClaimRing() noexcept
+{
+    for (size_t i = 0; i < RtTrace::MAX_THREADS; ++i)
+    {
+        Ring *ring = &rings[i];
+        bool expected = false;
+        if (ring->claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        {
+            ring->tid.store((int)syscall(SYS_gettid), std::memory_order_release);
+            return ring;
+        }
+    }
+    return nullptr;
+}
+
+void TraceWriter::StartThread()
+{
+    std::lock_guard lock{threadMutex};
+    if (!threadStarted)
+    {
+        threadStarted = true;
+        thread = std::thread([this]() { ThreadProc(); });
+    }
+}
+
+void TraceWriter::ThreadProc()
+{
+    toob::ThreadManager::Get().ConfigureCurrentThread(toob::ThreadRole::TraceWriter);
+    std::unique_lock lock{threadMutex};
+    while (!stopping)
+    {
+        threadCv.wait_for(lock, std::chrono::milliseconds(250));
+        if (stopping)
+        {
+            break;
+        }
+        lock.unlock();
+        Drain();
+        lock.lock();
+    }
+}
+
+std::string TraceWriter::Escape(const std::string &text)
+{
+    std::string result;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+        }
+        if ((unsigned char)c >= 0x20)
+        {
+            result += c;
+        }
+    }
+    return result;
+}
+
+void TraceWriter::WriteThreadName(int tid)
+{
+    std::string name;
+    std::ifstream comm("/proc/self/task/" + std::to_string(tid) + "/comm");
+    if (comm.is_open())
+    {
+        std::getline(comm, name);
+    }
+    if (name.empty())
+    {
+        name = "thread " + std::to_string(tid);
+    }
+    f << (firstEvent ? "\n" : ",\n");
+    firstEvent = false;
+    f << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid
+      << ",\"args\":{\"name\":\"" << Escape(name) << "\"}}";
+}
+
+void TraceWriter::Drain()
+{
+    std::lock_guard lock{nameMutex};
+
+    for (size_t i = 0; i < RtTrace::MAX_THREADS; ++i)
+    {
+        Ring &ring = rings[i];
+        uint64_t writeIndex = ring.writeIndex.load(std::memory_order_acquire);
+        if (writeIndex == ring.readIndex)
+        {
+            continue;
+        }
+        uint64_t start = ring.readIndex;
+        if (writeIndex - start > RtTrace::RING_SIZE)
+        {
+            droppedRecords += writeIndex - start - RtTrace::RING_SIZE;
+            start = writeIndex - RtTrace::RING_SIZE;
+        }
+        size_t n = 0;
+        for (uint64_t ix = start; ix < writeIndex; ++ix)
+        {
+            drainBuffer[n++] = ring.records[ix & (RtTrace::RING_SIZE - 1)];
+        }
+        // Discard anything the writer may have overwritten while we were copying.
+        uint64_t newWriteIndex = ring.writeIndex.load(std::memory_order_acquire);
+        size_t skip = 0;
+        if (newWriteIndex >= RtTrace::RING_SIZE && newWriteIndex - RtTrace::RING_SIZE + 1 > start)
+        {
+            skip = (size_t)std::min<uint64_t>(newWriteIndex - RtTrace::RING_SIZE + 1 - start, n);
+            droppedRecords += skip;
+        }
+        ring.readIndex = writeIndex;
+
+        int tid = ring.tid.load(std::memory_order_acquire);
+        if (namedThreads.insert(tid).second)
+        {
+            WriteThreadName(tid);
+        }
+
+        for (size_t r = skip; r < n; ++r)
+        {
+            const RtTrace::Record &record = drainBuffer[r];
+            const std::string &source = record.source < names.size() ? names[record.source] : "?";
+            const std::string &phase = record.phase < names.size() ? names[record.phase] : "?";
+
+            f << (firstEvent ? "\n" : ",\n");
+            firstEvent = false;
+            f << "{\"name\":\"" << Escape(source) << "\",\"cat\":\"" << Escape(phase)
+              << "\",\"ph\":\"X\",\"ts\":" << std::fixed << std::setprecision(3) << record.startNs * 1E-3
+              << ",\"dur\":" << record.durationNs * 1E-3
+              << ",\"pid\":" << pid << ",\"tid\":" << tid << "}";
+        }
+    }
+    f.flush();
+}
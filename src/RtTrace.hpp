@@ -0,0 +1,139 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace toob
+{
+    /// @brief Low-overhead execution tracing, for finding where block deadlines are missed on a live rig.
+    ///
+    /// Tracing is compiled into release builds, but is disabled unless the TOOB_TRACE environment
+    /// variable holds the name of an output file when the plugin library is loaded. When disabled,
+    /// a trace scope costs a single test of a global flag.
+    ///
+    /// Each thread that writes trace records gets its own lock-free ring of fixed-size records, claimed
+    /// from a preallocated pool on first use (no allocation, no locks). A background thread drains
+    /// the rings periodically, and writes Chrome trace event JSON, which can be viewed in
+    /// chrome://tracing, or https://ui.perfetto.dev.
+    ///
+    /// e.g. TOOB_TRACE=/tmp/toob_trace.json pipedald
+    class RtTrace
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        static constexpr size_t MAX_THREADS = 32;
+        static constexpr size_t RING_SIZE = 8192; // records per thread; must be a power of 2.
+        static constexpr size_t MAX_NAMES = 1024;
+
+        /// Predefined phase names.
+        enum Phase : uint16_t
+        {
+            Run = 0,
+            Work = 1,
+            WorkResponse = 2,
+            Background = 3,
+        };
+
+        struct Record
+        {
+            uint64_t startNs;
+            uint32_t durationNs;
+            uint16_t source;
+            uint16_t phase;
+        };
+
+        static bool Enabled() { return enabled; }
+
+        /// @brief Get the id of a name (a phase, or a trace source). Not real-time safe.
+        /// @returns The id of the name, or 0 if tracing is disabled.
+        static uint16_t RegisterName(const std::string &name);
+
+        /// @brief Register a uniquely numbered name for a plugin instance (e.g. "ToobNam 2"). Not real-time safe.
+        static uint16_t RegisterInstance(const std::string &name);
+
+        /// @brief Write a record to the calling thread's trace ring. Real-time safe.
+        static void Write(uint16_t source, uint16_t phase, clock::time_point start, clock::time_point end) noexcept;
+
+        /// @brief Return the calling thread's ring to the pool.
+        ///
+        /// Threads that are owned by plugins should call this before they exit, so that their
+        /// ring can be reused.
+        static void ReleaseThread() noexcept;
+
+    private:
+        static bool enabled;
+        static bool Initialize();
+    };
+
+    /// @brief A named source of trace records (typically a plugin instance).
+    class RtTraceSource
+    {
+    public:
+        RtTraceSource(const char *name)
+            : id(RtTrace::Enabled() ? RtTrace::RegisterInstance(name) : 0)
+        {
+        }
+        uint16_t Id() const { return id; }
+
+    private:
+        uint16_t id;
+    };
+
+    /// @brief Records the duration of the enclosing scope.
+    class RtTraceScope
+    {
+    public:
+        RtTraceScope(const RtTraceSource &source, uint16_t phase = RtTrace::Phase::Run) noexcept
+        {
+            if (RtTrace::Enabled())
+            {
+                this->active = true;
+                this->source = source.Id();
+                this->phase = phase;
+                this->start = RtTrace::clock::now();
+            }
+        }
+        ~RtTraceScope() noexcept
+        {
+            if (active)
+            {
+                RtTrace::Write(source, phase, start, RtTrace::clock::now());
+            }
+        }
+        RtTraceScope(const RtTraceScope &) = delete;
+        RtTraceScope &operator=(const RtTraceScope &) = delete;
+
+    private:
+        bool active = false;
+        uint16_t source = 0;
+        uint16_t phase = 0;
+        RtTrace::clock::time_point start;
+    };
+}
@@ -55,6 +55,7 @@ namespace toob{
         {
             powerFilter.SetSampleRate(rate);
             powerFilter.SetCutoffFrequency(13.0);
+            SagF.Invalidate();
         }
 
         void Reset()
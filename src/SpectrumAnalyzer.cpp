@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //
 
 #include "SpectrumAnalyzer.h"
+#include "LsNumerics/Denorms.hpp"
 
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
@@ -41,7 +42,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sstream>
 #include <iomanip>
 #include "LsNumerics/LsMath.hpp"
-#include "LsNumerics/Window.hpp"
 
 using namespace std;
 using namespace toob;
@@ -74,6 +74,7 @@ SpectrumAnalyzer::SpectrumAnalyzer(double _rate,
 {
 	urids.Map(this);
 	lv2_atom_forge_init(&forge, map);
+	cpuLoadMeter.SetSampleRate(_rate);
 }
 
 SpectrumAnalyzer::~SpectrumAnalyzer()
@@ -106,6 +107,12 @@ void SpectrumAnalyzer::ConnectPort(uint32_t port, void *data)
 	case PortId::LEVEL:
 		this->level.SetData(data);
 		break;
+	case PortId::CPU_LOAD:
+		this->cpuLoadMeter.SetLoadData(data);
+		break;
+	case PortId::CPU_PEAK:
+		this->cpuLoadMeter.SetPeakData(data);
+		break;
 	}
 }
 
@@ -120,6 +127,9 @@ void SpectrumAnalyzer::Deactivate()
 
 void SpectrumAnalyzer::Run(uint32_t n_samples)
 {
+	RtTraceScope traceScope(traceSource);
+	CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+	LsNumerics::AutoDenorm autoDenorm;
 	// prepare forge to write to notify output port.
 	// Set up forge to write directly to notify output port.
 	const uint32_t notify_capacity = this->notifyOut->atom.size;
@@ -162,33 +172,50 @@ void SpectrumAnalyzer::Run(uint32_t n_samples)
 
 void SpectrumAnalyzer::WriteSpectrum()
 {
-	if (!enabled)
-		return;
-	lv2_atom_forge_frame_time(&forge, 0);
+	if (enabled && !pSvgPath->empty())
+	{
+		lv2_atom_forge_frame_time(&forge, 0);
 
-	LV2_Atom_Forge_Frame objectFrame;
+		LV2_Atom_Forge_Frame objectFrame;
 
-	lv2_atom_forge_object(&forge, &objectFrame, 0, urids.patch__Set);
-	lv2_atom_forge_key(&forge, urids.patch__property);
-	lv2_atom_forge_urid(&forge, urids.patchProperty__spectrumResponse);
+		lv2_atom_forge_object(&forge, &objectFrame, 0, urids.patch__Set);
+		lv2_atom_forge_key(&forge, urids.patch__property);
+		lv2_atom_forge_urid(&forge, urids.patchProperty__spectrumResponse);
 
-	lv2_atom_forge_key(&forge, urids.patch__value);
-	LV2_Atom_Forge_Frame tupleFrame;
-	lv2_atom_forge_tuple(&forge,&tupleFrame);
-	{
-		lv2_atom_forge_string(&forge, this->pSvgPath->c_str(), (uint32_t)(this->pSvgPath->length()));
-		lv2_atom_forge_string(&forge, this->pSvgHoldPath->c_str(), (uint32_t)(this->pSvgHoldPath->length()));
+		lv2_atom_forge_key(&forge, urids.patch__value);
+		LV2_Atom_Forge_Frame tupleFrame;
+		lv2_atom_forge_tuple(&forge,&tupleFrame);
+		{
+			lv2_atom_forge_string(&forge, this->pSvgPath->c_str(), (uint32_t)(this->pSvgPath->length()));
+			lv2_atom_forge_string(&forge, this->pSvgHoldPath->c_str(), (uint32_t)(this->pSvgHoldPath->length()));
+		}
+		lv2_atom_forge_pop(&forge,&tupleFrame);
+
+		lv2_atom_forge_pop(&forge, &objectFrame);
 	}
-	lv2_atom_forge_pop(&forge,&tupleFrame);
+	if (frameEnabled && !pSpectrumFrame->empty())
+	{
+		lv2_atom_forge_frame_time(&forge, 0);
+
+		LV2_Atom_Forge_Frame objectFrame;
+
+		lv2_atom_forge_object(&forge, &objectFrame, 0, urids.patch__Set);
+		lv2_atom_forge_key(&forge, urids.patch__property);
+		lv2_atom_forge_urid(&forge, urids.patchProperty__spectrumFrame);
 
-	lv2_atom_forge_pop(&forge, &objectFrame);
+		lv2_atom_forge_key(&forge, urids.patch__value);
+		lv2_atom_forge_vector(&forge, sizeof(float), urids.atom__float, (uint32_t)pSpectrumFrame->size(), pSpectrumFrame->data());
+
+		lv2_atom_forge_pop(&forge, &objectFrame);
+	}
 }
 
-void SpectrumAnalyzer::OnSvgPathReady(const std::string &svgPath,const std::string&svgHoldPath)
+void SpectrumAnalyzer::OnSvgPathReady(const std::string &svgPath,const std::string&svgHoldPath, const std::vector<float>&spectrumFrame)
 {
 	this->svgPathReady = true;
 	this->pSvgPath = &svgPath;
 	this->pSvgHoldPath = &svgHoldPath;
+	this->pSpectrumFrame = &spectrumFrame;
 }
 
 void SpectrumAnalyzer::HandleEvent(LV2_Atom_Event *event)
@@ -251,12 +278,32 @@ void SpectrumAnalyzer::OnPatchSet(LV2_URID propertyUrid, const LV2_Atom*value)
 		} else {
 			--enabledCount;
 		}
-		bool enabled = enabledCount != 0;
-		if (enabled != this->enabled)
+		UpdateEnabled();
+	} else if (propertyUrid == urids.patchProperty__spectrumFrameEnable)
+	{
+		LV2_Atom_Bool *pVal = (LV2_Atom_Bool*)value;
+		bool enabledVal = pVal->body != 0;
+		if (enabledVal)
 		{
-			this->enabled = enabled;
-			fftWorker.SetEnabled(enabled);
+			++frameEnabledCount;
+		} else {
+			--frameEnabledCount;
 		}
+		UpdateEnabled();
+	}
+}
+
+void SpectrumAnalyzer::UpdateEnabled()
+{
+	// SVG paths are only generated for clients that asked for them.
+	bool enabled = enabledCount != 0;
+	bool frameEnabled = frameEnabledCount != 0;
+	if (enabled != this->enabled || frameEnabled != this->frameEnabled)
+	{
+		this->enabled = enabled;
+		this->frameEnabled = frameEnabled;
+		fftWorker.SetOutputFormats(enabled, frameEnabled);
+		fftWorker.SetEnabled(enabled || frameEnabled);
 	}
 }
 
@@ -311,6 +358,12 @@ void SpectrumAnalyzer::FftWorker::SetEnabled(bool enabled)
 	}
 }
 
+void SpectrumAnalyzer::FftWorker::SetOutputFormats(bool svgEnabled, bool frameEnabled)
+{
+	this->svgEnabled = svgEnabled;
+	this->frameEnabled = frameEnabled;
+}
+
 void SpectrumAnalyzer::FftWorker::BackgroundTask::Initialize(FftWorker*fftWorker)
 {
 
@@ -318,17 +371,16 @@ void SpectrumAnalyzer::FftWorker::BackgroundTask::Initialize(FftWorker*fftWorker
 	blockSize = fftWorker->blockSize;
 	this->sampleRate = fftWorker->sampleRate;
 
-	fft.SetSize(blockSize);
-	fftResult.resize(blockSize);
-
-
-	this->norm = 2/std::sqrt(blockSize);
+	samples.resize(blockSize);
 
-
-	fftValues.resize(blockSize/2);
-	fftHoldValues.resize(blockSize/2);
-	fftHoldTimes.resize(0);
-	fftHoldTimes.resize(blockSize/2);
+	// the spectrum is prepared on the worker thread, once the frequency range is known.
+	preparedMinFrequency = 0;
+	preparedMaxFrequency = 0;
+	pointValues.resize(SPECTRUM_POINTS+1);
+	holdValues.resize(SPECTRUM_POINTS+1);
+	holdTimes.resize(0);
+	holdTimes.resize(SPECTRUM_POINTS+1);
+	spectrumFrame.reserve(2+2*(SPECTRUM_POINTS+1));
 
 	constexpr float HOLD_TIME_SECONDS = 2.0;
 	this->holdSamples = (size_t)(sampleRate*HOLD_TIME_SECONDS);
@@ -336,8 +388,6 @@ void SpectrumAnalyzer::FftWorker::BackgroundTask::Initialize(FftWorker*fftWorker
 	constexpr float DECAY_TIME = 2.0;
 
 	this->holdDecay = -60*(samplesPerUpdate/(DECAY_TIME*sampleRate));
-
-	fftWindow = LsNumerics::Window::FlatTop<double>(blockSize);
 }
 void SpectrumAnalyzer::FftWorker::Initialize(double sampleRate, size_t blockSize, float minFrequency,float maxFrequency, float dbLevel)
 {
@@ -381,6 +431,8 @@ void SpectrumAnalyzer::FftWorker::BackgroundTask::CaptureData(FftWorker *fftWork
 	fftWorker->resetHoldValues = false;
 	this->minFrequency = fftWorker->minFrequency;
 	this->maxFrequency = fftWorker->maxFrequency;
+	this->svgEnabled = fftWorker->svgEnabled;
+	this->frameEnabled = fftWorker->frameEnabled;
 
 	this->capturePosition = fftWorker->captureIndex;
 	this->pCaptureBuffer = &(fftWorker->captureBuffer);
@@ -403,8 +455,7 @@ void SpectrumAnalyzer::FftWorker::BackgroundTask::CopyFromCaptureBuffer()
 		size_t ix = 0;
 		for (size_t i = captureStart; i < captureEnd;++i)
 		{
-			float value = (*pCaptureBuffer)[i];
-			fftResult[ix++] = std::complex<double>(value,0);
+			samples[ix++] = (*pCaptureBuffer)[i];
 		}
 	} else {
 		// data wraps around. Two segments.
@@ -413,44 +464,48 @@ void SpectrumAnalyzer::FftWorker::BackgroundTask::CopyFromCaptureBuffer()
 		size_t ix = 0;
 		for (size_t i = captureStart; i < pCaptureBuffer->size(); ++i)
 		{
-			float value = (*pCaptureBuffer)[i];
-			fftResult[ix++] = std::complex<double>(value,0);
+			samples[ix++] = (*pCaptureBuffer)[i];
 		}
 		for (size_t i = 0; i < captureEnd;++i)
 		{
-			float value = (*pCaptureBuffer)[i];
-			fftResult[ix++] = std::complex<double>(value,0);
+			samples[ix++] = (*pCaptureBuffer)[i];
 		}
 	}
 }
-void SpectrumAnalyzer::FftWorker::BackgroundTask::CalculateSvgPaths(size_t blockSize,float minF, float maxF, float dbLevel)
+void SpectrumAnalyzer::FftWorker::BackgroundTask::CalculateSpectrum(float dbLevel)
 {
+	if (minFrequency != preparedMinFrequency || maxFrequency != preparedMaxFrequency)
+	{
+		// (worker thread, so allocation is fine.)
+		spectrum.Prepare(sampleRate,blockSize,FFT_RESOLUTIONS,minFrequency,maxFrequency,SPECTRUM_POINTS+1);
+		preparedMinFrequency = minFrequency;
+		preparedMaxFrequency = maxFrequency;
+		this->resetHoldValues = true;
+	}
 	if (this->resetHoldValues)
 	{
 		this->resetHoldValues = false;
 
-		for (size_t i = 0; i < fftHoldValues.size(); ++i)
+		for (size_t i = 0; i < holdValues.size(); ++i)
 		{
-			fftHoldValues[i] = -200;
+			holdValues[i] = -200;
 		}
 	}
 
 	// copy fft data out of the capture buffer.
 	CopyFromCaptureBuffer();
 
+	spectrum.Process(samples.data(),pointValues.data());
 
-	fft.Forward(fftResult,fftResult);
-
-
-	for (size_t i = 0; i < fftValues.size(); ++i)
+	for (size_t i = 0; i < pointValues.size(); ++i)
 	{
-		fftValues[i] = Af2Db(norm*std::abs(fftResult[i]))+ dbLevel;
+		pointValues[i] += dbLevel;
 	}
 
-	for (size_t i = 0; i < fftValues.size(); ++i)
+	for (size_t i = 0; i < pointValues.size(); ++i)
 	{
-		float x = fftHoldValues[i];
-		int64_t t = fftHoldTimes[i];
+		float x = holdValues[i];
+		int64_t t = holdTimes[i];
 		t -= samplesPerUpdate;
 		if (t <= 0)
 		{
@@ -461,78 +516,52 @@ void SpectrumAnalyzer::FftWorker::BackgroundTask::CalculateSvgPaths(size_t block
 				x = -200;
 			}
 		} 
-		float result = fftValues[i];
+		float result = pointValues[i];
 		if (result > x)
 		{
 			x = result;
 			t = this->holdSamples;
 		}
-		fftHoldValues[i] = x;
-		fftHoldTimes[i] = t;
+		holdValues[i] = x;
+		holdTimes[i] = t;
 	}
 
-	this->svgPath = FftToSvg(fftValues);
-	this->svgHoldPath = FftToSvg(fftHoldValues);
+	if (svgEnabled)
+	{
+		this->svgPath = PointsToSvg(pointValues);
+		this->svgHoldPath = PointsToSvg(holdValues);
+	} else {
+		this->svgPath.clear();
+		this->svgHoldPath.clear();
+	}
+	spectrumFrame.clear();
+	if (frameEnabled)
+	{
+		spectrumFrame.push_back(minFrequency);
+		spectrumFrame.push_back(maxFrequency);
+		spectrumFrame.insert(spectrumFrame.end(),pointValues.begin(),pointValues.end());
+		spectrumFrame.insert(spectrumFrame.end(),holdValues.begin(),holdValues.end());
+	}
 }
-std::string SpectrumAnalyzer::FftWorker::BackgroundTask::FftToSvg(const std::vector<float>& fft)
+std::string SpectrumAnalyzer::FftWorker::BackgroundTask::PointsToSvg(const std::vector<float>& points)
 {
-	int lastX = 0;
-	int lastValue = 1000;
-
-	float logMinF = std::log(minFrequency);
-	float logMaxF = std::log(maxFrequency);
+	// points are already on a log-frequency axis, one per x coordinate.
+	constexpr float MAX_DB = 0;
+	constexpr float MIN_DB = -80;
+	constexpr float MAX_Y = 0;
+	constexpr float MIN_Y = 1000;
+	constexpr float SCALE = (MAX_Y-MIN_Y)/(MAX_DB-MIN_DB);
 
 	std::stringstream s;
-	s << std::setprecision(4); 
 	s << "M0,1000";
-	for (size_t i = 1; i < fft.size(); ++i) // "= 1": ignore DC since the window function gives is a DC that fluctuates wildly.
+	for (size_t x = 0; x < points.size(); ++x)
 	{
-		float mag = fft[i];
+		float mag = points[x];
 		if (mag < -150) mag = -150;
-		float f = i*sampleRate/blockSize;
-		float logF = std::log(f);
-		int x = (logF-logMinF)*SPECTRUM_POINTS/(logMaxF-logMinF);
-		constexpr float MAX_DB = 0;
-		constexpr float MIN_DB = -80;
-		constexpr float MAX_Y = 0;
-		constexpr float MIN_Y = 1000;
-		constexpr float SCALE = (MAX_Y-MIN_Y)/(MAX_DB-MIN_DB);
-
 		float value = (mag-MIN_DB)*SCALE+MIN_Y;
-
-		if (lastX != x)
-		{
-
-			if (x >= 0)
-			{
-				if (x >= SPECTRUM_POINTS) 
-				{
-					float blend = (SPECTRUM_POINTS-lastX)/(x-lastX);
-					float xN = lastValue*(1-blend)+value*blend;
-					s << " L" << SPECTRUM_POINTS << ',' << (int)std::round(xN);	
-					break;
-				}
-				else if (lastX < 0 && x != 0)
-				{
-					float blend = -lastX/(x-lastX);
-					float x0 = lastValue*(1-blend)+value*blend;
-				
-					s << " L" << 0 << ',' << (int)std::round(x0);	
-					s << " L" << x << ',' << (int)std::round(value);	
-				} else {
-					s << " L" << x << ',' << value;
-				}
-			}
-			lastX = x;
-			lastValue = value;
-		} else {
-			if (x == lastX && value < lastValue) {
-				lastValue = value;
-			}
-		}
+		s << " L" << x << ',' << (int)std::round(value);
 	}
-	s << " L" << lastX << "," << (int)std::round(lastValue);
-	s << " L" << lastX << "," << 1000;
+	s << " L" << (points.size()-1) << "," << 1000;
 	s << " L" << 0 << "," << 1000; // close the path.
 		
 	return s.str();
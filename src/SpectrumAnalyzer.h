@@ -46,7 +46,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Filters/ShelvingLowCutFilter2.h"
 #include "NoiseGate.h"
 #include "GainStage.h"
-#include "LsNumerics/StagedFft.hpp"
+#include "LsNumerics/MultiResolutionSpectrum.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 
@@ -65,10 +67,14 @@ namespace toob {
 			NOTIFY_OUT,
 			MIN_F,
 			MAX_F,
-			LEVEL
+			LEVEL,
+			CPU_LOAD,
+			CPU_PEAK
 		};
 		static constexpr size_t MAX_BUFFER_SIZE = 16*1024;
 		static constexpr size_t FFT_SIZE = 16*1024;
+		// FFTs of FFT_SIZE, FFT_SIZE/2, ... Higher frequencies are taken from shorter FFTs. 1 to use a single FFT.
+		static constexpr size_t FFT_RESOLUTIONS = 4;
 
 		RangedInputPort minF = RangedInputPort(10.0f, 400.0f);
 		RangedInputPort maxF = RangedInputPort(1000.0f,22000.0f);
@@ -77,12 +83,13 @@ namespace toob {
 		bool svgPathReady = false;
 		const std::string *pSvgPath = nullptr;
 		const std::string *pSvgHoldPath = nullptr;
+		const std::vector<float> *pSpectrumFrame = nullptr;
 
 
 		class FftWorker: public WorkerAction
 		{
 		private: 
-			static constexpr float FRAMES_PER_SECOND = 15;
+			static constexpr float FRAMES_PER_SECOND = 30;
 
 			enum class FftState {
 				Idle,
@@ -93,6 +100,8 @@ namespace toob {
 			};
 			FftState state = FftState::Idle;
 			bool enabled = false;
+			bool svgEnabled = false;
+			bool frameEnabled = false;
 			double sampleRate;
 			size_t captureIndex = 0;
 			size_t samplesPerUpdate = 0;
@@ -119,6 +128,7 @@ namespace toob {
 			void Reset();
 			void Deactivate();
 			void SetEnabled(bool enabled);
+			void SetOutputFormats(bool svgEnabled, bool frameEnabled);
 			void OnWriteComplete()
 			{
 				this->state = FftState::Idle;
@@ -156,11 +166,11 @@ namespace toob {
 			}
 		protected:
 			void OnWork() {
-				backgroundTask.CalculateSvgPaths(blockSize,minFrequency,maxFrequency,dbLevel);
+				backgroundTask.CalculateSpectrum(dbLevel);
 			}
 			void OnResponse()
 			{
-				pThis->OnSvgPathReady(this->backgroundTask.svgPath,this->backgroundTask.svgHoldPath);
+				pThis->OnSvgPathReady(this->backgroundTask.svgPath,this->backgroundTask.svgHoldPath,this->backgroundTask.spectrumFrame);
 			}
 
 		private:
@@ -169,36 +179,40 @@ namespace toob {
 			private:
 				std::vector<float> *pCaptureBuffer;
 				size_t capturePosition;
-				std::vector<float> fftValues;
-				std::vector<float> fftHoldValues;
-				std::vector<int64_t> fftHoldTimes;
-				std::vector<std::complex<double>> fftResult;
+				std::vector<float> samples;
+				std::vector<float> pointValues;
+				std::vector<float> holdValues;
+				std::vector<int64_t> holdTimes;
 				size_t samplesPerUpdate = 0;
 
 				size_t blockSize = 0;
-				double norm =0;
 				double sampleRate = 0;
 				size_t holdSamples = 0;
 				float holdDecay = 0;
 				bool resetHoldValues = true;
+				bool svgEnabled = false;
+				bool frameEnabled = false;
 
 
 				float minFrequency = 0;
 				float maxFrequency = 0;
+				float preparedMinFrequency = 0;
+				float preparedMaxFrequency = 0;
 
-				LsNumerics::StagedFft fft {4};
-				std::vector<double> fftWindow;
+				LsNumerics::MultiResolutionSpectrum spectrum;
 
 			public:
 				std::string svgPath;
 				std::string svgHoldPath;
+				// minFrequency, maxFrequency, N point values (dB), N hold values (dB).
+				std::vector<float> spectrumFrame;
 			public:
 				void Initialize(FftWorker* fftWorker);
 				// convenient way to make sure we don't accidentally share state with audio thread.
 				void CaptureData(FftWorker *fftWorker);
 				void CopyFromCaptureBuffer();
-				void CalculateSvgPaths(size_t blockSize,float minF, float maxF, float dbLevel);
-				std::string FftToSvg(const std::vector<float>& fft);
+				void CalculateSpectrum(float dbLevel);
+				std::string PointsToSvg(const std::vector<float>& points);
 			};
 
 			BackgroundTask backgroundTask;
@@ -213,7 +227,7 @@ namespace toob {
 
 		static constexpr  size_t MAX_FFT_SIZE = 8192;
 
-		void OnSvgPathReady(const std::string &svgPath, const std::string&svgHoldPath);
+		void OnSvgPathReady(const std::string &svgPath, const std::string&svgHoldPath, const std::vector<float>&spectrumFrame);
 		void WriteSpectrum();
 
 		double sampleRate;
@@ -249,6 +263,8 @@ namespace toob {
 				units__Frame = plugin->MapURI(LV2_UNITS__frame);
 				patchProperty__spectrumResponse = plugin->MapURI(TOOB_URI  "#spectrumResponse");
 				patchProperty__spectrumEnable = plugin->MapURI(TOOB_URI  "#spectrumEnable");
+				patchProperty__spectrumFrame = plugin->MapURI(TOOB_URI  "#spectrumFrame");
+				patchProperty__spectrumFrameEnable = plugin->MapURI(TOOB_URI  "#spectrumFrameEnable");
 			}
 			LV2_URID patch_accept;
 
@@ -267,6 +283,8 @@ namespace toob {
 			LV2_URID patch__value;
 			LV2_URID patchProperty__spectrumResponse;
 			LV2_URID patchProperty__spectrumEnable;
+			LV2_URID patchProperty__spectrumFrame;
+			LV2_URID patchProperty__spectrumFrameEnable;
 		};
 
 		Urids urids;
@@ -279,6 +297,11 @@ namespace toob {
 	private:
 		bool enabled = false;
 		int64_t enabledCount = 0;
+		bool frameEnabled = false;
+		int64_t frameEnabledCount = 0;
+		RtTraceSource traceSource{"SpectrumAnalyzer"};
+		CpuLoadMeter cpuLoadMeter;
+		void UpdateEnabled();
 
 
 	protected:
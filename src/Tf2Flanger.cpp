@@ -26,6 +26,7 @@
 #include <iostream>
 #include <iomanip>
 #include <cassert>
+#include <algorithm>
 
 using namespace toob;
 using namespace LsNumerics;
@@ -186,11 +187,8 @@ inline void Tf2Flanger::ClearBucketBrigade()
 }
 
 
-inline float Tf2Flanger::TickBucketBrigade(float lfoValue) {
-
-    double fBB = LfoToFreq(lfoValue);
-
-
+inline float Tf2Flanger::ClockBucketBrigade(double fBB)
+{
     float bbDelay = 1/fBB;
 
     double clocksThisSample = fBB/sampleRate + bbX;
@@ -212,6 +210,10 @@ inline float Tf2Flanger::TickBucketBrigade(float lfoValue) {
     return bucketBrigadeTotal;
 }
 
+inline float Tf2Flanger::TickBucketBrigade(float lfoValue) {
+    return ClockBucketBrigade(LfoToFreq(lfoValue));
+}
+
 
 inline double Tf2Flanger::TickLfo()
 {
@@ -231,6 +233,126 @@ inline double Tf2Flanger::TickLfo()
 }
 
 
+void Tf2Flanger::ProcessLfo(float *delaySec, size_t n)
+{
+    // Same arithmetic as TickLfo(), a stage at a time. Only the bucket-brigade clocking 
+    // and the lfo filter carry state from sample to sample.
+    float values[MAX_BLOCK_SIZE];
+    double frequencies[MAX_BLOCK_SIZE];
+    for (size_t i = 0; i < n; ++i)
+    {
+        lfoValue += lfoDx;
+        if (lfoValue >= 1)
+        {
+            lfoValue = lfoValue-2;
+            lfoSign = -lfoSign;
+        }
+        values[i] = lfoValue*lfoSign;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        values[i] = lfoLowpassFilter.Tick(values[i]);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        frequencies[i] = LfoToFreq(values[i]);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        delaySec[i] = ClockBucketBrigade(frequencies[i]);
+    }
+}
+
+void Tf2Flanger::ProcessDelay(const float*input, float *values, float*delayed, size_t n)
+{
+    float delaySec[MAX_BLOCK_SIZE];
+    double index[MAX_BLOCK_SIZE];
+    float feedback[MAX_BLOCK_SIZE];
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        values[i] = preemphasisFilter.Tick(input[i]);
+    }
+    ProcessLfo(delaySec, n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        index[i] = delaySec[i]*sampleRate;
+    }
+
+    // Resonance feeds delay output back into the delay line, so reads can only run ahead of 
+    // writes for as many samples as the delay is long.
+    size_t start = 0;
+    while (start < n)
+    {
+        size_t m = 1;
+        while (start + m < n && index[start + m] >= m)
+        {
+            ++m;
+        }
+        float *pDelayed = delayed + start;
+        const float *pValues = values + start;
+        delayLine.Read(index + start, pDelayed, m);
+        antiAliasingLowpassFilter.Process(pDelayed, pDelayed, m);
+        for (size_t i = 0; i < m; ++i)
+        {
+            float delayValue = pDelayed[i];
+            // TODO: delay is hard-clipped. Should really be diode soft-clipped.
+            if (delayValue > 1.0) 
+                delayValue = 1.0;
+            if (delayValue < -1.0) 
+                delayValue = -1.0; 
+            pDelayed[i] = delayValue;
+
+            double delayInput = pValues[i] + this->res*delayValue;
+            delayInput = this->preDelayHighPass.Tick(delayInput);
+            feedback[i] = (float)delayInput;
+        }
+        delayLine.Write(feedback, m);
+        start += m;
+    }
+}
+
+void Tf2Flanger::Process(const float*input, float*output, size_t n)
+{
+    float values[MAX_BLOCK_SIZE];
+    float delayed[MAX_BLOCK_SIZE];
+    while (n != 0)
+    {
+        size_t m = std::min(n, MAX_BLOCK_SIZE);
+        ProcessDelay(input, values, delayed, m);
+        for (size_t i = 0; i < m; ++i)
+        {
+            output[i] = deemphasisFilterL.Tick(delayed[i]+values[i]);
+        }
+        input += m;
+        output += m;
+        n -= m;
+    }
+}
+
+void Tf2Flanger::Process(const float*input, float*outL, float*outR, size_t n)
+{
+    float values[MAX_BLOCK_SIZE];
+    float delayed[MAX_BLOCK_SIZE];
+    while (n != 0)
+    {
+        size_t m = std::min(n, MAX_BLOCK_SIZE);
+        ProcessDelay(input, values, delayed, m);
+        for (size_t i = 0; i < m; ++i)
+        {
+            outL[i] = deemphasisFilterL.Tick(values[i]+delayed[i]);
+        }
+        for (size_t i = 0; i < m; ++i)
+        {
+            outR[i] = deemphasisFilterR.Tick(values[i]-delayed[i]);
+        }
+        input += m;
+        outL += m;
+        outR += m;
+        n -= m;
+    }
+}
+
 void Tf2Flanger::SetManual(float value)
 {
     this->manual = value;
@@ -348,3 +470,14 @@ float Tf2Flanger::Instrumentation::TickLfo()
     return delay;
 
 }
+
+void Tf2Flanger::Instrumentation::ProcessLfo(float *delaySec, size_t n)
+{
+    while (n != 0)
+    {
+        size_t m = std::min(n, MAX_BLOCK_SIZE);
+        pFlanger->ProcessLfo(delaySec, m);
+        delaySec += m;
+        n -= m;
+    }
+}
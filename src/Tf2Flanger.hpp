@@ -49,6 +49,11 @@ namespace toob
 
         float Tick(float value);
         void Tick(float value, float*outL, float*outR);
+
+        // Block processing, equivalent to calling Tick() for each sample. The anti-aliasing 
+        // filter keeps separate state for Tick() and Process(); use one or the other.
+        void Process(const float*input, float*output, size_t n);
+        void Process(const float*input, float*outL, float*outR, size_t n);
         void Clear();
 
         float GetLfoValue() const { return this->lfoValue*this->lfoSign; }
@@ -64,6 +69,8 @@ namespace toob
 
             }
             float TickLfo();
+            // Block equivalent of TickLfo().
+            void ProcessLfo(float *delaySec, size_t n);
              
         };
     private:
@@ -77,8 +84,13 @@ namespace toob
         double LfoToVoltage(double lfoValue);
         double LfoToFreq(double lfoVoltage);
         void UpdateLfoRange();
+        static constexpr size_t MAX_BLOCK_SIZE = 64;
+
         void ClearBucketBrigade();
+        float ClockBucketBrigade(double fBB);
         float TickBucketBrigade(float value);
+        void ProcessLfo(float *delaySec, size_t n);
+        void ProcessDelay(const float*input, float *values, float*delayed, size_t n);
 
 
         double TickLfo();
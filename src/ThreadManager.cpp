@@ -0,0 +1,599 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "ThreadManager.hpp"
+#include "util.hpp"
+#include "ss.hpp"
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/sysinfo.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace toob;
+
+std::atomic<bool> ThreadManager::audioThreadNoted{false};
+std::atomic<bool> ThreadManager::audioThreadValid{false};
+int ThreadManager::audioThreadPriority = 0;
+cpu_set_t ThreadManager::audioThreadCpus;
+
+static std::string Trim(const std::string &text)
+{
+    size_t start = text.find_first_not_of(" \t\r");
+    if (start == std::string::npos)
+    {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(start, end + 1 - start);
+}
+
+static int ParseInt(const std::string &text)
+{
+    size_t pos = 0;
+    int result;
+    try
+    {
+        result = std::stoi(text, &pos);
+    }
+    catch (const std::exception &)
+    {
+        pos = 0;
+    }
+    if (pos == 0 || pos != text.length())
+    {
+        throw std::runtime_error(SS("Expecting a number: '" << text << "'"));
+    }
+    return result;
+}
+
+ThreadManager &ThreadManager::Get()
+{
+    static ThreadManager instance;
+    return instance;
+}
+
+ThreadManager::ThreadManager()
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    // The main thread's affinity (which excludes isolcpus CPUs by default).
+    if (sched_getaffinity(getpid(), sizeof(cpus), &cpus) == 0)
+    {
+        for (int i = 0; i < CPU_SETSIZE; ++i)
+        {
+            if (CPU_ISSET(i, &cpus))
+            {
+                processCpus.push_back(i);
+            }
+        }
+    }
+
+    std::filesystem::path path = DefaultConfigPath();
+    std::error_code ec;
+    if (!path.empty() && std::filesystem::exists(path, ec))
+    {
+        try
+        {
+            Load(path);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "ToobAmp: " << e.what() << " Using default thread policy." << std::endl;
+        }
+    }
+}
+
+std::filesystem::path ThreadManager::DefaultConfigPath()
+{
+    const char *configFile = std::getenv("TOOB_THREAD_CONFIG");
+    if (configFile && configFile[0] != '\0')
+    {
+        return std::filesystem::path(configFile);
+    }
+    std::error_code ec;
+    std::filesystem::path userConfigDirectory;
+    const char *xdgConfigHome = std::getenv("XDG_CONFIG_HOME");
+    const char *home = std::getenv("HOME");
+    if (xdgConfigHome && xdgConfigHome[0] != '\0')
+    {
+        userConfigDirectory = xdgConfigHome;
+    }
+    else if (home && home[0] != '\0')
+    {
+        userConfigDirectory = std::filesystem::path(home) / ".config";
+    }
+    if (!userConfigDirectory.empty())
+    {
+        std::filesystem::path path = userConfigDirectory / "ToobAmp" / "threads.conf";
+        if (std::filesystem::exists(path, ec))
+        {
+            return path;
+        }
+    }
+    return "/etc/ToobAmp/threads.conf";
+}
+
+void ThreadManager::Load(const std::filesystem::path &path)
+{
+    std::ifstream f(path);
+    if (!f.is_open())
+    {
+        throw std::runtime_error(SS("Can't open " << path.string() << "."));
+    }
+    Policy newPolicy;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(f, line))
+    {
+        ++lineNumber;
+        size_t commentPos = line.find('#');
+        if (commentPos != std::string::npos)
+        {
+            line = line.substr(0, commentPos);
+        }
+        line = Trim(line);
+        if (line.empty())
+        {
+            continue;
+        }
+        try
+        {
+            size_t equalsPos = line.find('=');
+            if (equalsPos == std::string::npos)
+            {
+                throw std::runtime_error("Expecting 'key = value'.");
+            }
+            std::string key = Trim(line.substr(0, equalsPos));
+            std::string value = Trim(line.substr(equalsPos + 1));
+
+            auto parseCpus = [&value]() -> std::optional<std::vector<int>>
+            {
+                if (value == "auto")
+                {
+                    return std::nullopt;
+                }
+                if (value == "all")
+                {
+                    return std::vector<int>();
+                }
+                return ParseCpuList(value);
+            };
+
+            if (key == "audio_priority")
+            {
+                newPolicy.audioPriority = value == "auto" ? 0 : ParseInt(value);
+                if (newPolicy.audioPriority < 0)
+                {
+                    throw std::runtime_error("Invalid priority.");
+                }
+            }
+            else if (key == "audio_cpus")
+            {
+                newPolicy.audioCpus = parseCpus();
+            }
+            else if (key == "dsp_cpus")
+            {
+                newPolicy.dspCpus = parseCpus();
+            }
+            else if (key == "io_cpus")
+            {
+                newPolicy.ioCpus = parseCpus();
+            }
+            else if (key == "nam_priority")
+            {
+                newPolicy.namPriority = ParsePriority(value);
+            }
+            else if (key == "assembly_priority")
+            {
+                newPolicy.assemblyPriority = ParsePriority(value);
+            }
+            else if (key == "convolution_priorities")
+            {
+                std::vector<Priority> priorities;
+                std::istringstream s(value);
+                std::string item;
+                while (s >> item)
+                {
+                    priorities.push_back(ParsePriority(item));
+                }
+                if (priorities.empty())
+                {
+                    throw std::runtime_error("Expecting a list of priorities.");
+                }
+                newPolicy.convolutionPriorities = std::move(priorities);
+            }
+            else if (key == "player_nice")
+            {
+                newPolicy.playerNice = ParseInt(value);
+            }
+            else if (key == "indexer_nice")
+            {
+                newPolicy.indexerNice = ParseInt(value);
+            }
+            else
+            {
+                throw std::runtime_error(SS("Unknown key '" << key << "'."));
+            }
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error(SS(path.string() << "(" << lineNumber << "): " << e.what()));
+        }
+    }
+    SetPolicy(newPolicy);
+}
+
+void ThreadManager::SetPolicy(const Policy &policy)
+{
+    std::lock_guard lock{mutex};
+    this->policy = policy;
+}
+
+ThreadManager::Policy ThreadManager::GetPolicy() const
+{
+    std::lock_guard lock{mutex};
+    return policy;
+}
+
+void ThreadManager::NoteAudioThreadSlow()
+{
+    bool expected = false;
+    if (!audioThreadNoted.compare_exchange_strong(expected, true))
+    {
+        return;
+    }
+    // Runs once, on the audio thread: no allocations or locks.
+    int schedPolicy = 0;
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    audioThreadPriority = 0;
+    if (pthread_getschedparam(pthread_self(), &schedPolicy, &param) == 0)
+    {
+        schedPolicy &= ~SCHED_RESET_ON_FORK;
+        if (schedPolicy == SCHED_FIFO || schedPolicy == SCHED_RR)
+        {
+            audioThreadPriority = param.sched_priority;
+        }
+    }
+    CPU_ZERO(&audioThreadCpus);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(audioThreadCpus), &audioThreadCpus) != 0)
+    {
+        CPU_ZERO(&audioThreadCpus);
+    }
+    audioThreadValid.store(true, std::memory_order_release);
+}
+
+int ThreadManager::AudioPriorityLocked() const
+{
+    if (policy.audioPriority > 0)
+    {
+        return policy.audioPriority;
+    }
+    if (IsAudioThreadNoted() && audioThreadPriority > 0)
+    {
+        return audioThreadPriority;
+    }
+    return DEFAULT_AUDIO_PRIORITY;
+}
+
+std::vector<int> ThreadManager::AudioCpusLocked() const
+{
+    if (policy.audioCpus)
+    {
+        return *policy.audioCpus;
+    }
+    std::vector<int> result;
+    if (IsAudioThreadNoted())
+    {
+        // Only count the audio thread as pinned if it can't run on every CPU.
+        int count = CPU_COUNT(&audioThreadCpus);
+        if (count != 0 && count < get_nprocs_conf())
+        {
+            for (int i = 0; i < CPU_SETSIZE; ++i)
+            {
+                if (CPU_ISSET(i, &audioThreadCpus))
+                {
+                    result.push_back(i);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+int ThreadManager::ResolvePriority(const Priority &priority) const
+{
+    int audioPriority = AudioPriorityLocked();
+    int result = priority.value;
+    if (priority.relativeToAudio)
+    {
+        result = std::min(audioPriority + priority.value, audioPriority - 1);
+    }
+    int maxPriority = sched_get_priority_max(SCHED_RR) - 1;
+    return std::clamp(result, 1, std::max(1, maxPriority));
+}
+
+std::vector<int> ThreadManager::ResolveCpus(const std::optional<std::vector<int>> &cpus) const
+{
+    if (cpus)
+    {
+        return *cpus;
+    }
+    std::vector<int> audioCpus = AudioCpusLocked();
+    if (audioCpus.empty())
+    {
+        return std::vector<int>();
+    }
+    std::vector<int> result;
+    for (int cpu : processCpus)
+    {
+        if (std::find(audioCpus.begin(), audioCpus.end(), cpu) == audioCpus.end())
+        {
+            result.push_back(cpu);
+        }
+    }
+    // If the audio thread has all of our CPUs, sharing is better than nothing.
+    return result;
+}
+
+int ThreadManager::GetAudioPriority() const
+{
+    std::lock_guard lock{mutex};
+    return AudioPriorityLocked();
+}
+
+std::vector<int> ThreadManager::GetAudioCpus() const
+{
+    std::lock_guard lock{mutex};
+    return AudioCpusLocked();
+}
+
+bool ThreadManager::IsRealtime(ThreadRole role)
+{
+    switch (role)
+    {
+    case ThreadRole::ConvolutionSection:
+    case ThreadRole::ConvolutionAssembly:
+    case ThreadRole::NamBackground:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::string ThreadManager::GetThreadName(ThreadRole role, int threadNumber)
+{
+    switch (role)
+    {
+    case ThreadRole::ConvolutionSection:
+        return SS("crvb" << threadNumber);
+    case ThreadRole::ConvolutionAssembly:
+        return "crvb_asm";
+    case ThreadRole::NamBackground:
+        return "nam_bg";
+    case ThreadRole::PlayerBackground:
+        return "ply_bg";
+    case ThreadRole::LooperBackground:
+        return "loop_bg";
+    case ThreadRole::MetadataIndexer:
+        return "mdscan";
+    case ThreadRole::TraceWriter:
+        return "trace";
+    default:
+        return "unknown";
+    }
+}
+
+int ThreadManager::GetPriority(ThreadRole role, int threadNumber) const
+{
+    std::lock_guard lock{mutex};
+    switch (role)
+    {
+    case ThreadRole::ConvolutionSection:
+    {
+        if (policy.convolutionPriorities.empty())
+        {
+            return ResolvePriority(Priority{false, 1});
+        }
+        size_t index = threadNumber <= 1 ? 0 : (size_t)(threadNumber - 1);
+        index = std::min(index, policy.convolutionPriorities.size() - 1);
+        return ResolvePriority(policy.convolutionPriorities[index]);
+    }
+    case ThreadRole::ConvolutionAssembly:
+        return ResolvePriority(policy.assemblyPriority);
+    case ThreadRole::NamBackground:
+        return ResolvePriority(policy.namPriority);
+    case ThreadRole::PlayerBackground:
+    case ThreadRole::LooperBackground:
+        return policy.playerNice;
+    case ThreadRole::MetadataIndexer:
+        return policy.indexerNice;
+    default:
+        return 0;
+    }
+}
+
+std::vector<int> ThreadManager::GetCpus(ThreadRole role) const
+{
+    std::lock_guard lock{mutex};
+    return ResolveCpus(IsRealtime(role) ? policy.dspCpus : policy.ioCpus);
+}
+
+void ThreadManager::SetAffinity(ThreadRole role)
+{
+    std::vector<int> cpus = GetCpus(role);
+    if (cpus.empty())
+    {
+        return;
+    }
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int cpu : cpus)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    if (rc != 0)
+    {
+        std::cerr << "ToobAmp: Can't set CPU affinity of thread " << GetThreadName(role)
+                  << " to " << FormatCpuList(cpus) << ". (" << strerror(rc) << ")" << std::endl;
+    }
+}
+
+void ThreadManager::ConfigureCurrentThreadNonRealtime(ThreadRole role, int threadNumber)
+{
+    SetThreadName(GetThreadName(role, threadNumber));
+    SetAffinity(role);
+}
+
+void ThreadManager::ConfigureCurrentThread(ThreadRole role, int threadNumber)
+{
+    ConfigureCurrentThreadNonRealtime(role, threadNumber);
+    int priority = GetPriority(role, threadNumber);
+    if (IsRealtime(role))
+    {
+        try
+        {
+            SetRtThreadPriority(priority);
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error(SS("Can't set realtime priority " << priority << " for thread " << GetThreadName(role, threadNumber) << ". (" << e.what() << ")"));
+        }
+    }
+    else if (priority != 0)
+    {
+        SetThreadNice(priority);
+    }
+}
+
+std::vector<int> ThreadManager::ParseCpuList(const std::string &text)
+{
+    // Linux cpu-list format, as used by isolcpus: "0-1,3".
+    std::vector<int> result;
+    std::string item;
+    std::istringstream s(text);
+    while (std::getline(s, item, ','))
+    {
+        item = Trim(item);
+        if (item.empty())
+        {
+            throw std::runtime_error(SS("Invalid CPU list: '" << text << "'"));
+        }
+        size_t dashPos = item.find('-');
+        int first, last;
+        if (dashPos == std::string::npos)
+        {
+            first = last = ParseInt(item);
+        }
+        else
+        {
+            first = ParseInt(Trim(item.substr(0, dashPos)));
+            last = ParseInt(Trim(item.substr(dashPos + 1)));
+        }
+        if (first < 0 || last < first || last >= CPU_SETSIZE)
+        {
+            throw std::runtime_error(SS("Invalid CPU list: '" << text << "'"));
+        }
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            if (std::find(result.begin(), result.end(), cpu) == result.end())
+            {
+                result.push_back(cpu);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::string ThreadManager::FormatCpuList(const std::vector<int> &cpus)
+{
+    std::ostringstream s;
+    size_t i = 0;
+    while (i < cpus.size())
+    {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+        {
+            ++j;
+        }
+        if (i != 0)
+        {
+            s << ',';
+        }
+        s << cpus[i];
+        if (j != i)
+        {
+            s << '-' << cpus[j];
+        }
+        i = j + 1;
+    }
+    return s.str();
+}
+
+ThreadManager::Priority ThreadManager::ParsePriority(const std::string &text)
+{
+    if (text.rfind("audio", 0) == 0)
+    {
+        std::string offset = text.substr(5);
+        if (offset.empty())
+        {
+            return Priority{true, 0};
+        }
+        if (offset[0] != '-' && offset[0] != '+')
+        {
+            throw std::runtime_error(SS("Invalid priority: '" << text << "'"));
+        }
+        return Priority{true, ParseInt(offset[0] == '+' ? offset.substr(1) : offset)};
+    }
+    int value = ParseInt(text);
+    if (value <= 0)
+    {
+        throw std::runtime_error(SS("Invalid priority: '" << text << "'"));
+    }
+    return Priority{false, value};
+}
+
+std::string ThreadManager::ToString(const Priority &priority)
+{
+    if (!priority.relativeToAudio)
+    {
+        return std::to_string(priority.value);
+    }
+    if (priority.value == 0)
+    {
+        return "audio";
+    }
+    return SS("audio" << (priority.value > 0 ? "+" : "") << priority.value);
+}
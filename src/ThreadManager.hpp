@@ -0,0 +1,178 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <sched.h>
+
+namespace toob
+{
+    /// @brief The kinds of background thread that ToobAmp plugins create.
+    enum class ThreadRole
+    {
+        ConvolutionSection,  // BalancedConvolution section threads. threadNumber 1 is the smallest section.
+        ConvolutionAssembly, // BalancedConvolution assembly thread.
+        NamBackground,       // NAM background processing thread.
+        PlayerBackground,    // Audio file player/recorder file I/O.
+        LooperBackground,    // Looper file I/O.
+        MetadataIndexer,     // Audio file metadata scanning.
+        TraceWriter,         // RtTrace output.
+    };
+
+    /// @brief Central policy for naming, scheduling and CPU placement of background threads.
+    ///
+    /// Realtime priorities are either absolute, or relative to the priority of the host's audio
+    /// thread ("audio-5"). The audio thread's priority and CPU affinity are detected the first time
+    /// that a plugin calls NoteAudioThread() from run(), and can be overridden in the config file.
+    /// Background DSP threads are kept off the audio thread's CPUs when those are known.
+    ///
+    /// The policy is read from $TOOB_THREAD_CONFIG, $XDG_CONFIG_HOME/ToobAmp/threads.conf
+    /// (~/.config/ToobAmp/threads.conf), or /etc/ToobAmp/threads.conf, whichever is found first.
+    /// Each line is "key = value"; '#' starts a comment.
+    ///
+    ///     audio_priority = auto           # or a SCHED_RR/SCHED_FIFO priority.
+    ///     audio_cpus = auto               # CPUs used by the host's audio thread, e.g. 3 or 2-3.
+    ///     dsp_cpus = auto                 # CPUs for realtime background threads, or "all".
+    ///     io_cpus = auto                  # CPUs for non-realtime background threads, or "all".
+    ///     nam_priority = audio-5
+    ///     assembly_priority = audio-4
+    ///     convolution_priorities = audio-35 audio-36 4 3 2 1   # by section thread number; the last value repeats.
+    ///     player_nice = -11
+    ///     indexer_nice = 10
+    ///
+    /// "auto" CPU sets are the CPUs that the process may run on, less audio_cpus. Threads read the policy
+    /// when they start, so changes only affect threads started afterwards.
+    ///
+    /// For example, on a 4-core Raspberry Pi booted with isolcpus=2,3, with the host's audio thread pinned to
+    /// CPU 3:
+    ///
+    ///     audio_cpus = 3
+    ///     dsp_cpus = 2
+    ///     io_cpus = 0-1
+    class ThreadManager
+    {
+    public:
+        static constexpr int DEFAULT_AUDIO_PRIORITY = 80;
+
+        struct Priority
+        {
+            bool relativeToAudio = false;
+            int value = 0;
+
+            bool operator==(const Priority &other) const = default;
+        };
+
+        struct Policy
+        {
+            int audioPriority = 0; // 0: detect.
+            std::optional<std::vector<int>> audioCpus; // nullopt: detect.
+            std::optional<std::vector<int>> dspCpus;   // nullopt: auto. Empty: don't set affinity.
+            std::optional<std::vector<int>> ioCpus;    // nullopt: auto. Empty: don't set affinity.
+            Priority namPriority{true, -5};
+            Priority assemblyPriority{true, -4};
+            std::vector<Priority> convolutionPriorities{
+                {true, -35},
+                {true, -36},
+                {false, 4}, // large sections stay below USB audio service threads (RT priority 6).
+                {false, 3},
+                {false, 2},
+                {false, 1}};
+            int playerNice = -11;
+            int indexerNice = 10;
+        };
+
+        static ThreadManager &Get();
+
+        static std::filesystem::path DefaultConfigPath();
+
+        /// @brief Load a policy file.
+        /// @throws std::runtime_error if the file can't be read or contains errors.
+        void Load(const std::filesystem::path &path);
+        void SetPolicy(const Policy &policy);
+        Policy GetPolicy() const;
+
+        /// @brief Name the calling thread, set its CPU affinity, and its scheduling priority.
+        /// @throws std::runtime_error if a realtime priority was required and can't be set.
+        void ConfigureCurrentThread(ThreadRole role, int threadNumber = 0);
+
+        /// @brief Name the calling thread and set its CPU affinity, without changing its priority.
+        ///
+        /// For unit tests and offline processing, which may not have realtime privileges.
+        void ConfigureCurrentThreadNonRealtime(ThreadRole role, int threadNumber = 0);
+
+        /// @brief Record the calling thread's priority and CPU affinity as those of the host's audio thread.
+        ///
+        /// Call from run(). Only the first call does any work.
+        static void NoteAudioThread()
+        {
+            if (!audioThreadNoted.load(std::memory_order_relaxed))
+            {
+                NoteAudioThreadSlow();
+            }
+        }
+
+        static std::string GetThreadName(ThreadRole role, int threadNumber = 0);
+        static bool IsRealtime(ThreadRole role);
+
+        /// @brief SCHED_RR priority for realtime roles; nice value for others.
+        int GetPriority(ThreadRole role, int threadNumber = 0) const;
+        /// @brief CPUs that the thread will be pinned to. Empty if affinity isn't set.
+        std::vector<int> GetCpus(ThreadRole role) const;
+        int GetAudioPriority() const;
+        std::vector<int> GetAudioCpus() const;
+        /// @brief True if the audio thread's priority and affinity have been detected.
+        static bool IsAudioThreadNoted() { return audioThreadNoted.load(std::memory_order_acquire) && audioThreadValid.load(std::memory_order_acquire); }
+
+        static std::vector<int> ParseCpuList(const std::string &text);
+        static std::string FormatCpuList(const std::vector<int> &cpus);
+        static Priority ParsePriority(const std::string &text);
+        static std::string ToString(const Priority &priority);
+
+    private:
+        ThreadManager();
+        static void NoteAudioThreadSlow();
+        // Called with mutex held.
+        int ResolvePriority(const Priority &priority) const;
+        std::vector<int> ResolveCpus(const std::optional<std::vector<int>> &cpus) const;
+        int AudioPriorityLocked() const;
+        std::vector<int> AudioCpusLocked() const;
+
+        void SetAffinity(ThreadRole role);
+
+        static std::atomic<bool> audioThreadNoted;
+        static std::atomic<bool> audioThreadValid;
+        static int audioThreadPriority; // 0 if not realtime.
+        static cpu_set_t audioThreadCpus;
+
+        mutable std::mutex mutex;
+        Policy policy;
+        std::vector<int> processCpus;
+    };
+}
@@ -0,0 +1,157 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "ThreadManager.hpp"
+#include "util.hpp"
+#include "TestAssert.hpp"
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+using namespace toob;
+using namespace std;
+
+static void TestParsing()
+{
+    TEST_ASSERT((ThreadManager::ParseCpuList("0-1,3") == std::vector<int>{0, 1, 3}));
+    TEST_ASSERT((ThreadManager::ParseCpuList(" 3, 1 ") == std::vector<int>{1, 3}));
+    TEST_ASSERT(ThreadManager::FormatCpuList({0, 1, 2, 5, 7, 8}) == "0-2,5,7-8");
+
+    bool threw = false;
+    try
+    {
+        ThreadManager::ParseCpuList("3-1");
+    }
+    catch (const std::exception &)
+    {
+        threw = true;
+    }
+    TEST_ASSERT(threw);
+
+    TEST_ASSERT((ThreadManager::ParsePriority("audio-5") == ThreadManager::Priority{true, -5}));
+    TEST_ASSERT((ThreadManager::ParsePriority("audio+2") == ThreadManager::Priority{true, 2}));
+    TEST_ASSERT((ThreadManager::ParsePriority("audio") == ThreadManager::Priority{true, 0}));
+    TEST_ASSERT((ThreadManager::ParsePriority("45") == ThreadManager::Priority{false, 45}));
+    TEST_ASSERT(ThreadManager::ToString(ThreadManager::Priority{true, -5}) == "audio-5");
+
+    threw = false;
+    try
+    {
+        ThreadManager::ParsePriority("audio5");
+    }
+    catch (const std::exception &)
+    {
+        threw = true;
+    }
+    TEST_ASSERT(threw);
+}
+
+static void TestDefaultPolicy()
+{
+    ThreadManager &manager = ThreadManager::Get();
+    ThreadManager::Policy policy;
+    policy.audioPriority = 80;
+    manager.SetPolicy(policy);
+
+    // The defaults match the priorities that were used before ThreadManager.
+    TEST_ASSERT(manager.GetPriority(ThreadRole::NamBackground) == 75);
+    TEST_ASSERT(manager.GetPriority(ThreadRole::ConvolutionAssembly) == 76);
+    TEST_ASSERT(manager.GetPriority(ThreadRole::ConvolutionSection, 1) == 45);
+    TEST_ASSERT(manager.GetPriority(ThreadRole::ConvolutionSection, 2) == 44);
+    TEST_ASSERT(manager.GetPriority(ThreadRole::ConvolutionSection, 3) == 4);
+    TEST_ASSERT(manager.GetPriority(ThreadRole::ConvolutionSection, 11) == 1);
+    TEST_ASSERT(manager.GetPriority(ThreadRole::PlayerBackground) == -11);
+    TEST_ASSERT(manager.GetPriority(ThreadRole::MetadataIndexer) == 10);
+    TEST_ASSERT(manager.GetCpus(ThreadRole::NamBackground).empty() || !manager.GetAudioCpus().empty());
+}
+
+static void TestConfigFile()
+{
+    std::filesystem::path path = TemporaryFilename("ThreadManagerTest", ".conf");
+    Finally deleteFile{[&path]() { std::filesystem::remove(path); }};
+    {
+        std::ofstream f(path);
+        f << "# Raspberry Pi, isolcpus=2,3" << endl
+          << "audio_priority = 90" << endl
+          << "audio_cpus = 3" << endl
+          << "dsp_cpus = 2" << endl
+          << "io_cpus = 0-1  # non-realtime threads" << endl
+          << "nam_priority = audio+5" << endl
+          << "convolution_priorities = audio-30 5" << endl
+          << "indexer_nice = 15" << endl;
+    }
+    ThreadManager &manager = ThreadManager::Get();
+    manager.Load(path);
+
+    TEST_ASSERT(manager.GetAudioPriority() == 90);
+    TEST_ASSERT((manager.GetAudioCpus() == std::vector<int>{3}));
+    TEST_ASSERT((manager.GetCpus(ThreadRole::ConvolutionSection) == std::vector<int>{2}));
+    TEST_ASSERT((manager.GetCpus(ThreadRole::MetadataIndexer) == std::vector<int>{0, 1}));
+    TEST_ASSERT(manager.GetPriority(ThreadRole::NamBackground) == 89); // never above the audio thread.
+    TEST_ASSERT(manager.GetPriority(ThreadRole::ConvolutionAssembly) == 86);
+    TEST_ASSERT(manager.GetPriority(ThreadRole::ConvolutionSection, 1) == 60);
+    TEST_ASSERT(manager.GetPriority(ThreadRole::ConvolutionSection, 4) == 5);
+    TEST_ASSERT(manager.GetPriority(ThreadRole::MetadataIndexer) == 15);
+
+    {
+        std::ofstream f(path);
+        f << "audio_priority = 90" << endl
+          << "dsp_cpu = 2" << endl;
+    }
+    bool threw = false;
+    try
+    {
+        manager.Load(path);
+    }
+    catch (const std::exception &e)
+    {
+        cout << "    Expected error: " << e.what() << endl;
+        threw = true;
+    }
+    TEST_ASSERT(threw);
+    // A failed load leaves the previous policy in place.
+    TEST_ASSERT(manager.GetAudioPriority() == 90);
+    TEST_ASSERT((manager.GetCpus(ThreadRole::ConvolutionSection) == std::vector<int>{2}));
+}
+
+int main(int argc, char **argv)
+{
+    // Don't pick up the machine's configuration.
+    setenv("TOOB_THREAD_CONFIG", "/nonexistent/threads.conf", 1);
+    try
+    {
+        cout << "TestParsing" << endl;
+        TestParsing();
+        cout << "TestDefaultPolicy" << endl;
+        TestDefaultPolicy();
+        cout << "TestConfigFile" << endl;
+        TestConfigFile();
+    }
+    catch (const std::exception &e)
+    {
+        cout << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
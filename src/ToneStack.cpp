@@ -25,6 +25,7 @@
 //
 
 #include "ToneStack.h"
+#include "LsNumerics/Denorms.hpp"
 
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
@@ -80,6 +81,7 @@ ToneStack::ToneStack(double _rate,
 	this->updateMsDelay = (1000/MAX_UPDATES_PER_SECOND);
     gainDezipper.SetSampleRate(_rate);
     gainDezipper.SetRate(0.1f); // 100ms dezipper time.
+    cpuLoadMeter.SetSampleRate(_rate);
 }
 
 ToneStack::~ToneStack()
@@ -120,6 +122,12 @@ void ToneStack::ConnectPort(uint32_t port, void* data)
 	case PortId::NOTIFY_OUT:
 		this->notifyOut = (LV2_Atom_Sequence*)data;
 		break;
+	case PortId::CPU_LOAD:
+		this->cpuLoadMeter.SetLoadData(data);
+		break;
+	case PortId::CPU_PEAK:
+		this->cpuLoadMeter.SetPeakData(data);
+		break;
 	}
 }
 
@@ -138,6 +146,9 @@ void ToneStack::Deactivate()
 
 void ToneStack::Run(uint32_t n_samples)
 {
+	RtTraceScope traceScope(traceSource);
+	CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+	LsNumerics::AutoDenorm autoDenorm;
 	// prepare forge to write to notify output port.
 	// Set up forge to write directly to notify output port.
 	const uint32_t notify_capacity = this->notifyOut->atom.size;
@@ -163,13 +174,13 @@ void ToneStack::Run(uint32_t n_samples)
 		for (uint32_t i = 0; i < n_samples; ++i)
 		{
             float gain = gainDezipper.Tick();
-			output[i] = Undenormalize((float)baxandallToneStack.Tick(input[i])*gain);
+			output[i] = (float)baxandallToneStack.Tick(input[i])*gain;
 		}
 	} else {
 		for (uint32_t i = 0; i < n_samples; ++i)
 		{
             float gain = gainDezipper.Tick();
-			output[i] = Undenormalize((float)toneStackFilter.Tick(input[i])*gain);
+			output[i] = (float)toneStackFilter.Tick(input[i])*gain;
 		}
 	}
 	frameTime += n_samples;
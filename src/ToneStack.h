@@ -45,6 +45,8 @@
 #include "InputPort.h"
 #include "OutputPort.h"
 #include "LsNumerics/ToneStackFilter.h"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 
@@ -69,6 +71,8 @@ namespace toob {
 			AUDIO_OUT,
 			CONTROL_IN,
 			NOTIFY_OUT,
+			CPU_LOAD,
+			CPU_PEAK,
 		};
 
 		double rate;
@@ -163,6 +167,8 @@ namespace toob {
 		bool useBaxandall = false;
 
         DbDezipper gainDezipper;
+        RtTraceSource traceSource{"ToneStack"};
+        CpuLoadMeter cpuLoadMeter;
         
 		bool UpdateControls();
 
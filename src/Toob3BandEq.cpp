@@ -25,6 +25,7 @@
 //
 
 #include "Toob3BandEq.h"
+#include "LsNumerics/Denorms.hpp"
 
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
@@ -64,12 +65,14 @@ uint64_t timeMs();
 
 Toob3BandEq::Toob3BandEq(double _rate,
 	const char* _bundle_path,
-	const LV2_Feature* const* features)
+	const LV2_Feature* const* features,
+	bool _stereo)
 	: 
 	Lv2Plugin(_rate, _bundle_path,features),
 	rate(_rate),
 	filterResponse(),
-	bundle_path(_bundle_path)
+	bundle_path(_bundle_path),
+	stereo(_stereo)
 {
 	uris.Map(this);
 	lv2_atom_forge_init(&forge, map);
@@ -83,6 +86,7 @@ Toob3BandEq::Toob3BandEq(double _rate,
 	this->updateMsDelay = (1000/MAX_UPDATES_PER_SECOND);
     gainDezipper.SetSampleRate(_rate);
     gainDezipper.SetRate(0.1f); // 100ms dezipper time.
+    cpuLoadMeter.SetSampleRate(_rate);
 }
 
 Toob3BandEq::~Toob3BandEq()
@@ -92,6 +96,11 @@ Toob3BandEq::~Toob3BandEq()
 
 void Toob3BandEq::ConnectPort(uint32_t port, void* data)
 {
+	if (!stereo && port >= (uint32_t)PortId::AUDIO_INR)
+	{
+		// The mono plugin has no AUDIO_INR/AUDIO_OUTR ports, so the ports that follow them are two indices lower.
+		port += 2;
+	}
 	switch ((PortId)port) {
 
 	case PortId::BASS:
@@ -126,6 +135,12 @@ void Toob3BandEq::ConnectPort(uint32_t port, void* data)
 	case PortId::AUDIO_OUTR:
 		this->outputR = (float*)data;
 		break;
+	case PortId::CPU_LOAD:
+		this->cpuLoadMeter.SetLoadData(data);
+		break;
+	case PortId::CPU_PEAK:
+		this->cpuLoadMeter.SetPeakData(data);
+		break;
 	}
 }
 
@@ -146,6 +161,9 @@ void Toob3BandEq::Deactivate()
 
 void Toob3BandEq::Run(uint32_t n_samples)
 {
+	RtTraceScope traceScope(traceSource);
+	CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+	LsNumerics::AutoDenorm autoDenorm;
 	// prepare forge to write to notify output port.
 	// Set up forge to write directly to notify output port.
 	const uint32_t notify_capacity = this->notifyOut->atom.size;
@@ -329,4 +347,4 @@ REGISTRATION_DECLARATION PluginRegistration<Toob3BandEq>
 threeBandEqRegistrationMono(TOOB_3_BAND_EQU_URI_MONO);
 
 REGISTRATION_DECLARATION 
-PluginRegistration<Toob3BandEq> threeBandEqRegistrationStereo(TOOB_3_BAND_EQU_URI_STEREO);
\ No newline at end of file
+PluginRegistration<Toob3BandEqStereo> threeBandEqRegistrationStereo(TOOB_3_BAND_EQU_URI_STEREO);
\ No newline at end of file
@@ -45,6 +45,8 @@
 #include "OutputPort.h"
 #include "LsNumerics/ToneStackFilter.h"
 #include "NamTonestack/ToneStack.h"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 #define TOOB_3_BAND_EQU_URI_MONO "http://two-play.com/plugins/toob-three-band-eq"
@@ -71,10 +73,13 @@ namespace toob {
 			NOTIFY_OUT,
 			AUDIO_INR,
 			AUDIO_OUTR,
+			CPU_LOAD,
+			CPU_PEAK,
 		};
 
 		double rate;
 		std::string bundle_path;
+		bool stereo;
 
 
 		bool stereoConnected = false;
@@ -163,6 +168,8 @@ namespace toob {
         RangedInputPort Gain = RangedInputPort(-40,30);
 
         DbDezipper gainDezipper;
+        RtTraceSource traceSource{"Toob3BandEq"};
+        CpuLoadMeter cpuLoadMeter;
         
 		bool UpdateControls();
 
@@ -188,7 +195,8 @@ namespace toob {
 
 		Toob3BandEq(double rate,
 			const char* bundle_path,
-			const LV2_Feature* const* features
+			const LV2_Feature* const* features,
+			bool stereo = false
 		);
 		virtual ~Toob3BandEq();
 
@@ -201,4 +209,21 @@ namespace toob {
 		virtual void Run(uint32_t n_samples);
 		virtual void Deactivate();
 	};
+
+	class Toob3BandEqStereo : public Toob3BandEq {
+	public:
+		static Lv2Plugin* Create(double rate,
+			const char* bundle_path,
+			const LV2_Feature* const* features)
+		{
+			return new Toob3BandEqStereo(rate, bundle_path, features);
+		}
+
+		Toob3BandEqStereo(double rate,
+			const char* bundle_path,
+			const LV2_Feature* const* features)
+			: Toob3BandEq(rate, bundle_path, features, true)
+		{
+		}
+	};
 }
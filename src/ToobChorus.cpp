@@ -21,6 +21,8 @@
  *   SOFTWARE.
  */
 #include "ToobChorus.h"
+#include <algorithm>
+#include "LsNumerics/Denorms.hpp"
 
 
 
@@ -44,6 +46,7 @@ ToobChorus::ToobChorus(
       chorus(rate)
 
 {
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 const char *ToobChorus::URI = TOOB_CHORUS_URI;
@@ -70,6 +73,12 @@ void ToobChorus::ConnectPort(uint32_t port, void *data)
     case PortId::AUDIO_OUTR:
         this->outR = (float *)data;
         break;
+    case PortId::CPU_LOAD:
+        this->cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::CPU_PEAK:
+        this->cpuLoadMeter.SetPeakData(data);
+        break;
     }
 }
 void ToobChorus::clear()
@@ -111,30 +120,46 @@ void ToobChorus::Activate()
 
 void ToobChorus::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     updateControls();
-    if (this->outR != nullptr)
+    // inL and outL may be the same buffer, so the chorus output goes to scratch buffers first.
+    constexpr uint32_t CHUNK_SIZE = 64;
+    float l[CHUNK_SIZE];
+    float r[CHUNK_SIZE];
+    const float *inL = this->inL;
+    float *outL = this->outL;
+    float *outR = this->outR;
+    while (n_samples != 0)
     {
-        for (uint32_t i = 0; i < n_samples; ++i)
+        uint32_t n = std::min(n_samples, CHUNK_SIZE);
+        if (outR != nullptr)
         {
-            float wet = dryWetDezipper.Tick();
-            float dry = 1.0-wet;
-            float l,r;
-            float input = inL[i];
-            chorus.Tick(inL[i],&l,&r);
-            outL[i] = input*dry+l*wet;
-            outR[i] = input*dry+r*wet;
-        }
-    } else {
-        for (uint32_t i = 0; i < n_samples; ++i)
-        {
-            float input = inL[i];
-
-            float output = chorus.Tick(input);
-            float wet = dryWetDezipper.Tick();
-            float dry = 1.0f-wet;
-            
-            outL[i] = dry*input+wet*output;
+            chorus.Process(inL, l, r, n);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                float wet = dryWetDezipper.Tick();
+                float dry = 1.0-wet;
+                float input = inL[i];
+                outL[i] = input*dry+l[i]*wet;
+                outR[i] = input*dry+r[i]*wet;
+            }
+            outR += n;
+        } else {
+            chorus.Process(inL, l, n);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                float input = inL[i];
+                float wet = dryWetDezipper.Tick();
+                float dry = 1.0f-wet;
+                
+                outL[i] = dry*input+wet*l[i];
+            }
         }
+        inL += n;
+        outL += n;
+        n_samples -= n;
     }
 }
 void ToobChorus::Deactivate()
@@ -43,6 +43,8 @@
 #include "OutputPort.h"
 #include "ControlDezipper.h"
 #include "Ce2Chorus.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 
@@ -57,6 +59,8 @@ namespace toob {
 			AUDIO_INL,
 			AUDIO_OUTL,
 			AUDIO_OUTR,
+			CPU_LOAD,
+			CPU_PEAK,
 		};
 
 		float*pRate = nullptr;
@@ -75,6 +79,8 @@ namespace toob {
 		std::string bundle_path;
 
 		Ce2Chorus chorus;
+		RtTraceSource traceSource{"ToobChorus"};
+		CpuLoadMeter cpuLoadMeter;
 		double getRate() { return rate; }
 		std::string getBundlePath() { return bundle_path.c_str(); }
 
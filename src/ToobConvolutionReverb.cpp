@@ -31,6 +31,7 @@
 #include "FlacReader.hpp"
 #include "ss.hpp"
 #include "LsNumerics/ConvolutionReverb.hpp"
+#include "ThreadManager.hpp"
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
@@ -65,6 +66,7 @@ ToobConvolutionReverbBase::ToobConvolutionReverbBase(
 {
     urids.Init(this);
     loadWorker.Initialize((size_t)rate, this);
+    cpuLoadMeter.SetSampleRate(rate);
 
     SetDefaultFile(features);
 
@@ -141,6 +143,12 @@ void ToobConvolutionReverbBase::ConnectPort(uint32_t port, void *data)
         case MonoReverbPortId::CONTROL_OUT:
             this->controlOut = (LV2_Atom_Sequence *)data;
             break;
+        case MonoReverbPortId::CPU_LOAD:
+            this->cpuLoadMeter.SetLoadData(data);
+            break;
+        case MonoReverbPortId::CPU_PEAK:
+            this->cpuLoadMeter.SetPeakData(data);
+            break;
         default:
             this->LogError("%s\n", SS("Illegal port id: " << port).c_str());
             break;
@@ -215,6 +223,12 @@ void ToobConvolutionReverbBase::ConnectPort(uint32_t port, void *data)
         case StereoReverbPortId::CONTROL_OUT:
             this->controlOut = (LV2_Atom_Sequence *)data;
             break;
+        case StereoReverbPortId::CPU_LOAD:
+            this->cpuLoadMeter.SetLoadData(data);
+            break;
+        case StereoReverbPortId::CPU_PEAK:
+            this->cpuLoadMeter.SetPeakData(data);
+            break;
         default:
             this->LogError("%s\n", SS("Illegal port id: " << port).c_str());
             break;
@@ -265,6 +279,12 @@ void ToobConvolutionReverbBase::ConnectPort(uint32_t port, void *data)
         case CabIrPortId::CONTROL_OUT:
             this->controlOut = (LV2_Atom_Sequence *)data;
             break;
+        case CabIrPortId::CPU_LOAD:
+            this->cpuLoadMeter.SetLoadData(data);
+            break;
+        case CabIrPortId::CPU_PEAK:
+            this->cpuLoadMeter.SetPeakData(data);
+            break;
         default:
             this->LogError("%s\n", SS("Illegal port id: " << port).c_str());
         }
@@ -439,7 +459,10 @@ void ToobConvolutionReverbBase::Activate()
 
 void ToobConvolutionReverbBase::Run(uint32_t n_samples)
 {
-    fp_state_t savedDenorms = disable_denorms();
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    toob::ThreadManager::NoteAudioThread();
+    LsNumerics::AutoDenorm autoDenorm;
     BeginAtomOutput(this->controlOut);
     HandleEvents(this->controlIn);
     UpdateControls();
@@ -492,7 +515,6 @@ void ToobConvolutionReverbBase::Run(uint32_t n_samples)
 
     // absolutely ignore hosts that set *pLoadingState.
     *(pLoadingState) = this->loadingState;
-    restore_denorms(savedDenorms);
 
 }
 
@@ -44,6 +44,8 @@
 #include "OutputPort.h"
 #include "ControlDezipper.h"
 #include "LsNumerics/ConvolutionReverb.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 namespace toob
 {
@@ -87,7 +89,9 @@ namespace toob
 			AUDIO_INL,
 			AUDIO_OUTL,
 			CONTROL_IN,
-			CONTROL_OUT
+			CONTROL_OUT,
+			CPU_LOAD,
+			CPU_PEAK
 		};
 		enum class StereoReverbPortId
 		{
@@ -112,7 +116,9 @@ namespace toob
 			AUDIO_OUTL,
 			AUDIO_OUTR,
 			CONTROL_IN,
-			CONTROL_OUT
+			CONTROL_OUT,
+			CPU_LOAD,
+			CPU_PEAK
 		};
 
 		enum class CabIrPortId
@@ -127,7 +133,9 @@ namespace toob
 			AUDIO_INL,
 			AUDIO_OUTL,
 			CONTROL_IN,
-			CONTROL_OUT
+			CONTROL_OUT,
+			CPU_LOAD,
+			CPU_PEAK
 		};
 		using convolution_reverb_ptr = std::shared_ptr<ConvolutionReverb>;
 		static constexpr const char *VERSION_FILENAME = "ToobAmp.lv2.version";
@@ -364,6 +372,8 @@ namespace toob
 
 		double sampleRate = 0;
 		bool activated = false;
+		RtTraceSource traceSource{"ToobConvolutionReverb"};
+		CpuLoadMeter cpuLoadMeter;
         const float *pBypass = nullptr;
 		const float *pTime = nullptr;
 		const float *pDirectMix = nullptr;
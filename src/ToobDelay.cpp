@@ -21,11 +21,27 @@
  *   SOFTWARE.
  */
 #include "ToobDelay.h"
+#include <algorithm>
+#include <cmath>
+#include "LsNumerics/LsMath.hpp"
+#include "LsNumerics/Denorms.hpp"
 
 using namespace toob;
 
 const float MAX_DELAY_MS = 4000;
-const float NOMINAL_DELAY_MS = 1600;
+const float DENORM_GUARD = 1E-11;
+
+// Delay-time changes glide (with the pitch shift of a tape machine changing speed) rather than jump.
+const float DELAY_GLIDE_SECONDS = 0.2f;
+const float MODULATION_FADE_SECONDS = 0.5f;
+
+// Tape mode: peak pitch deviation of wow and flutter.
+const double WOW_HZ = 0.55;
+const double WOW_PITCH_DEVIATION = 0.0015;
+const double FLUTTER_HZ = 6.3;
+const double FLUTTER_PITCH_DEVIATION = 0.0004;
+
+static const size_t MAX_CHUNK_SIZE = 128;
 
 ToobDelay::ToobDelay(
     double rate,
@@ -36,6 +52,19 @@ ToobDelay::ToobDelay(
       bundle_path(bundle_path)
 
 {
+    delayDezipper.SetSampleRate(rate);
+    modulationDezipper.SetSampleRate(rate);
+
+    // A delay modulated by A*sin(2*pi*f*t) samples shifts pitch by up to 2*pi*f*A/rate.
+    wowDepth = (float)(WOW_PITCH_DEVIATION * rate / (2 * LsNumerics::Pi * WOW_HZ));
+    flutterDepth = (float)(FLUTTER_PITCH_DEVIATION * rate / (2 * LsNumerics::Pi * FLUTTER_HZ));
+    maxModulation = (uint32_t)std::ceil(wowDepth + flutterDepth) + 1;
+
+    wowCos = (float)std::cos(2 * LsNumerics::Pi * WOW_HZ / rate);
+    wowSin = (float)std::sin(2 * LsNumerics::Pi * WOW_HZ / rate);
+    flutterCos = (float)std::cos(2 * LsNumerics::Pi * FLUTTER_HZ / rate);
+    flutterSin = (float)std::sin(2 * LsNumerics::Pi * FLUTTER_HZ / rate);
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 const char *ToobDelay::URI = TOOB_DELAY_URI;
@@ -59,15 +88,22 @@ void ToobDelay::ConnectPort(uint32_t port, void *data)
     case PortId::AUDIO_OUTL:
         this->outL = (float *)data;
         break;
+    case PortId::MODE:
+        this->mode = (float *)data;
+        break;
+    case PortId::CPU_LOAD:
+        this->cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::CPU_PEAK:
+        this->cpuLoadMeter.SetPeakData(data);
+        break;
     }
 }
 void ToobDelay::clear()
 {
-    for (size_t i = 0; i < delayLine.size(); ++i)
-    {
-        delayLine[i] = 0;
-    }
-    this->delayIndex = 0;
+    delayLine.Clear();
+    wowX = flutterX = 1;
+    wowY = flutterY = 0;
 }
 inline void ToobDelay::updateControls()
 {
@@ -83,12 +119,13 @@ inline void ToobDelay::updateControls()
         delayValue = (uint32_t)(t * rate / 1000);
         if (delayValue == 0)
             delayValue = 1;
-
-        size_t len = delayValue + 2;
-        if (len > delayLine.size())
-        {
-            delayLine.resize(len);
-        }
+        delayDezipper.To((float)delayValue, DELAY_GLIDE_SECONDS);
+    }
+    if (lastMode != *mode)
+    {
+        lastMode = *mode;
+        modeValue = lastMode >= 0.5f ? DelayMode::Tape : DelayMode::Digital;
+        modulationDezipper.To(modeValue == DelayMode::Tape ? 1.0f : 0.0f, MODULATION_FADE_SECONDS);
     }
     if (lastLevel != *level)
     {
@@ -120,23 +157,81 @@ inline void ToobDelay::updateControls()
 }
 void ToobDelay::Activate()
 {
-    delayLine.resize(uint32_t(NOMINAL_DELAY_MS*rate/1000)+2);
-    lastDelay =lastLevel = lastFeedback = -1E30; // force updates
+    // Sized for the longest delay up front, so that delay changes never allocate on the audio thread.
+    delayLine.SetMaxDelay(uint32_t(MAX_DELAY_MS*rate/1000) + maxModulation + 1);
+    lastDelay =lastLevel = lastFeedback = lastMode = -1E30; // force updates
     updateControls();
+    delayDezipper.To((float)delayValue, 0);
+    modulationDezipper.To(modeValue == DelayMode::Tape ? 1.0f : 0.0f, 0);
     clear();
 }
 
+void ToobDelay::runFixed(const float *input, float *output, uint32_t n_samples)
+{
+    // Each chunk is read from the delay line before it is written back, 
+    // so a chunk can be no longer than the delay.
+    float delayed[MAX_CHUNK_SIZE];
+    float feedbackInput[MAX_CHUNK_SIZE];
+    size_t maxChunk = std::min(MAX_CHUNK_SIZE, (size_t)delayValue + 1);
+    while (n_samples != 0)
+    {
+        size_t n = std::min((size_t)n_samples, maxChunk);
+        delayLine.Read(delayValue, delayed, n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            float x = input[i];
+            float t = delayed[i];
+            feedbackInput[i] = x + t*feedbackValue + DENORM_GUARD;
+            output[i] = x + levelValue*t;
+        }
+        delayLine.Write(feedbackInput, n);
+        input += n;
+        output += n;
+        n_samples -= (uint32_t)n;
+    }
+}
+
+void ToobDelay::runModulated(const float *input, float *output, uint32_t n_samples)
+{
+    for (uint32_t i = 0; i < n_samples; ++i)
+    {
+        float x = wowX*wowCos - wowY*wowSin;
+        wowY = wowX*wowSin + wowY*wowCos;
+        wowX = x;
+        x = flutterX*flutterCos - flutterY*flutterSin;
+        flutterY = flutterX*flutterSin + flutterY*flutterCos;
+        flutterX = x;
+
+        float depth = modulationDezipper.Tick();
+        float delay = delayDezipper.Tick() + depth*(wowDepth*wowY + flutterDepth*flutterY);
+        if (delay < 1)
+        {
+            delay = 1;
+        }
+        float t = delayLine.GetLagrange(delay);
+
+        float in = input[i];
+        delayLine.Put(in + t*feedbackValue + DENORM_GUARD);
+        output[i] = in + levelValue*t;
+    }
+    // keep the oscillators on the unit circle.
+    float g = 1.5f - 0.5f*(wowX*wowX + wowY*wowY);
+    wowX *= g; wowY *= g;
+    g = 1.5f - 0.5f*(flutterX*flutterX + flutterY*flutterY);
+    flutterX *= g; flutterY *= g;
+}
+
 void ToobDelay::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     updateControls();
-    for (uint32_t i = 0; i < n_samples; ++i)
+    if (modeValue == DelayMode::Digital && delayDezipper.IsComplete() && modulationDezipper.IsComplete())
     {
-        float input = inL[i];
-        float t = delayGet();
-        const float DENORM_GUARD = 1E-11;
-        delayPut(input + t*feedbackValue + DENORM_GUARD);
-        float output = input + levelValue*t;
-        outL[i] = output;
+        runFixed(inL, outL, n_samples);
+    } else {
+        runModulated(inL, outL, n_samples);
     }
 }
 void ToobDelay::Deactivate()
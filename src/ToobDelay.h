@@ -40,6 +40,9 @@
 #include "InputPort.h"
 #include "OutputPort.h"
 #include "ControlDezipper.h"
+#include "LsNumerics/InterpolatingDelay.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 
@@ -60,6 +63,13 @@ namespace toob {
 			FEEDBACK,
 			AUDIO_INL,
 			AUDIO_OUTL,
+			MODE,
+			CPU_LOAD,
+			CPU_PEAK,
+		};
+		enum class DelayMode {
+			Digital = 0,
+			Tape = 1
 		};
 
 		float*delay = nullptr;
@@ -67,14 +77,17 @@ namespace toob {
 		float *feedback = nullptr;
 		const float*inL = nullptr;
 		float*outL = nullptr;
+		float*mode = nullptr;
 
 		float lastDelay = -2;
 		float lastLevel = -2;
 		float lastFeedback = -2;
+		float lastMode = -2;
 
 		uint32_t delayValue = 340*44100/1000;
 		float levelValue = .37;
 		float feedbackValue = 0.25;
+		DelayMode modeValue = DelayMode::Digital;
 
 
 		double rate = 44100;
@@ -82,22 +95,25 @@ namespace toob {
 
 		double getRate() { return rate; }
 		std::string getBundlePath() { return bundle_path.c_str(); }
-		std::vector<float> delayLine;
-		uint32_t delayIndex = 0;
-		float delayGet() const {
-			return delayLine[(delayIndex + delayValue) % delayLine.size()];
-		}
-		void delayPut(float value) {
-			if (delayIndex == 0)
-			{
-				delayIndex = delayLine.size()-1;
-			} else {
-				delayIndex = delayIndex-1;
-			}
-			delayLine[delayIndex] = value;
-		}
+		LsNumerics::InterpolatingDelay delayLine;
+		// delay time in samples, glides to delayValue when the delay control changes.
+		ControlDezipper delayDezipper;
+		// 0..1 scale of the tape modulation, so that mode changes fade the modulation in and out.
+		ControlDezipper modulationDezipper;
+
+		// Tape wow and flutter: quadrature oscillators, and modulation depths in samples.
+		float wowX = 1, wowY = 0, wowCos = 1, wowSin = 0;
+		float flutterX = 1, flutterY = 0, flutterCos = 1, flutterSin = 0;
+		float wowDepth = 0;
+		float flutterDepth = 0;
+		uint32_t maxModulation = 0;
+		RtTraceSource traceSource{"ToobDelay"};
+		CpuLoadMeter cpuLoadMeter;
+
 		void clear();
 		void updateControls();
+		void runFixed(const float *input, float *output, uint32_t n_samples);
+		void runModulated(const float *input, float *output, uint32_t n_samples);
 	public:
 		static Lv2Plugin* Create(double rate,
 			const char* bundle_path,
@@ -0,0 +1,95 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+/*
+    Measures StagedFft plans on the current machine, and saves the fastest plan for each FFT size
+    to the wisdom file that ToobAmp plugins load when they create their first FFT plan.
+
+    Usage: ToobFftWisdom [-m max-log2-size] [-o output-file] [-v]
+*/
+
+#include "LsNumerics/StagedFft.hpp"
+#include "CommandLineParser.hpp"
+#include <iostream>
+#include <cstdlib>
+
+using namespace LsNumerics;
+using namespace toob;
+
+int main(int argc, const char **argv)
+{
+    try
+    {
+        int maxLog2Size = 17;
+        std::string outputFile;
+        bool verbose = false;
+        bool help = false;
+
+        CommandLineParser commandLineParser;
+        commandLineParser.AddOption("m", "max-log2-size", &maxLog2Size);
+        commandLineParser.AddOption("o", "output", &outputFile);
+        commandLineParser.AddOption("v", "verbose", &verbose);
+        commandLineParser.AddOption("h", "help", &help);
+        commandLineParser.Parse(argc, argv);
+
+        if (help || commandLineParser.Arguments().size() != 0)
+        {
+            std::cout << "ToobFftWisdom - Measure FFT plans for the current machine." << std::endl
+                      << "Syntax: ToobFftWisdom [options]" << std::endl
+                      << "Options:" << std::endl
+                      << "  -m, --max-log2-size n   Measure FFT sizes up to 2^n (default 17)." << std::endl
+                      << "  -o, --output file       Output file (default " << StagedFftWisdom::DefaultPath().string() << ")." << std::endl
+                      << "  -v, --verbose           Display timings for all candidate plans." << std::endl
+                      << "  -h, --help              Display this message." << std::endl;
+            return help ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        if (maxLog2Size < 1 || maxLog2Size > (int)StagedFftWisdom::MAX_LOG2_SIZE)
+        {
+            throw std::runtime_error("Invalid value for --max-log2-size.");
+        }
+        std::filesystem::path path = outputFile.empty() ? StagedFftWisdom::DefaultPath() : std::filesystem::path(outputFile);
+        if (path.empty())
+        {
+            throw std::runtime_error("Can't determine the default wisdom file. Use --output.");
+        }
+
+        if (verbose)
+        {
+            StagedFftWisdom::Measure((size_t)maxLog2Size, &std::cout);
+        }
+        else
+        {
+            std::cout << "Measuring..." << std::endl;
+            StagedFftWisdom::Measure((size_t)maxLog2Size);
+        }
+        StagedFftWisdom::Save(path);
+        std::cout << "Saved " << path.string() << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -21,6 +21,8 @@
  *   SOFTWARE.
  */
 #include "ToobFlanger.h"
+#include <algorithm>
+#include "LsNumerics/Denorms.hpp"
 
 
 
@@ -48,6 +50,7 @@ ToobFlangerBase::ToobFlangerBase(
 
 {
     dryWetDezipper.SetSampleRate(rate);
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 const char *ToobFlanger::URI = TOOB_FLANGER_URI;
@@ -85,7 +88,23 @@ void ToobFlangerBase::ConnectPort(uint32_t port, void *data)
     case PortId::AUDIO_OUTR:
         this->outR = (float *)data;
         break;
+    case PortId::CPU_LOAD:
+        this->cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::CPU_PEAK:
+        this->cpuLoadMeter.SetPeakData(data);
+        break;
+    }
+}
+
+void ToobFlanger::ConnectPort(uint32_t port, void *data)
+{
+    // The mono plugin has no AUDIO_OUTR port, so the ports that follow it are one index lower.
+    if (port >= (uint32_t)PortId::AUDIO_OUTR)
+    {
+        ++port;
     }
+    ToobFlangerBase::ConnectPort(port, data);
 }
 void ToobFlangerBase::clear()
 {
@@ -145,34 +164,49 @@ void ToobFlangerBase::Activate()
 
 void ToobFlangerBase::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     updateControls();
-    if (outR != nullptr)
+    // inL and outL may be the same buffer, so the flanger output goes to scratch buffers first.
+    constexpr uint32_t CHUNK_SIZE = 64;
+    float l[CHUNK_SIZE];
+    float r[CHUNK_SIZE];
+    const float *inL = this->inL;
+    float *outL = this->outL;
+    float *outR = this->outR;
+    while (n_samples != 0)
     {
-        for (uint32_t i = 0; i < n_samples; ++i)
-        {
-            float input = inL[i];
-
-            float wet = dryWetDezipper.Tick();
-            float dry = 1.0f-wet;
-
-            float l, r;
-
-            flanger.Tick(input,&l,&r);
-
-            outL[i] = input*dry + l*wet;
-            outR[i] = input*dry + r*wet;
-        }
-    } else {
-        for (uint32_t i = 0; i < n_samples; ++i)
+        uint32_t n = std::min(n_samples, CHUNK_SIZE);
+        if (outR != nullptr)
         {
-            float input = inL[i];
-
-            float wet = dryWetDezipper.Tick();
-            float dry = 1.0-wet;
-
-            outL[i] = input*dry + flanger.Tick(input)*wet;
+            flanger.Process(inL, l, r, n);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                float input = inL[i];
+
+                float wet = dryWetDezipper.Tick();
+                float dry = 1.0f-wet;
+
+                outL[i] = input*dry + l[i]*wet;
+                outR[i] = input*dry + r[i]*wet;
+            }
+            outR += n;
+        } else {
+            flanger.Process(inL, l, n);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                float input = inL[i];
+
+                float wet = dryWetDezipper.Tick();
+                float dry = 1.0-wet;
+
+                outL[i] = input*dry + l[i]*wet;
+            }
         }
-
+        inL += n;
+        outL += n;
+        n_samples -= n;
     }
     *pLfo = flanger.GetLfoValue();
 }
@@ -43,13 +43,15 @@
 #include "OutputPort.h"
 #include "ControlDezipper.h"
 #include "Tf2Flanger.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 namespace toob
 {
 
 	class ToobFlangerBase : public Lv2Plugin
 	{
-	private:
+	protected:
 		enum class PortId
 		{
 			MANUAL = 0,
@@ -61,8 +63,11 @@ namespace toob
 			AUDIO_INL,
 			AUDIO_OUTL,
 			AUDIO_OUTR,
+			CPU_LOAD,
+			CPU_PEAK,
 		};
 
+	private:
 		const float *pManual = nullptr;
 		const float *pRate = nullptr;
 		const float *pDepth = nullptr;
@@ -85,6 +90,8 @@ namespace toob
 		std::string bundle_path;
 
 		Tf2Flanger flanger;
+		RtTraceSource traceSource{"ToobFlanger"};
+		CpuLoadMeter cpuLoadMeter;
 		double getRate() { return rate; }
 		std::string getBundlePath() { return bundle_path.c_str(); }
 
@@ -125,6 +132,9 @@ namespace toob
 		{
 		}
 		static const char *URI;
+
+	protected:
+		virtual void ConnectPort(uint32_t port, void *data) override;
 	};
 	class ToobFlangerStereo : public ToobFlangerBase
 	{
@@ -35,6 +35,7 @@ ToobFreeverb::ToobFreeverb(
       rate(rate),
       bundle_path(bundle_path)
 {
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 const char *ToobFreeverb::URI = TOOB_FREEVERB_URI;
@@ -70,6 +71,12 @@ void ToobFreeverb::ConnectPort(uint32_t port, void *data)
     case PortId::AUDIO_OUTR:
         this->outR = (float *)data;
         break;
+    case PortId::CPU_LOAD:
+        this->cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::CPU_PEAK:
+        this->cpuLoadMeter.SetPeakData(data);
+        break;
     }
 }
 void ToobFreeverb::Activate()
@@ -94,7 +101,9 @@ void ToobFreeverb::Activate()
 }
 void ToobFreeverb::Run(uint32_t n_samples)
 {
-    fp_state_t oldstate = disable_denorms();
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
 
     if (dryWetValue != *dryWet)
     {
@@ -122,11 +131,7 @@ void ToobFreeverb::Run(uint32_t n_samples)
         freeverb.setBypass(t,false);
     }
 
-    for (uint32_t i = 0; i < n_samples; ++i)
-    {
-        freeverb.tick(inL[i], inR[i], &outL[i], &outR[i]);
-    }
-    restore_denorms(oldstate);
+    freeverb.Process(inL, inR, outL, outR, n_samples);
 }
 void ToobFreeverb::Deactivate()
 {
@@ -41,6 +41,8 @@
 #include "OutputPort.h"
 #include "ControlDezipper.h"
 #include "LsNumerics/Freeverb.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 
@@ -65,6 +67,8 @@ namespace toob {
 			AUDIO_INR,
 			AUDIO_OUTL,
 			AUDIO_OUTR,
+			CPU_LOAD,
+			CPU_PEAK,
 		};
 
 		const float*bypass = nullptr;
@@ -85,6 +89,8 @@ namespace toob {
 
 
 		Freeverb freeverb;
+		RtTraceSource traceSource{"ToobFreeverb"};
+		CpuLoadMeter cpuLoadMeter;
 		double rate = 44100;
 		std::string bundle_path;
 
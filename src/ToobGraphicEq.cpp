@@ -19,6 +19,8 @@
 
 #include "ToobGraphicEq.hpp"
 #include "ControlDezipper.h"
+#include <algorithm>
+#include "LsNumerics/Denorms.hpp"
 
 using namespace graphiceq_plugin;
 
@@ -36,14 +38,34 @@ ToobGraphicEq::ToobGraphicEq(double rate,
         &gain_1600hz,
         &gain_3200hz,
         &gain_6400hz};
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 ToobGraphicEq::~ToobGraphicEq()
 {
 }
 
+void ToobGraphicEq::ConnectPort(uint32_t port, void *data)
+{
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobGraphicEq::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     for (size_t i = 0; i < bandDezippers.size(); ++i)
     {
         auto & dezipper = bandDezippers[i];
@@ -60,17 +82,38 @@ void ToobGraphicEq::Run(uint32_t n_samples)
 
     const float *inL = in_left.Get();
     float *outL = out_left.Get();
-    for (size_t i = 0; i < n_samples; ++i)
+
+    // Band gains are dezipped once per sub-block rather than per sample, since
+    // recalculating section coefficients is expensive.
+    constexpr size_t GAIN_UPDATE_SAMPLES = 32;
+    for (size_t i = 0; i < n_samples; /**/)
     {
+        size_t n = std::min((size_t)(n_samples - i), GAIN_UPDATE_SAMPLES);
+        bool gainsChanged = false;
         for (size_t z = 0; z < bandDezippers.size(); ++z)
         {
-            auto & dezipper = bandDezippers[z];
-            if (!dezipper.IsIdle()) {
-                graphicEq.setGain(z,dezipper.Tick());
+            auto &dezipper = bandDezippers[z];
+            if (!dezipper.IsIdle())
+            {
+                float gain = 0;
+                for (size_t j = 0; j < n; ++j)
+                {
+                    gain = dezipper.Tick();
+                }
+                graphicEq.setGain(z, gain);
+                gainsChanged = true;
             }
         }
-        double y = graphicEq.process(inL[i]); 
-        outL[i] = y * levelDezipper.Tick();
+        if (gainsChanged)
+        {
+            blockEq.updateCoefficients(graphicEq);
+        }
+        blockEq.process(inL + i, outL + i, n);
+        for (size_t j = 0; j < n; ++j)
+        {
+            outL[i + j] *= levelDezipper.Tick();
+        }
+        i += n;
     }
 }
 
@@ -90,6 +133,8 @@ void ToobGraphicEq::Activate()
         graphicEq.setGain(i, dezipper.Tick());
     }
     graphicEq.reset();
+    blockEq.updateCoefficients(graphicEq);
+    blockEq.reset();
 }
 void ToobGraphicEq::Deactivate()
 {
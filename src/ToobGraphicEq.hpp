@@ -28,6 +28,8 @@
 #include "ToobGraphicEqInfo.hpp"
 #include "DbDezipper.h"
 #include "HoltersGraphicEq.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 using namespace lv2c::lv2_plugin;
 using namespace graphiceq_plugin;
@@ -52,6 +54,8 @@ public:
     virtual ~ToobGraphicEq();
 
 protected:
+    virtual void ConnectPort(uint32_t port, void *data) override;
+
     virtual void Run(uint32_t n_samples) override;
 
     virtual void Activate() override;
@@ -59,7 +63,10 @@ protected:
 
 private:
     toob::holters_graphic_eq::GraphicEq graphicEq;
+    toob::holters_graphic_eq::GraphicEqBlock<float> blockEq;
     std::vector<RangedDbInputPort*> bandInputPorts;
     std::vector<DbDezipper> bandDezippers;
     DbDezipper levelDezipper;
+    RtTraceSource traceSource{"ToobGraphicEq"};
+    CpuLoadMeter cpuLoadMeter;
 };
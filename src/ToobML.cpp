@@ -270,6 +270,7 @@ ToobML::ToobML(double _rate,
     this->updateSampleDelay = (int)(_rate / MAX_UPDATES_PER_SECOND);
     this->updateMsDelay = (1000 / MAX_UPDATES_PER_SECOND);
     this->trimOutputSampleRate = (int)(_rate * TRIMOUT_UPDATE_RATE_S);
+    cpuLoadMeter.SetSampleRate(_rate);
 }
 
 ToobML::~ToobML()
@@ -350,6 +351,12 @@ void ToobML::ConnectPort(uint32_t port, void *data)
     case PortId::SAGF:
         this->sagProcessor.SagF.SetData(data);
         break;
+    case PortId::CPU_LOAD:
+        this->cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::CPU_PEAK:
+        this->cpuLoadMeter.SetPeakData(data);
+        break;
     }
 }
 
@@ -660,9 +667,9 @@ inline void ToobML::UpdateFilter()
 }
 void ToobML::Run(uint32_t n_samples)
 {
-    using namespace LsNumerics;
-    auto oldFpState = disable_denorms();
-    restore_denorms(oldFpState);
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     BeginAtomOutput(notifyOut);
 
     HandleEvents(this->controlIn);
@@ -790,8 +797,6 @@ void ToobML::Run(uint32_t n_samples)
             WriteFrequencyResponse();
         }
     }
-
-    restore_denorms(oldFpState);
 }
 
 std::string ToobML::UnmapFilename(const LV2_Feature *const *features, const std::string &fileName)
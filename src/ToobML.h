@@ -47,6 +47,8 @@
 #include "ControlDezipper.h"
 #include "LsNumerics/BaxandallToneStack.hpp"
 #include "SagProcessor.h"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 #define TOOB_ML_URI "http://two-play.com/plugins/toob-ml"
 #ifndef TOOB_URI
@@ -97,6 +99,9 @@ namespace toob
 			CONTROL_IN,
 			NOTIFY_OUT,
 
+			CPU_LOAD,
+			CPU_PEAK,
+
 		};
 
 		double rate;
@@ -233,6 +238,8 @@ namespace toob
 		ControlDezipper trimDezipper;
 		ControlDezipper gainDezipper;
 		ControlDezipper masterDezipper;
+		RtTraceSource traceSource{"ToobML"};
+		CpuLoadMeter cpuLoadMeter;
 
 		enum class AsyncState
 		{
@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "ToobMix.hpp"
+#include "LsNumerics/Denorms.hpp"
 
 ToobMix::ToobMix(double rate,
                  const char *bundle_path,
@@ -28,6 +29,7 @@ ToobMix::ToobMix(double rate,
     zipLR.SetSampleRate(rate);
     zipRL.SetSampleRate(rate);
     zipRR.SetSampleRate(rate);
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 ToobMix::~ToobMix()
@@ -75,8 +77,27 @@ void ToobMix::Mix(uint32_t n_samples)
     }
 }
 
+void ToobMix::ConnectPort(uint32_t port, void *data)
+{
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobMix::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     Mix(n_samples);
 }
 
@@ -21,12 +21,14 @@
 #include "lv2_plugin/Lv2Ports.hpp"
 
 #include <limits>
+#include "LsNumerics/Denorms.hpp"
 
 ToobNoiseGate::ToobNoiseGate(double rate,
                              const char *bundle_path,
                              const LV2_Feature *const *features)
     : ToobNoiseGateBase(rate, bundle_path, features)
 {
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 ToobNoiseGate::~ToobNoiseGate()
@@ -195,8 +197,27 @@ void ToobNoiseGate::UpdateControls()
     this->holdSamples = msToSamples(this->hold.GetValue(), getRate());
     this->releaseSamples = msToSamples(this->release.GetValue(), getRate());
 }
+void ToobNoiseGate::ConnectPort(uint32_t port, void *data)
+{
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobNoiseGate::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     UpdateControls();
     Mix(n_samples);
 }
@@ -26,6 +26,8 @@
 #include <memory>
 #include "ToobNoiseGateInfo.hpp"
 #include "ControlDezipper.h"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 using namespace lv2c::lv2_plugin;
 using namespace noise_gate_plugin;
@@ -53,6 +55,8 @@ protected:
 
 	virtual void Mix(uint32_t n_samples);
 
+	virtual void ConnectPort(uint32_t port, void *data) override;
+
 	virtual void Run(uint32_t n_samples) override;
 
 	virtual void Activate() override;
@@ -81,5 +85,7 @@ private:
 	size_t attackSamples = 1;
 	size_t holdSamples = 100;
 	size_t releaseSamples = 10000;
+	RtTraceSource traceSource{"ToobNoiseGate"};
+	CpuLoadMeter cpuLoadMeter;
 };
 
@@ -25,6 +25,7 @@
 //
 
 #include "ToobParametricEq.h"
+#include "LsNumerics/Denorms.hpp"
 
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
@@ -77,6 +78,8 @@ ToobParametricEq::ToobParametricEq(double _rate,
     this->updateMsDelay = (1000 / MAX_UPDATES_PER_SECOND);
     gainDezipper.SetSampleRate(_rate);
     gainDezipper.SetRate(0.1f); // 100ms dezipper time.
+    cpuLoadMeter.SetSampleRate(rate);
+    stereoPorts = isStereo;
 }
 
 ToobParametricEq::~ToobParametricEq()
@@ -119,6 +122,7 @@ void ToobParametricEq::Activate()
     eq.highShelf.SetHighShelf(this->hfLevel.GetDb(), this->hfC.GetValue() * 1000.0f);
     eq.lmf.SetParameters(this->lmfC.GetValue(), this->lmfLevel.GetDb(), this->lmfQ.GetValue());
     eq.hmf.SetParameters(this->hmfC.GetValue() * 1000.0f, this->hmfLevel.GetDb(), this->hmfQ.GetValue());
+    eq.ResetCascade();
 
     this->responseChanged = true;
 }
@@ -126,8 +130,32 @@ void ToobParametricEq::Deactivate()
 {
 }
 
+void ToobParametricEq::ConnectPort(uint32_t port, void *data)
+{
+    if (!stereoPorts && port >= (uint32_t)PortId::inR)
+    {
+        // The mono plugin has no inR/outR ports, so the ports that follow them are two indices lower.
+        port += 2;
+    }
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobParametricEq::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
 
     if (UpdateControls())
     {
@@ -138,18 +166,10 @@ void ToobParametricEq::Run(uint32_t n_samples)
         const float *input = this->in.Get();
         float *output = this->out.Get();
 
-        for (size_t i = 0; i < n_samples; ++i)
-        {
-            output[i] = this->eq.Tick(input[i]);
-        }
-
         const float *inputR = this->inR.Get();
         float *outputR = this->outR.Get();
 
-        for (size_t i = 0; i < n_samples; ++i)
-        {
-            outputR[i] = this->eq.TickR(inputR[i]);
-        }
+        this->eq.Process(input, inputR, output, outputR, n_samples);
 
         for (size_t i = 0; i < n_samples; ++i)
         {
@@ -163,10 +183,7 @@ void ToobParametricEq::Run(uint32_t n_samples)
         const float *input = this->in.Get();
         float *output = this->out.Get();
 
-        for (size_t i = 0; i < n_samples; ++i)
-        {
-            output[i] = this->eq.Tick(input[i]);
-        }
+        this->eq.Process(input, output, n_samples);
 
         for (size_t i = 0; i < n_samples; ++i)
         {
@@ -327,4 +344,4 @@ void ToobParametricEq::OnPatchGet(LV2_URID propertyUrid)
 
 
 REGISTRATION_DECLARATION PluginRegistration<ToobParametricEq> toobParametricEqRegistration(ToobParametricEq::MONO_URI);
-REGISTRATION_DECLARATION PluginRegistration<ToobParametricEq> toobParametricEqStereoRegistration(ToobParametricEq::STEREO_URI);
+REGISTRATION_DECLARATION PluginRegistration<ToobParametricEqStereo> toobParametricEqStereoRegistration(ToobParametricEq::STEREO_URI);
@@ -45,6 +45,8 @@
 #include "ToobParametricEqInfo.hpp"
 
 #include "ParametricEq.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 
 #ifndef TOOB_URI
@@ -124,6 +126,9 @@ class ToobParametricEq : public ToobParametricEqBase {
 
 	private:
         DbDezipper gainDezipper;
+        RtTraceSource traceSource{"ToobParametricEq"};
+        CpuLoadMeter cpuLoadMeter;
+        bool stereoPorts = false;
 
 	protected:
 		bool isStereo = false;
@@ -165,7 +170,25 @@ class ToobParametricEq : public ToobParametricEqBase {
 
 	protected:
 		virtual void Activate();
+		virtual void ConnectPort(uint32_t port, void *data) override;
 		virtual void Run(uint32_t n_samples);
 		virtual void Deactivate();
 	};
+
+	class ToobParametricEqStereo : public ToobParametricEq {
+	public:
+		static Lv2Plugin* Create(double rate,
+			const char* bundle_path,
+			const LV2_Feature* const* features)
+		{
+			return new ToobParametricEqStereo(rate, bundle_path, features);
+		}
+
+		ToobParametricEqStereo(double rate,
+			const char* bundle_path,
+			const LV2_Feature* const* features)
+			: ToobParametricEq(rate, bundle_path, features, true)
+		{
+		}
+	};
 }
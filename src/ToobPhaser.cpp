@@ -19,6 +19,7 @@
 
 #include "ToobPhaser.hpp"
 #include "restrict.hpp"
+#include "LsNumerics/Denorms.hpp"
 
 ToobPhaser::ToobPhaser(double rate,
                  const char *bundle_path,
@@ -27,6 +28,7 @@ ToobPhaser::ToobPhaser(double rate,
       phaser(rate)
 {
     dryWetDezipper.SetSampleRate(rate);
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 ToobPhaser::~ToobPhaser()
@@ -35,7 +37,26 @@ ToobPhaser::~ToobPhaser()
 
 
 
+void ToobPhaser::ConnectPort(uint32_t port, void *data)
+{
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobPhaser::Run(uint32_t n_samples) {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     const float* restrict inL = this->in.Get();
     float * restrict outL = this->out.Get();
 
@@ -47,13 +68,23 @@ void ToobPhaser::Run(uint32_t n_samples) {
         dryWetDezipper.To(dryWet.GetValue(),0.1f);
     }
 
-    for (size_t i = 0; i < n_samples; ++i)
+    constexpr size_t CHUNK_SIZE = 64;
+    float wetBuffer[CHUNK_SIZE];
+    while (n_samples != 0)
     {
-        float input = inL[i];
-        float output = phaser.process(input);
-        float wet = dryWetDezipper.Tick();
-        float dry = 1.0f-wet;
-        outL[i] = dry*input+wet*output;
+        size_t n = std::min((size_t)n_samples, CHUNK_SIZE);
+        phaser.process(inL, wetBuffer, n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            float input = inL[i];
+            float output = wetBuffer[i];
+            float wet = dryWetDezipper.Tick();
+            float dry = 1.0f-wet;
+            outL[i] = dry*input+wet*output;
+        }
+        inL += n;
+        outL += n;
+        n_samples -= n;
     }
 }
 
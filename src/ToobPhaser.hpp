@@ -27,6 +27,8 @@
 #include "ToobPhaserInfo.hpp"
 #include "ControlDezipper.h"
 #include "Phaser.hpp"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 using namespace lv2c::lv2_plugin;
 using namespace phaser_plugin;
@@ -54,6 +56,8 @@ public:
 
 protected:
 
+	virtual void ConnectPort(uint32_t port, void *data) override;
+
 	virtual void Run(uint32_t n_samples) override;
 
 	virtual void Activate() override;
@@ -61,5 +65,7 @@ protected:
 private:
     ControlDezipper dryWetDezipper;
 	Phaser phaser;
+	RtTraceSource traceSource{"ToobPhaser"};
+	CpuLoadMeter cpuLoadMeter;
 };
 
@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "ToobTone.hpp"
+#include "LsNumerics/Denorms.hpp"
 
 static constexpr int MAX_UPDATES_PER_SECOND = 10;
 
@@ -25,7 +26,8 @@ uint64_t timeMs();
 
 ToobTone::ToobTone(double rate,
                    const char *bundle_path,
-                   const LV2_Feature *const *features)
+                   const LV2_Feature *const *features,
+                   bool stereo)
     : super(rate, bundle_path, features),
       _rate(rate)
 {
@@ -39,6 +41,8 @@ ToobTone::ToobTone(double rate,
     gainDezipper.SetSampleRate(rate);
     gainDezipper.Reset(0);
     gainDezipper.SetRate(0.1);
+    cpuLoadMeter.SetSampleRate(rate);
+    stereoPorts = stereo;
 }
 
 ToobTone::~ToobTone()
@@ -78,8 +82,32 @@ void ToobTone::UpdateFilter()
     responseChanged = true;
 }
 
+void ToobTone::ConnectPort(uint32_t port, void *data)
+{
+    if (!stereoPorts && port >= (uint32_t)PortId::inR)
+    {
+        // The mono plugin has no inR/outR ports, so the ports that follow them are two indices lower.
+        port += 2;
+    }
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobTone::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     const float *in = this->in.Get();
     float *out = this->out.Get();
 
@@ -233,4 +261,4 @@ void ToobTone::OnPatchGet(LV2_URID propertyUrid)
 
 REGISTRATION_DECLARATION PluginRegistration<ToobTone> toobToneRegistration(ToobTone::URI);
 
-REGISTRATION_DECLARATION PluginRegistration<ToobTone> toobToneStereoRegistration(ToobTone::STEREO_URI);
+REGISTRATION_DECLARATION PluginRegistration<ToobToneStereo> toobToneStereoRegistration(ToobTone::STEREO_URI);
@@ -29,6 +29,8 @@
 #include "Filters/ShelvingFilter.h"
 #include "FilterResponse.h"
 #include "DbDezipper.h"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 #ifndef TOOB_URI
 #define TOOB_URI "http://two-play.com/plugins/toob"
 #endif
@@ -52,7 +54,8 @@ public:
     }
     ToobTone(double rate,
              const char *bundle_path,
-             const LV2_Feature *const *features);
+             const LV2_Feature *const *features,
+             bool stereo = false);
 
     virtual ~ToobTone();
 
@@ -62,6 +65,8 @@ public:
 protected:
     virtual void OnPatchGet(LV2_URID propertyUrid) override;
 
+    virtual void ConnectPort(uint32_t port, void *data) override;
+
     virtual void Run(uint32_t n_samples) override;
 
     virtual void Activate() override;
@@ -69,6 +74,9 @@ protected:
 
 private:
     bool isStereo = false;
+    RtTraceSource traceSource{"ToobTone"};
+    CpuLoadMeter cpuLoadMeter;
+    bool stereoPorts = false;
     struct Uris
     {
     public:
@@ -138,3 +146,20 @@ private:
 
 
 };
+
+class ToobToneStereo : public ToobTone
+{
+public:
+    static Lv2Plugin *Create(double rate,
+                             const char *bundle_path,
+                             const LV2_Feature *const *features)
+    {
+        return new ToobToneStereo(rate, bundle_path, features);
+    }
+    ToobToneStereo(double rate,
+                   const char *bundle_path,
+                   const LV2_Feature *const *features)
+        : ToobTone(rate, bundle_path, features, true)
+    {
+    }
+};
@@ -49,15 +49,34 @@ ToobTremolo::ToobTremolo(double rate,
     midHighPass.SetCutoffFrequency(lfC);
     midLowPass.SetCutoffFrequency(hfC);
     highPass.SetCutoffFrequency(hfC);
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 ToobTremolo::~ToobTremolo()
 {
 }
 
+void ToobTremolo::ConnectPort(uint32_t port, void *data)
+{
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobTremolo::Run(uint32_t n_samples)
 {
-    fp_state_t fpState = disable_denorms();
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     if (shape.HasChanged())
     {
         shapeMap.SetShape(shape.GetValue());
@@ -108,7 +127,6 @@ void ToobTremolo::Run(uint32_t n_samples)
         requestLfoShapeCount = 0;
         WriteLfoShape();
     }
-    restore_denorms(fpState);
 
 }
 void ToobTremolo::RunNormalStereo(uint32_t n_samples)
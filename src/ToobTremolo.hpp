@@ -28,6 +28,8 @@
 #include "ControlDezipper.h"
 #include "Filters/LowPassFilter.h"
 #include "Filters/HighPassFilter.h"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 #include <cmath>
 #include <cassert>
 
@@ -180,6 +182,8 @@ public:
     static constexpr const char *URI = "http://two-play.com/plugins/toob-tremolo";
 
 protected:
+    virtual void ConnectPort(uint32_t port, void *data) override;
+
     virtual void Run(uint32_t n_samples) override;
 
     virtual void Activate() override;
@@ -209,6 +213,8 @@ private:
     LowPassFilter midLowPass;
     HighPassFilter highPass;
     tremolo_plugin::SinLfo sinLfo;
+    RtTraceSource traceSource{"ToobTremolo"};
+    CpuLoadMeter cpuLoadMeter;
 };
 
 class ToobTremoloMono : public ToobTremolo
@@ -222,7 +228,7 @@ public:
                              const char *bundle_path,
                              const LV2_Feature *const *features)
     {
-        return new ToobTremolo(rate, bundle_path, features);
+        return new ToobTremoloMono(rate, bundle_path, features);
     }
     ToobTremoloMono(double rate,
                     const char *bundle_path,
@@ -240,6 +246,8 @@ public:
         outl = 5,
         control = 6,
         notify = 7,
+        cpuLoad = 8,
+        cpuPeak = 9,
     };
 
     virtual void ConnectPort(uint32_t port, void *data) override
@@ -270,6 +278,12 @@ public:
         case PortId::notify:
             notify.SetData(data);
             break;
+        case PortId::cpuLoad:
+            super::ConnectPort((uint32_t)ToobTremoloBase::PortId::cpuLoad, data);
+            break;
+        case PortId::cpuPeak:
+            super::ConnectPort((uint32_t)ToobTremoloBase::PortId::cpuPeak, data);
+            break;
         default:
             LogError("Invalid port id");
             break;
@@ -25,6 +25,7 @@
 //
 
 #include "ToobTuner.h"
+#include "LsNumerics/Denorms.hpp"
 
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
@@ -40,6 +41,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 using namespace std;
 using namespace toob;
@@ -53,7 +55,8 @@ using namespace LsNumerics;
 
 using namespace toob;
 
-static const int MAX_UPDATES_PER_SECOND = 15;
+static const int MAX_UPDATES_PER_SECOND = 30;
+static constexpr size_t DECIMATOR_CHUNK_SIZE = 1024;
 
 const char *ToobTuner::URI = TOOB_TUNER_URI;
 
@@ -77,18 +80,18 @@ ToobTuner::ToobTuner(double _rate,
 	uris.Map(this);
 	lv2_atom_forge_init(&forge, map);
 
-	subsampleRate = _rate;
-	while (subsampleRate > 48000/2)
-		subsampleRate /= 2;
+	// Decimate to 5.5kHz-6kHz. The pitch detector only needs the first few harmonics of notes below ~1kHz.
+	decimator.Prepare(_rate, 6000, 1200);
+	subsampleRate = decimator.GetOutputRate();
+	decimatorBuffer.resize(decimator.GetMaxOutputSize(DECIMATOR_CHUNK_SIZE));
 
 	this->tunerWorker.Initialize(getRate(), subsampleRate);
 	this->fftSize = this->tunerWorker.pitchDetector.getFftSize();
 	circularBuffer.SetSize(fftSize * 8);
 
-	this->lowpassFilter.Design(_rate, 0.1, 1200, -60, subsampleRate / 2);
-
 	this->updateFrameCount = (size_t)(rate / MAX_UPDATES_PER_SECOND);
 	this->updateFrameIndex = 0;
+	cpuLoadMeter.SetSampleRate(_rate);
 }
 
 ToobTuner::~ToobTuner()
@@ -124,6 +127,12 @@ void ToobTuner::ConnectPort(uint32_t port, void *data)
 	case PortId::NOTIFY_OUT:
 		this->notifyOut = (LV2_Atom_Sequence *)data;
 		break;
+	case PortId::CPU_LOAD:
+		this->cpuLoadMeter.SetLoadData(data);
+		break;
+	case PortId::CPU_PEAK:
+		this->cpuLoadMeter.SetPeakData(data);
+		break;
 	}
 }
 
@@ -131,14 +140,13 @@ void ToobTuner::Activate()
 {
 	requestState = RequestState::Idle;
 	frameTime = 0;
-	this->lowpassFilter.Reset();
+	this->decimator.Reset();
 	this->circularBuffer.Reset();
+	this->subsampleFrameTime = 0;
+	this->tunerWorker.Reset();
 
 	this->updateFrameIndex = 0;
 
-	this->subsampleIndex = 0;
-	this->subsampleCount = (int)(this->rate / this->subsampleRate);
-
 	this->muted = Mute.GetValue() != 0;
 	muteDezipper.To(this->muted ? 0 : 1, 0);
 }
@@ -148,6 +156,9 @@ void ToobTuner::Deactivate()
 
 void ToobTuner::Run(uint32_t n_samples)
 {
+	RtTraceScope traceScope(traceSource);
+	CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+	LsNumerics::AutoDenorm autoDenorm;
 	// prepare forge to write to notify output port.
 	// Set up forge to write directly to notify output port.
 	const uint32_t notify_capacity = this->notifyOut->atom.size;
@@ -166,7 +177,7 @@ void ToobTuner::Run(uint32_t n_samples)
 	if (updateFrameIndex <= 0 && requestState == RequestState::Idle )
 	{
 		requestState = RequestState::Requested;
-		this->tunerWorker.Request(circularBuffer,this->frameTime);
+		this->tunerWorker.Request(circularBuffer,this->frameTime,this->subsampleFrameTime);
 
 		// set time (in samples) to next request.
 		this->updateFrameIndex = this->updateFrameCount;
@@ -179,23 +190,22 @@ void ToobTuner::Run(uint32_t n_samples)
 			updateFrameIndex = 0;
 		}
 	}
-	int subsampleCount = this->subsampleCount;
-	int subsampleIndex = this->subsampleIndex;
-	;
+	for (uint32_t i = 0; i < n_samples; i += DECIMATOR_CHUNK_SIZE)
+	{
+		size_t n = std::min((size_t)(n_samples - i), DECIMATOR_CHUNK_SIZE);
+		size_t nOut = decimator.Process(input + i, n, decimatorBuffer.data());
+		for (size_t j = 0; j < nOut; ++j)
+		{
+			circularBuffer.Add(decimatorBuffer[j]);
+		}
+		subsampleFrameTime += nOut;
+	}
 
 	for (uint32_t i = 0; i < n_samples; ++i)
 	{
 		float v = input[i];
-		double subV = lowpassFilter.Tick(v);
-		if (++subsampleIndex == subsampleCount)
-		{
-			subsampleIndex = 0;
-			circularBuffer.Add((float)subV);
-		}
 		output[i] = (float)(v * muteDezipper.Tick());
 	}
-	this->subsampleCount = subsampleCount;
-	this->subsampleIndex = subsampleIndex;
 	frameTime += n_samples;
 
 	lv2_atom_forge_pop(&forge, &out_frame);
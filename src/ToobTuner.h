@@ -39,7 +39,7 @@
 #include "LsNumerics/PitchDetector.hpp"
 #include "LsNumerics/LsMath.hpp"
 #include <string>
-#include "Filters/ChebyshevDownsamplingFilter.h"
+#include "LsNumerics/Decimator.hpp"
 #include "ControlDezipper.h"
 #include "CircularBuffer.h"
 #include <iostream>
@@ -49,6 +49,8 @@
 #include "MidiProcessor.h"
 #include "InputPort.h"
 #include "OutputPort.h"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 #define TOOB_TUNER_URI "http://two-play.com/plugins/toob-tuner"
 #ifndef TOOB_URI
@@ -72,6 +74,8 @@ namespace toob
 			AUDIO_OUT,
 			CONTROL_IN,
 			NOTIFY_OUT,
+			CPU_LOAD,
+			CPU_PEAK,
 		};
 
 		double rate;
@@ -84,11 +88,11 @@ namespace toob
 		LV2_Atom_Sequence *notifyOut = NULL;
 		uint64_t frameTime = 0;
 
-		ChebyshevDownsamplingFilter lowpassFilter;
+		Decimator decimator;
+		std::vector<float> decimatorBuffer;
 		double subsampleRate;
 		size_t fftSize;
-		int subsampleCount;
-		int subsampleIndex;
+		uint64_t subsampleFrameTime = 0;
 		int updateFrameCount;
 		int updateFrameIndex;
 
@@ -229,6 +233,9 @@ namespace toob
 
 			PitchFilter pitchFilter;
 			std::vector<float> capturedData;
+			size_t hopSamples = 0;
+			uint64_t lastSubsampleFrame = 0;
+			bool hasLastSubsampleFrame = false;
 
 		public:
 			PitchDetector pitchDetector;
@@ -243,15 +250,23 @@ namespace toob
 			void Initialize(double sampleRate, double subSampleRate)
 			{
 				pitchFilter.Initialize(sampleRate);
-				constexpr size_t FFT_SIZE = 4096;
-				pitchDetector.Initialize((int)subSampleRate,FFT_SIZE);
+				pitchDetector.Initialize(subSampleRate);
 				capturedData.resize(pitchDetector.getFftSize());
 			}
 
-			void Request(const CircularBuffer<float>&circularBuffer, uint64_t currentFrame)
+			// Audio thread. Forget the previous frame, so that the next detection doesn't use stale phase data.
+			void Reset()
+			{
+				hasLastSubsampleFrame = false;
+			}
+
+			void Request(const CircularBuffer<float>&circularBuffer, uint64_t currentFrame, uint64_t currentSubsampleFrame)
 			{
 				circularBuffer.CopyTo(capturedData);
 				this->currentSampleFrame = currentFrame;
+				this->hopSamples = hasLastSubsampleFrame ? (size_t)(currentSubsampleFrame - lastSubsampleFrame) : 0;
+				this->lastSubsampleFrame = currentSubsampleFrame;
+				this->hasLastSubsampleFrame = true;
 				this->WorkerAction::Request();
 			}
 
@@ -269,11 +284,13 @@ namespace toob
 				}
 				if (aboveThreshold)
 				{
-					pitchResult = pitchDetector.detectPitch(this->capturedData.data());
+					// hops larger than half a frame skip refinement.
+					pitchResult = (float)pitchDetector.detectPitchIncremental(this->capturedData.data(), hopSamples);
 					// std::cout << "pitch: " << pitchResult << " " << FrequencyToNoteName(pitchResult) << std::endl;
 				}
 				else
 				{
+					pitchDetector.resetIncremental();
 					pitchResult = 0;
 				}
 
@@ -300,6 +317,8 @@ namespace toob
 
 		bool muted = false;
 		ControlDezipper muteDezipper{0};
+		RtTraceSource traceSource{"ToobTuner"};
+		CpuLoadMeter cpuLoadMeter;
 
 		void UpdateControls();
 
@@ -0,0 +1,164 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+/*
+    Displays the cache sizes detected on the current machine, and the processing and thread
+    parameters that ToobAmp plugins choose.
+
+    Usage: ToobTuningReport [-m max-log2-size] [-w wisdom-file]
+*/
+
+#include "LsNumerics/CacheInfo.hpp"
+#include "LsNumerics/StagedFft.hpp"
+#include "CommandLineParser.hpp"
+#include "ThreadManager.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+using namespace LsNumerics;
+using namespace toob;
+
+static std::string FormatSize(size_t size)
+{
+    if (size == 0)
+    {
+        return "none";
+    }
+    if (size >= 1024 * 1024 && size % (1024 * 1024) == 0)
+    {
+        return std::to_string(size / (1024 * 1024)) + "M";
+    }
+    if (size >= 1024 && size % 1024 == 0)
+    {
+        return std::to_string(size / 1024) + "K";
+    }
+    return std::to_string(size);
+}
+
+int main(int argc, const char **argv)
+{
+    try
+    {
+        int maxLog2Size = 17;
+        std::string wisdomFile;
+        bool help = false;
+
+        CommandLineParser commandLineParser;
+        commandLineParser.AddOption("m", "max-log2-size", &maxLog2Size);
+        commandLineParser.AddOption("w", "wisdom", &wisdomFile);
+        commandLineParser.AddOption("h", "help", &help);
+        commandLineParser.Parse(argc, argv);
+
+        if (help || commandLineParser.Arguments().size() != 0)
+        {
+            std::cout << "ToobTuningReport - Display processing parameters chosen for the current machine." << std::endl
+                      << "Syntax: ToobTuningReport [options]" << std::endl
+                      << "Options:" << std::endl
+                      << "  -m, --max-log2-size n   Report FFT plans up to 2^n (default 17)." << std::endl
+                      << "  -w, --wisdom file       FFT wisdom file (default " << StagedFftWisdom::DefaultPath().string() << ")." << std::endl
+                      << "  -h, --help              Display this message." << std::endl;
+            return help ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        if (maxLog2Size < 1 || maxLog2Size > (int)StagedFftWisdom::MAX_LOG2_SIZE)
+        {
+            throw std::runtime_error("Invalid value for --max-log2-size.");
+        }
+
+        const CacheInfo::CacheSizes &cacheSizes = CacheInfo::GetCacheSizes();
+        std::cout << "Caches (" << (cacheSizes.detected ? "detected" : "not detected; using defaults") << ")" << std::endl;
+        std::cout << "    L1 data:    " << FormatSize(cacheSizes.l1DataSize) << std::endl;
+        std::cout << "    L2:         " << FormatSize(cacheSizes.l2Size) << std::endl;
+        std::cout << "    L3:         " << FormatSize(cacheSizes.l3Size) << std::endl;
+        std::cout << "    Line size:  " << cacheSizes.lineSize << std::endl;
+        std::cout << std::endl;
+
+        std::filesystem::path wisdomPath = wisdomFile.empty() ? StagedFftWisdom::DefaultPath() : std::filesystem::path(wisdomFile);
+        bool hasWisdom = false;
+        if (!wisdomPath.empty() && std::filesystem::exists(wisdomPath))
+        {
+            StagedFftWisdom::Load(wisdomPath);
+            hasWisdom = true;
+        }
+        else if (!wisdomFile.empty())
+        {
+            throw std::runtime_error("File not found: " + wisdomFile);
+        }
+
+        using StagedFftPlan = Implementation::StagedFftPlan;
+        std::cout << "StagedFft" << std::endl;
+        std::cout << "    L1 block size: " << StagedFftPlan::L1BlockSize() << std::endl;
+        std::cout << "    L2 block size: " << StagedFftPlan::L2BlockSize() << std::endl;
+        std::cout << "    Wisdom:        " << (hasWisdom ? wisdomPath.string() : std::string("none")) << std::endl;
+        for (size_t log2Size = 1; log2Size <= (size_t)maxLog2Size; ++log2Size)
+        {
+            std::optional<StagedFftWisdom::PlanChoice> wisdomChoice = StagedFftWisdom::GetPlanChoice(log2Size);
+            StagedFftWisdom::PlanChoice choice = wisdomChoice ? *wisdomChoice : StagedFftPlan::DefaultPlanChoice(log2Size);
+            std::cout << "    " << std::setw(8) << ((size_t)1 << log2Size)
+                      << ": " << StagedFftPlan::ToString(choice)
+                      << (wisdomChoice ? " (wisdom)" : "") << std::endl;
+        }
+        std::cout << std::endl;
+
+        std::cout << "NeuralAmpModeler processing block size" << std::endl;
+        for (size_t bufferSize = 64; bufferSize <= 8192; bufferSize *= 2)
+        {
+            std::cout << "    buffer " << std::setw(4) << bufferSize << ": " << CacheInfo::NamProcessingBlockSize(bufferSize) << std::endl;
+        }
+        std::cout << std::endl;
+
+        ThreadManager &threadManager = ThreadManager::Get();
+        std::filesystem::path threadConfigPath = ThreadManager::DefaultConfigPath();
+        std::error_code ec;
+        auto formatCpus = [](const std::vector<int> &cpus) {
+            return cpus.empty() ? std::string("any") : ThreadManager::FormatCpuList(cpus);
+        };
+        std::cout << "Threads (" << (std::filesystem::exists(threadConfigPath, ec) ? threadConfigPath.string() : std::string("default policy")) << ")" << std::endl;
+        std::cout << "    Audio thread priority: " << threadManager.GetAudioPriority()
+                  << (threadManager.GetPolicy().audioPriority == 0 ? " (detected at run time; default shown)" : "") << std::endl;
+        std::cout << "    Audio thread CPUs:     " << formatCpus(threadManager.GetAudioCpus()) << std::endl;
+        auto printThread = [&](ThreadRole role, int threadNumber) {
+            std::string name = "toob_" + ThreadManager::GetThreadName(role, threadNumber);
+            std::cout << "    " << std::left << std::setw(16) << name << std::right
+                      << (ThreadManager::IsRealtime(role) ? "SCHED_RR " : "nice     ")
+                      << std::setw(3) << threadManager.GetPriority(role, threadNumber)
+                      << "  CPUs: " << formatCpus(threadManager.GetCpus(role)) << std::endl;
+        };
+        printThread(ThreadRole::NamBackground, 0);
+        printThread(ThreadRole::ConvolutionAssembly, 0);
+        for (int threadNumber = 1; threadNumber <= 6; ++threadNumber)
+        {
+            printThread(ThreadRole::ConvolutionSection, threadNumber);
+        }
+        printThread(ThreadRole::PlayerBackground, 0);
+        printThread(ThreadRole::LooperBackground, 0);
+        printThread(ThreadRole::MetadataIndexer, 0);
+        printThread(ThreadRole::TraceWriter, 0);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "ToobVolume.hpp"
+#include "LsNumerics/Denorms.hpp"
 
 ToobVolume::ToobVolume(double rate,
                  const char *bundle_path,
@@ -25,6 +26,7 @@ ToobVolume::ToobVolume(double rate,
     : ToobVolumeBase(rate,bundle_path,features)
 {
     dezipVol.SetSampleRate(rate);
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 ToobVolume::~ToobVolume()
@@ -46,7 +48,26 @@ void ToobVolume::Mix(uint32_t n_samples)
     }
 }
 
+void ToobVolume::ConnectPort(uint32_t port, void *data)
+{
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobVolume::Run(uint32_t n_samples) {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     Mix(n_samples);
 }
 
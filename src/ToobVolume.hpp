@@ -26,6 +26,8 @@
 #include <memory>
 #include "ToobVolumeInfo.hpp"
 #include "ControlDezipper.h"
+#include "RtTrace.hpp"
+#include "CpuLoadMeter.hpp"
 
 using namespace lv2c::lv2_plugin;
 using namespace volume_plugin;
@@ -55,11 +57,15 @@ protected:
 
 	virtual void Mix(uint32_t n_samples);
 
+	virtual void ConnectPort(uint32_t port, void *data) override;
+
 	virtual void Run(uint32_t n_samples) override;
 
 	virtual void Activate() override;
 	virtual void Deactivate() override;
 private:
 	ControlDezipper dezipVol;
+	RtTraceSource traceSource{"ToobVolume"};
+	CpuLoadMeter cpuLoadMeter;
 };
 
@@ -55,6 +55,26 @@ inline double Atan(double value)
         return AtanApprox(value);
     }
 }
+
+// Branch-free float version of Atan(), for loops that need to vectorize.
+inline float AtanBranchFree(float value)
+{
+    bool large = std::abs(value) > 1.0f;
+    // 1/value when |value| > 1, value otherwise, without dividing by zero.
+    float x = (large ? 1.0f : value) / (large ? value : 1.0f);
+    float x2 = x*x;
+    float y = ((((((((0.00286623f*x2-0.0161657f)
+                *x2+0.0429096f)
+                *x2-0.0752896f)
+                *x2+0.106563f)
+                *x2-0.142089f)
+                *x2+0.199936f)
+                *x2-0.333331f)
+                *x2+1)*x;
+    float offset = value > 0 ? (float)(M_PI/2) : (float)(-M_PI/2);
+    return large ? offset - y : y;
+}
+
 inline double AsymmetricAtan(double value)
 {
     return Atan(value-0.5);
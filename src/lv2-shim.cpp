@@ -24,6 +24,10 @@ SOFTWARE.
 
 /*
     dynamically links to either toob ToobAmp-a72.so or ToobAmp-a76.so depending on which architecture we're using.
+
+    Hot DSP kernels in both builds are also multi-versioned at runtime (see LsNumerics/CpuFeatures.hpp),
+    so the a76 build mostly buys the Eigen matrix code in the NAM plugin, whose vectorization is fixed at
+    compile time.
 */
 
 #include <cstdint>
@@ -35,41 +39,17 @@ SOFTWARE.
 #include <vector>
 #include <string>
 #include "lv2/core/lv2.h"
+#include "LsNumerics/CpuFeatures.hpp"
 #include <dlfcn.h>
 #include <memory.h>
 
 
-// a list of known arm8.1a processors.
-static std::vector<std::string> arm82aProcessorIds  = {
-    "0xd0a", // a75
-    "0xd0b", // a76
-    "0xd0e", // a76AE
-    "0xd0d", // a77
-    "0xd41", // a78
-    "0xd4a", // neoverse-e1
-    "0xd0c", // Neoverse-n1
-    "0xd40", // Neoverse-V1 (8.4)
-};
-
+// ToobAmp-a76.so is compiled for ARMv8.2-a (dot-product and fp16 arithmetic). Check for
+// the extensions directly, rather than matching a list of known CPU part numbers, so that
+// newer cores pick up the faster build as well.
 static bool isA76OrBetter()
 {
-    std::ifstream cpuinfo("/proc/cpuinfo");
-    std::string line;
-    
-    while (std::getline(cpuinfo, line))
-    {
-        if (line.find("CPU part") != std::string::npos)
-        {
-            for (const auto &processor : arm82aProcessorIds)
-            {
-                if (line.find(processor) != std::string::npos)
-                {
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
+    return LsNumerics::CpuFeatures::Get().IsArmV82OrBetter();
 }
 
 typedef const LV2_Descriptor *
@@ -22,6 +22,20 @@ namespace toob {
         int minBlockSize, 
         int maxBlockSize);
 
+    // Process in blocks of at most blockSize frames, so that a model's working set stays in cache
+    // when the host uses large buffers.
+    inline void ProcessInBlocks(ToobNamDsp *dsp, float *input, float *output, size_t numFrames, size_t blockSize)
+    {
+        while (numFrames != 0)
+        {
+            size_t n = numFrames < blockSize ? numFrames : blockSize;
+            dsp->Process(input, output, n);
+            input += n;
+            output += n;
+            numFrames -= n;
+        }
+    }
+
 };
 
 
@@ -125,11 +125,29 @@ namespace toob
         float *GetChannel(size_t channel) { return data_[channel].data(); }
         const float *GetChannel(size_t channel) const { return data_[channel].data(); }
 
+        // Position in the source file of a frame in this buffer. sourceRate is source frames
+        // per buffer frame (not 1.0 when playback is time-stretched).
+        void SetSourcePosition(size_t sourcePosition, double sourceRate = 1.0)
+        {
+            sourcePosition_ = sourcePosition;
+            sourceRate_ = sourceRate;
+        }
+        size_t GetSourcePosition(size_t index) const
+        {
+            if (sourceRate_ == 1.0)
+            {
+                return sourcePosition_ + index;
+            }
+            return sourcePosition_ + (size_t)(index * sourceRate_);
+        }
+
     private:
         friend class AudioFileBufferPool;
         AudioFileBuffer* next = nullptr;
         std::atomic<uint64_t> refCount;
         size_t bufferSize_;
+        size_t sourcePosition_ = 0;
+        double sourceRate_ = 1.0;
         std::vector<std::vector<float>> data_;
     };
 
@@ -0,0 +1,134 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "AudioFileLoopRegion.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace toob;
+
+void AudioFileLoopRegion::Init(int channels, size_t loopEnd_0, size_t loopEnd_1, size_t loopSize, size_t maxFrames)
+{
+    if (loopEnd_1 < loopEnd_0 || loopSize < loopEnd_1 - loopEnd_0 || loopEnd_0 < loopSize)
+    {
+        throw std::logic_error("Invalid loop region.");
+    }
+    this->channels = channels;
+    this->loopEnd_0 = loopEnd_0;
+    this->loopEnd_1 = loopEnd_1;
+    this->blendLength = loopEnd_1 - loopEnd_0;
+    this->regionStart = loopEnd_0 - loopSize;
+    this->regionLength = std::min(blendLength + loopSize, std::max(maxFrames, blendLength));
+    this->cachedFrames = 0;
+
+    // storage is allocated by Write() as frames are captured.
+    dataL.clear();
+    dataR.clear();
+}
+
+void AudioFileLoopRegion::Clear()
+{
+    channels = 0;
+    regionStart = regionLength = blendLength = 0;
+    loopEnd_0 = loopEnd_1 = 0;
+    cachedFrames = 0;
+    dataL = std::vector<float>();
+    dataR = std::vector<float>();
+}
+
+void AudioFileLoopRegion::Write(size_t position, float *const *data, size_t frames)
+{
+    if (regionLength == 0 || frames == 0)
+    {
+        return;
+    }
+
+    // bake the loop-end crossfade, if the fade-in material has been captured.
+    size_t blendStart = std::max(position, loopEnd_0);
+    size_t blendEnd = std::min(position + frames, loopEnd_1);
+    if (blendStart < blendEnd && cachedFrames >= blendLength)
+    {
+        float dt = 1.0f / (float)blendLength;
+        for (int c = 0; c < std::min(channels, 2); ++c)
+        {
+            float *dst = data[c];
+            if (!dst)
+            {
+                continue;
+            }
+            const std::vector<float> &fadeIn = (c == 0 ? dataL : dataR);
+            for (size_t i = blendStart; i < blendEnd; ++i)
+            {
+                size_t blendOffset = i - loopEnd_0;
+                float t = (float)blendOffset * dt;
+                float &v = dst[i - position];
+                v = v * (1.0f - t) + fadeIn[blendOffset] * t;
+            }
+        }
+    }
+
+    // extend the captured region.
+    size_t cachedEnd = GetCachedEnd();
+    if (position <= cachedEnd && position + frames > cachedEnd && cachedFrames < regionLength)
+    {
+        size_t offset = cachedEnd - position;
+        size_t n = std::min(frames - offset, regionLength - cachedFrames);
+        if (dataL.size() < cachedFrames + n)
+        {
+            // grow geometrically, so that capturing a long loop doesn't copy it repeatedly.
+            size_t size = std::min(regionLength, std::max(cachedFrames + n, dataL.size() * 2));
+            dataL.resize(size);
+            if (channels >= 2)
+            {
+                dataR.resize(size);
+            }
+        }
+        std::memcpy(dataL.data() + cachedFrames, data[0] + offset, n * sizeof(float));
+        if (!dataR.empty())
+        {
+            const float *src = data[1] ? data[1] : data[0];
+            std::memcpy(dataR.data() + cachedFrames, src + offset, n * sizeof(float));
+        }
+        cachedFrames += n;
+    }
+}
+
+size_t AudioFileLoopRegion::Read(size_t position, float *const *data, size_t frames) const
+{
+    size_t cachedEnd = GetCachedEnd();
+    if (position < regionStart || position >= cachedEnd)
+    {
+        return 0;
+    }
+    size_t n = std::min(frames, cachedEnd - position);
+    size_t offset = position - regionStart;
+    std::memcpy(data[0], dataL.data() + offset, n * sizeof(float));
+    if (data[1])
+    {
+        const float *src = dataR.empty() ? dataL.data() : dataR.data();
+        std::memcpy(data[1], src + offset, n * sizeof(float));
+    }
+    return n;
+}
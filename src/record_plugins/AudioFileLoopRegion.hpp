@@ -0,0 +1,79 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace toob
+{
+
+    // Decoded audio for a streamed loop, with the loop-point crossfade baked in.
+    //
+    // The region covers source frames [loopEnd_0 - loopSize, loopEnd_1). The first
+    // (loopEnd_1 - loopEnd_0) frames are the material that fades in at the loop point; the
+    // remaining loopSize frames are the loop itself, starting at GetRingStart(). Frames in
+    // [loopEnd_0, loopEnd_1) are crossfaded with the fade-in material as they are written, so
+    // playing to GetLoopEnd() and continuing from GetRingStart() is seamless.
+    //
+    // Frames are captured as the stream decodes them, so each loop is decoded once, and storage
+    // grows as frames are captured. Capture is contiguous from GetRegionStart(): a stream that
+    // starts inside the loop needs only the fade-in material up front, and captures the rest of
+    // the loop on its next pass. Loops longer than maxFrames keep only their first maxFrames
+    // frames; the rest must be streamed again on each pass.
+    class AudioFileLoopRegion
+    {
+    public:
+        void Init(int channels, size_t loopEnd_0, size_t loopEnd_1, size_t loopSize, size_t maxFrames);
+        void Clear();
+
+        size_t GetRegionStart() const { return regionStart; }
+        size_t GetRingStart() const { return regionStart + blendLength; }
+        size_t GetLoopEnd() const { return loopEnd_1; }
+        size_t GetLoopSize() const { return loopEnd_1 - GetRingStart(); }
+
+        // Source position up to which frames have been captured.
+        size_t GetCachedEnd() const { return regionStart + cachedFrames; }
+        bool IsComplete() const { return regionLength != 0 && GetCachedEnd() == loopEnd_1; }
+
+        // Capture decoded frames starting at source frame `position`, and apply the loop-end
+        // crossfade to them in place. Frames that don't extend the captured region are not cached.
+        void Write(size_t position, float *const *data, size_t frames);
+
+        // Copy captured frames starting at `position`. Returns the number of frames copied.
+        size_t Read(size_t position, float *const *data, size_t frames) const;
+
+    private:
+        int channels = 0;
+        size_t regionStart = 0;
+        size_t regionLength = 0;
+        size_t blendLength = 0;
+        size_t loopEnd_0 = 0;
+        size_t loopEnd_1 = 0;
+        size_t cachedFrames = 0;
+        std::vector<float> dataL;
+        std::vector<float> dataR;
+    };
+}
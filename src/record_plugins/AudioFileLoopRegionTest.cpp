@@ -0,0 +1,141 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "AudioFileLoopRegion.hpp"
+#include "../TestAssert.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace toob;
+using namespace std;
+
+static float Source(size_t position, int channel)
+{
+    return (float)std::sin(position * 0.01 + channel);
+}
+
+// Expected output: the file, wrapping from loopEnd_1 back by loopSize, crossfaded into the
+// frames preceding the wrap target over [loopEnd_0, loopEnd_1).
+static float Expected(size_t position, int channel, size_t loopEnd_0, size_t loopEnd_1, size_t loopSize)
+{
+    while (position >= loopEnd_1)
+    {
+        position -= loopSize;
+    }
+    if (position < loopEnd_0)
+    {
+        return Source(position, channel);
+    }
+    float t = (float)(position - loopEnd_0) / (float)(loopEnd_1 - loopEnd_0);
+    return Source(position, channel) * (1 - t) + Source(position - loopSize, channel) * t;
+}
+
+// Simulates the streaming reader: decode from the "file" until the region is cached, then play from the cache.
+static void TestLoopRegion(size_t start, size_t loopEnd_0, size_t loopEnd_1, size_t loopSize, size_t maxFrames)
+{
+    cout << "TestLoopRegion " << start << " " << loopEnd_0 << " " << loopEnd_1 << " " << loopSize << " " << maxFrames << endl;
+
+    constexpr size_t BLOCK_SIZE = 1000;
+    AudioFileLoopRegion region;
+    region.Init(2, loopEnd_0, loopEnd_1, loopSize, maxFrames);
+
+    TEST_ASSERT(region.GetRingStart() == loopEnd_1 - loopSize);
+    TEST_ASSERT(region.GetLoopSize() == loopSize);
+
+    vector<float> left(BLOCK_SIZE), right(BLOCK_SIZE);
+    float *buffers[2] = {left.data(), right.data()};
+
+    if (start > region.GetRegionStart())
+    {
+        // Starting inside the loop: the reader captures the fade-in material up front.
+        size_t fillEnd = std::min(start, region.GetRingStart());
+        for (size_t position = region.GetRegionStart(); position < fillEnd; position += BLOCK_SIZE)
+        {
+            size_t n = std::min(BLOCK_SIZE, fillEnd - position);
+            for (size_t i = 0; i < n; ++i)
+            {
+                left[i] = Source(position + i, 0);
+                right[i] = Source(position + i, 1);
+            }
+            region.Write(position, buffers, n);
+        }
+    }
+
+    size_t readPos = start;
+    size_t outputPos = start;
+    size_t testLength = start + loopSize * 4;
+    while (outputPos < testLength)
+    {
+        if (readPos >= region.GetLoopEnd())
+        {
+            readPos -= region.GetLoopSize();
+        }
+        size_t n = std::min(BLOCK_SIZE, region.GetLoopEnd() - readPos);
+        size_t nRead = region.Read(readPos, buffers, n);
+        if (nRead == 0)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                left[i] = Source(readPos + i, 0);
+                right[i] = Source(readPos + i, 1);
+            }
+            region.Write(readPos, buffers, n);
+            nRead = n;
+        }
+        for (size_t i = 0; i < nRead; ++i)
+        {
+            TEST_ASSERT(std::abs(left[i] - Expected(outputPos + i, 0, loopEnd_0, loopEnd_1, loopSize)) < 1E-5f);
+            TEST_ASSERT(std::abs(right[i] - Expected(outputPos + i, 1, loopEnd_0, loopEnd_1, loopSize)) < 1E-5f);
+        }
+        readPos += nRead;
+        outputPos += nRead;
+    }
+    TEST_ASSERT(region.IsComplete() == (loopSize + loopEnd_1 - loopEnd_0 <= maxFrames));
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        // blend before the loop end.
+        TestLoopRegion(0, 95000, 100000, 80000, 1000000);
+        // blend after the loop end.
+        TestLoopRegion(3000, 100000, 105000, 80000, 1000000);
+        // no blend.
+        TestLoopRegion(1500, 100000, 100000, 80000, 1000000);
+        // starting inside the loop, in the fade-in material, and past it.
+        TestLoopRegion(17000, 95000, 100000, 80000, 1000000);
+        TestLoopRegion(40000, 95000, 100000, 80000, 1000000);
+        // too long to cache in full.
+        TestLoopRegion(0, 95000, 100000, 80000, 30000);
+    }
+    catch (const std::exception &e)
+    {
+        cerr << "ERROR: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,464 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "AudioFileMetadataIndex.hpp"
+#include "../util.hpp"
+#include "../ThreadManager.hpp"
+#include "../ss.hpp"
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+using namespace toob;
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr char INDEX_FILE_MAGIC[4] = {'T', 'M', 'D', 'X'};
+    constexpr uint32_t INDEX_FILE_VERSION = 1;
+
+    const std::set<std::string> AUDIO_EXTENSIONS = {
+        ".mp3", ".mp4", ".m4a", ".flac", ".wav", ".ogg", ".opus", ".aac", ".aif", ".aiff", ".wv"};
+
+    template <typename T>
+    void WriteValue(std::ostream &s, const T &value)
+    {
+        s.write((const char *)&value, sizeof(T));
+    }
+    template <typename T>
+    T ReadValue(std::istream &s)
+    {
+        T value;
+        s.read((char *)&value, sizeof(T));
+        if (!s)
+        {
+            throw std::runtime_error("Unexpected end of file.");
+        }
+        return value;
+    }
+    void WriteString(std::ostream &s, const std::string &value)
+    {
+        WriteValue<uint32_t>(s, (uint32_t)value.length());
+        s.write(value.c_str(), value.length());
+    }
+    std::string ReadString(std::istream &s)
+    {
+        uint32_t length = ReadValue<uint32_t>(s);
+        if (length > 64 * 1024)
+        {
+            throw std::runtime_error("Invalid index file.");
+        }
+        std::string result(length, '\0');
+        s.read(result.data(), length);
+        if (!s)
+        {
+            throw std::runtime_error("Unexpected end of file.");
+        }
+        return result;
+    }
+}
+
+AudioFileMetadataIndex &AudioFileMetadataIndex::Instance()
+{
+    static AudioFileMetadataIndex instance{
+        GetUserCacheDirectory().empty() ? fs::path() : GetUserCacheDirectory() / "metadata.index"};
+    return instance;
+}
+
+AudioFileMetadataIndex::AudioFileMetadataIndex(const fs::path &indexFile)
+    : indexFile(indexFile)
+{
+    Load();
+}
+
+AudioFileMetadataIndex::~AudioFileMetadataIndex()
+{
+    if (scanThread)
+    {
+        scanThread->request_stop();
+        scanThread->join();
+        scanThread.reset();
+    }
+    try
+    {
+        Flush();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Warning: " << e.what() << std::endl;
+    }
+}
+
+bool AudioFileMetadataIndex::IsAudioFile(const fs::path &path)
+{
+    std::string extension = path.extension().string();
+    for (char &c : extension)
+    {
+        c = (char)std::tolower((unsigned char)c);
+    }
+    return AUDIO_EXTENSIONS.contains(extension);
+}
+
+bool AudioFileMetadataIndex::GetFileKey(const fs::path &file, uint64_t *fileSize, int64_t *lastWrite)
+{
+    std::error_code ec;
+    auto size = fs::file_size(file, ec);
+    if (ec)
+    {
+        return false;
+    }
+    auto time = fs::last_write_time(file, ec);
+    if (ec)
+    {
+        return false;
+    }
+    *fileSize = (uint64_t)size;
+    *lastWrite = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    return true;
+}
+
+bool AudioFileMetadataIndex::TryGet(const fs::path &file, AudioFileMetadata *result)
+{
+    uint64_t fileSize;
+    int64_t lastWrite;
+    if (!GetFileKey(file, &fileSize, &lastWrite))
+    {
+        return false;
+    }
+    std::lock_guard lock{mutex};
+    auto it = entries.find(file.string());
+    if (it == entries.end() || it->second.fileSize != fileSize || it->second.lastWrite != lastWrite)
+    {
+        return false;
+    }
+    *result = it->second.metadata;
+    return true;
+}
+
+AudioFileMetadata AudioFileMetadataIndex::Get(const fs::path &file)
+{
+    AudioFileMetadata result;
+    if (TryGet(file, &result))
+    {
+        return result;
+    }
+    result = AudioFileMetadata(file);
+    Put(file, result);
+    return result;
+}
+
+void AudioFileMetadataIndex::Put(const fs::path &file, const AudioFileMetadata &metadata)
+{
+    Entry entry;
+    if (!GetFileKey(file, &entry.fileSize, &entry.lastWrite))
+    {
+        return;
+    }
+    entry.metadata = metadata;
+    {
+        std::lock_guard lock{mutex};
+        entries[file.string()] = std::move(entry);
+        ++unsavedChanges;
+    }
+    // let the scan thread write the change.
+    StartScanThread();
+    scanCv.notify_all();
+}
+
+void AudioFileMetadataIndex::ScanDirectory(const fs::path &directory)
+{
+    {
+        std::lock_guard lock{mutex};
+        for (const auto &queued : scanQueue)
+        {
+            if (queued == directory)
+            {
+                return;
+            }
+        }
+        scanQueue.push_back(directory);
+    }
+    StartScanThread();
+    scanCv.notify_all();
+}
+
+void AudioFileMetadataIndex::WaitForScans()
+{
+    std::unique_lock lock{mutex};
+    while (!scanQueue.empty() || scanning)
+    {
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        lock.lock();
+    }
+}
+
+void AudioFileMetadataIndex::StartScanThread()
+{
+    std::lock_guard lock{mutex};
+    if (!scanThread)
+    {
+        scanThread = std::make_unique<std::jthread>(
+            [this](std::stop_token stopToken)
+            {
+                ScanThreadProc(stopToken);
+            });
+    }
+}
+
+void AudioFileMetadataIndex::ScanThreadProc(std::stop_token stopToken)
+{
+    ThreadManager::Get().ConfigureCurrentThread(ThreadRole::MetadataIndexer);
+
+    while (!stopToken.stop_requested())
+    {
+        fs::path directory;
+        {
+            std::unique_lock lock{mutex};
+            // wake on new work; otherwise write outstanding changes every few seconds.
+            scanCv.wait_for(lock, stopToken, std::chrono::seconds(5),
+                            [this]()
+                            { return !scanQueue.empty(); });
+            if (stopToken.stop_requested())
+            {
+                break;
+            }
+            if (scanQueue.empty())
+            {
+                if (unsavedChanges == 0)
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                directory = scanQueue.front();
+                scanQueue.pop_front();
+                scanning = true;
+            }
+        }
+        try
+        {
+            if (!directory.empty())
+            {
+                ScanDirectoryNow(directory, stopToken);
+            }
+            Flush();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Warning: Metadata scan failed. " << e.what() << std::endl;
+        }
+        {
+            std::lock_guard lock{mutex};
+            scanning = false;
+        }
+    }
+}
+
+void AudioFileMetadataIndex::ScanDirectoryNow(const fs::path &directory, std::stop_token &stopToken)
+{
+    std::error_code ec;
+    fs::directory_iterator it{directory, fs::directory_options::skip_permission_denied, ec};
+    if (ec)
+    {
+        return;
+    }
+    std::set<std::string> present;
+    for (const auto &dirEntry : it)
+    {
+        if (stopToken.stop_requested())
+        {
+            return;
+        }
+        if (!dirEntry.is_regular_file(ec) || !IsAudioFile(dirEntry.path()))
+        {
+            continue;
+        }
+        present.insert(dirEntry.path().string());
+
+        AudioFileMetadata metadata;
+        if (TryGet(dirEntry.path(), &metadata))
+        {
+            continue;
+        }
+        try
+        {
+            Put(dirEntry.path(), AudioFileMetadata(dirEntry.path()));
+        }
+        catch (const std::exception &)
+        {
+            // not a file that ffprobe understands. Skip it.
+            continue;
+        }
+        bool saveNow;
+        {
+            std::lock_guard lock{mutex};
+            saveNow = unsavedChanges >= SAVE_INTERVAL;
+        }
+        if (saveNow)
+        {
+            Flush();
+        }
+    }
+
+    // drop entries for files that have been deleted from the directory.
+    std::lock_guard lock{mutex};
+    for (auto i = entries.begin(); i != entries.end(); /**/)
+    {
+        fs::path path{i->first};
+        if (path.parent_path() == directory && !present.contains(i->first))
+        {
+            i = entries.erase(i);
+            ++unsavedChanges;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void AudioFileMetadataIndex::Flush()
+{
+    std::lock_guard saveLock{saveMutex};
+    {
+        std::lock_guard lock{mutex};
+        if (unsavedChanges == 0)
+        {
+            return;
+        }
+    }
+    Save();
+}
+
+void AudioFileMetadataIndex::Load()
+{
+    if (indexFile.empty() || !fs::exists(indexFile))
+    {
+        return;
+    }
+    try
+    {
+        std::ifstream f(indexFile, std::ios_base::binary);
+        char magic[sizeof(INDEX_FILE_MAGIC)];
+        f.read(magic, sizeof(magic));
+        if (!f || memcmp(magic, INDEX_FILE_MAGIC, sizeof(magic)) != 0)
+        {
+            return;
+        }
+        if (ReadValue<uint32_t>(f) != INDEX_FILE_VERSION)
+        {
+            return;
+        }
+        uint32_t count = ReadValue<uint32_t>(f);
+        std::unordered_map<std::string, Entry> newEntries;
+        newEntries.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            std::string path = ReadString(f);
+            Entry entry;
+            entry.fileSize = ReadValue<uint64_t>(f);
+            entry.lastWrite = ReadValue<int64_t>(f);
+            AudioFileMetadata &md = entry.metadata;
+            md.path = path;
+            md.duration = ReadValue<double>(f);
+            md.artist = ReadString(f);
+            md.album_artist = ReadString(f);
+            md.title = ReadString(f);
+            md.album = ReadString(f);
+            md.date = ReadString(f);
+            md.year = ReadString(f);
+            md.track = ReadString(f);
+            md.disc = ReadString(f);
+            md.totalTracks = ReadString(f);
+            newEntries[path] = std::move(entry);
+        }
+        std::lock_guard lock{mutex};
+        entries = std::move(newEntries);
+        unsavedChanges = 0;
+    }
+    catch (const std::exception &e)
+    {
+        // a damaged index is rebuilt from scratch.
+        std::cerr << "Warning: Ignoring invalid metadata index " << indexFile << ". " << e.what() << std::endl;
+    }
+}
+
+void AudioFileMetadataIndex::Save()
+{
+    if (indexFile.empty())
+    {
+        return;
+    }
+    // serialize under the lock; write without it.
+    std::stringstream f;
+    {
+        std::lock_guard lock{mutex};
+        f.write(INDEX_FILE_MAGIC, sizeof(INDEX_FILE_MAGIC));
+        WriteValue<uint32_t>(f, INDEX_FILE_VERSION);
+        WriteValue<uint32_t>(f, (uint32_t)entries.size());
+        for (const auto &[path, entry] : entries)
+        {
+            const AudioFileMetadata &md = entry.metadata;
+            WriteString(f, path);
+            WriteValue<uint64_t>(f, entry.fileSize);
+            WriteValue<int64_t>(f, entry.lastWrite);
+            WriteValue<double>(f, md.duration);
+            WriteString(f, md.artist);
+            WriteString(f, md.album_artist);
+            WriteString(f, md.title);
+            WriteString(f, md.album);
+            WriteString(f, md.date);
+            WriteString(f, md.year);
+            WriteString(f, md.track);
+            WriteString(f, md.disc);
+            WriteString(f, md.totalTracks);
+        }
+        unsavedChanges = 0;
+    }
+
+    fs::create_directories(indexFile.parent_path());
+
+    // write-then-rename so that concurrent readers never see a partial file.
+    fs::path tempPath = indexFile;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios_base::binary | std::ios_base::trunc);
+        out << f.rdbuf();
+        out.close();
+        if (!out)
+        {
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            throw std::runtime_error(SS("Can't write to " << tempPath));
+        }
+    }
+    fs::rename(tempPath, indexFile);
+}
@@ -0,0 +1,105 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "FfmpegDecoderStream.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace toob
+{
+
+    // Persistent index of AudioFileMetadata, keyed on path, size and modification time.
+    //
+    // The index is a flat binary file in the user cache directory, loaded once and served
+    // from memory. A background thread probes files in directories queued with ScanDirectory(),
+    // and writes the index back to disk as entries are added, so that opening a directory
+    // of several thousand tracks doesn't require one ffprobe per track.
+    class AudioFileMetadataIndex
+    {
+    public:
+        AudioFileMetadataIndex(const std::filesystem::path &indexFile);
+        ~AudioFileMetadataIndex();
+
+        static AudioFileMetadataIndex &Instance();
+
+        // Returns false if there is no up-to-date entry for the file.
+        bool TryGet(const std::filesystem::path &file, AudioFileMetadata *result);
+
+        // Probes the file (and updates the index) if there is no up-to-date entry.
+        AudioFileMetadata Get(const std::filesystem::path &file);
+
+        void Put(const std::filesystem::path &file, const AudioFileMetadata &metadata);
+
+        // Asynchronously refresh entries for all audio files in a directory (non-recursive),
+        // and drop entries for files that no longer exist.
+        void ScanDirectory(const std::filesystem::path &directory);
+
+        // Wait until queued directory scans have completed.
+        void WaitForScans();
+
+        // Write pending changes to disk.
+        void Flush();
+
+        static bool IsAudioFile(const std::filesystem::path &path);
+
+    private:
+        struct Entry
+        {
+            uint64_t fileSize = 0;
+            int64_t lastWrite = 0;
+            AudioFileMetadata metadata;
+        };
+        static bool GetFileKey(const std::filesystem::path &file, uint64_t *fileSize, int64_t *lastWrite);
+
+        void Load();
+        void Save();
+        void StartScanThread();
+        void ScanThreadProc(std::stop_token stopToken);
+        void ScanDirectoryNow(const std::filesystem::path &directory, std::stop_token &stopToken);
+
+        static constexpr size_t SAVE_INTERVAL = 64; // entries added between intermediate saves.
+
+        std::filesystem::path indexFile;
+
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+        size_t unsavedChanges = 0;
+
+        std::mutex saveMutex;
+
+        std::condition_variable_any scanCv;
+        std::deque<std::filesystem::path> scanQueue;
+        bool scanning = false;
+        std::unique_ptr<std::jthread> scanThread;
+    };
+}
@@ -0,0 +1,155 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "AudioFileMetadataIndex.hpp"
+#include "../TestAssert.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using namespace toob;
+using namespace std;
+namespace fs = std::filesystem;
+
+static void WriteWav(const fs::path &path, double seconds)
+{
+    // 16-bit mono PCM.
+    constexpr uint32_t SAMPLE_RATE = 8000;
+    uint32_t frames = (uint32_t)std::round(seconds * SAMPLE_RATE);
+    vector<int16_t> data(frames);
+    for (uint32_t i = 0; i < frames; ++i)
+    {
+        data[i] = (int16_t)(8000 * std::sin(i * 0.1));
+    }
+    uint32_t dataSize = frames * sizeof(int16_t);
+
+    std::ofstream f(path, std::ios_base::binary | std::ios_base::trunc);
+    auto write32 = [&f](uint32_t v)
+    { f.write((const char *)&v, sizeof(v)); };
+    auto write16 = [&f](uint16_t v)
+    { f.write((const char *)&v, sizeof(v)); };
+    f.write("RIFF", 4);
+    write32(36 + dataSize);
+    f.write("WAVE", 4);
+    f.write("fmt ", 4);
+    write32(16);
+    write16(1); // PCM
+    write16(1); // channels
+    write32(SAMPLE_RATE);
+    write32(SAMPLE_RATE * sizeof(int16_t));
+    write16(sizeof(int16_t));
+    write16(16);
+    f.write("data", 4);
+    write32(dataSize);
+    f.write((const char *)data.data(), dataSize);
+    TEST_ASSERT(f);
+}
+
+static bool HasDuration(AudioFileMetadataIndex &index, const fs::path &file, double duration)
+{
+    AudioFileMetadata metadata;
+    return index.TryGet(file, &metadata) && std::abs(metadata.getDuration() - duration) < 0.01;
+}
+
+static void TestIndex()
+{
+    fs::path tempDirectory = fs::temp_directory_path() / "AudioFileMetadataIndexTest";
+    fs::remove_all(tempDirectory);
+    fs::path audioDirectory = tempDirectory / "audio";
+    fs::create_directories(audioDirectory);
+    fs::path indexFile = tempDirectory / "metadata.index";
+
+    fs::path fileA = audioDirectory / "a.wav";
+    fs::path fileB = audioDirectory / "b.wav";
+    fs::path fileC = audioDirectory / "c.wav";
+    fs::path textFile = audioDirectory / "notes.txt";
+    WriteWav(fileA, 1.0);
+    WriteWav(fileB, 2.5);
+    WriteWav(fileC, 4.0);
+    {
+        std::ofstream f(textFile);
+        f << "not audio.";
+    }
+    fs::file_time_type timeA = fs::last_write_time(fileA);
+
+    {
+        AudioFileMetadataIndex index(indexFile);
+        index.ScanDirectory(audioDirectory);
+        index.WaitForScans();
+
+        TEST_ASSERT(HasDuration(index, fileA, 1.0));
+        TEST_ASSERT(HasDuration(index, fileB, 2.5));
+        TEST_ASSERT(HasDuration(index, fileC, 4.0));
+        AudioFileMetadata metadata;
+        TEST_ASSERT(!index.TryGet(textFile, &metadata));
+        TEST_ASSERT(!index.TryGet(audioDirectory / "missing.wav", &metadata));
+
+        // rewriting a file invalidates its entry, and Get() re-probes it.
+        WriteWav(fileB, 3.0);
+        TEST_ASSERT(!index.TryGet(fileB, &metadata));
+        TEST_ASSERT(std::abs(index.Get(fileB).getDuration() - 3.0) < 0.01);
+        TEST_ASSERT(HasDuration(index, fileB, 3.0));
+
+        // so does touching it.
+        fs::last_write_time(fileC, fs::last_write_time(fileC) + std::chrono::seconds(10));
+        TEST_ASSERT(!index.TryGet(fileC, &metadata));
+
+        // a rescan refreshes stale entries, and drops entries for deleted files.
+        fs::remove(fileA);
+        index.ScanDirectory(audioDirectory);
+        index.WaitForScans();
+        TEST_ASSERT(HasDuration(index, fileC, 4.0));
+    }
+    {
+        // the index persists.
+        AudioFileMetadataIndex index(indexFile);
+        TEST_ASSERT(HasDuration(index, fileB, 3.0));
+        TEST_ASSERT(HasDuration(index, fileC, 4.0));
+
+        // an identical file in the deleted file's place would match a stale entry.
+        WriteWav(fileA, 1.0);
+        fs::last_write_time(fileA, timeA);
+        AudioFileMetadata metadata;
+        TEST_ASSERT(!index.TryGet(fileA, &metadata));
+    }
+    fs::remove_all(tempDirectory);
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        TestIndex();
+    }
+    catch (const std::exception &e)
+    {
+        cerr << "ERROR: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,426 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "AudioFilePeaks.hpp"
+#include "../ss.hpp"
+#include "../util.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace toob;
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr char PEAK_FILE_MAGIC[4] = {'T', 'P', 'K', 'S'};
+    constexpr uint32_t PEAK_FILE_VERSION = 1;
+
+    int16_t Quantize(float value)
+    {
+        float v = std::round(value * 32767.0f);
+        if (v > 32767.0f)
+            v = 32767.0f;
+        if (v < -32767.0f)
+            v = -32767.0f;
+        return (int16_t)v;
+    }
+    float Unquantize(int16_t value)
+    {
+        return value * (1.0f / 32767.0f);
+    }
+
+    template <typename T>
+    void WriteValue(std::ostream &s, const T &value)
+    {
+        s.write((const char *)&value, sizeof(T));
+    }
+    template <typename T>
+    T ReadValue(std::istream &s)
+    {
+        T value;
+        s.read((char *)&value, sizeof(T));
+        if (!s)
+        {
+            throw std::runtime_error("Unexpected end of peak file.");
+        }
+        return value;
+    }
+
+    // Identity of the source file. Any change to path, size or modification time
+    // invalidates the cache entry.
+    struct PeakFileKey
+    {
+        PeakFileKey(const fs::path &audioFile)
+            : path(audioFile.string()),
+              fileSize((uint64_t)fs::file_size(audioFile)),
+              lastWrite((int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            fs::last_write_time(audioFile).time_since_epoch())
+                            .count())
+        {
+        }
+        std::string path;
+        uint64_t fileSize;
+        int64_t lastWrite;
+
+        void Write(std::ostream &s) const
+        {
+            s.write(PEAK_FILE_MAGIC, sizeof(PEAK_FILE_MAGIC));
+            WriteValue<uint32_t>(s, PEAK_FILE_VERSION);
+            WriteValue<uint32_t>(s, (uint32_t)path.length());
+            s.write(path.c_str(), path.length());
+            WriteValue(s, fileSize);
+            WriteValue(s, lastWrite);
+        }
+        bool Matches(std::istream &s) const
+        {
+            char magic[sizeof(PEAK_FILE_MAGIC)];
+            s.read(magic, sizeof(magic));
+            if (!s || memcmp(magic, PEAK_FILE_MAGIC, sizeof(magic)) != 0)
+            {
+                return false;
+            }
+            if (ReadValue<uint32_t>(s) != PEAK_FILE_VERSION)
+            {
+                return false;
+            }
+            uint32_t pathLength = ReadValue<uint32_t>(s);
+            if (pathLength != path.length())
+            {
+                return false;
+            }
+            std::string filePath(pathLength, '\0');
+            s.read(filePath.data(), pathLength);
+            if (!s || filePath != path)
+            {
+                return false;
+            }
+            return ReadValue<uint64_t>(s) == fileSize && ReadValue<int64_t>(s) == lastWrite;
+        }
+    };
+}
+
+std::vector<AudioFilePeaks::Peak> AudioFilePeaks::GetOverview(size_t points) const
+{
+    std::vector<Peak> result;
+    if (points == 0 || levels.empty() || levels[0].empty())
+    {
+        return result;
+    }
+    size_t level = 0;
+    while (level + 1 < levels.size() && levels[level + 1].size() >= points)
+    {
+        ++level;
+    }
+    const std::vector<Peak> &source = levels[level];
+    size_t n = source.size();
+
+    result.resize(points);
+    for (size_t i = 0; i < points; ++i)
+    {
+        size_t begin = std::min(i * n / points, n - 1);
+        size_t end = std::clamp((i + 1) * n / points, begin + 1, n);
+
+        int16_t vMin = source[begin].min;
+        int16_t vMax = source[begin].max;
+        double sumSquares = 0;
+        for (size_t j = begin; j < end; ++j)
+        {
+            vMin = std::min(vMin, source[j].min);
+            vMax = std::max(vMax, source[j].max);
+            double rms = Unquantize(source[j].rms);
+            sumSquares += rms * rms;
+        }
+        result[i].min = vMin;
+        result[i].max = vMax;
+        result[i].rms = Quantize((float)std::sqrt(sumSquares / (end - begin)));
+    }
+    return result;
+}
+
+std::string AudioFilePeaks::GetOverviewJson(size_t points) const
+{
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    std::vector<Peak> overview = GetOverview(points);
+
+    std::string hex;
+    hex.reserve(overview.size() * 6);
+    auto putByte = [&hex](uint8_t v)
+    {
+        hex.push_back(HEX[v >> 4]);
+        hex.push_back(HEX[v & 0x0F]);
+    };
+    for (const auto &peak : overview)
+    {
+        putByte((uint8_t)(int8_t)(peak.min >> 8));
+        putByte((uint8_t)(int8_t)(peak.max >> 8));
+        putByte((uint8_t)(peak.rms >> 7));
+    }
+    return SS("{\"duration\":" << GetDuration() << ",\"peaks\":\"" << hex << "\"}");
+}
+
+void AudioFilePeaks::BuildLevels()
+{
+    levels.resize(1);
+    while (levels.back().size() > MIN_LEVEL_SIZE)
+    {
+        const std::vector<Peak> &previous = levels.back();
+        std::vector<Peak> next((previous.size() + 1) / 2);
+        for (size_t i = 0; i < next.size(); ++i)
+        {
+            const Peak &a = previous[i * 2];
+            if (i * 2 + 1 < previous.size())
+            {
+                const Peak &b = previous[i * 2 + 1];
+                float rmsA = Unquantize(a.rms);
+                float rmsB = Unquantize(b.rms);
+                next[i].min = std::min(a.min, b.min);
+                next[i].max = std::max(a.max, b.max);
+                next[i].rms = Quantize(std::sqrt((rmsA * rmsA + rmsB * rmsB) * 0.5f));
+            }
+            else
+            {
+                next[i] = a;
+            }
+        }
+        levels.push_back(std::move(next));
+    }
+}
+
+void AudioFilePeaks::Write(std::ostream &s) const
+{
+    WriteValue(s, sampleRate);
+    WriteValue<uint64_t>(s, frameCount);
+    WriteValue<uint32_t>(s, (uint32_t)FRAMES_PER_PEAK);
+    WriteValue<uint32_t>(s, (uint32_t)levels.size());
+    for (const auto &level : levels)
+    {
+        WriteValue<uint64_t>(s, level.size());
+        s.write((const char *)level.data(), level.size() * sizeof(Peak));
+    }
+}
+
+void AudioFilePeaks::Read(std::istream &s)
+{
+    sampleRate = ReadValue<double>(s);
+    frameCount = (size_t)ReadValue<uint64_t>(s);
+    if (ReadValue<uint32_t>(s) != FRAMES_PER_PEAK)
+    {
+        throw std::runtime_error("Peak file resolution does not match.");
+    }
+    uint32_t levelCount = ReadValue<uint32_t>(s);
+    if (levelCount > 64)
+    {
+        throw std::runtime_error("Invalid peak file.");
+    }
+    levels.resize(levelCount);
+    for (auto &level : levels)
+    {
+        uint64_t count = ReadValue<uint64_t>(s);
+        if (count > frameCount / FRAMES_PER_PEAK + 1)
+        {
+            throw std::runtime_error("Invalid peak file.");
+        }
+        level.resize(count);
+        s.read((char *)level.data(), count * sizeof(Peak));
+        if (!s)
+        {
+            throw std::runtime_error("Unexpected end of peak file.");
+        }
+    }
+}
+
+AudioFilePeakBuilder::AudioFilePeakBuilder(int channels, double sampleRate)
+    : channels(channels),
+      peaks(std::make_shared<AudioFilePeaks>())
+{
+    peaks->sampleRate = sampleRate;
+    peaks->levels.resize(1);
+}
+
+void AudioFilePeakBuilder::Add(float *const *buffers, size_t frames)
+{
+    size_t nChannels = (channels >= 2 && buffers[1] != nullptr) ? 2 : 1;
+    size_t i = 0;
+    while (i < frames)
+    {
+        size_t n = std::min(frames - i, AudioFilePeaks::FRAMES_PER_PEAK - framesInPeak);
+        if (framesInPeak == 0)
+        {
+            peakMin = peakMax = buffers[0][i];
+        }
+        for (size_t c = 0; c < nChannels; ++c)
+        {
+            const float *p = buffers[c] + i;
+            float vMin = peakMin;
+            float vMax = peakMax;
+            float sumSquares = 0;
+            for (size_t j = 0; j < n; ++j)
+            {
+                float v = p[j];
+                vMin = std::min(vMin, v);
+                vMax = std::max(vMax, v);
+                sumSquares += v * v;
+            }
+            peakMin = vMin;
+            peakMax = vMax;
+            peakSumSquares += sumSquares / nChannels;
+        }
+        framesInPeak += n;
+        i += n;
+        peaks->frameCount += n;
+        if (framesInPeak == AudioFilePeaks::FRAMES_PER_PEAK)
+        {
+            FlushPeak();
+        }
+    }
+}
+
+void AudioFilePeakBuilder::FlushPeak()
+{
+    if (framesInPeak == 0)
+    {
+        return;
+    }
+    AudioFilePeaks::Peak peak;
+    peak.min = Quantize(peakMin);
+    peak.max = Quantize(peakMax);
+    peak.rms = Quantize((float)std::sqrt(peakSumSquares / framesInPeak));
+    peaks->levels[0].push_back(peak);
+
+    framesInPeak = 0;
+    peakSumSquares = 0;
+}
+
+AudioFilePeaks::ptr AudioFilePeakBuilder::Finish()
+{
+    FlushPeak();
+    peaks->BuildLevels();
+    AudioFilePeaks::ptr result = std::move(peaks);
+    peaks = nullptr;
+    return result;
+}
+
+fs::path toob::GetAudioFilePeakCachePath(const fs::path &audioFile)
+{
+    fs::path directory = GetUserCacheDirectory();
+    if (directory.empty())
+    {
+        return directory;
+    }
+    directory /= "peaks";
+    size_t hash = std::hash<std::string>{}(fs::absolute(audioFile).string());
+    return directory / SS(std::hex << hash << ".peaks");
+}
+
+AudioFilePeaks::ptr toob::LoadCachedAudioFilePeaks(const fs::path &audioFile)
+{
+    try
+    {
+        fs::path cachePath = GetAudioFilePeakCachePath(audioFile);
+        if (cachePath.empty() || !fs::exists(cachePath))
+        {
+            return nullptr;
+        }
+        PeakFileKey key{audioFile};
+        std::ifstream f(cachePath, std::ios_base::binary);
+        if (!f || !key.Matches(f))
+        {
+            return nullptr;
+        }
+        auto result = std::make_shared<AudioFilePeaks>();
+        result->Read(f);
+        return result;
+    }
+    catch (const std::exception &)
+    {
+        // stale or damaged cache entries are simply regenerated.
+        return nullptr;
+    }
+}
+
+bool toob::GetCachedAudioFileDuration(const fs::path &audioFile, double *duration)
+{
+    try
+    {
+        fs::path cachePath = GetAudioFilePeakCachePath(audioFile);
+        if (cachePath.empty() || !fs::exists(cachePath))
+        {
+            return false;
+        }
+        PeakFileKey key{audioFile};
+        std::ifstream f(cachePath, std::ios_base::binary);
+        if (!f || !key.Matches(f))
+        {
+            return false;
+        }
+        double sampleRate = ReadValue<double>(f);
+        uint64_t frameCount = ReadValue<uint64_t>(f);
+        if (sampleRate <= 0 || frameCount == 0)
+        {
+            return false;
+        }
+        *duration = frameCount / sampleRate;
+        return true;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+void toob::SaveCachedAudioFilePeaks(const fs::path &audioFile, const AudioFilePeaks &peaks)
+{
+    fs::path cachePath = GetAudioFilePeakCachePath(audioFile);
+    if (cachePath.empty())
+    {
+        return;
+    }
+    fs::create_directories(cachePath.parent_path());
+
+    // write-then-rename so that concurrent readers never see a partial file.
+    fs::path tempPath = cachePath;
+    tempPath += ".tmp";
+    {
+        PeakFileKey key{audioFile};
+        std::ofstream f(tempPath, std::ios_base::binary | std::ios_base::trunc);
+        if (!f)
+        {
+            throw std::runtime_error(SS("Can't write to " << tempPath));
+        }
+        key.Write(f);
+        peaks.Write(f);
+        f.close();
+        if (!f)
+        {
+            std::error_code ec;
+            fs::remove(tempPath, ec);
+            throw std::runtime_error(SS("Can't write to " << tempPath));
+        }
+    }
+    fs::rename(tempPath, cachePath);
+}
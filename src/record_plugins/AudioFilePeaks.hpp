@@ -0,0 +1,119 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace toob
+{
+
+    // Multi-resolution min/max/rms overview of an audio file.
+    //
+    // Level 0 holds one entry per FRAMES_PER_PEAK frames; each successive level
+    // halves the resolution. Channels are merged. Values are stored as 16-bit fixed point
+    // so that cache files stay small.
+    class AudioFilePeaks
+    {
+    public:
+        using ptr = std::shared_ptr<AudioFilePeaks>;
+
+        static constexpr size_t FRAMES_PER_PEAK = 512;
+        static constexpr size_t MIN_LEVEL_SIZE = 64;
+
+        struct Peak
+        {
+            int16_t min = 0;
+            int16_t max = 0;
+            int16_t rms = 0;
+        };
+
+        double GetSampleRate() const { return sampleRate; }
+        size_t GetFrameCount() const { return frameCount; }
+        double GetDuration() const { return sampleRate == 0 ? 0.0 : frameCount / sampleRate; }
+
+        size_t GetLevelCount() const { return levels.size(); }
+        const std::vector<Peak> &GetLevel(size_t level) const { return levels[level]; }
+        size_t GetFramesPerPeak(size_t level) const { return FRAMES_PER_PEAK << level; }
+
+        // Reduce to exactly `points` entries, using the coarsest level that still has
+        // at least one entry per point.
+        std::vector<Peak> GetOverview(size_t points) const;
+
+        // Compact overview for transmission to a UI:
+        //   {"duration":<seconds>,"peaks":"<hex>"}
+        // where each point is encoded as 3 bytes (int8 min, int8 max, uint8 rms).
+        std::string GetOverviewJson(size_t points) const;
+
+        void Write(std::ostream &s) const;
+        void Read(std::istream &s);
+
+    private:
+        friend class AudioFilePeakBuilder;
+
+        void BuildLevels();
+
+        double sampleRate = 0;
+        size_t frameCount = 0;
+        std::vector<std::vector<Peak>> levels;
+    };
+
+    // Accumulates level-0 peaks incrementally as buffers are decoded.
+    class AudioFilePeakBuilder
+    {
+    public:
+        AudioFilePeakBuilder(int channels, double sampleRate);
+
+        // buffers[1] may be null for mono streams.
+        void Add(float *const *buffers, size_t frames);
+
+        AudioFilePeaks::ptr Finish();
+
+    private:
+        void FlushPeak();
+
+        int channels;
+        AudioFilePeaks::ptr peaks;
+        size_t framesInPeak = 0;
+        float peakMin = 0;
+        float peakMax = 0;
+        double peakSumSquares = 0;
+    };
+
+    // Sidecar cache. Peak files live in the user's cache directory and are keyed on the
+    // source file's path, size and modification time. Loading returns null if no valid cache
+    // entry exists.
+    std::filesystem::path GetAudioFilePeakCachePath(const std::filesystem::path &audioFile);
+    AudioFilePeaks::ptr LoadCachedAudioFilePeaks(const std::filesystem::path &audioFile);
+    void SaveCachedAudioFilePeaks(const std::filesystem::path &audioFile, const AudioFilePeaks &peaks);
+
+    // Reads only the header of a cached peak file. Returns false if there is no valid cache entry.
+    bool GetCachedAudioFileDuration(const std::filesystem::path &audioFile, double *duration);
+
+} // namespace toob
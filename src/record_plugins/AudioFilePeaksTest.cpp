@@ -0,0 +1,155 @@
+/*
+ *   Copyright (c) 2025 Robin E. R. Davies
+ *   All rights reserved.
+
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:
+
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ */
+
+
+#include "AudioFilePeaks.hpp"
+#include "../TestAssert.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using namespace toob;
+using namespace std;
+namespace fs = std::filesystem;
+
+static AudioFilePeaks::ptr BuildPeaks(size_t frames, size_t blockSize)
+{
+    // left: 0.5 amplitude sine; right: silence, except for a single full-scale spike.
+    vector<float> left(frames), right(frames);
+    for (size_t i = 0; i < frames; ++i)
+    {
+        left[i] = 0.5f * (float)std::sin(i * 0.05);
+        right[i] = 0;
+    }
+    right[frames / 2] = -1.0f;
+
+    AudioFilePeakBuilder builder(2, 48000);
+    for (size_t i = 0; i < frames; i += blockSize)
+    {
+        size_t n = std::min(blockSize, frames - i);
+        float *buffers[2] = {left.data() + i, right.data() + i};
+        builder.Add(buffers, n);
+    }
+    return builder.Finish();
+}
+
+static void TestBuilder()
+{
+    constexpr size_t FRAMES = 48000 * 10 + 17;
+    auto peaks = BuildPeaks(FRAMES, 4800);
+    auto peaks2 = BuildPeaks(FRAMES, 333);
+
+    TEST_ASSERT(peaks->GetFrameCount() == FRAMES);
+    TEST_ASSERT(std::abs(peaks->GetDuration() - FRAMES / 48000.0) < 1E-9);
+
+    // block size must not affect the result.
+    TEST_ASSERT(peaks->GetLevelCount() == peaks2->GetLevelCount());
+    for (size_t level = 0; level < peaks->GetLevelCount(); ++level)
+    {
+        const auto &a = peaks->GetLevel(level);
+        const auto &b = peaks2->GetLevel(level);
+        TEST_ASSERT(a.size() == b.size());
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            TEST_ASSERT(a[i].min == b[i].min && a[i].max == b[i].max && std::abs(a[i].rms - b[i].rms) <= 1);
+        }
+    }
+    TEST_ASSERT(peaks->GetLevel(0).size() == (FRAMES + AudioFilePeaks::FRAMES_PER_PEAK - 1) / AudioFilePeaks::FRAMES_PER_PEAK);
+    TEST_ASSERT(peaks->GetLevel(peaks->GetLevelCount() - 1).size() <= AudioFilePeaks::MIN_LEVEL_SIZE);
+
+    // every level must see the spike.
+    for (size_t level = 0; level < peaks->GetLevelCount(); ++level)
+    {
+        int16_t vMin = 0;
+        for (const auto &peak : peaks->GetLevel(level))
+        {
+            vMin = std::min(vMin, peak.min);
+        }
+        TEST_ASSERT(vMin == -32767);
+    }
+
+    auto overview = peaks->GetOverview(256);
+    TEST_ASSERT(overview.size() == 256);
+    // sine rms is 0.5/sqrt(2), averaged with a silent channel.
+    float expectedRms = 0.5f / std::sqrt(2.0f) / std::sqrt(2.0f);
+    TEST_ASSERT(std::abs(overview[10].rms / 32767.0f - expectedRms) < 0.01f);
+    TEST_ASSERT(std::abs(overview[10].max / 32767.0f - 0.5f) < 0.01f);
+
+    std::string json = peaks->GetOverviewJson(256);
+    TEST_ASSERT(json.find("\"peaks\":\"") != std::string::npos);
+    TEST_ASSERT(json.length() < 1800);
+}
+
+static void TestCache()
+{
+    fs::path tempDirectory = fs::temp_directory_path() / "AudioFilePeaksTest";
+    fs::remove_all(tempDirectory);
+    fs::create_directories(tempDirectory);
+    setenv("XDG_CACHE_HOME", (tempDirectory / "cache").c_str(), 1);
+
+    fs::path audioFile = tempDirectory / "test.flac";
+    {
+        std::ofstream f(audioFile);
+        f << "not really audio.";
+    }
+    TEST_ASSERT(LoadCachedAudioFilePeaks(audioFile) == nullptr);
+
+    auto peaks = BuildPeaks(48000 * 3, 1024);
+    SaveCachedAudioFilePeaks(audioFile, *peaks);
+
+    auto loaded = LoadCachedAudioFilePeaks(audioFile);
+    TEST_ASSERT(loaded != nullptr);
+    TEST_ASSERT(loaded->GetFrameCount() == peaks->GetFrameCount());
+    TEST_ASSERT(loaded->GetOverviewJson(256) == peaks->GetOverviewJson(256));
+
+    double duration = 0;
+    TEST_ASSERT(GetCachedAudioFileDuration(audioFile, &duration));
+    TEST_ASSERT(duration == 3.0);
+
+    // modifying the source file invalidates the cache entry.
+    {
+        std::ofstream f(audioFile, std::ios_base::app);
+        f << "more data";
+    }
+    TEST_ASSERT(LoadCachedAudioFilePeaks(audioFile) == nullptr);
+    TEST_ASSERT(!GetCachedAudioFileDuration(audioFile, &duration));
+
+    fs::remove_all(tempDirectory);
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        TestBuilder();
+        TestCache();
+    }
+    catch (const std::exception &e)
+    {
+        cerr << "ERROR: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -26,6 +26,8 @@
 //  ffmpeg -i 01\ Once\ in\ Royal\ David\'s\ City.mp3 -filter:v scale=-2:250 -an output.jpeg
 
 #include "FfmpegDecoderStream.hpp"
+#include "AudioFilePeaks.hpp"
+#include "AudioFileMetadataIndex.hpp"
 #include "../ss.hpp"
 #include <unistd.h>
 #include <fcntl.h>
@@ -37,7 +39,6 @@
 #include <iostream>
 #include "../json.hpp"
 #include "../json_variant.hpp"
-#include "../LRUCache.hpp"
 #include <mutex>
 
 namespace fs = std::filesystem;
@@ -592,65 +593,19 @@ AudioFileMetadata::AudioFileMetadata(const std::filesystem::path &file)
 ffprobe -v error -show_entries format=duration -of default=noprint_wrappers=1:nokey=1 ~/Music/FLAC/St\ Germain/St\ Germain/04\ -\ Voila.flac
 */
 
-namespace
-{
-    class AudioCacheKey
-    {
-    public:
-        AudioCacheKey(const std::filesystem::path &path)
-        {
-            this->path = path.string();
-            lastWrite = std::filesystem::last_write_time(path);
-        }
-        // Equality operator
-        bool operator==(const AudioCacheKey &other) const
-        {
-            return path == other.path && lastWrite == other.lastWrite;
-        }
-
-    public:
-        std::string path;
-        fs::file_time_type lastWrite;
-    };
-}
-
-namespace std
-{
-    template <>
-    struct hash<AudioCacheKey>
-    {
-
-        size_t operator()(const AudioCacheKey &key) const
-        {
-            size_t path_hash = hash<std::string>{}(key.path);
-            size_t time_hash = hash<uintmax_t>{}(
-                duration_cast<std::chrono::nanoseconds>(key.lastWrite.time_since_epoch()).count());
-            // Combine hashes (boost::hash_combine approach)
-            return path_hash ^ (time_hash + 0x9e3779b9 + (path_hash << 6) + (path_hash >> 2));
-        }
-    };
-}
-
-static LRUCache<AudioCacheKey, AudioFileMetadata> metadataCache{100};
-static std::mutex metadataCacheMutex;
-
 AudioFileMetadata toob::GetAudioFileMetadata(const std::filesystem::path &path)
 {
-    
-    std::lock_guard lock{metadataCacheMutex};
-    AudioCacheKey key{path};
-    AudioFileMetadata result;
-    if (metadataCache.get(key, result))
-    {
-        return result;
-    }
-    result = AudioFileMetadata(path);
-    metadataCache.put(key, result);
-    return result;
+    return AudioFileMetadataIndex::Instance().Get(path);
 }
 
 double toob::GetAudioFileDuration(const std::filesystem::path &path)
 {
+    // a cached peak file records the decoded length; avoid spawning ffprobe if we have one.
+    double duration;
+    if (GetCachedAudioFileDuration(path, &duration))
+    {
+        return duration;
+    }
     AudioFileMetadata md = GetAudioFileMetadata(path);
     return md.getDuration();
 }
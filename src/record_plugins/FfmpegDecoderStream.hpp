@@ -89,6 +89,8 @@ namespace toob
         const std::string &getAlbumArtist() const { return artist; }
 
     private:
+        friend class AudioFileMetadataIndex;
+
         std::filesystem::path path;
         double duration = 0;
         std::string artist;
@@ -28,12 +28,16 @@
 #include <algorithm>
 #include <memory>
 #include "../util.hpp"
+#include "../ThreadManager.hpp"
 
 #include "FfmpegDecoderStream.hpp"
+#include "AudioFileMetadataIndex.hpp"
 
 #include "../LsNumerics/LsMath.hpp"
+#include "../LsNumerics/MixKernels.hpp"
 
 using namespace toob;
+using namespace LsNumerics;
 
 namespace
 {
@@ -54,8 +58,10 @@ namespace
         NextPlayBufferResponse,
         StartPlayback,
         StopPlayback,
+        SetPlaybackRate,
 
         UpdateLoopParameters,
+        Waveform,
         RecordingStopped,
         BackgroundError,
         Quit,
@@ -95,6 +101,18 @@ namespace
         char filename[1024];
     };
 
+    struct SetPlaybackRateMessage : public BufferMessage
+    {
+        SetPlaybackRateMessage(float speed, float pitch)
+            : BufferMessage(MessageType::SetPlaybackRate, sizeof(SetPlaybackRateMessage)),
+              speed(speed),
+              pitch(pitch)
+        {
+        }
+        float speed;
+        float pitch;
+    };
+
     struct QuitMessage : public BufferMessage
     {
         QuitMessage() : BufferMessage(MessageType::Quit, sizeof(QuitMessage))
@@ -153,6 +171,25 @@ namespace
         double duration = 0.0; 
         char loopJson[1024] = {0};
     };  
+    struct ToobWaveformMessage : public BufferMessage
+    {
+        ToobWaveformMessage(uint64_t operationId, const char *waveformJson)
+            : BufferMessage(MessageType::Waveform, sizeof(ToobWaveformMessage)),
+              operationId(operationId)
+        {
+            size_t len = strlen(waveformJson) + 1;
+            this->size = sizeof(ToobWaveformMessage) - sizeof(this->waveformJson) + len;
+            if (this->size > sizeof(ToobWaveformMessage))
+            {
+                throw std::runtime_error("Command size exceeds structure size");
+            }
+            this->size = (this->size + 3) & (~3);
+            memcpy(this->waveformJson, waveformJson, len);
+        }
+
+        uint64_t operationId = (uint64_t)-1;
+        char waveformJson[1800] = {0};
+    };
     struct ToobStartRecordingMessage : public BufferMessage
     {
         ToobStartRecordingMessage(const std::string &fileName, OutputFormat outputFormat)
@@ -175,11 +212,13 @@ namespace
 
     struct ToobCuePlaybackMessage : public BufferMessage
     {
-        ToobCuePlaybackMessage(uint64_t operationId, const char *fileNameInput, size_t seekPos)
+        ToobCuePlaybackMessage(uint64_t operationId, const char *fileNameInput, size_t seekPos, float speed, float pitch)
             : BufferMessage(MessageType::CuePlayback,
                             sizeof(ToobCuePlaybackMessage)),
               operationId(operationId),
-              seekPos(seekPos)
+              seekPos(seekPos),
+              speed(speed),
+              pitch(pitch)
         {
             size_t fileNameLen = strlen(fileNameInput);
             if (fileNameLen + 1 > sizeof(this->buffer))
@@ -205,6 +244,8 @@ namespace
         }
         uint64_t operationId = (size_t)-1;
         size_t seekPos = 0;
+        float speed = 1.0f;
+        float pitch = 1.0f;
 
     private:
         char buffer[1024];
@@ -425,12 +466,16 @@ void Lv2AudioFileProcessor::Activate()
             try
             {
                 bool quit = false;
-                SetThreadName("tply_bg");
-                SetThreadNice(-11);
+                ThreadManager::Get().ConfigureCurrentThread(ThreadRole::PlayerBackground);
                 std::vector<uint8_t> buffer(2048);
                 BufferMessage *cmd = (BufferMessage *)buffer.data();
                 while (!quit)
                 {
+                    if (bgPeakDecoder && !this->toBackgroundQueue.isReadReady())
+                    {
+                        bgPeakScanStep();
+                        continue;
+                    }
                     this->toBackgroundQueue.readWait();
                     size_t size = this->toBackgroundQueue.peekSize();
                     if (size == 0)
@@ -482,6 +527,7 @@ void Lv2AudioFileProcessor::Activate()
                         case MessageType::CuePlayback:
                         {
                             ToobCuePlaybackMessage *cueCmd = (ToobCuePlaybackMessage *)cmd;
+                            bgReader.SetPlaybackRate(cueCmd->speed, cueCmd->pitch);
                             bgCuePlayback(cueCmd->operationId, cueCmd->getFileName(), cueCmd->seekPos);
                             break;
                         }
@@ -510,6 +556,12 @@ void Lv2AudioFileProcessor::Activate()
                             bgStopPlaying();
                             break;
                         }
+                        case MessageType::SetPlaybackRate:
+                        {
+                            SetPlaybackRateMessage *rateCmd = (SetPlaybackRateMessage *)cmd;
+                            bgReader.ChangePlaybackRate(rateCmd->speed, rateCmd->pitch);
+                            break;
+                        }
                         case MessageType::Quit:
                         {
                             quit = true;
@@ -536,6 +588,7 @@ void Lv2AudioFileProcessor::Activate()
                 this->fromBackgroundQueue.write_packet(errorCmd.size, (uint8_t *)&errorCmd);
             }
             bgStopPlaying();
+            bgCancelPeakScan();
             bgCloseTempFile();
 
             FinishedMessage finishedCommand;
@@ -703,7 +756,7 @@ void Lv2AudioFileProcessor::fgStopPlaying()
 
 void Lv2AudioFileProcessor::fgCuePlayback(const char *filename, size_t seekPos)
 {
-    ToobCuePlaybackMessage cmd{++fgOperationId, filename, seekPos};
+    ToobCuePlaybackMessage cmd{++fgOperationId, filename, seekPos, playbackSpeed, playbackPitch};
     this->toBackgroundQueue.write_packet(cmd.size, (uint8_t *)&cmd);
 }
 
@@ -886,6 +939,19 @@ void Lv2AudioFileProcessor::HandleMessages()
             OnFgUpdateLoopParameters(updateCmd->loopJson, updateCmd->seekPosSeconds, updateCmd->duration);
             break;
         }
+        case MessageType::Waveform:
+        {
+            ToobWaveformMessage *waveformCmd = (ToobWaveformMessage *)cmd;
+            if (waveformCmd->operationId != fgOperationId)
+            {
+                return; // cancelled request.
+            }
+            if (host)
+            {
+                host->OnFgWaveformChanged(waveformCmd->waveformJson);
+            }
+            break;
+        }
         case MessageType::StartRecording:
         {
             ToobStartRecordingMessage *startCommand = (ToobStartRecordingMessage *)cmd;
@@ -961,45 +1027,29 @@ toob::AudioFileBuffer *BgFileReader::NextBuffer(
     bufferPool->Reserve(PREROLL_BUFFERS + 1);
 
     toob::AudioFileBuffer *buffer = nullptr;
-    if (!this->decoderStream && !useTestData)
+    if (!this->decoderStream && !useTestData && !(loopType == LoopType::BigLoop && loopRegion.IsComplete()))
     {
         // No decoder stream and no test data, so we can't read anything.
         return nullptr;
     }
-    if (this->loopType == LoopType::BigLoop && this->readPos >= loopControlInfo.loopEnd_1)
+    if (this->phaseVocoder)
     {
-        // We have reached the end of the loop, so we need to reset the read position.
-        this->readPos -= loopControlInfo.loopSize + loopControlInfo.loopEnd_1 - loopControlInfo.loopEnd_0;
-
-        this->decoderStream.reset();
-
-#ifndef NDEBUG
-        auto start = clock_t::now();
-#endif
-        if (useTestData)
+        return NextStretchedBuffer(bufferPool);
+    }
+    if (this->loopType == LoopType::BigLoop && this->readPos >= loopRegion.GetLoopEnd())
+    {
+        // Wrap around. Cached loop data is already crossfaded, so this is just a position reset.
+        this->readPos -= loopRegion.GetLoopSize();
+        if (loopRegion.IsComplete())
         {
-            decoderStreamOpen(this->filePath, this->channels, this->sampleRate, this->readPos / (double)this->sampleRate);
+            decoderStream.reset();
         }
         else
         {
-            if (this->readPos != this->lookaheadPosition) {
-                throw std::logic_error("Read position does not match lookahead position.");
-            }
-            this->decoderStream = std::move(nextDecoderStream);
-            // next decode stream will cue up asynchronously
-            nextDecoderStream = std::make_unique<FfmpegDecoderStream>();
-            this->lookaheadPosition = this->readPos;
-            nextDecoderStream->open(this->filePath, this->channels, this->sampleRate, this->readPos / (double)this->sampleRate);
+            // the loop is too long to cache in full. Cue up the decoder for the uncached
+            // part; there's plenty of cached audio to play while it opens.
+            decoderStreamOpen(this->filePath, this->channels, this->sampleRate, loopRegion.GetCachedEnd() / (double)this->sampleRate);
         }
-// print the time taken to open the decoder stream.
-#ifndef NDEBUG
-        auto end = clock_t::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-        if (duration > 500)
-        {
-            std::cerr << "Warning: Decoder stream open took " << duration << " ms for file: " << this->filePath << std::endl;
-        }
-#endif
     }
 
     try
@@ -1041,6 +1091,15 @@ toob::AudioFileBuffer *BgFileReader::NextBuffer(
             buffers[0] = buffer->GetChannel(0);
             buffers[1] = nullptr; // mono file, so we can just read the data directly.
         }
+        if (loopType == LoopType::BigLoop && readPos >= loopRegion.GetRingStart() && readPos < loopRegion.GetCachedEnd())
+        {
+            size_t nRead = loopRegion.Read(readPos, buffers, thisTime);
+            buffer->SetBufferSize(nRead);
+            buffer->SetSourcePosition(this->readPos);
+            this->readPos += nRead;
+            return buffer;
+        }
+
         auto start = clock_t::now();
 
         size_t nRead = this->decoderStreamRead(buffers, thisTime);
@@ -1068,6 +1127,10 @@ toob::AudioFileBuffer *BgFileReader::NextBuffer(
                 nRead = thisTime;
             }
         }
+        if (loopType == LoopType::BigLoop)
+        {
+            loopRegion.Write(this->readPos, buffers, nRead);
+        }
         if (nRead == 0)
         {
             bufferPool->PutBuffer(buffer);
@@ -1075,6 +1138,7 @@ toob::AudioFileBuffer *BgFileReader::NextBuffer(
             return nullptr; // no more streamed data.
         }
         buffer->SetBufferSize(nRead);
+        buffer->SetSourcePosition(this->readPos);
 
         this->readPos += nRead;
         return buffer;
@@ -1086,11 +1150,95 @@ toob::AudioFileBuffer *BgFileReader::NextBuffer(
             bufferPool->PutBuffer(buffer);
         }
         decoderStream.reset();
-        nextDecoderStream.reset();
         return nullptr;
     }
 }
 
+toob::AudioFileBuffer *BgFileReader::NextStretchedBuffer(
+    toob::AudioFileBufferPool *bufferPool)
+{
+    toob::AudioFileBuffer *buffer = nullptr;
+    try
+    {
+        size_t bufferSize = bufferPool->GetBufferSize();
+        buffer = bufferPool->TakeBuffer();
+        float *outputs[2];
+        outputs[0] = buffer->GetChannel(0);
+        outputs[1] = bufferPool->GetChannels() >= 2 ? buffer->GetChannel(1) : nullptr;
+
+        stretchInputL.resize(bufferSize);
+        stretchInputR.resize(bufferSize);
+        float *inputs[2];
+        inputs[0] = stretchInputL.data();
+        inputs[1] = outputs[1] ? stretchInputR.data() : nullptr;
+
+        size_t produced = 0;
+        while (true)
+        {
+            float *dst[2] = {outputs[0] + produced, outputs[1] ? outputs[1] + produced : nullptr};
+            produced += phaseVocoder->Read(dst, bufferSize - produced);
+            if (produced == bufferSize || phaseVocoder->IsFinished())
+            {
+                break;
+            }
+            // decode more input.
+            size_t nRead = (decoderStream || useTestData) ? this->decoderStreamRead(inputs, bufferSize) : 0;
+            if (nRead == 0)
+            {
+                decoderStream.reset();
+                phaseVocoder->WriteEnd();
+            }
+            else
+            {
+                phaseVocoder->Write(inputs, nRead);
+                this->readPos += nRead;
+            }
+        }
+        if (produced == 0)
+        {
+            bufferPool->PutBuffer(buffer);
+            phaseVocoder.reset();
+            return nullptr; // no more streamed data.
+        }
+        buffer->SetBufferSize(produced);
+        buffer->SetSourcePosition((size_t)stretchedSourcePos, playbackSpeed);
+        stretchedSourcePos += produced * playbackSpeed;
+        return buffer;
+    }
+    catch (const std::exception &e)
+    {
+        if (buffer)
+        {
+            bufferPool->PutBuffer(buffer);
+        }
+        decoderStream.reset();
+        phaseVocoder.reset();
+        return nullptr;
+    }
+}
+
+void BgFileReader::SetPlaybackRate(double speed, double pitch)
+{
+    this->playbackSpeed = speed;
+    this->playbackPitch = pitch;
+}
+
+void BgFileReader::ChangePlaybackRate(double speed, double pitch)
+{
+    SetPlaybackRate(speed, pitch);
+    if (phaseVocoder)
+    {
+        phaseVocoder->ChangeRate(speed, pitch);
+    }
+    else if (loopType == LoopType::None && (decoderStream || useTestData) && (speed != 1.0 || pitch != 1.0))
+    {
+        // start stretching from the next buffer.
+        phaseVocoder = std::make_unique<LsNumerics::PhaseVocoder>(channels >= 2 ? 2 : 1);
+        phaseVocoder->SetRate(speed, pitch);
+        stretchedSourcePos = (double)this->readPos;
+    }
+}
+
 Lv2AudioFileProcessor::Lv2AudioFileProcessor(ILv2AudioFileProcessorHost *host, double sampleRate, int channels)
     : sampleRate(sampleRate), channels(channels), host(host)
 {
@@ -1100,9 +1248,6 @@ Lv2AudioFileProcessor::Lv2AudioFileProcessor(ILv2AudioFileProcessorHost *host, d
     this->volumeDezipperL.SetSampleRate(sampleRate);
     this->volumeDezipperR.SetSampleRate(sampleRate);
     SetDbVolume(0.0, 0.0, true);
-    size_t blendBufferSize = GetLoopBlendLength(sampleRate);
-    bgReader.blendBufferL.resize(blendBufferSize * channels);
-    bgReader.blendBufferR.resize(blendBufferSize);
 }
 
 static constexpr size_t FILE_LRU_MAX = 4;
@@ -1257,6 +1402,9 @@ void Lv2AudioFileProcessor::bgCuePlayback(
                 PreCacheFile(filename);
             }
             duration = GetAudioFileDuration(filename);
+
+            // warm the metadata index for the rest of the directory, which the file browser is likely showing.
+            AudioFileMetadataIndex::Instance().ScanDirectory(std::filesystem::path(filename).parent_path());
         }
 
         // normalize the loop parameters.
@@ -1323,6 +1471,17 @@ void Lv2AudioFileProcessor::bgCuePlayback(
             seekPosSeconds,
             duration);
 
+        if (bgPeaksPath != filename)
+        {
+            bgPeaksPath = filename;
+            bgPeaks = bgReader.useTestData ? nullptr : LoadCachedAudioFilePeaks(filename);
+        }
+        bgSendWaveform(bgOperationId, bgPeaks.get());
+        if (!bgPeaks && !bgReader.useTestData && bgPeakScanPath != filename)
+        {
+            bgStartPeakScan(filename);
+        }
+
         bgReader.loopType = bgReader.loopControlInfo.loopType;
         auto loopType = bgReader.loopControlInfo.loopType;
 
@@ -1403,12 +1562,6 @@ void Lv2AudioFileProcessor::bgCuePlayback(
                     responseCommand.bufferCount++;
                 }
             }
-            // if we are playing a big loop, cue up the next decoder stream, so it can initialize asynchronously.
-            if (loopType == LoopType::BigLoop)
-            {
-                bgReader.PrepareLookaheadDecoderStream();
-            }
-
             bool cancelled = operationId != fgOperationId;
 
             if (cancelled)
@@ -1434,6 +1587,87 @@ void Lv2AudioFileProcessor::bgCuePlayback(
     }
 }
 
+void Lv2AudioFileProcessor::bgSendWaveform(uint64_t operationId, const AudioFilePeaks *peaks)
+{
+    if (operationId != fgOperationId)
+    {
+        // This is a cancelled request.
+        return;
+    }
+    std::string json = peaks ? peaks->GetOverviewJson(WAVEFORM_POINTS) : std::string();
+    ToobWaveformMessage cmd{operationId, json.c_str()};
+    this->fromBackgroundQueue.write_packet(cmd.size, (uint8_t *)&cmd);
+}
+
+void Lv2AudioFileProcessor::bgStartPeakScan(const std::filesystem::path &filename)
+{
+    bgCancelPeakScan();
+    bgPeakScanPath = filename;
+    try
+    {
+        bgPeakDecoder = std::make_unique<toob::FfmpegDecoderStream>();
+        bgPeakDecoder->open(filename, channels, (uint32_t)sampleRate);
+        bgPeakBuilder = std::make_unique<AudioFilePeakBuilder>(channels, sampleRate);
+        bgPeakScanL.resize(PEAK_SCAN_CHUNK_FRAMES);
+        bgPeakScanR.resize(channels >= 2 ? PEAK_SCAN_CHUNK_FRAMES : 0);
+    }
+    catch (const std::exception &e)
+    {
+        // not fatal. The file just doesn't get a waveform.
+        std::cerr << "Warning: Can't scan peaks for " << filename << ": " << e.what() << std::endl;
+        bgPeakDecoder.reset();
+        bgPeakBuilder.reset();
+    }
+}
+
+void Lv2AudioFileProcessor::bgPeakScanStep()
+{
+    try
+    {
+        float *buffers[2] = {bgPeakScanL.data(), channels >= 2 ? bgPeakScanR.data() : nullptr};
+        size_t nRead = bgPeakDecoder->read(buffers, PEAK_SCAN_CHUNK_FRAMES);
+        if (nRead != 0)
+        {
+            bgPeakBuilder->Add(buffers, nRead);
+        }
+        if (nRead != 0 && !bgPeakDecoder->eof())
+        {
+            return;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Warning: Can't scan peaks for " << bgPeakScanPath << ": " << e.what() << std::endl;
+        bgCancelPeakScan();
+        return;
+    }
+
+    AudioFilePeaks::ptr peaks = bgPeakBuilder->Finish();
+    bgPeakDecoder.reset();
+    bgPeakBuilder.reset();
+    try
+    {
+        SaveCachedAudioFilePeaks(bgPeakScanPath, *peaks);
+    }
+    catch (const std::exception &e)
+    {
+        // not fatal. We'll scan again the next time the file is loaded.
+        std::cerr << "Warning: Can't save peak file for " << bgPeakScanPath << ": " << e.what() << std::endl;
+    }
+    if (bgPeaksPath == bgPeakScanPath)
+    {
+        bgPeaks = peaks;
+        bgSendWaveform(bgOperationId, bgPeaks.get());
+    }
+}
+
+void Lv2AudioFileProcessor::bgCancelPeakScan()
+{
+    bgPeakDecoder.reset();
+    bgPeakBuilder.reset();
+    bgPeakScanPath.clear();
+}
+
 void Lv2AudioFileProcessor::bgError(const char *message)
 {
     bgReader.Close();
@@ -1661,21 +1895,6 @@ void Lv2AudioFileProcessor::OnFgCuePlaybackResponse(
         {
             SetState(ProcessorState::Playing);
         }
-        // deal with the corner case where blend buffers won't be filled on the first loop.
-        if (fgLoopControlInfo.loopType == LoopType::BigLoop)
-        {
-            if (playPosition > fgLoopControlInfo.loopEnd_0 &&
-                playPosition < fgLoopControlInfo.loopEnd_1)
-            {
-                bgReader.blendBufferL.resize(fgLoopControlInfo.loopEnd_1 - fgLoopControlInfo.loopEnd_0);
-                bgReader.blendBufferR.resize(fgLoopControlInfo.loopEnd_1 - fgLoopControlInfo.loopEnd_0);
-                for (size_t i = 0; i < bgReader.blendBufferL.size(); ++i)
-                {
-                    bgReader.blendBufferL[i] = 0.0f;
-                    bgReader.blendBufferR[i] = 0.0f;
-                }
-            }
-        }
         if (host)
         {
             host->OnFgLoopJsonChanged(loopParameterJson);
@@ -1706,24 +1925,60 @@ void Lv2AudioFileProcessor::OnFgRecordingStopped(const char *filename)
     CuePlayback(filename, 0, !playAfterRecording);
     playAfterRecording = false;
 }
+void Lv2AudioFileProcessor::MixOut(float *dst, const float *src, size_t n_samples)
+{
+    while (n_samples != 0)
+    {
+        size_t n = volumeDezipperL.RampLength(n_samples);
+        MixKernels::MixAccumulateRamp(dst, src, volumeDezipperL.RampStart(), volumeDezipperL.RampDx(), n);
+        volumeDezipperL.Skip(n);
+        dst += n;
+        src += n;
+        n_samples -= n;
+    }
+}
+
+void Lv2AudioFileProcessor::MixOut(float *dstL, float *dstR, const float *srcL, const float *srcR, size_t n_samples)
+{
+    while (n_samples != 0)
+    {
+        size_t n = volumeDezipperL.RampLength(n_samples);
+        n = volumeDezipperR.RampLength(n);
+        MixKernels::StereoPanRampAccumulate(
+            dstL, dstR, srcL, srcR,
+            volumeDezipperL.RampStart(), volumeDezipperL.RampDx(),
+            volumeDezipperR.RampStart(), volumeDezipperR.RampDx(),
+            n);
+        volumeDezipperL.Skip(n);
+        volumeDezipperR.Skip(n);
+        dstL += n;
+        dstR += n;
+        srcL += n;
+        srcR += n;
+        n_samples -= n;
+    }
+}
+
 void Lv2AudioFileProcessor::Play(float *dst, size_t n_samples)
 {
     if (this->state == ProcessorState::Playing)
     {
-        if (this->fgLoopType == LoopType::None)
+        if (this->fgLoopType == LoopType::None || this->fgLoopType == LoopType::BigLoop)
         {
+            // big loops arrive with loop wraps and crossfades already applied by the background reader.
             if (!this->fgPlaybackQueue.empty())
             {
-                this->playPosition += n_samples;
-
                 auto buffer = this->fgPlaybackQueue.front();
-                float *playData = buffer->GetChannel(0);
 
-                for (uint32_t i = 0; i < n_samples; ++i)
+                size_t ix = 0;
+                while (ix < n_samples)
                 {
-                    dst[i] += playData[this->fgPlaybackIndex++] * volumeDezipperL.Tick();
+                    size_t n = std::min(n_samples - ix, buffer->GetBufferSize() - fgPlaybackIndex);
+                    MixOut(dst + ix, buffer->GetChannel(0) + fgPlaybackIndex, n);
+                    fgPlaybackIndex += n;
+                    playPosition = buffer->GetSourcePosition(fgPlaybackIndex);
+                    ix += n;
 
-                    ++this->playPosition;
                     if (fgPlaybackIndex == buffer->GetBufferSize())
                     {
                         fgPlaybackIndex = 0;
@@ -1731,12 +1986,17 @@ void Lv2AudioFileProcessor::Play(float *dst, size_t n_samples)
                         bufferPool->PutBuffer(buffer);
                         if (fgPlaybackQueue.empty())
                         {
+                            if (this->fgLoopType == LoopType::BigLoop)
+                            {
+                                OnUnderrunError();
+                                return;
+                            }
                             SetState(ProcessorState::Idle);
                             CuePlayback();
                             break;
                         }
                         buffer = fgPlaybackQueue.front();
-                        playData = buffer->GetChannel(0);
+                        playPosition = buffer->GetSourcePosition(0);
 
                         fgRequestNextPlayBuffer();
                     }
@@ -1747,68 +2007,44 @@ void Lv2AudioFileProcessor::Play(float *dst, size_t n_samples)
         {
             if (fgLoopBuffer.Get() != nullptr)
             {
-                float *playData = fgLoopBuffer->GetChannel(0);
-
-                for (uint32_t i = 0; i < n_samples; ++i)
-                {
-                    float value;
-                    if (playPosition >= fgLoopControlInfo.loopEnd_0)
-                    {
-                        if (playPosition >= fgLoopControlInfo.loopEnd_1)
-                        {
-                            // loop point reached.
-                            playPosition = playPosition - fgLoopControlInfo.loopSize;
-                            value = playData[playPosition - fgLoopControlInfo.loopOffset];
-                            if (playPosition >= fgLoopControlInfo.loopBufferSize - fgLoopControlInfo.loopOffset)
-                            {
-                                throw std::logic_error("Play position out of bounds.");
-                            }
-                        }
-                        else
-                        {
-                            // blend data across the loop point
-                            size_t blendIndex = playPosition - fgLoopControlInfo.loopSize;
-                            float v0 = playData[blendIndex - fgLoopControlInfo.loopOffset];
-                            float v1 = playData[playPosition - fgLoopControlInfo.loopOffset];
-                            size_t t = playPosition - fgLoopControlInfo.loopEnd_0;
-                            float blendFactor = (float)t / (float)(fgLoopControlInfo.loopEnd_1 - fgLoopControlInfo.loopEnd_0);
-                            value = v0 * (1.0f - blendFactor) + v1 * blendFactor;
-                        }
-                    }
-                    else
-                    {
-                        value = playData[playPosition - fgLoopControlInfo.loopOffset];
-                    }
-                    dst[i] += value * volumeDezipperL.Tick();
-                    ++this->playPosition;
-                }
-            }
-        }
-        else if (fgLoopType == LoopType::BigLoop)
-        {
-            if (fgLoopBuffer.Get() != nullptr)
-            {
-                float *playData = fgLoopBuffer->GetChannel(0);
+                const float *playData = fgLoopBuffer->GetChannel(0);
+                const LoopControlInfo &loop = fgLoopControlInfo;
 
-                for (uint32_t i = 0; i < n_samples; ++i)
+                size_t ix = 0;
+                while (ix < n_samples)
                 {
-                    float value;
-                    if (playPosition >= fgLoopControlInfo.loopEnd_1)
+                    if (playPosition >= loop.loopEnd_1)
                     {
                         // loop point reached.
-                        playPosition = playPosition - fgLoopControlInfo.loopSize;
-                        value = playData[playPosition - fgLoopControlInfo.loopOffset];
-                        if (playPosition >= fgLoopControlInfo.loopBufferSize - fgLoopControlInfo.loopOffset)
+                        playPosition = playPosition - loop.loopSize;
+                        if (playPosition - loop.loopOffset >= loop.loopBufferSize)
                         {
                             throw std::logic_error("Play position out of bounds.");
                         }
                     }
+                    if (playPosition < loop.loopEnd_0)
+                    {
+                        size_t n = std::min(n_samples - ix, loop.loopEnd_0 - playPosition);
+                        MixOut(dst + ix, playData + (playPosition - loop.loopOffset), n);
+                        ix += n;
+                        playPosition += n;
+                    }
                     else
                     {
-                        value = playData[playPosition - fgLoopControlInfo.loopOffset];
+                        // blend data across the loop point
+                        float blendBuffer[MIX_CHUNK_SIZE];
+                        size_t n = std::min(std::min(n_samples - ix, loop.loopEnd_1 - playPosition), MIX_CHUNK_SIZE);
+                        float dt = 1.0f / (float)(loop.loopEnd_1 - loop.loopEnd_0);
+                        float t0 = (float)(playPosition - loop.loopEnd_0) * dt;
+                        MixKernels::LinearCrossfade(
+                            blendBuffer,
+                            playData + (playPosition - loop.loopOffset),
+                            playData + (playPosition - loop.loopSize - loop.loopOffset),
+                            t0, dt, n);
+                        MixOut(dst + ix, blendBuffer, n);
+                        ix += n;
+                        playPosition += n;
                     }
-                    dst[i] += value * volumeDezipperL.Tick();
-                    ++this->playPosition;
                 }
             }
         }
@@ -1839,16 +2075,19 @@ void Lv2AudioFileProcessor::Play(float *dstL, float *dstR, size_t n_samples)
                 } else 
                 {
                     auto buffer = this->fgPlaybackQueue.front();
-                    float *playDataL = buffer->GetChannel(0);
-                    float *playDataR = buffer->GetChannel(1);
 
-                    for (; ix < n_samples; ++ix)
+                    while (ix < n_samples)
                     {
-                        dstL[ix] += playDataL[this->fgPlaybackIndex] * volumeDezipperL.Tick();
-                        dstR[ix] += playDataR[this->fgPlaybackIndex] * volumeDezipperR.Tick();
-                        this->fgPlaybackIndex++;
+                        size_t n = std::min(n_samples - ix, buffer->GetBufferSize() - fgPlaybackIndex);
+                        MixOut(
+                            dstL + ix, dstR + ix,
+                            buffer->GetChannel(0) + fgPlaybackIndex,
+                            buffer->GetChannel(1) + fgPlaybackIndex,
+                            n);
+                        fgPlaybackIndex += n;
+                        playPosition = buffer->GetSourcePosition(fgPlaybackIndex);
+                        ix += n;
 
-                        ++this->playPosition;
                         if (fgPlaybackIndex == buffer->GetBufferSize())
                         {
                             fgPlaybackIndex = 0;
@@ -1862,8 +2101,6 @@ void Lv2AudioFileProcessor::Play(float *dstL, float *dstR, size_t n_samples)
                                 break;
                             }
                             buffer = fgPlaybackQueue.front();
-                            playDataL = buffer->GetChannel(0);
-                            playDataR = buffer->GetChannel(1);
 
                             fgRequestNextPlayBuffer();
                         }
@@ -1872,161 +2109,98 @@ void Lv2AudioFileProcessor::Play(float *dstL, float *dstR, size_t n_samples)
             }
             else if (loopType == LoopType::SmallLoop)
             {
-                if (fgLoopBuffer.Get() != nullptr)
+                if (fgLoopBuffer.Get() == nullptr)
                 {
-                    float *playDataL = fgLoopBuffer->GetChannel(0);
-                    float *playDataR = fgLoopBuffer->GetChannel(1);
+                    break;
+                }
+                const float *playDataL = fgLoopBuffer->GetChannel(0);
+                const float *playDataR = fgLoopBuffer->GetChannel(1);
+                const LoopControlInfo &loop = fgLoopControlInfo;
 
-                    for (; ix < n_samples; ++ix)
+                while (ix < n_samples)
+                {
+                    if (playPosition >= loop.loopEnd_1)
                     {
-                        float valueL, valueR;
-                        if (playPosition >= fgLoopControlInfo.loopEnd_0)
+                        /// loop point reached.
+                        playPosition = playPosition - loop.loopSize;
+                        if (playPosition - loop.loopOffset >= loop.loopBufferSize)
                         {
-                            if (playPosition >= fgLoopControlInfo.loopEnd_1)
-                            {
-                                /// loop point reached.
-                                playPosition = playPosition - fgLoopControlInfo.loopSize;
-                                if (playPosition - fgLoopControlInfo.loopOffset >= fgLoopControlInfo.loopBufferSize)
-                                {
-                                    throw std::logic_error("Play position out of bounds.");
-                                }
-                                valueL = playDataL[playPosition - fgLoopControlInfo.loopOffset];
-                                valueR = playDataR[playPosition - fgLoopControlInfo.loopOffset];
-                            }
-                            else
-                            {
-                                // blend data across the loop point.
-                                size_t blendIndex = playPosition - fgLoopControlInfo.loopEnd + fgLoopControlInfo.loopStart;
-                                float blendFactor = (float)(playPosition - fgLoopControlInfo.loopEnd_0) / (float)(fgLoopControlInfo.loopEnd_1 - fgLoopControlInfo.loopEnd_0);
-
-                                float v1L = playDataL[blendIndex - fgLoopControlInfo.loopOffset];
-                                float v0L = playDataL[playPosition - fgLoopControlInfo.loopOffset];
-                                valueL = v0L * (1.0f - blendFactor) + v1L * blendFactor;
-
-                                float v1R = playDataR[blendIndex - fgLoopControlInfo.loopOffset];
-                                float v0R = playDataR[playPosition - fgLoopControlInfo.loopOffset];
-                                valueR = v0R * (1.0f - blendFactor) + v1R * blendFactor;
-                            }
-                        }
-                        else
-                        {
-                            valueL = playDataL[playPosition - fgLoopControlInfo.loopOffset];
-                            valueR = playDataR[playPosition - fgLoopControlInfo.loopOffset];
+                            throw std::logic_error("Play position out of bounds.");
                         }
-                        dstL[ix] += valueL * volumeDezipperL.Tick();
-                        dstR[ix] += valueR * volumeDezipperR.Tick();
-                        ++this->playPosition;
+                    }
+                    if (playPosition < loop.loopEnd_0)
+                    {
+                        size_t n = std::min(n_samples - ix, loop.loopEnd_0 - playPosition);
+                        MixOut(
+                            dstL + ix, dstR + ix,
+                            playDataL + (playPosition - loop.loopOffset),
+                            playDataR + (playPosition - loop.loopOffset),
+                            n);
+                        ix += n;
+                        playPosition += n;
+                    }
+                    else
+                    {
+                        // blend data across the loop point.
+                        float blendL[MIX_CHUNK_SIZE];
+                        float blendR[MIX_CHUNK_SIZE];
+                        size_t n = std::min(std::min(n_samples - ix, loop.loopEnd_1 - playPosition), MIX_CHUNK_SIZE);
+
+                        size_t blendIndex = playPosition - loop.loopEnd + loop.loopStart;
+                        float dt = 1.0f / (float)(loop.loopEnd_1 - loop.loopEnd_0);
+                        float t0 = (float)(playPosition - loop.loopEnd_0) * dt;
+
+                        MixKernels::LinearCrossfade(
+                            blendL,
+                            playDataL + (playPosition - loop.loopOffset),
+                            playDataL + (blendIndex - loop.loopOffset),
+                            t0, dt, n);
+                        MixKernels::LinearCrossfade(
+                            blendR,
+                            playDataR + (playPosition - loop.loopOffset),
+                            playDataR + (blendIndex - loop.loopOffset),
+                            t0, dt, n);
+                        MixOut(dstL + ix, dstR + ix, blendL, blendR, n);
+                        ix += n;
+                        playPosition += n;
                     }
                 }
             }
             else if (loopType == LoopType::BigLoop || loopType == LoopType::BigStartSmallLoop)
             {
+                // Streamed loops arrive with loop wraps and crossfades already applied by the
+                // background reader, so this is plain buffer playback up to the start of the small loop.
                 if (this->fgPlaybackQueue.empty())
                 {
                     OnUnderrunError();
                     return;
                 }
                 auto buffer = this->fgPlaybackQueue.front();
-                float *playDataL = buffer->GetChannel(0);
-                float *playDataR = buffer->GetChannel(1);
 
-                for (; ix < n_samples; ++ix)
+                size_t n = std::min(n_samples - ix, buffer->GetBufferSize() - fgPlaybackIndex);
+                if (loopType == LoopType::BigStartSmallLoop)
                 {
-                    float vLeft, vRight;
-
-                    if (playPosition == fgLoopControlInfo.loopStart && loopType == LoopType::BigStartSmallLoop)
-                    {
-                        break; // switch over to small loop processing.
-                    }
-                    if (fgPlaybackIndex == buffer->GetBufferSize())
+                    n = std::min(n, fgLoopControlInfo.loopStart - playPosition);
+                }
+                MixOut(
+                    dstL + ix, dstR + ix,
+                    buffer->GetChannel(0) + fgPlaybackIndex,
+                    buffer->GetChannel(1) + fgPlaybackIndex,
+                    n);
+                fgPlaybackIndex += n;
+                playPosition = buffer->GetSourcePosition(fgPlaybackIndex);
+                ix += n;
+
+                if (fgPlaybackIndex == buffer->GetBufferSize())
+                {
+                    fgPlaybackIndex = 0;
+                    fgPlaybackQueue.pop_front();
+                    bufferPool->PutBuffer(buffer);
+                    if (!fgPlaybackQueue.empty())
                     {
-                        fgPlaybackIndex = 0;
-                        fgPlaybackQueue.pop_front();
-                        bufferPool->PutBuffer(buffer);
-                        if (fgPlaybackQueue.empty())
-                        {
-                            OnUnderrunError();
-                            return;
-                        }
-                        buffer = fgPlaybackQueue.front();
-                        playDataL = buffer->GetChannel(0);
-                        playDataR = buffer->GetChannel(1);
-
+                        playPosition = fgPlaybackQueue.front()->GetSourcePosition(0);
                         fgRequestNextPlayBuffer();
                     }
-
-                    if (playPosition >= fgLoopControlInfo.loopEnd_0)
-                    {
-                        if (playPosition >= fgLoopControlInfo.loopEnd_1)
-                        {
-                            // loop point reached.
-                            playPosition = playPosition - fgLoopControlInfo.loopSize;
-                            if (playPosition >= fgLoopControlInfo.loopEnd_0)
-                            {
-                                throw std::logic_error("Play position out of bounds.");
-                            }
-                            if (playPosition >= fgLoopControlInfo.loopEnd_0)
-                            {
-                                throw std::logic_error("Play position out of bounds.");
-                            }
-
-                            vLeft = playDataL[this->fgPlaybackIndex];
-                            vRight = playDataR[this->fgPlaybackIndex];
-                            this->fgPlaybackIndex++;
-                        }
-                        else
-                        {
-                            if (playPosition == fgLoopControlInfo.loopEnd_0)
-                            {
-                                // fill the blend buffers with the loop end data.
-                                bgReader.blendBufferL.resize(0);
-                                bgReader.blendBufferR.resize(0);
-                                for (size_t j = fgLoopControlInfo.loopEnd_0; j < fgLoopControlInfo.loopEnd_1; ++j)
-                                {
-                                    bgReader.blendBufferL.push_back(playDataL[this->fgPlaybackIndex]);
-                                    bgReader.blendBufferR.push_back(playDataR[this->fgPlaybackIndex]);
-                                    ++fgPlaybackIndex;
-                                    if (fgPlaybackIndex == buffer->GetBufferSize())
-                                    {
-                                        fgPlaybackIndex = 0;
-                                        fgPlaybackQueue.pop_front();
-                                        bufferPool->PutBuffer(buffer);
-                                        if (fgPlaybackQueue.empty())
-                                        {
-                                            OnUnderrunError();
-                                            return;
-                                        }
-                                        buffer = fgPlaybackQueue.front();
-                                        playDataL = buffer->GetChannel(0);
-                                        playDataR = buffer->GetChannel(1);
-
-                                        fgRequestNextPlayBuffer();
-                                    }
-                                }
-                            }
-                            // blend data across the loop point.
-                            size_t blendIndex = playPosition - fgLoopControlInfo.loopEnd_0;
-                            float blendFactor = (float)(playPosition - fgLoopControlInfo.loopEnd_0) / (float)(fgLoopControlInfo.loopEnd_1 - fgLoopControlInfo.loopEnd_0);
-                            float v0L = bgReader.blendBufferL[blendIndex];
-                            float v1L = playDataL[this->fgPlaybackIndex];
-                            vLeft = v0L * (1.0f - blendFactor) + v1L * blendFactor;
-                            float v0R = bgReader.blendBufferR[blendIndex];
-                            float v1R = playDataR[this->fgPlaybackIndex];
-                            vRight = v0R * (1.0f - blendFactor) + v1R * blendFactor;
-
-                            ++fgPlaybackIndex;
-                        }
-                    }
-                    else
-                    {
-                        vLeft = playDataL[this->fgPlaybackIndex];
-                        vRight = playDataR[this->fgPlaybackIndex];
-                        this->fgPlaybackIndex++;
-                    }
-
-                    dstL[ix] += vLeft * volumeDezipperL.Tick();
-                    dstR[ix] += vRight * volumeDezipperR.Tick();
-                    ++this->playPosition;
                 }
             }
         }
@@ -2045,21 +2219,23 @@ void Lv2AudioFileProcessor::Record(const float *src, float level, size_t n_sampl
         this->realtimeWriteIndex = 0;
     }
     this->playPosition += n_samples;
-    float *buffer = this->realtimeRecordBuffer->GetChannel(0);
 
-    for (size_t i = 0; i < n_samples; ++i)
+    size_t ix = 0;
+    while (ix < n_samples)
     {
-        auto value = src[i];
-        value *= level;
+        size_t n = std::min(n_samples - ix, this->realtimeRecordBuffer->GetBufferSize() - this->realtimeWriteIndex);
+        MixKernels::Gain(
+            this->realtimeRecordBuffer->GetChannel(0) + this->realtimeWriteIndex,
+            src + ix,
+            level, n);
+        this->realtimeWriteIndex += n;
+        ix += n;
 
-        buffer[this->realtimeWriteIndex] = value;
-        this->realtimeWriteIndex++;
         if (this->realtimeWriteIndex >= this->realtimeRecordBuffer->GetBufferSize())
         {
             SendBufferToBackground();
 
             this->realtimeRecordBuffer.attach(this->bufferPool->TakeBuffer());
-            buffer = this->realtimeRecordBuffer->GetChannel(0);
             this->realtimeWriteIndex = 0;
         }
     }
@@ -2076,25 +2252,27 @@ void Lv2AudioFileProcessor::Record(const float *srcL, const float *srcR, float l
         this->realtimeWriteIndex = 0;
     }
     this->playPosition += n_samples;
-    float *bufferL = this->realtimeRecordBuffer->GetChannel(0);
-    float *bufferR = this->realtimeRecordBuffer->GetChannel(1);
 
-    for (size_t i = 0; i < n_samples; ++i)
-    {
-        auto valueL = srcL[i] * level;
-        auto valueR = srcR[i] * level;
-
-        bufferL[this->realtimeWriteIndex] = valueL;
-        bufferR[this->realtimeWriteIndex] = valueR;
-        this->realtimeWriteIndex++;
+    size_t ix = 0;
+    while (ix < n_samples)
+    {
+        size_t n = std::min(n_samples - ix, this->realtimeRecordBuffer->GetBufferSize() - this->realtimeWriteIndex);
+        MixKernels::Gain(
+            this->realtimeRecordBuffer->GetChannel(0) + this->realtimeWriteIndex,
+            srcL + ix,
+            level, n);
+        MixKernels::Gain(
+            this->realtimeRecordBuffer->GetChannel(1) + this->realtimeWriteIndex,
+            srcR + ix,
+            level, n);
+        this->realtimeWriteIndex += n;
+        ix += n;
 
         if (this->realtimeWriteIndex >= this->realtimeRecordBuffer->GetBufferSize())
         {
             SendBufferToBackground();
 
             this->realtimeRecordBuffer.attach(this->bufferPool->TakeBuffer());
-            bufferL = this->realtimeRecordBuffer->GetChannel(0);
-            bufferR = this->realtimeRecordBuffer->GetChannel(1);
             this->realtimeWriteIndex = 0;
         }
     }
@@ -2256,24 +2434,18 @@ void Lv2AudioFileProcessor::SetDbVolume(float db, float pan, bool immediate)
     volumeDezipperR.To(afRight, slew);
 }
 
-void BgFileReader::PrepareLookaheadDecoderStream()
+void Lv2AudioFileProcessor::SetPlaybackRate(float speed, float pitch)
 {
-    if (loopControlInfo.loopType != LoopType::BigLoop) 
+    if (speed == this->playbackSpeed && pitch == this->playbackPitch)
     {
-        throw std::logic_error("PrepareLookaheadDecoderStream called with invalid loop type.");
+        return;
     }
-    // prepare the next stream, so that  it cues up asynchronously.
-    if (!useTestData)
+    this->playbackSpeed = speed;
+    this->playbackPitch = pitch;
+    if (activated)
     {
-        nextDecoderStream = std::make_unique<FfmpegDecoderStream>();
-        this->lookaheadPosition = this->loopControlInfo.loopEnd_1 -
-                this->loopControlInfo.loopSize -
-                (this->loopControlInfo.loopEnd_1 - this->loopControlInfo.loopEnd_0);
-        nextDecoderStream->open(
-            this->filePath, 
-            this->channels, 
-            this->sampleRate,
-            lookaheadPosition / sampleRate);
+        SetPlaybackRateMessage cmd{speed, pitch};
+        this->toBackgroundQueue.write_packet(sizeof(cmd), (uint8_t *)&cmd);
     }
 }
 
@@ -2309,8 +2481,16 @@ void BgFileReader::Init(
             // if the seek position is before the loop start, then we need to seek to the loop start.
             seekPosSeconds = loopParameters_.start_;
         }
+        this->readPos = (size_t)std::round(seekPosSeconds * sampleRate);
 
         decoderStreamOpen(filename, channels, (uint32_t)sampleRate, seekPosSeconds);
+
+        if (playbackSpeed != 1.0 || playbackPitch != 1.0)
+        {
+            phaseVocoder = std::make_unique<LsNumerics::PhaseVocoder>(channels >= 2 ? 2 : 1);
+            phaseVocoder->SetRate(playbackSpeed, playbackPitch);
+            stretchedSourcePos = (double)this->readPos;
+        }
     }
     else if (loopType == LoopType::SmallLoop)
     {
@@ -2326,6 +2506,31 @@ void BgFileReader::Init(
         }
         this->readPos = (size_t)std::round(seekPosSeconds * sampleRate);
 
+        if (loopType == LoopType::BigLoop)
+        {
+            loopRegion.Init(
+                channels,
+                loopControlInfo.loopEnd_0,
+                loopControlInfo.loopEnd_1,
+                loopControlInfo.loopSize,
+                (size_t)(MAX_LOOP_REGION_SECONDS * sampleRate));
+            while (this->readPos >= loopRegion.GetLoopEnd())
+            {
+                this->readPos -= loopRegion.GetLoopSize();
+            }
+            if (this->readPos > loopRegion.GetRegionStart())
+            {
+                // Starting inside the loop. Capture the fade-in material for the loop-point crossfade
+                // (short); the rest of the loop is captured as it streams, on the next pass.
+                FillLoopRegion(std::min(this->readPos, loopRegion.GetRingStart()));
+                if (loopRegion.GetCachedEnd() == this->readPos)
+                {
+                    return; // continue streaming from where the fill left off.
+                }
+            }
+            seekPosSeconds = this->readPos / sampleRate;
+        }
+
         decoderStreamOpen(filename, channels, (uint32_t)sampleRate, seekPosSeconds);
     }
     else
@@ -2334,6 +2539,30 @@ void BgFileReader::Init(
     }
 }
 
+void BgFileReader::FillLoopRegion(size_t endPosition)
+{
+    size_t position = loopRegion.GetRegionStart();
+    endPosition = std::min(endPosition, loopRegion.GetLoopEnd());
+
+    decoderStreamOpen(this->filePath, this->channels, (uint32_t)this->sampleRate, position / this->sampleRate);
+
+    std::vector<float> scratchL(bufferSize);
+    std::vector<float> scratchR(bufferSize);
+    float *buffers[2]{scratchL.data(), channels >= 2 ? scratchR.data() : nullptr};
+
+    while (position < endPosition && position == loopRegion.GetCachedEnd())
+    {
+        size_t thisTime = std::min(bufferSize, endPosition - position);
+        size_t nRead = decoderStreamRead(buffers, thisTime);
+        if (nRead == 0)
+        {
+            break;
+        }
+        loopRegion.Write(position, buffers, nRead);
+        position += nRead;
+    }
+}
+
 toob::AudioFileBuffer::ptr BgFileReader::ReadLoopBuffer(
     const std::string &filename,
     int channels,
@@ -2457,6 +2686,8 @@ void Lv2AudioFileProcessor::Play()
 
 void BgFileReader::Close()
 {
+    phaseVocoder.reset();
+    loopRegion.Clear();
     if (this->decoderStream)
     {
         this->decoderStream->close();
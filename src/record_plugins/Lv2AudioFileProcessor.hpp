@@ -36,6 +36,9 @@
 #include <vector>
 #include <string>
 #include "FfmpegDecoderStream.hpp"
+#include "AudioFilePeaks.hpp"
+#include "AudioFileLoopRegion.hpp"
+#include "../LsNumerics/PhaseVocoder.hpp"
 #include "../ControlDezipper.h"
 
 class Lv2AudioFileProcessorTest;
@@ -168,6 +171,9 @@ namespace toob
         virtual void OnFgLoopJsonChanged(const char*loopJson) = 0;
         virtual std::string bgGetLoopJson(const std::string &filePath) = 0;
         virtual void bgSaveLoopJson(const std::string &filePath, const std::string &loopJson) = 0;
+        // waveformJson is in the format produced by AudioFilePeaks::GetOverviewJson(), or "" if
+        // no overview is available yet.
+        virtual void OnFgWaveformChanged(const char *waveformJson) = 0;
     };
 
     class BgFileReader
@@ -193,10 +199,14 @@ namespace toob
             int channels,
             double sampleRate,
             const LoopControlInfo &loopControlInfo);
-        void PrepareLookaheadDecoderStream();
         toob::AudioFileBuffer *NextBuffer(
             toob::AudioFileBufferPool *bufferPool);
 
+        // Time-stretch and pitch-shift for unlooped playback. Takes effect at the next Init().
+        void SetPlaybackRate(double speed, double pitch);
+        // Change the rate of the stream that is currently playing, without re-cueing.
+        void ChangePlaybackRate(double speed, double pitch);
+
 
         void Test_SetFileData(
             std::vector<float> &&testDataL,
@@ -217,15 +227,24 @@ namespace toob
         double duration = 0.0;
 
         std::unique_ptr<toob::FfmpegDecoderStream> decoderStream;
-        size_t lookaheadPosition = 0;
-        std::unique_ptr<toob::FfmpegDecoderStream> nextDecoderStream;
 
         LoopType loopType = LoopType::None;
         size_t originalSeekPosForLoop = 0; // original seek position before looping.
         size_t readPos = 0;
         size_t operationId = 0;
-        std::vector<float> blendBufferL;
-        std::vector<float> blendBufferR;
+
+        // Loops longer than this are only partially cached, and stream the remainder on each pass.
+        static constexpr double MAX_LOOP_REGION_SECONDS = 120.0;
+        AudioFileLoopRegion loopRegion;
+        void FillLoopRegion(size_t endPosition);
+
+        double playbackSpeed = 1.0;
+        double playbackPitch = 1.0;
+        std::unique_ptr<LsNumerics::PhaseVocoder> phaseVocoder;
+        double stretchedSourcePos = 0;
+        std::vector<float> stretchInputL;
+        std::vector<float> stretchInputR;
+        toob::AudioFileBuffer *NextStretchedBuffer(toob::AudioFileBufferPool *bufferPool);
 
         bool useTestData = false;
         size_t testReadIndex = std::numeric_limits<size_t>::max();
@@ -313,15 +332,26 @@ namespace toob
         const std::string &GetPath() const { return filePath; }
         void SetPath(const char *path);
         void SetDbVolume(float db, float pan = 0, bool immediate = false);
+
+        // speed: 0.5 = half speed. pitch: frequency ratio. Streamed (unlooped) playback only.
+        // Changes the rate of the stream that is already playing, after the pre-roll buffers.
+        void SetPlaybackRate(float speed, float pitch);
         float GetDbVolume() const { return dbVolume; };
         float GetPan() const { return pan; }
 
     private:
         float dbVolume = 0.0f;
         float pan = 0.0f;
+        float playbackSpeed = 1.0f;
+        float playbackPitch = 1.0f;
         toob::ControlDezipper volumeDezipperL;
         toob::ControlDezipper volumeDezipperR;
 
+        static constexpr size_t MIX_CHUNK_SIZE = 64;
+        // Mix source samples into the output, applying volume and pan.
+        void MixOut(float *dst, const float *src, size_t n_samples);
+        void MixOut(float *dstL, float *dstR, const float *srcL, const float *srcR, size_t n_samples);
+
         std::string filePath;
 
         void SendBufferToBackground();
@@ -395,6 +425,23 @@ namespace toob
         void bgStopPlaying();
         void bgError(const char *message);
 
+        static constexpr size_t WAVEFORM_POINTS = 256;
+        void bgSendWaveform(uint64_t operationId, const AudioFilePeaks *peaks);
+        std::filesystem::path bgPeaksPath;
+        AudioFilePeaks::ptr bgPeaks;
+
+        // Files without a cached peak overview are scanned on the background thread, one
+        // chunk at a time in between background messages, so the scan never delays playback.
+        static constexpr size_t PEAK_SCAN_CHUNK_FRAMES = 16384;
+        void bgStartPeakScan(const std::filesystem::path &filename);
+        void bgPeakScanStep();
+        void bgCancelPeakScan();
+        std::filesystem::path bgPeakScanPath;
+        std::unique_ptr<toob::FfmpegDecoderStream> bgPeakDecoder;
+        std::unique_ptr<AudioFilePeakBuilder> bgPeakBuilder;
+        std::vector<float> bgPeakScanL;
+        std::vector<float> bgPeakScanR;
+
         std::shared_ptr<toob::AudioFileBufferPool> bufferPool;
         toob::AudioFileBuffer::ptr realtimeRecordBuffer;
         size_t realtimeWriteIndex = 0;
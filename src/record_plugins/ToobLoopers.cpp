@@ -28,10 +28,14 @@
 #include <thread>
 #include <iostream>
 #include "FfmpegDecoderStream.hpp"
+#include "../LsNumerics/MixKernels.hpp"
+#include "../ThreadManager.hpp"
+#include "../LsNumerics/Denorms.hpp"
 
 // using namespace lv2c::lv2_plugin;
 
 using namespace toob;
+using namespace LsNumerics;
 
 static constexpr float TRANSITION_TIME_SEC = 0.003f;
 static constexpr float TRIGGER_LEAD_TIME = 0.001f;
@@ -158,6 +162,7 @@ ToobLooperFour::ToobLooperFour(
         loops[i].plugin = this;
         loops[i].sampleRate = rate;
     }
+    cpuLoadMeter.SetSampleRate(rate);
 }
 ToobLooperOne::ToobLooperOne(
     double rate,
@@ -179,6 +184,7 @@ ToobLooperOne::ToobLooperOne(
     activeLoops = 1;
 
     this->isStereo = channels > 1;
+    cpuLoadMeter.SetSampleRate(rate);
 }
 
 void ToobLooperOne::PushLoop()
@@ -217,6 +223,7 @@ void ToobLooperFour::Activate()
         [this]()
         {
         try {
+        toob::ThreadManager::Get().ConfigureCurrentThread(toob::ThreadRole::LooperBackground);
         bool quit = false;
 
         std::vector<uint8_t> buffer (2048);
@@ -733,8 +740,27 @@ void ToobLooperFour::HandleTriggers()
     }
 }
 
+void ToobLooperFour::ConnectPort(uint32_t port, void *data)
+{
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobLooperFour::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
     const float *in = this->in.Get();
     const float *inR = this->inR.Get();
 
@@ -760,8 +786,27 @@ void ToobLooperFour::Run(uint32_t n_samples)
     UpdateOutputControls(n_samples);
 }
 
+void ToobLooperOne::ConnectPort(uint32_t port, void *data)
+{
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobLooperOne::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
 
     inputTrigger.ThresholdDb(trigger_level.GetDb());
     inputTrigger.Run(in.Get(), inR.Get(), n_samples);
@@ -791,11 +836,8 @@ void ToobLooperEngine::Mix(
     float *__restrict dst,
     float *__restrict dstR)
 {
-    for (uint32_t i = 0; i < n_samples; ++i)
-    {
-        dst[i] = src[i];
-        dstR[i] = srcR[i];
-    }
+    MixKernels::Copy(dst, src, n_samples);
+    MixKernels::Copy(dstR, srcR, n_samples);
 
     for (size_t i = 0; i < loops.size(); ++i)
     {
@@ -803,11 +845,8 @@ void ToobLooperEngine::Mix(
     }
 
     float lvl = getOutputLevel();
-    for (size_t i = 0; i < n_samples; ++i)
-    {
-        dst[i] *= lvl;
-        dstR[i] *= lvl;
-    }
+    MixKernels::Scale(dst, lvl, n_samples);
+    MixKernels::Scale(dstR, lvl, n_samples);
 }
 
 void ToobLooperFour::Deactivate()
@@ -1287,19 +1326,31 @@ void ToobLooperEngine::Loop::process(
         {
             while (index < n_samples)
             {
-                float recordLevel = this->recordLevel.Tick();
-                float playLevel = this->playbackLevel.Tick();
-                float &vLeft = atL(play_cursor);
-                float &vRight = atR(play_cursor);
-                outL[index] += playLevel * vLeft;
-                outR[index] += playLevel * vRight;
-                float left = inL[index];
-                float right = inL[index];
-                vLeft += recordLevel * left;
-                vRight += recordLevel * right;
-
-                play_cursor++;
-                index++;
+                // process runs that are contiguous in the loop buffers, and linear in both levels.
+                size_t n = contiguousLength(play_cursor, n_samples - index);
+                if (this->length > play_cursor)
+                {
+                    n = std::min(n, this->length - play_cursor);
+                }
+                n = this->recordLevel.RampLength(n);
+                n = this->playbackLevel.RampLength(n);
+
+                float *vLeft = &atL(play_cursor);
+                float *vRight = &atR(play_cursor);
+
+                MixKernels::StereoPanRampAccumulate(
+                    outL + index, outR + index,
+                    vLeft, vRight,
+                    playbackLevel.RampStart(), playbackLevel.RampDx(),
+                    playbackLevel.RampStart(), playbackLevel.RampDx(),
+                    n);
+                MixKernels::MixAccumulateRamp(vLeft, inL + index, recordLevel.RampStart(), recordLevel.RampDx(), n);
+                MixKernels::MixAccumulateRamp(vRight, inR + index, recordLevel.RampStart(), recordLevel.RampDx(), n);
+                playbackLevel.Skip(n);
+                recordLevel.Skip(n);
+
+                play_cursor += n;
+                index += n;
                 if (play_cursor >= this->length)
                 {
                     play_cursor = 0;
@@ -1404,11 +1455,15 @@ void ToobLooperEngine::Loop::fadeHead()
     size_t nSamples = std::min(this->declickSamples, this->length);
     if (nSamples == 0)
         return;
-    for (size_t i = 0; i < nSamples; ++i)
+    float dFade = 1.0f / (float)nSamples;
+    size_t i = 0;
+    while (i < nSamples)
     {
-        float fade = (float)i / (float)nSamples;
-        atL(i) *= fade;
-        atR(i) *= fade;
+        size_t n = contiguousLength(i, nSamples - i);
+        float fade = i * dFade;
+        MixKernels::ScaleRamp(&atL(i), fade, dFade, n);
+        MixKernels::ScaleRamp(&atR(i), fade, dFade, n);
+        i += n;
     }
 }
 void ToobLooperEngine::Loop::fadeTail()
@@ -1416,13 +1471,17 @@ void ToobLooperEngine::Loop::fadeTail()
     size_t nSamples = std::min(this->declickSamples, this->length);
     if (nSamples == 0)
         return;
-    for (size_t i = 0; i < nSamples; ++i)
+    float dFade = 1.0f / (float)nSamples;
+    size_t i = 0;
+    while (i < nSamples)
     {
-        float fadeOut = 1.0f - (float)i / (float)nSamples;
         size_t ix = length - nSamples + i;
+        size_t n = contiguousLength(ix, nSamples - i);
+        float fadeOut = 1.0f - i * dFade;
 
-        atL(ix) *= fadeOut;
-        atR(ix) *= fadeOut;
+        MixKernels::ScaleRamp(&atL(ix), fadeOut, -dFade, n);
+        MixKernels::ScaleRamp(&atR(ix), fadeOut, -dFade, n);
+        i += n;
     }
 }
 
@@ -1720,10 +1779,13 @@ void ToobLooperEngine::Loop::CopyInPreTriggerSamples(
 ) {
 
     int32_t inputDelay = (int32_t)this->pre_trigger_samples - (int32_t)inputDelayOffset-1;
-    for (size_t i = 0; i < pre_trigger_samples; ++i)
+    size_t i = 0;
+    while (i < pre_trigger_samples)
     {
-        this->atL(play_cursor+i) = plugin->leftInputDelay.Tap(inputDelay-i);
-        this->atR(play_cursor+i) = plugin->rightInputDelay.Tap(inputDelay-i);
+        size_t n = contiguousLength(play_cursor + i, pre_trigger_samples - i);
+        plugin->leftInputDelay.Read(inputDelay - (int32_t)i, &atL(play_cursor + i), n);
+        plugin->rightInputDelay.Read(inputDelay - (int32_t)i, &atR(play_cursor + i), n);
+        i += n;
     }
 }
 
@@ -1732,28 +1794,47 @@ void ToobLooperEngine::Loop::BlendInPreTriggerSamples(
 ) {
 
     int32_t inputDelay = (int32_t)this->pre_trigger_samples + (int32_t)pre_trigger_blend_samples - (int32_t)inputDelayOffset - 1;
-    float blend = 0;
     float dBlend = 1.0f/pre_trigger_blend_samples;
     int64_t outX = (int64_t)play_cursor-this->pre_trigger_blend_samples - this->pre_trigger_samples;
     while (outX < 0) {
         outX += length;
     }
-    for (size_t i = 0; i < pre_trigger_blend_samples; ++i) 
-    {
-        this->atL(outX) += blend*plugin->leftInputDelay.Tap(inputDelay);
-        this->atR(outX) += blend*plugin->rightInputDelay.Tap(inputDelay);
-        ++outX;
-        if (outX > (int64_t)length) outX -= length;
-        --inputDelay;
-        blend += dBlend;
-    }
-    for (size_t i = 0; i < pre_trigger_samples; ++i)
+
+    // Fade in over the blend samples, and then full level for the pre-trigger samples.
+    constexpr size_t CHUNK_SIZE = 64;
+    float tapL[CHUNK_SIZE];
+    float tapR[CHUNK_SIZE];
+
+    size_t totalSamples = pre_trigger_blend_samples + pre_trigger_samples;
+    size_t i = 0;
+    while (i < totalSamples)
     {
-        this->atL(outX) += plugin->leftInputDelay.Tap(inputDelay);
-        this->atR(outX) += plugin->rightInputDelay.Tap(inputDelay);
-        ++outX;
-        if (outX > (int64_t)length) outX -= length;
-        --inputDelay;
+        if (outX >= (int64_t)length) outX -= length;
+
+        size_t n = std::min(CHUNK_SIZE, totalSamples - i);
+        n = std::min(n, (size_t)(length - outX));
+        if (i < pre_trigger_blend_samples)
+        {
+            n = std::min(n, pre_trigger_blend_samples - i);
+        }
+        n = contiguousLength(outX, n);
+
+        plugin->leftInputDelay.Read(inputDelay, tapL, n);
+        plugin->rightInputDelay.Read(inputDelay, tapR, n);
+        if (i < pre_trigger_blend_samples)
+        {
+            float blend = i * dBlend;
+            MixKernels::MixAccumulateRamp(&atL(outX), tapL, blend, dBlend, n);
+            MixKernels::MixAccumulateRamp(&atR(outX), tapR, blend, dBlend, n);
+        }
+        else
+        {
+            MixKernels::MixAccumulate(&atL(outX), tapL, 1.0f, n);
+            MixKernels::MixAccumulate(&atR(outX), tapR, 1.0f, n);
+        }
+        outX += n;
+        inputDelay -= (int32_t)n;
+        i += n;
     }
 }
 
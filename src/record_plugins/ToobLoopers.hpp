@@ -43,6 +43,8 @@
 
 #define NO_MLOCK
 #include "ToobRingBuffer.hpp"
+#include "../RtTrace.hpp"
+#include "../CpuLoadMeter.hpp"
 
 using namespace lv2c::lv2_plugin;
 using namespace record_plugin;
@@ -153,6 +155,13 @@ protected:
 			return buffer->GetChannel(1)[bufferIndex];
 		}
 
+		// The number of samples (up to n) that are contiguous in memory starting at index.
+		size_t contiguousLength(size_t index, size_t n) const
+		{
+			size_t remaining = bufferSize - index % bufferSize;
+			return n < remaining ? n : remaining;
+		}
+
 		float &atL(size_t index)
 		{
 			size_t bufferNumber = index / bufferSize;
@@ -345,6 +354,7 @@ protected:
 	void ResetAll();
 	void UndoLoop();
 
+	virtual void ConnectPort(uint32_t port, void *data) override;
 	virtual void Run(uint32_t n_samples) override;
 	void HandleTriggers();
 	void UpdateOutputControls(uint64_t sampleInFrame);
@@ -385,6 +395,8 @@ private:
 		Overdubbing,
 	};
 	toob::ControlDezipper triggerDezipper;
+	RtTraceSource traceSource{"ToobLooperOne"};
+	CpuLoadMeter cpuLoadMeter;
 
 
 	PluginState pluginState = PluginState::Empty;
@@ -414,6 +426,7 @@ public:
 
 	virtual ~ToobLooperFour();
 
+	virtual void ConnectPort(uint32_t port, void *data) override;
 	virtual void Run(uint32_t n_samples) override;
 
 	virtual void Activate() override;
@@ -443,4 +456,7 @@ public:
 
 	void UpdateOutputControls(uint64_t sampleInFrame);
 
+private:
+	RtTraceSource traceSource{"ToobLooperFour"};
+	CpuLoadMeter cpuLoadMeter;
 };
@@ -20,8 +20,12 @@
 #include "lv2/atom/atom.h"
 #include "ToobPlayer.hpp"
 #include "../json.hpp"
+#include "../LsNumerics/MixKernels.hpp"
+#include <cmath>
+#include "../LsNumerics/Denorms.hpp"
 
 using namespace pipedal;
+using namespace LsNumerics;
 
 static float SLOW_RATE = 0.15f;
 
@@ -37,7 +41,9 @@ ToobPlayer::ToobPlayer(double rate,
     urids.atom__String = MapURI(LV2_ATOM__String);
     urids.player__seek_urid = MapURI("http://two-play.com/plugins/toob-player#seek");
     urids.player__loop_urid = MapURI("http://two-play.com/plugins/toob-player#loop");
+    urids.player__waveform_urid = MapURI("http://two-play.com/plugins/toob-player#waveform");
     loopJson.reserve(1024);
+    waveformJson.reserve(2048);
 
     this->fileMetadataFeature = nullptr;
     for (const LV2_Feature *const *feature = features; *feature; ++feature)
@@ -51,6 +57,7 @@ ToobPlayer::ToobPlayer(double rate,
 
     zipInL.SetSampleRate(rate);
     zipInR.SetSampleRate(rate);
+    cpuLoadMeter.SetSampleRate(rate);
 
     // set default values for loop parameters.
     {
@@ -104,8 +111,27 @@ void ToobPlayer::HandleButtons()
     }
 }
 
+void ToobPlayer::ConnectPort(uint32_t port, void *data)
+{
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobPlayer::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
 
     lv2AudioFileProcessor.HandleMessages();
 
@@ -137,11 +163,24 @@ void ToobPlayer::Run(uint32_t n_samples)
     {
         lv2AudioFileProcessor.SetDbVolume(this->volFile.GetDb(), this->panFile.GetValue(), SLOW_RATE);
     }
+    if (speed.HasChanged() || pitch.HasChanged())
+    {
+        UpdatePlaybackRate();
+    }
 
-    for (size_t i = 0; i < n_samples; ++i)
+    for (size_t i = 0; i < n_samples; /**/)
     {
-        outL[i] = zipInL.Tick() * inL[i];
-        outR[i] = zipInR.Tick() * inR[i];
+        size_t n = zipInL.RampLength(n_samples - i);
+        n = zipInR.RampLength(n);
+        MixKernels::StereoPanRamp(
+            outL + i, outR + i,
+            inL + i, inR + i,
+            zipInL.RampStart(), zipInL.RampDx(),
+            zipInR.RampStart(), zipInR.RampDx(),
+            n);
+        zipInL.Skip(n);
+        zipInR.Skip(n);
+        i += n;
     }
 
     lv2AudioFileProcessor.Play(outL,outR,n_samples);
@@ -155,6 +194,11 @@ void ToobPlayer::Run(uint32_t n_samples)
         PutPatchPropertyString(0, urids.player__loop_urid, loopJson.c_str());
         requestLoopJson = false;
     }
+    if (requestWaveformJson)
+    {
+        PutPatchPropertyString(0, urids.player__waveform_urid, waveformJson.c_str());
+        requestWaveformJson = false;
+    }
 }
 
 
@@ -184,6 +228,9 @@ void ToobPlayer::Activate()
         //requestLoopJson = true; // request the loop json to be sent to the UI.
     }
 
+    lv2AudioFileProcessor.SetPlaybackRate(
+        this->speed.GetValue(),
+        std::pow(2.0f, this->pitch.GetValue() / 12.0f));
     lv2AudioFileProcessor.Activate();
     lv2AudioFileProcessor.SetDbVolume(volFile.GetDb(), panFile.GetValue(), true);
 
@@ -196,6 +243,15 @@ void ToobPlayer::Deactivate()
     super::Deactivate();
 }
 
+void ToobPlayer::UpdatePlaybackRate()
+{
+    // The background reader changes the rate of the running stream in place, so this takes
+    // effect once the buffers that are already queued have played.
+    lv2AudioFileProcessor.SetPlaybackRate(
+        this->speed.GetValue(),
+        std::pow(2.0f, this->pitch.GetValue() / 12.0f));
+}
+
 void ToobPlayer::Seek(float value)
 {
     position.SetValue(value); // set the output immediately (no n_samples parameter)
@@ -262,6 +318,11 @@ void ToobPlayer::OnPatchGet(LV2_URID propertyUrid)
         requestLoopJson = true;
         return;
     }
+    if (propertyUrid == urids.player__waveform_urid)
+    {
+        requestWaveformJson = true;
+        return;
+    }
     super::OnPatchGet(propertyUrid);
 }
 const char *ToobPlayer::OnGetPatchPropertyValue(LV2_URID propertyUrid)
@@ -599,5 +660,14 @@ void ToobPlayer::OnFgLoopJsonChanged(const char*loopJson)
     }   
 }
 
+void ToobPlayer::OnFgWaveformChanged(const char*waveformJson)
+{
+    if (strcmp(waveformJson, this->waveformJson.c_str()) != 0)
+    {
+        this->waveformJson = waveformJson;
+        requestWaveformJson = true;
+    }
+}
+
 
 REGISTRATION_DECLARATION PluginRegistration<ToobPlayer> toobPlayerRegistration(ToobPlayer::URI);
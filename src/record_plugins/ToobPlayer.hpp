@@ -29,6 +29,8 @@
 #include "lv2ext/pipedal.lv2/ext/FileMetadataFeature.h"
 
 #include "../ControlDezipper.h"
+#include "../RtTrace.hpp"
+#include "../CpuLoadMeter.hpp"
 
 using namespace lv2c::lv2_plugin;
 using namespace player_plugin;
@@ -59,6 +61,8 @@ protected:
     {
         return lv2AudioFileProcessor.GetState();
     }
+    virtual void ConnectPort(uint32_t port, void *data) override;
+
     virtual void Run(uint32_t n_samples) override;
 
     virtual void Activate() override;
@@ -105,6 +109,7 @@ private:
     virtual std::string bgGetLoopJson(const std::string &filePath) override;
     virtual void bgSaveLoopJson(const std::string &filePath, const std::string &loopJson) override;
     virtual void OnFgLoopJsonChanged(const char*loopJson) override;
+    virtual void OnFgWaveformChanged(const char*waveformJson) override;
 
 
 
@@ -117,6 +122,7 @@ private:
         uint32_t atom__Double;
         uint32_t player__seek_urid;
         uint32_t player__loop_urid;
+        uint32_t player__waveform_urid;
     };
 
     Urids urids;
@@ -126,10 +132,15 @@ private:
     std::string defaultLoopJson;
 
     bool requestLoopJson = false;
+
+    std::string waveformJson;
+    bool requestWaveformJson = false;
     std::atomic<bool> loadRequested = false;
     std::atomic<bool> loopLoadRequested = false;
 
     size_t requestedPlayPosition = 0;
+    RtTraceSource traceSource{"ToobPlayer"};
+    CpuLoadMeter cpuLoadMeter;
 
     void RequestLoad(const char *filename);
 
@@ -137,6 +148,7 @@ private:
     void CuePlayback();
     void CuePlayback(const char *filename, size_t seekPos, bool pauseAfterLoad);
     void Seek(float value);
+    void UpdatePlaybackRate();
 
     void HandleButtons();
     void MuteVolume(float slewTime);
@@ -28,12 +28,15 @@
 #include <thread>
 #include <iostream>
 #include "FfmpegDecoderStream.hpp"
+#include "../LsNumerics/MixKernels.hpp"
 #include <algorithm>
 #include <cstdio>
+#include "../LsNumerics/Denorms.hpp"
 
 // using namespace lv2c::lv2_plugin;
 
 using namespace toob;
+using namespace LsNumerics;
 
 static REGISTRATION_DECLARATION PluginRegistration<ToobRecordMono> registration(ToobRecordMono::URI);
 
@@ -57,6 +60,7 @@ ToobRecordMono::ToobRecordMono(
     recordingDirectory.reserve(1024);
 
     this->isStereo = channels > 1;
+    cpuLoadMeter.SetSampleRate(rate);
 
     this->recordingDirectory = "/tmp";
 
@@ -217,8 +221,32 @@ void ToobRecordMono::StopRecording()
     lv2AudioFileProcessor.StopRecording();
 }
 
+void ToobRecordMono::ConnectPort(uint32_t port, void *data)
+{
+    if (!isStereo && port >= (uint32_t)PortId::inR)
+    {
+        // The mono plugin has no inR/outR ports, so the ports that follow them are two indices lower.
+        port += 2;
+    }
+    super::ConnectPort(port, data);
+    switch ((PortId)port)
+    {
+    case PortId::cpuLoad:
+        cpuLoadMeter.SetLoadData(data);
+        break;
+    case PortId::cpuPeak:
+        cpuLoadMeter.SetPeakData(data);
+        break;
+    default:
+        break;
+    }
+}
+
 void ToobRecordMono::Run(uint32_t n_samples)
 {
+    RtTraceScope traceScope(traceSource);
+    CpuLoadMeter::Scope cpuLoadScope(cpuLoadMeter, n_samples);
+    LsNumerics::AutoDenorm autoDenorm;
 
     if (this->loadRequested)
     {
@@ -327,10 +355,7 @@ void ToobRecordMono::Mix(uint32_t n_samples)
     if (state == ProcessorState::Playing || state == ProcessorState::CuePlayingThenPlay)
     {
         /// mute thrue audio when playing back because we are "previewing"  the recording.
-        for (size_t i = 0; i < n_samples; ++i)
-        {
-            dst[i] = 0; // mute thru audio.
-        }
+        MixKernels::Zero(dst, n_samples); // mute thru audio.
         lv2AudioFileProcessor.Play(dst, n_samples);
     }
 }
@@ -362,11 +387,8 @@ void ToobRecordStereo::Mix(uint32_t n_samples)
     {
         // We are "previewing" the recoding, so mute thru audio.
         // this is to avoid clicks when the playback starts.
-        for (uint32_t i = 0; i < n_samples; ++i)
-        {
-            dstL[i] = 0;
-            dstR[i] = 0;
-        }
+        MixKernels::Zero(dstL, n_samples);
+        MixKernels::Zero(dstR, n_samples);
         lv2AudioFileProcessor.Play(dstL, dstR, n_samples);
     }
 }
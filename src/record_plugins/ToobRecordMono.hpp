@@ -30,6 +30,8 @@
 #include <queue>
 
 #include "Lv2AudioFileProcessor.hpp"
+#include "../RtTrace.hpp"
+#include "../CpuLoadMeter.hpp"
 
 using namespace lv2c::lv2_plugin;
 using namespace record_plugin;
@@ -74,6 +76,7 @@ protected:
     virtual std::string bgGetLoopJson(const std::string &filePath) override { return ""; }
     virtual void bgSaveLoopJson(const std::string &filePath, const std::string &loopJson) override {}
     virtual void OnFgLoopJsonChanged(const char*loopJson) override {}
+    virtual void OnFgWaveformChanged(const char*waveformJson) override {}
   
     struct Urids
     {
@@ -85,6 +88,8 @@ protected:
 
     virtual void Mix(uint32_t n_samples);
 
+    virtual void ConnectPort(uint32_t port, void *data) override;
+
     virtual void Run(uint32_t n_samples) override;
 
     virtual void Activate() override;
@@ -155,6 +160,10 @@ protected:
     std::string recordingDirectory;
 
     size_t realtimeWriteIndex = 0;
+
+private:
+    RtTraceSource traceSource{"ToobRecordMono"};
+    CpuLoadMeter cpuLoadMeter;
 };
 
 class ToobRecordStereo : public ToobRecordMono
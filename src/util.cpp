@@ -26,6 +26,7 @@
 #include <memory.h>
 #include "ss.hpp"
 #include <stdexcept>
+#include <cstdlib>
 #include <random>
 #include <mutex>
 #include <fstream>
@@ -44,7 +45,7 @@ using namespace toob;
 #endif
 void toob::SetThreadName(const std::string &name)
 {
-    std::string threadName = "crvb_" + name;
+    std::string threadName = "toob_" + name;
     if (threadName.length() > 15)
     {
         threadName = threadName.substr(0, 15);
@@ -193,4 +194,19 @@ std::filesystem::path toob::TemporaryFilename(const std::string &prefix, const s
 
     
 
-}
\ No newline at end of file
+}
+
+std::filesystem::path toob::GetUserCacheDirectory()
+{
+    const char *cacheHome = getenv("XDG_CACHE_HOME");
+    if (cacheHome && cacheHome[0] != '\0')
+    {
+        return std::filesystem::path(cacheHome) / "toob";
+    }
+    const char *home = getenv("HOME");
+    if (home && home[0] != '\0')
+    {
+        return std::filesystem::path(home) / ".cache" / "toob";
+    }
+    return std::filesystem::path();
+}
@@ -41,6 +41,9 @@ namespace toob
 
     std::filesystem::path TemporaryFilename(const std::string &prefix = "", const std::string&extension = ".tmp");
 
+    // $XDG_CACHE_HOME/toob, or ~/.cache/toob. Empty if neither is available.
+    std::filesystem::path GetUserCacheDirectory();
+
     class Finally
     {
     public: